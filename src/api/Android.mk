@@ -52,6 +52,7 @@ LOCAL_MODULE := libiot
 LOCAL_SRC_FILES := \
 	./iot_action.c \
 	./iot_alarm.c \
+	./iot_archive.c \
 	./iot_attribute.c \
 	./iot_base.c \
 	./iot_base64.c \
@@ -65,9 +66,13 @@ LOCAL_SRC_FILES := \
 	./iot_telemetry.c \
 	./checksum/iot_checksum.c \
 	./checksum/iot_checksum_crc32.c \
+	./checksum/iot_checksum_md5.c \
+	./checksum/iot_checksum_sha256.c \
 	./json/iot_json_decode.c \
 	./json/iot_json_encode.c \
 	./json/iot_json_base.c \
+	./json/iot_json_path.c \
+	./json/iot_json_stream.c \
 	./plugin/iot_plugin_builtin.c
 include $(BUILD_SHARED_LIBRARY)
 
@@ -17,6 +17,146 @@
 
 #include "iot_checksum.h"
 #include "iot_checksum_crc32.h"
+#include "iot_checksum_md5.h"
+#include "iot_checksum_sha256.h"
+
+#if ( defined( __unix__ ) || defined( __APPLE__ ) ) && !defined( _WRS_KERNEL )
+/** @brief files can be mapped into memory to be hashed */
+#	define IOT_CHECKSUM_MMAP
+#	include <fcntl.h>    /* for open */
+#	include <sys/mman.h> /* for mmap, munmap */
+#	include <sys/stat.h> /* for fstat */
+#	include <unistd.h>   /* for close */
+#endif /* if ( defined( __unix__ ) || defined( __APPLE__ ) ) && ... */
+
+/** @brief size of the blocks used by MD5 and SHA256 */
+#define IOT_CHECKSUM_BLOCK_SIZE               64u
+/** @brief amount of data added to each context at a time when updating
+ *         several, small enough to stay in the processor's cache */
+#define IOT_CHECKSUM_CHUNK_SIZE               16384u
+/** @brief size of the buffer used to read a file on the heap */
+#define IOT_CHECKSUM_FILE_BUFFER              65536u
+/** @brief size of the buffer used to read a file on the stack */
+#define IOT_CHECKSUM_STACK_BUFFER             4096u
+
+/**
+ * @brief adds whole blocks of data to a block based checksum
+ *
+ * @param[in]      type                checksum algorithm
+ * @param[in,out]  h                   state of the calculation
+ * @param[in]      data                blocks of data to add
+ * @param[in]      blocks              number of blocks
+ */
+static void iot_checksum_blocks( iot_checksum_type_t type,
+	iot_uint32_t *h, const unsigned char *data, size_t blocks );
+
+/**
+ * @brief returns the size of the digest produced by an algorithm
+ *
+ * @param[in]      type                checksum algorithm
+ *
+ * @return the size of the digest in bytes, 0 if not supported
+ */
+static size_t iot_checksum_size( iot_checksum_type_t type );
+
+iot_status_t iot_checksum_digest_get(
+	const iot_checksum_context_t *ctx,
+	unsigned char *digest,
+	size_t len,
+	size_t *digest_len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( ctx && digest )
+	{
+		const size_t size = iot_checksum_size( ctx->type );
+		result = IOT_STATUS_NOT_SUPPORTED;
+		if ( size > 0u && len < size )
+			result = IOT_STATUS_FULL;
+		else if ( ctx->type == IOT_CHECKSUM_TYPE_CRC32 )
+		{
+			digest[0] = (unsigned char)( ctx->state.crc32 >> 24 );
+			digest[1] = (unsigned char)( ctx->state.crc32 >> 16 );
+			digest[2] = (unsigned char)( ctx->state.crc32 >> 8 );
+			digest[3] = (unsigned char)( ctx->state.crc32 );
+			result = IOT_STATUS_SUCCESS;
+		}
+		else if ( size > 0u )
+		{
+			/* pad a copy of the state, so more can be added later */
+			iot_uint32_t h[8u];
+			unsigned char block[ IOT_CHECKSUM_BLOCK_SIZE * 2u ];
+			const iot_uint64_t bits = ctx->state.digest.length * 8u;
+			size_t used = (size_t)( ctx->state.digest.length %
+				IOT_CHECKSUM_BLOCK_SIZE );
+			size_t blocks = 1u;
+			size_t i;
+
+			os_memcpy( h, ctx->state.digest.h, sizeof( h ) );
+			os_memzero( block, sizeof( block ) );
+			os_memcpy( block, ctx->state.digest.block, used );
+			block[used++] = 0x80u;
+			if ( used > IOT_CHECKSUM_BLOCK_SIZE - 8u )
+				blocks = 2u;
+			for ( i = 0u; i < 8u; ++i )
+			{
+				/* md5 uses little-endian, sha256 big-endian */
+				const unsigned char b =
+					(unsigned char)( bits >> ( i * 8u ) );
+				if ( ctx->type == IOT_CHECKSUM_TYPE_MD5 )
+					block[blocks * IOT_CHECKSUM_BLOCK_SIZE - 8u + i] = b;
+				else
+					block[blocks * IOT_CHECKSUM_BLOCK_SIZE - 1u - i] = b;
+			}
+			iot_checksum_blocks( ctx->type, h, block, blocks );
+
+			for ( i = 0u; i < size; ++i )
+			{
+				if ( ctx->type == IOT_CHECKSUM_TYPE_MD5 )
+					digest[i] = (unsigned char)
+						( h[i / 4u] >> ( ( i % 4u ) * 8u ) );
+				else
+					digest[i] = (unsigned char)
+						( h[i / 4u] >> ( ( 3u - i % 4u ) * 8u ) );
+			}
+			result = IOT_STATUS_SUCCESS;
+		}
+
+		if ( result == IOT_STATUS_SUCCESS && digest_len )
+			*digest_len = size;
+	}
+	return result;
+}
+
+iot_status_t iot_checksum_digest_hex_get(
+	const iot_checksum_context_t *ctx,
+	char *hex,
+	size_t len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( ctx && hex )
+	{
+		unsigned char digest[ IOT_CHECKSUM_SIZE_MAX ];
+		size_t digest_len = 0u;
+
+		result = iot_checksum_digest_get( ctx, digest, sizeof( digest ),
+			&digest_len );
+		if ( result == IOT_STATUS_SUCCESS &&
+			len < IOT_CHECKSUM_HEX_SIZE( digest_len ) + 1u )
+			result = IOT_STATUS_FULL;
+		if ( result == IOT_STATUS_SUCCESS )
+		{
+			const char *const hex_chars = "0123456789abcdef";
+			size_t i;
+			for ( i = 0u; i < digest_len; ++i )
+			{
+				hex[i * 2u] = hex_chars[digest[i] >> 4];
+				hex[i * 2u + 1u] = hex_chars[digest[i] & 0xFu];
+			}
+			hex[digest_len * 2u] = '\0';
+		}
+	}
+	return result;
+}
 
 iot_status_t iot_checksum_file_get(
 	iot_t *lib,
@@ -34,11 +174,269 @@ iot_status_t iot_checksum_file_get(
 			break;
 		case IOT_CHECKSUM_TYPE_MD5:
 		case IOT_CHECKSUM_TYPE_SHA256:
+			/* digest is larger than the integer returned */
+			IOT_LOG( lib, IOT_LOG_ERROR, "%s",
+				"Checksum does not fit in an integer, "
+				"use iot_checksum_file_update" );
+			result = IOT_STATUS_NOT_SUPPORTED;
+			break;
 		default:
 			IOT_LOG( lib, IOT_LOG_ERROR, "%s",
 				"Checksum algorithm not support" );
+			result = IOT_STATUS_NOT_SUPPORTED;
 			break;
 		}
 	}
 	return result;
 }
+
+iot_status_t iot_checksum_file_update(
+	os_file_t file,
+	iot_checksum_context_t *ctx,
+	size_t count )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( file && ctx && count > 0u )
+	{
+		union
+		{
+			unsigned char data[ IOT_CHECKSUM_STACK_BUFFER ];
+			iot_uint64_t align;
+		} stack_buf;
+		unsigned char *buf = stack_buf.data;
+		size_t buf_size = sizeof( stack_buf.data );
+		size_t bytes;
+#ifndef IOT_STACK_ONLY
+		unsigned char *const heap_buf =
+			os_malloc( IOT_CHECKSUM_FILE_BUFFER );
+		if ( heap_buf )
+		{
+			buf = heap_buf;
+			buf_size = IOT_CHECKSUM_FILE_BUFFER;
+		}
+#endif /* ifndef IOT_STACK_ONLY */
+
+		result = iot_checksum_update_multiple( ctx, count, NULL, 0u );
+		while ( result == IOT_STATUS_SUCCESS &&
+			( bytes = os_file_read( buf, 1u, buf_size, file ) ) > 0u )
+			result = iot_checksum_update_multiple(
+				ctx, count, buf, bytes );
+		if ( result == IOT_STATUS_SUCCESS &&
+			os_file_eof( file ) == OS_FALSE )
+			result = IOT_STATUS_IO_ERROR;
+
+#ifndef IOT_STACK_ONLY
+		if ( heap_buf )
+			os_free( heap_buf );
+#endif /* ifndef IOT_STACK_ONLY */
+	}
+	return result;
+}
+
+iot_status_t iot_checksum_finalize(
+	const iot_checksum_context_t *ctx,
+	iot_uint64_t *checksum )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( ctx && checksum )
+	{
+		result = IOT_STATUS_NOT_SUPPORTED;
+		if ( ctx->type == IOT_CHECKSUM_TYPE_CRC32 )
+		{
+			*checksum = (iot_uint64_t)ctx->state.crc32;
+			result = IOT_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+void iot_checksum_blocks( iot_checksum_type_t type,
+	iot_uint32_t *h, const unsigned char *data, size_t blocks )
+{
+	if ( type == IOT_CHECKSUM_TYPE_MD5 )
+		iot_checksum_md5_blocks( h, data, blocks );
+	else
+		iot_checksum_sha256_blocks( h, data, blocks );
+}
+
+iot_status_t iot_checksum_initialize(
+	iot_checksum_context_t *ctx,
+	iot_checksum_type_t type )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( ctx )
+	{
+		os_memzero( ctx, sizeof( iot_checksum_context_t ) );
+		ctx->type = type;
+		result = IOT_STATUS_SUCCESS;
+		if ( type == IOT_CHECKSUM_TYPE_MD5 )
+			iot_checksum_md5_initialize( ctx->state.digest.h );
+		else if ( type == IOT_CHECKSUM_TYPE_SHA256 )
+			iot_checksum_sha256_initialize( ctx->state.digest.h );
+		else if ( type != IOT_CHECKSUM_TYPE_CRC32 )
+			result = IOT_STATUS_NOT_SUPPORTED;
+	}
+	return result;
+}
+
+iot_status_t iot_checksum_path_update(
+	const char *path,
+	iot_checksum_context_t *ctx,
+	size_t count )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( path && ctx && count > 0u )
+	{
+		iot_bool_t done = IOT_FALSE;
+#ifdef IOT_CHECKSUM_MMAP
+		/* map the file, no copy is made into a buffer */
+		const int fd = open( path, O_RDONLY );
+		if ( fd >= 0 )
+		{
+			struct stat st;
+			if ( fstat( fd, &st ) == 0 && S_ISREG( st.st_mode ) &&
+				(iot_uint64_t)st.st_size <= (iot_uint64_t)SIZE_MAX )
+			{
+				const size_t size = (size_t)st.st_size;
+				void *map = NULL;
+				if ( size > 0u )
+					map = mmap( NULL, size, PROT_READ,
+						MAP_PRIVATE, fd, 0 );
+				if ( size == 0u )
+				{
+					result = iot_checksum_update_multiple(
+						ctx, count, NULL, 0u );
+					done = IOT_TRUE;
+				}
+				else if ( map != MAP_FAILED )
+				{
+#ifdef POSIX_MADV_SEQUENTIAL
+					posix_madvise( map, size,
+						POSIX_MADV_SEQUENTIAL );
+#endif /* ifdef POSIX_MADV_SEQUENTIAL */
+					result = iot_checksum_update_multiple(
+						ctx, count, map, size );
+					munmap( map, size );
+					done = IOT_TRUE;
+				}
+			}
+			close( fd );
+		}
+#endif /* ifdef IOT_CHECKSUM_MMAP */
+
+		/* otherwise read the file in large chunks */
+		if ( done == IOT_FALSE )
+		{
+			os_file_t file = os_file_open( path, OS_READ );
+			result = IOT_STATUS_FILE_OPEN_FAILED;
+			if ( file )
+			{
+				result = iot_checksum_file_update( file, ctx,
+					count );
+				os_file_close( file );
+			}
+		}
+	}
+	return result;
+}
+
+size_t iot_checksum_size( iot_checksum_type_t type )
+{
+	size_t result = 0u;
+	if ( type == IOT_CHECKSUM_TYPE_CRC32 )
+		result = IOT_CHECKSUM_CRC32_SIZE;
+	else if ( type == IOT_CHECKSUM_TYPE_MD5 )
+		result = IOT_CHECKSUM_MD5_SIZE;
+	else if ( type == IOT_CHECKSUM_TYPE_SHA256 )
+		result = IOT_CHECKSUM_SHA256_SIZE;
+	return result;
+}
+
+iot_status_t iot_checksum_update(
+	iot_checksum_context_t *ctx,
+	const void *buf,
+	size_t len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( ctx && ( buf || len == 0u ) )
+	{
+		result = IOT_STATUS_NOT_SUPPORTED;
+		if ( ctx->type == IOT_CHECKSUM_TYPE_CRC32 )
+		{
+			ctx->state.crc32 = iot_checksum_crc32_update(
+				ctx->state.crc32, buf, len );
+			result = IOT_STATUS_SUCCESS;
+		}
+		else if ( iot_checksum_size( ctx->type ) > 0u )
+		{
+			const unsigned char *p = (const unsigned char *)buf;
+			size_t used = (size_t)( ctx->state.digest.length %
+				IOT_CHECKSUM_BLOCK_SIZE );
+
+			ctx->state.digest.length += len;
+
+			/* complete a partially filled block */
+			if ( used > 0u )
+			{
+				size_t fill = IOT_CHECKSUM_BLOCK_SIZE - used;
+				if ( fill > len )
+					fill = len;
+				os_memcpy( &ctx->state.digest.block[used], p, fill );
+				used += fill;
+				p += fill;
+				len -= fill;
+				if ( used == IOT_CHECKSUM_BLOCK_SIZE )
+					iot_checksum_blocks( ctx->type,
+						ctx->state.digest.h,
+						ctx->state.digest.block, 1u );
+			}
+
+			/* whole blocks straight from the data, keep the rest */
+			if ( len >= IOT_CHECKSUM_BLOCK_SIZE )
+			{
+				const size_t blocks = len / IOT_CHECKSUM_BLOCK_SIZE;
+				iot_checksum_blocks( ctx->type,
+					ctx->state.digest.h, p, blocks );
+				p += blocks * IOT_CHECKSUM_BLOCK_SIZE;
+				len -= blocks * IOT_CHECKSUM_BLOCK_SIZE;
+			}
+			if ( len > 0u )
+				os_memcpy( ctx->state.digest.block, p, len );
+			result = IOT_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+iot_status_t iot_checksum_update_multiple(
+	iot_checksum_context_t *ctx,
+	size_t count,
+	const void *buf,
+	size_t len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( ctx && count > 0u && ( buf || len == 0u ) )
+	{
+		const unsigned char *p = (const unsigned char *)buf;
+		size_t i;
+
+		result = IOT_STATUS_SUCCESS;
+		for ( i = 0u; i < count && result == IOT_STATUS_SUCCESS; ++i )
+			if ( iot_checksum_size( ctx[i].type ) == 0u )
+				result = IOT_STATUS_NOT_SUPPORTED;
+
+		/* each chunk is hashed by every context while it is still in
+		 * the processor's cache */
+		while ( result == IOT_STATUS_SUCCESS && len > 0u )
+		{
+			size_t chunk = len;
+			if ( chunk > IOT_CHECKSUM_CHUNK_SIZE )
+				chunk = IOT_CHECKSUM_CHUNK_SIZE;
+			for ( i = 0u; i < count && result == IOT_STATUS_SUCCESS; ++i )
+				result = iot_checksum_update( &ctx[i], p, chunk );
+			p += chunk;
+			len -= chunk;
+		}
+	}
+	return result;
+}
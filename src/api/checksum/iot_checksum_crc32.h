@@ -35,4 +35,77 @@ iot_status_t iot_checksum_crc32_file_get(
 	os_file_t file,
 	iot_uint64_t *checksum );
 
+/**
+ * @brief updates a CRC-32 checksum using the fastest method available on
+ *        the processor, falling back to @p iot_checksum_crc32_slice8
+ *
+ * @param[in]      crc                 checksum of the previous data (0 for
+ *                                     the start of the data)
+ * @param[in]      buf                 data to add
+ * @param[in]      size                number of bytes in the data
+ *
+ * @return the checksum of the previous data followed by @p buf
+ *
+ * @see iot_checksum_crc32_hardware_name
+ */
+iot_uint32_t iot_checksum_crc32_hardware(
+	iot_uint32_t crc,
+	const void *buf,
+	size_t size );
+
+/**
+ * @brief returns the name of the processor feature used to accelerate
+ *        CRC-32 calculations
+ *
+ * @return the name of the feature, NULL if the processor has none
+ */
+const char *iot_checksum_crc32_hardware_name( void );
+
+/**
+ * @brief updates a CRC-32 checksum one byte at a time (reference
+ *        implementation)
+ *
+ * @param[in]      crc                 checksum of the previous data (0 for
+ *                                     the start of the data)
+ * @param[in]      buf                 data to add
+ * @param[in]      size                number of bytes in the data
+ *
+ * @return the checksum of the previous data followed by @p buf
+ */
+iot_uint32_t iot_checksum_crc32_reference(
+	iot_uint32_t crc,
+	const void *buf,
+	size_t size );
+
+/**
+ * @brief updates a CRC-32 checksum eight bytes at a time using
+ *        slicing-by-8 tables (portable implementation)
+ *
+ * @param[in]      crc                 checksum of the previous data (0 for
+ *                                     the start of the data)
+ * @param[in]      buf                 data to add
+ * @param[in]      size                number of bytes in the data
+ *
+ * @return the checksum of the previous data followed by @p buf
+ */
+iot_uint32_t iot_checksum_crc32_slice8(
+	iot_uint32_t crc,
+	const void *buf,
+	size_t size );
+
+/**
+ * @brief updates a CRC-32 checksum with more data
+ *
+ * @param[in]      crc                 checksum of the previous data (0 for
+ *                                     the start of the data)
+ * @param[in]      buf                 data to add
+ * @param[in]      size                number of bytes in the data
+ *
+ * @return the checksum of the previous data followed by @p buf
+ */
+iot_uint32_t iot_checksum_crc32_update(
+	iot_uint32_t crc,
+	const void *buf,
+	size_t size );
+
 #endif /* IOT_CHECKSUM_CRC32_H */
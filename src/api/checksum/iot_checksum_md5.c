@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief source file for calculating md5 checksums (RFC 1321)
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "iot_checksum_md5.h"
+
+/** @brief rotates a 32-bit value left */
+#define IOT_CHECKSUM_MD5_ROTATE(x,n) \
+	( ( (x) << (n) ) | ( (x) >> ( 32u - (n) ) ) )
+
+/** @brief round 1 function */
+#define IOT_CHECKSUM_MD5_ROUND1(x,y,z)     ( (z) ^ ( (x) & ( (y) ^ (z) ) ) )
+/** @brief round 2 function */
+#define IOT_CHECKSUM_MD5_ROUND2(x,y,z)     ( (y) ^ ( (z) & ( (x) ^ (y) ) ) )
+/** @brief round 3 function */
+#define IOT_CHECKSUM_MD5_ROUND3(x,y,z)     ( (x) ^ (y) ^ (z) )
+/** @brief round 4 function */
+#define IOT_CHECKSUM_MD5_ROUND4(x,y,z)     ( (y) ^ ( (x) | ~(z) ) )
+
+/** @brief one step of the calculation */
+#define IOT_CHECKSUM_MD5_STEP(f,a,b,c,d,m,k,s) \
+	(a) += f( (b), (c), (d) ) + (m) + (k); \
+	(a) = IOT_CHECKSUM_MD5_ROTATE( (a), (s) ) + (b)
+
+void iot_checksum_md5_initialize(
+	iot_uint32_t *h )
+{
+	h[0] = 0x67452301u;
+	h[1] = 0xefcdab89u;
+	h[2] = 0x98badcfeu;
+	h[3] = 0x10325476u;
+}
+
+void iot_checksum_md5_blocks(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks )
+{
+	while ( blocks > 0u )
+	{
+		iot_uint32_t m[16u];
+		iot_uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+		unsigned int i;
+
+		/* md5 words are little-endian */
+		for ( i = 0u; i < 16u; ++i )
+			m[i] = (iot_uint32_t)data[i * 4u] |
+				(iot_uint32_t)data[i * 4u + 1u] << 8 |
+				(iot_uint32_t)data[i * 4u + 2u] << 16 |
+				(iot_uint32_t)data[i * 4u + 3u] << 24;
+
+		/* round 1 */
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, a, b, c, d, m[ 0], 0xd76aa478u,  7u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, d, a, b, c, m[ 1], 0xe8c7b756u, 12u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, c, d, a, b, m[ 2], 0x242070dbu, 17u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, b, c, d, a, m[ 3], 0xc1bdceeeu, 22u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, a, b, c, d, m[ 4], 0xf57c0fafu,  7u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, d, a, b, c, m[ 5], 0x4787c62au, 12u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, c, d, a, b, m[ 6], 0xa8304613u, 17u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, b, c, d, a, m[ 7], 0xfd469501u, 22u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, a, b, c, d, m[ 8], 0x698098d8u,  7u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, d, a, b, c, m[ 9], 0x8b44f7afu, 12u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, c, d, a, b, m[10], 0xffff5bb1u, 17u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, b, c, d, a, m[11], 0x895cd7beu, 22u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, a, b, c, d, m[12], 0x6b901122u,  7u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, d, a, b, c, m[13], 0xfd987193u, 12u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, c, d, a, b, m[14], 0xa679438eu, 17u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND1, b, c, d, a, m[15], 0x49b40821u, 22u );
+
+		/* round 2 */
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, a, b, c, d, m[ 1], 0xf61e2562u,  5u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, d, a, b, c, m[ 6], 0xc040b340u,  9u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, c, d, a, b, m[11], 0x265e5a51u, 14u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, b, c, d, a, m[ 0], 0xe9b6c7aau, 20u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, a, b, c, d, m[ 5], 0xd62f105du,  5u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, d, a, b, c, m[10], 0x02441453u,  9u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, c, d, a, b, m[15], 0xd8a1e681u, 14u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, b, c, d, a, m[ 4], 0xe7d3fbc8u, 20u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, a, b, c, d, m[ 9], 0x21e1cde6u,  5u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, d, a, b, c, m[14], 0xc33707d6u,  9u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, c, d, a, b, m[ 3], 0xf4d50d87u, 14u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, b, c, d, a, m[ 8], 0x455a14edu, 20u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, a, b, c, d, m[13], 0xa9e3e905u,  5u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, d, a, b, c, m[ 2], 0xfcefa3f8u,  9u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, c, d, a, b, m[ 7], 0x676f02d9u, 14u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND2, b, c, d, a, m[12], 0x8d2a4c8au, 20u );
+
+		/* round 3 */
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, a, b, c, d, m[ 5], 0xfffa3942u,  4u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, d, a, b, c, m[ 8], 0x8771f681u, 11u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, c, d, a, b, m[11], 0x6d9d6122u, 16u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, b, c, d, a, m[14], 0xfde5380cu, 23u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, a, b, c, d, m[ 1], 0xa4beea44u,  4u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, d, a, b, c, m[ 4], 0x4bdecfa9u, 11u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, c, d, a, b, m[ 7], 0xf6bb4b60u, 16u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, b, c, d, a, m[10], 0xbebfbc70u, 23u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, a, b, c, d, m[13], 0x289b7ec6u,  4u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, d, a, b, c, m[ 0], 0xeaa127fau, 11u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, c, d, a, b, m[ 3], 0xd4ef3085u, 16u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, b, c, d, a, m[ 6], 0x04881d05u, 23u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, a, b, c, d, m[ 9], 0xd9d4d039u,  4u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, d, a, b, c, m[12], 0xe6db99e5u, 11u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, c, d, a, b, m[15], 0x1fa27cf8u, 16u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND3, b, c, d, a, m[ 2], 0xc4ac5665u, 23u );
+
+		/* round 4 */
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, a, b, c, d, m[ 0], 0xf4292244u,  6u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, d, a, b, c, m[ 7], 0x432aff97u, 10u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, c, d, a, b, m[14], 0xab9423a7u, 15u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, b, c, d, a, m[ 5], 0xfc93a039u, 21u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, a, b, c, d, m[12], 0x655b59c3u,  6u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, d, a, b, c, m[ 3], 0x8f0ccc92u, 10u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, c, d, a, b, m[10], 0xffeff47du, 15u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, b, c, d, a, m[ 1], 0x85845dd1u, 21u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, a, b, c, d, m[ 8], 0x6fa87e4fu,  6u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, d, a, b, c, m[15], 0xfe2ce6e0u, 10u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, c, d, a, b, m[ 6], 0xa3014314u, 15u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, b, c, d, a, m[13], 0x4e0811a1u, 21u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, a, b, c, d, m[ 4], 0xf7537e82u,  6u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, d, a, b, c, m[11], 0xbd3af235u, 10u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, c, d, a, b, m[ 2], 0x2ad7d2bbu, 15u );
+		IOT_CHECKSUM_MD5_STEP( IOT_CHECKSUM_MD5_ROUND4, b, c, d, a, m[ 9], 0xeb86d391u, 21u );
+
+		h[0] += a;
+		h[1] += b;
+		h[2] += c;
+		h[3] += d;
+		data += 64u;
+		--blocks;
+	}
+}
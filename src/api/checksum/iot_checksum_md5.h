@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief header file for calculating md5 checksums
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#ifndef IOT_CHECKSUM_MD5_H
+#define IOT_CHECKSUM_MD5_H
+
+#include <iot.h>
+
+/**
+ * @brief initial state of the md5 algorithm
+ *
+ * @param[out]     h                   state to initialize (4 words)
+ */
+void iot_checksum_md5_initialize(
+	iot_uint32_t *h );
+
+/**
+ * @brief adds whole 64-byte blocks of data to an md5 calculation
+ *
+ * @param[in,out]  h                   state of the calculation (4 words)
+ * @param[in]      data                blocks of data to add
+ * @param[in]      blocks              number of 64-byte blocks
+ */
+void iot_checksum_md5_blocks(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks );
+
+#endif /* IOT_CHECKSUM_MD5_H */
@@ -0,0 +1,419 @@
+/**
+ * @file
+ * @brief source file for calculating sha256 checksums (FIPS 180-4)
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "iot_checksum_sha256.h"
+
+#if ( defined( __x86_64__ ) || defined( __i386__ ) ) && defined( __GNUC__ )
+/** @brief intel sha extensions (SHA-NI) can be used */
+#	define IOT_CHECKSUM_SHA256_SHANI
+#	include <cpuid.h>     /* for __get_cpuid, __get_cpuid_count */
+#	include <immintrin.h> /* for _mm_sha256* */
+#elif defined( __ARM_FEATURE_SHA2 ) || defined( __ARM_FEATURE_CRYPTO )
+/** @brief ARMv8 cryptography extensions can be used */
+#	define IOT_CHECKSUM_SHA256_ARM
+#	include <arm_neon.h>  /* for vsha256* */
+#endif
+
+/** @brief rotates a 32-bit value right */
+#define IOT_CHECKSUM_SHA256_ROTATE(x,n) \
+	( ( (x) >> (n) ) | ( (x) << ( 32u - (n) ) ) )
+
+/** @brief constants added in each round */
+static const iot_uint32_t IOT_CHECKSUM_SHA256_K[64u] = {
+	0x428a2f98u, 0x71374491u, 0xb5c0fbcfu, 0xe9b5dba5u, 0x3956c25bu, 0x59f111f1u,
+	0x923f82a4u, 0xab1c5ed5u, 0xd807aa98u, 0x12835b01u, 0x243185beu, 0x550c7dc3u,
+	0x72be5d74u, 0x80deb1feu, 0x9bdc06a7u, 0xc19bf174u, 0xe49b69c1u, 0xefbe4786u,
+	0x0fc19dc6u, 0x240ca1ccu, 0x2de92c6fu, 0x4a7484aau, 0x5cb0a9dcu, 0x76f988dau,
+	0x983e5152u, 0xa831c66du, 0xb00327c8u, 0xbf597fc7u, 0xc6e00bf3u, 0xd5a79147u,
+	0x06ca6351u, 0x14292967u, 0x27b70a85u, 0x2e1b2138u, 0x4d2c6dfcu, 0x53380d13u,
+	0x650a7354u, 0x766a0abbu, 0x81c2c92eu, 0x92722c85u, 0xa2bfe8a1u, 0xa81a664bu,
+	0xc24b8b70u, 0xc76c51a3u, 0xd192e819u, 0xd6990624u, 0xf40e3585u, 0x106aa070u,
+	0x19a4c116u, 0x1e376c08u, 0x2748774cu, 0x34b0bcb5u, 0x391c0cb3u, 0x4ed8aa4au,
+	0x5b9cca4fu, 0x682e6ff3u, 0x748f82eeu, 0x78a5636fu, 0x84c87814u, 0x8cc70208u,
+	0x90befffau, 0xa4506cebu, 0xbef9a3f7u, 0xc67178f2u
+};
+
+#ifdef IOT_CHECKSUM_SHA256_SHANI
+/** @brief hardware support detected (-1: not checked yet, 0: no, 1: yes) */
+static int iot_checksum_sha256_hw_state = -1;
+
+/**
+ * @brief adds whole 64-byte blocks of data using the intel sha extensions
+ *
+ * @param[in,out]  h                   state of the calculation (8 words)
+ * @param[in]      data                blocks of data to add
+ * @param[in]      blocks              number of 64-byte blocks
+ */
+static void iot_checksum_sha256_blocks_shani(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks )
+	__attribute__(( target( "sha,sse4.1,ssse3" ) ));
+#endif /* ifdef IOT_CHECKSUM_SHA256_SHANI */
+
+void iot_checksum_sha256_blocks(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks )
+{
+#if defined( IOT_CHECKSUM_SHA256_SHANI )
+	if ( iot_checksum_sha256_hardware_name() )
+		iot_checksum_sha256_blocks_shani( h, data, blocks );
+	else
+		iot_checksum_sha256_blocks_portable( h, data, blocks );
+#elif defined( IOT_CHECKSUM_SHA256_ARM )
+	uint32x4_t state0 = vld1q_u32( &h[0] );
+	uint32x4_t state1 = vld1q_u32( &h[4] );
+	while ( blocks > 0u )
+	{
+		const uint32x4_t abcd_save = state0;
+		const uint32x4_t efgh_save = state1;
+		uint32x4_t msg[4u];
+		unsigned int i;
+
+		for ( i = 0u; i < 4u; ++i )
+			msg[i] = vreinterpretq_u32_u8( vrev32q_u8(
+				vld1q_u8( data + i * 16u ) ) );
+
+		for ( i = 0u; i < 16u; ++i )
+		{
+			const uint32x4_t wk = vaddq_u32( msg[i % 4u],
+				vld1q_u32( &IOT_CHECKSUM_SHA256_K[i * 4u] ) );
+			const uint32x4_t abcd = state0;
+
+			/* schedule the words used 4 groups from now */
+			if ( i < 12u )
+				msg[i % 4u] = vsha256su1q_u32(
+					vsha256su0q_u32( msg[i % 4u],
+						msg[( i + 1u ) % 4u] ),
+					msg[( i + 2u ) % 4u], msg[( i + 3u ) % 4u] );
+			state0 = vsha256hq_u32( state0, state1, wk );
+			state1 = vsha256h2q_u32( state1, abcd, wk );
+		}
+
+		state0 = vaddq_u32( state0, abcd_save );
+		state1 = vaddq_u32( state1, efgh_save );
+		data += 64u;
+		--blocks;
+	}
+	vst1q_u32( &h[0], state0 );
+	vst1q_u32( &h[4], state1 );
+#else
+	iot_checksum_sha256_blocks_portable( h, data, blocks );
+#endif
+}
+
+void iot_checksum_sha256_blocks_portable(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks )
+{
+	while ( blocks > 0u )
+	{
+		iot_uint32_t w[64u];
+		iot_uint32_t s[8u];
+		unsigned int i;
+
+		/* sha256 words are big-endian */
+		for ( i = 0u; i < 16u; ++i )
+			w[i] = (iot_uint32_t)data[i * 4u] << 24 |
+				(iot_uint32_t)data[i * 4u + 1u] << 16 |
+				(iot_uint32_t)data[i * 4u + 2u] << 8 |
+				(iot_uint32_t)data[i * 4u + 3u];
+		for ( i = 16u; i < 64u; ++i )
+		{
+			const iot_uint32_t s0 =
+				IOT_CHECKSUM_SHA256_ROTATE( w[i - 15u], 7u ) ^
+				IOT_CHECKSUM_SHA256_ROTATE( w[i - 15u], 18u ) ^
+				( w[i - 15u] >> 3 );
+			const iot_uint32_t s1 =
+				IOT_CHECKSUM_SHA256_ROTATE( w[i - 2u], 17u ) ^
+				IOT_CHECKSUM_SHA256_ROTATE( w[i - 2u], 19u ) ^
+				( w[i - 2u] >> 10 );
+			w[i] = w[i - 16u] + s0 + w[i - 7u] + s1;
+		}
+
+		for ( i = 0u; i < 8u; ++i )
+			s[i] = h[i];
+		for ( i = 0u; i < 64u; ++i )
+		{
+			const iot_uint32_t e1 =
+				IOT_CHECKSUM_SHA256_ROTATE( s[4], 6u ) ^
+				IOT_CHECKSUM_SHA256_ROTATE( s[4], 11u ) ^
+				IOT_CHECKSUM_SHA256_ROTATE( s[4], 25u );
+			const iot_uint32_t ch = ( s[4] & s[5] ) ^ ( ~s[4] & s[6] );
+			const iot_uint32_t t1 = s[7] + e1 + ch +
+				IOT_CHECKSUM_SHA256_K[i] + w[i];
+			const iot_uint32_t e0 =
+				IOT_CHECKSUM_SHA256_ROTATE( s[0], 2u ) ^
+				IOT_CHECKSUM_SHA256_ROTATE( s[0], 13u ) ^
+				IOT_CHECKSUM_SHA256_ROTATE( s[0], 22u );
+			const iot_uint32_t maj =
+				( s[0] & s[1] ) ^ ( s[0] & s[2] ) ^ ( s[1] & s[2] );
+			s[7] = s[6];
+			s[6] = s[5];
+			s[5] = s[4];
+			s[4] = s[3] + t1;
+			s[3] = s[2];
+			s[2] = s[1];
+			s[1] = s[0];
+			s[0] = t1 + e0 + maj;
+		}
+		for ( i = 0u; i < 8u; ++i )
+			h[i] += s[i];
+
+		data += 64u;
+		--blocks;
+	}
+}
+
+#ifdef IOT_CHECKSUM_SHA256_SHANI
+void iot_checksum_sha256_blocks_shani(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks )
+{
+	/* reverses the bytes of each word, the data is big-endian */
+	const __m128i mask = _mm_set_epi64x(
+		(long long)0x0c0d0e0f08090a0bull, (long long)0x0405060700010203ull );
+	__m128i state0, state1, msg, tmp;
+	__m128i msg0, msg1, msg2, msg3;
+
+	/* the instructions use the state as ABEF and CDGH */
+	tmp = _mm_loadu_si128( (const __m128i *)(const void *)&h[0] );
+	state1 = _mm_loadu_si128( (const __m128i *)(const void *)&h[4] );
+	tmp = _mm_shuffle_epi32( tmp, 0xB1 );
+	state1 = _mm_shuffle_epi32( state1, 0x1B );
+	state0 = _mm_alignr_epi8( tmp, state1, 8 );
+	state1 = _mm_blend_epi16( state1, tmp, 0xF0 );
+
+	while ( blocks > 0u )
+	{
+		const __m128i abef_save = state0;
+		const __m128i cdgh_save = state1;
+
+		/* rounds 0-3 */
+		msg0 = _mm_shuffle_epi8( _mm_loadu_si128(
+			(const __m128i *)(const void *)( data + 0u ) ), mask );
+		msg = _mm_add_epi32( msg0, _mm_set_epi64x(
+			(long long)0xe9b5dba5b5c0fbcfull, (long long)0x71374491428a2f98ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+		/* rounds 4-7 */
+		msg1 = _mm_shuffle_epi8( _mm_loadu_si128(
+			(const __m128i *)(const void *)( data + 16u ) ), mask );
+		msg = _mm_add_epi32( msg1, _mm_set_epi64x(
+			(long long)0xab1c5ed5923f82a4ull, (long long)0x59f111f13956c25bull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+		/* rounds 8-11 */
+		msg2 = _mm_shuffle_epi8( _mm_loadu_si128(
+			(const __m128i *)(const void *)( data + 32u ) ), mask );
+		msg = _mm_add_epi32( msg2, _mm_set_epi64x(
+			(long long)0x550c7dc3243185beull, (long long)0x12835b01d807aa98ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+		/* rounds 12-15 */
+		msg3 = _mm_shuffle_epi8( _mm_loadu_si128(
+			(const __m128i *)(const void *)( data + 48u ) ), mask );
+		msg = _mm_add_epi32( msg3, _mm_set_epi64x(
+			(long long)0xc19bf1749bdc06a7ull, (long long)0x80deb1fe72be5d74ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg3, msg2, 4 );
+		msg0 = _mm_sha256msg2_epu32( _mm_add_epi32( msg0, tmp ), msg3 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+		/* rounds 16-19 */
+		msg = _mm_add_epi32( msg0, _mm_set_epi64x(
+			(long long)0x240ca1cc0fc19dc6ull, (long long)0xefbe4786e49b69c1ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg0, msg3, 4 );
+		msg1 = _mm_sha256msg2_epu32( _mm_add_epi32( msg1, tmp ), msg0 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+		/* rounds 20-23 */
+		msg = _mm_add_epi32( msg1, _mm_set_epi64x(
+			(long long)0x76f988da5cb0a9dcull, (long long)0x4a7484aa2de92c6full ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+		msg2 = _mm_sha256msg2_epu32( _mm_add_epi32( msg2, tmp ), msg1 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+		/* rounds 24-27 */
+		msg = _mm_add_epi32( msg2, _mm_set_epi64x(
+			(long long)0xbf597fc7b00327c8ull, (long long)0xa831c66d983e5152ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+		msg3 = _mm_sha256msg2_epu32( _mm_add_epi32( msg3, tmp ), msg2 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+		/* rounds 28-31 */
+		msg = _mm_add_epi32( msg3, _mm_set_epi64x(
+			(long long)0x1429296706ca6351ull, (long long)0xd5a79147c6e00bf3ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg3, msg2, 4 );
+		msg0 = _mm_sha256msg2_epu32( _mm_add_epi32( msg0, tmp ), msg3 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+		/* rounds 32-35 */
+		msg = _mm_add_epi32( msg0, _mm_set_epi64x(
+			(long long)0x53380d134d2c6dfcull, (long long)0x2e1b213827b70a85ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg0, msg3, 4 );
+		msg1 = _mm_sha256msg2_epu32( _mm_add_epi32( msg1, tmp ), msg0 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+		/* rounds 36-39 */
+		msg = _mm_add_epi32( msg1, _mm_set_epi64x(
+			(long long)0x92722c8581c2c92eull, (long long)0x766a0abb650a7354ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+		msg2 = _mm_sha256msg2_epu32( _mm_add_epi32( msg2, tmp ), msg1 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg0 = _mm_sha256msg1_epu32( msg0, msg1 );
+
+		/* rounds 40-43 */
+		msg = _mm_add_epi32( msg2, _mm_set_epi64x(
+			(long long)0xc76c51a3c24b8b70ull, (long long)0xa81a664ba2bfe8a1ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+		msg3 = _mm_sha256msg2_epu32( _mm_add_epi32( msg3, tmp ), msg2 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg1 = _mm_sha256msg1_epu32( msg1, msg2 );
+
+		/* rounds 44-47 */
+		msg = _mm_add_epi32( msg3, _mm_set_epi64x(
+			(long long)0x106aa070f40e3585ull, (long long)0xd6990624d192e819ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg3, msg2, 4 );
+		msg0 = _mm_sha256msg2_epu32( _mm_add_epi32( msg0, tmp ), msg3 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg2 = _mm_sha256msg1_epu32( msg2, msg3 );
+
+		/* rounds 48-51 */
+		msg = _mm_add_epi32( msg0, _mm_set_epi64x(
+			(long long)0x34b0bcb52748774cull, (long long)0x1e376c0819a4c116ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg0, msg3, 4 );
+		msg1 = _mm_sha256msg2_epu32( _mm_add_epi32( msg1, tmp ), msg0 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+		msg3 = _mm_sha256msg1_epu32( msg3, msg0 );
+
+		/* rounds 52-55 */
+		msg = _mm_add_epi32( msg1, _mm_set_epi64x(
+			(long long)0x682e6ff35b9cca4full, (long long)0x4ed8aa4a391c0cb3ull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg1, msg0, 4 );
+		msg2 = _mm_sha256msg2_epu32( _mm_add_epi32( msg2, tmp ), msg1 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+		/* rounds 56-59 */
+		msg = _mm_add_epi32( msg2, _mm_set_epi64x(
+			(long long)0x8cc7020884c87814ull, (long long)0x78a5636f748f82eeull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		tmp = _mm_alignr_epi8( msg2, msg1, 4 );
+		msg3 = _mm_sha256msg2_epu32( _mm_add_epi32( msg3, tmp ), msg2 );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+		/* rounds 60-63 */
+		msg = _mm_add_epi32( msg3, _mm_set_epi64x(
+			(long long)0xc67178f2bef9a3f7ull, (long long)0xa4506ceb90befffaull ) );
+		state1 = _mm_sha256rnds2_epu32( state1, state0, msg );
+		msg = _mm_shuffle_epi32( msg, 0x0E );
+		state0 = _mm_sha256rnds2_epu32( state0, state1, msg );
+
+		state0 = _mm_add_epi32( state0, abef_save );
+		state1 = _mm_add_epi32( state1, cdgh_save );
+		data += 64u;
+		--blocks;
+	}
+
+	/* back to ABCD and EFGH */
+	tmp = _mm_shuffle_epi32( state0, 0x1B );
+	state1 = _mm_shuffle_epi32( state1, 0xB1 );
+	state0 = _mm_blend_epi16( tmp, state1, 0xF0 );
+	state1 = _mm_alignr_epi8( state1, tmp, 8 );
+	_mm_storeu_si128( (__m128i *)(void *)&h[0], state0 );
+	_mm_storeu_si128( (__m128i *)(void *)&h[4], state1 );
+}
+#endif /* ifdef IOT_CHECKSUM_SHA256_SHANI */
+
+const char *iot_checksum_sha256_hardware_name( void )
+{
+	const char *result = NULL;
+#if defined( IOT_CHECKSUM_SHA256_SHANI )
+	/* detected once, every caller finds the same answer */
+	if ( iot_checksum_sha256_hw_state < 0 )
+	{
+		unsigned int eax = 0u, ebx = 0u, ecx = 0u, edx = 0u;
+		int supported = 0;
+		if ( __get_cpuid( 1u, &eax, &ebx, &ecx, &edx ) &&
+			( ecx & bit_SSE4_1 ) && ( ecx & bit_SSSE3 ) &&
+			__get_cpuid_max( 0u, NULL ) >= 7u )
+		{
+			__get_cpuid_count( 7u, 0u, &eax, &ebx, &ecx, &edx );
+			if ( ebx & bit_SHA )
+				supported = 1;
+		}
+		iot_checksum_sha256_hw_state = supported;
+	}
+	if ( iot_checksum_sha256_hw_state > 0 )
+		result = "sha-ni";
+#elif defined( IOT_CHECKSUM_SHA256_ARM )
+	result = "armv8-sha2";
+#endif
+	return result;
+}
+
+void iot_checksum_sha256_initialize(
+	iot_uint32_t *h )
+{
+	h[0] = 0x6a09e667u;
+	h[1] = 0xbb67ae85u;
+	h[2] = 0x3c6ef372u;
+	h[3] = 0xa54ff53au;
+	h[4] = 0x510e527fu;
+	h[5] = 0x9b05688cu;
+	h[6] = 0x1f83d9abu;
+	h[7] = 0x5be0cd19u;
+}
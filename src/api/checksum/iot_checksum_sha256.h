@@ -0,0 +1,67 @@
+/**
+ * @file
+ * @brief header file for calculating sha256 checksums
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#ifndef IOT_CHECKSUM_SHA256_H
+#define IOT_CHECKSUM_SHA256_H
+
+#include <iot.h>
+
+/**
+ * @brief adds whole 64-byte blocks of data to a sha256 calculation using
+ *        the fastest method available on the processor
+ *
+ * @param[in,out]  h                   state of the calculation (8 words)
+ * @param[in]      data                blocks of data to add
+ * @param[in]      blocks              number of 64-byte blocks
+ *
+ * @see iot_checksum_sha256_hardware_name
+ */
+void iot_checksum_sha256_blocks(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks );
+
+/**
+ * @brief adds whole 64-byte blocks of data to a sha256 calculation without
+ *        using any processor extensions (portable implementation)
+ *
+ * @param[in,out]  h                   state of the calculation (8 words)
+ * @param[in]      data                blocks of data to add
+ * @param[in]      blocks              number of 64-byte blocks
+ */
+void iot_checksum_sha256_blocks_portable(
+	iot_uint32_t *h,
+	const unsigned char *data,
+	size_t blocks );
+
+/**
+ * @brief returns the name of the processor feature used to accelerate
+ *        sha256 calculations
+ *
+ * @return the name of the feature, NULL if the processor has none
+ */
+const char *iot_checksum_sha256_hardware_name( void );
+
+/**
+ * @brief initial state of the sha256 algorithm
+ *
+ * @param[out]     h                   state to initialize (8 words)
+ */
+void iot_checksum_sha256_initialize(
+	iot_uint32_t *h );
+
+#endif /* IOT_CHECKSUM_SHA256_H */
@@ -17,12 +17,14 @@
 
 #include "public/iot.h"
 
+#include "iot_action_runner.h"
 #include "iot_common.h"
 #include "shared/iot_base64.h"
 #include "shared/iot_types.h"
 
 #include <limits.h> /* for CHAR_BIT */
 #include <stdarg.h>
+#include <stddef.h> /* for offsetof */
 
 /** @brief Maximum size of action command output */
 #define IOT_ACTION_COMMAND_OUTPUT_MAX_LEN        1024u
@@ -32,8 +34,95 @@
 #define IOT_ACTION_COMMAND_STDERR                "stderr"
 /** @brief Name of the parameter containing standard out for a command */
 #define IOT_ACTION_COMMAND_STDOUT                "stdout"
+#ifndef IOT_STACK_ONLY
+/** @brief Alignment of allocations from a request's arena */
+#define IOT_ACTION_REQUEST_ARENA_ALIGN           8u
+#endif /* ifndef IOT_STACK_ONLY */
 /** @brief Characters that cannot be used in parameter names */
 #define IOT_PARAMETER_NAME_BAD_CHARACTERS        "=\\;&|"
+#ifdef IOT_ACTION_RUNNER
+/** @brief Characters in a command that require it to be run by a shell */
+#define IOT_ACTION_COMMAND_SHELL_CHARACTERS      " \t\n\"'\\$`|&;<>()*?[]{}~#!"
+/** @brief Shell used by the runner for commands containing shell syntax */
+#define IOT_ACTION_COMMAND_SHELL                 "/bin/sh"
+#endif /* ifdef IOT_ACTION_RUNNER */
+
+/**
+ * @brief Reserves a place for a request of an action to run
+ *
+ * A request may run if it is within the concurrency limits of both its action
+ * and its action's group.  Exclusive actions run only when no other request is
+ * running, and no other request starts while one runs.
+ *
+ * @note The worker mutex must be held when calling this function
+ *
+ * @param[in,out]  lib                 library handle
+ * @param[in,out]  action              action the request is for
+ *
+ * @retval IOT_FALSE                   request must wait
+ * @retval IOT_TRUE                    place reserved, request may run
+ *
+ * @see iot_action_concurrency_release
+ */
+static IOT_SECTION iot_bool_t iot_action_concurrency_acquire(
+	struct iot *lib,
+	struct iot_action *action );
+
+/**
+ * @brief Releases a place reserved for a request of an action
+ *
+ * @note The worker mutex must be held when calling this function
+ *
+ * @param[in,out]  lib                 library handle
+ * @param[in,out]  action              action the request was for
+ *
+ * @see iot_action_concurrency_acquire
+ */
+static IOT_SECTION void iot_action_concurrency_release(
+	struct iot *lib,
+	struct iot_action *action );
+
+/**
+ * @brief Reports that a request has exceeded its time limit
+ *
+ * The completion is sent using a copy of the request without its parameters,
+ * as the action may still be updating them.  If the action returned while the
+ * completion was being sent, the request is freed.
+ *
+ * @param[in,out]  lib                 library handle
+ * @param[in,out]  request             request that has exceeded its time limit
+ *                                     (removed from the deadline wheel)
+ */
+static IOT_SECTION void iot_action_deadline_expire(
+	struct iot *lib,
+	struct iot_action_request *request );
+
+/**
+ * @brief Removes a request from the deadline wheel
+ *
+ * @note The caller must hold the worker mutex
+ *
+ * @param[in,out]  lib                 library handle
+ * @param[in,out]  request             request to remove
+ */
+static IOT_SECTION void iot_action_deadline_remove(
+	struct iot *lib,
+	struct iot_action_request *request );
+
+/**
+ * @brief Adds a request to the deadline wheel
+ *
+ * @note The caller must hold the worker mutex
+ *
+ * @param[in,out]  lib                 library handle
+ * @param[in,out]  request             request to add
+ * @param[in]      time_limit          time limit of the request in
+ *                                     milliseconds
+ */
+static IOT_SECTION void iot_action_deadline_schedule(
+	struct iot *lib,
+	struct iot_action_request *request,
+	iot_millisecond_t time_limit );
 
 /**
  * @brief Executes the action specified
@@ -75,6 +164,35 @@ static IOT_SECTION iot_status_t iot_action_execute_command(
 	struct iot_action_request *request,
 	iot_millisecond_t max_time_out );
 
+#ifdef IOT_ACTION_RUNNER
+/**
+ * @brief Executes a system command using the persistent runner process
+ *
+ * Parameters are passed to the command as separate arguments, without the
+ * quoting required when the command line is interpreted by a shell.  Commands
+ * containing shell syntax are run as @ref IOT_ACTION_COMMAND_SHELL -c with the
+ * complete command line instead.
+ *
+ * @param[in]      action              action containing the registered command
+ * @param[in]      request             request received from the cloud
+ * @param[in]      command_line        complete command line for the request
+ * @param[in,out]  args                output buffers & time limit for the
+ *                                     command (updated with the return code)
+ *
+ * @retval IOT_STATUS_FAILURE          error communicating with the command
+ * @retval IOT_STATUS_NOT_INITIALIZED  runner is not available or busy, could
+ *                                     not launch the command, or the command
+ *                                     is too large for it
+ * @retval IOT_STATUS_SUCCESS          command ran to completion
+ * @retval IOT_STATUS_TIMED_OUT        command was killed after the time limit
+ */
+static IOT_SECTION iot_status_t iot_action_execute_runner(
+	const struct iot_action *action,
+	const struct iot_action_request *request,
+	const char *command_line,
+	os_system_run_args_t *args );
+#endif /* ifdef IOT_ACTION_RUNNER */
+
 /**
  * @brief Sets the value of an action option
  *
@@ -103,6 +221,24 @@ static IOT_SECTION size_t iot_action_parameter_adjustment(
 	char *command_param,
 	const char *word );
 
+/**
+ * @brief Formats the value of a parameter as a command line argument
+ *
+ * @param[in]      p                   parameter to format
+ * @param[out]     buf                 destination buffer
+ * @param[in]      len                 size of the destination buffer
+ * @param[in]      quote               whether to quote strings, for a
+ *                                     command line interpreted by a shell
+ *
+ * @return the length of the value written, @p len if the value does not fit
+ *         (nothing is written)
+ */
+static IOT_SECTION size_t iot_action_parameter_format(
+	const struct iot_action_parameter *p,
+	char *buf,
+	size_t len,
+	iot_bool_t quote );
+
 /**
  * @brief Internal function to handle action registration
  *
@@ -139,6 +275,142 @@ static IOT_SECTION iot_status_t iot_action_request_option_set_data(
 	const char *name,
 	const struct iot_data *data );
 
+#ifndef IOT_STACK_ONLY
+/**
+ * @brief Allocates memory from the arena of a request
+ *
+ * Memory is taken from the arena reserved in the request, once the arena is
+ * full the heap is used instead.  Memory taken from the arena is released
+ * when the request is freed.
+ *
+ * @param[in,out]  request             request to allocate memory for
+ * @param[in]      size                number of bytes to allocate
+ *
+ * @retval NULL                        out of memory
+ * @retval !NULL                       allocated memory
+ *
+ * @see iot_action_request_arena_free
+ * @see iot_action_request_arena_realloc
+ */
+static IOT_SECTION void *iot_action_request_arena_alloc(
+	struct iot_action_request *request,
+	size_t size );
+
+/**
+ * @brief Frees memory allocated for a request
+ *
+ * Memory from the heap is freed, memory from the arena is only reclaimed if it
+ * was the most recent allocation (otherwise it is reclaimed when the request is
+ * freed).
+ *
+ * @param[in,out]  request             request memory was allocated for
+ * @param[in]      ptr                 memory to free (optional)
+ *
+ * @see iot_action_request_arena_alloc
+ */
+static IOT_SECTION void iot_action_request_arena_free(
+	struct iot_action_request *request,
+	void *ptr );
+
+/**
+ * @brief Returns whether memory is part of the arena of a request
+ *
+ * @param[in]      request             request to check
+ * @param[in]      ptr                 memory to check
+ *
+ * @retval IOT_FALSE                   memory is not in the arena
+ * @retval IOT_TRUE                    memory is in the arena
+ */
+static IOT_SECTION iot_bool_t iot_action_request_arena_owns(
+	const struct iot_action_request *request,
+	const void *ptr );
+
+/**
+ * @brief Resizes memory allocated for a request
+ *
+ * The most recent allocation from the arena is resized in place if possible.
+ *
+ * @param[in,out]  request             request memory was allocated for
+ * @param[in]      ptr                 memory to resize (optional)
+ * @param[in]      old_size            current size of the memory
+ * @param[in]      size                new size of the memory
+ *
+ * @retval NULL                        out of memory (@p ptr is unchanged)
+ * @retval !NULL                       resized memory
+ *
+ * @see iot_action_request_arena_alloc
+ */
+static IOT_SECTION void *iot_action_request_arena_realloc(
+	struct iot_action_request *request,
+	void *ptr,
+	size_t old_size,
+	size_t size );
+
+/**
+ * @brief Copies the value referenced by data into a request
+ *
+ * Strings, raw data & locations are copied into the arena of the request (or
+ * the heap if it is full), so the value remains valid after the caller's
+ * copy is released.  The storage of the value being replaced is reused if
+ * the new value fits in it, or grown in place if it was the most recent
+ * allocation from the arena, so setting a value repeatedly does not use up
+ * the arena.
+ *
+ * @note If the storage of the previous value is on the heap and is not
+ *       reused, the caller must free it
+ *
+ * @param[in,out]  request             request to store the value in
+ * @param[in,out]  data                data to update to reference the copy
+ * @param[in]      old                 value being replaced (NULL if none)
+ *
+ * @retval IOT_STATUS_NO_MEMORY        not enough memory to copy the value
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static IOT_SECTION iot_status_t iot_action_request_data_store(
+	struct iot_action_request *request,
+	struct iot_data *data,
+	const struct iot_data *old );
+
+/**
+ * @brief Returns the storage used by a value copied into a request
+ *
+ * @param[in]      request             request holding the value
+ * @param[in]      data                value to get the storage of
+ * @param[out]     size                size of the storage
+ *
+ * @retval NULL                        value is not stored in the request
+ * @retval !NULL                       storage of the value
+ */
+static IOT_SECTION void *iot_action_request_data_storage(
+	const struct iot_action_request *request,
+	const struct iot_data *data,
+	size_t *size );
+#endif /* ifndef IOT_STACK_ONLY */
+
+/**
+ * @brief Removes the first request that is able to run from the wait queue
+ *
+ * Requests over the concurrency limit of their action are passed over, so
+ * requests for other actions are not held up behind them.  Requests after
+ * an exclusive request that must wait are not started, so that it does not
+ * wait forever.
+ *
+ * @note The worker mutex must be held when calling this function
+ *
+ * @param[in,out]  lib                 library handle
+ * @param[out]     action              action a place was reserved for (NULL
+ *                                     if the action was not found, or the
+ *                                     library is stopping)
+ *
+ * @retval NULL                        no request is able to run
+ * @retval !NULL                       request removed from the queue
+ *
+ * @see iot_action_concurrency_acquire
+ */
+static IOT_SECTION struct iot_action_request *iot_action_request_dequeue(
+	struct iot *lib,
+	struct iot_action **action );
+
 /**
  * @brief Sets a parameter value for an action request to be executed
  *
@@ -275,6 +547,235 @@ iot_action_t *iot_action_allocate(
 	return result;
 }
 
+iot_bool_t iot_action_concurrency_acquire(
+	struct iot *lib,
+	struct iot_action *action )
+{
+	iot_bool_t result = IOT_FALSE;
+	struct iot_action_group *const group = action->group;
+	if ( lib->action_exclusive_running == IOT_FALSE &&
+		( !( action->flags & IOT_ACTION_EXCLUSIVE_APP ) ||
+			lib->action_running == 0u ) &&
+		( action->max_running == 0u ||
+			action->running < action->max_running ) &&
+		( !group || group->max_running == 0u ||
+			group->running < group->max_running ) )
+	{
+		++action->running;
+		if ( group )
+			++group->running;
+		if ( action->flags & IOT_ACTION_EXCLUSIVE_APP )
+			lib->action_exclusive_running = IOT_TRUE;
+		++lib->action_running;
+		result = IOT_TRUE;
+	}
+	return result;
+}
+
+void iot_action_concurrency_release(
+	struct iot *lib,
+	struct iot_action *action )
+{
+	if ( action->running > 0u )
+		--action->running;
+	if ( action->group && action->group->running > 0u )
+		--action->group->running;
+	if ( action->flags & IOT_ACTION_EXCLUSIVE_APP )
+		lib->action_exclusive_running = IOT_FALSE;
+	if ( lib->action_running > 0u )
+		--lib->action_running;
+}
+
+iot_status_t iot_action_concurrency_set(
+	iot_action_t *action,
+	iot_uint16_t max_running )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( action )
+	{
+#ifdef IOT_THREAD_SUPPORT
+		iot_t *const lib = action->lib;
+		if ( lib && !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+			os_thread_mutex_lock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		action->max_running = max_running;
+#ifdef IOT_THREAD_SUPPORT
+		if ( lib && !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+			os_thread_mutex_unlock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		result = IOT_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+iot_status_t iot_action_deadline_check(
+	iot_t *lib )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( lib )
+	{
+		const iot_timestamp_t now = iot_timestamp_monotonic();
+		const iot_timestamp_t tick = now / IOT_ACTION_DEADLINE_TICK;
+		struct iot_action_request *expired;
+
+		do
+		{
+			expired = NULL;
+#ifdef IOT_THREAD_SUPPORT
+			if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+				os_thread_mutex_lock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+			/* each slot only needs to be checked once per call,
+			 * (clock moved backwards: wait for it to catch up) */
+			if ( tick + 1u < lib->deadline_tick ||
+				tick >= lib->deadline_tick + IOT_ACTION_DEADLINE_SLOTS )
+				lib->deadline_tick =
+					tick + 1u - IOT_ACTION_DEADLINE_SLOTS;
+
+			while ( !expired && lib->deadline_tick <= tick )
+			{
+				struct iot_action_request **link =
+					&lib->deadline_wheel[ lib->deadline_tick &
+					( IOT_ACTION_DEADLINE_SLOTS - 1u ) ];
+				while ( !expired && *link )
+				{
+					if ( (*link)->deadline <= now )
+					{
+						expired = *link;
+						*link = expired->deadline_next;
+						expired->deadline_next = NULL;
+						expired->deadline_state =
+							IOT_ACTION_DEADLINE_EXPIRING;
+						expired->cancelled = IOT_TRUE;
+					}
+					else
+						link = &(*link)->deadline_next;
+				}
+				/* stay on this slot until it has no more */
+				if ( !expired )
+					++lib->deadline_tick;
+			}
+#ifdef IOT_THREAD_SUPPORT
+			if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+				os_thread_mutex_unlock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+
+			if ( expired )
+				iot_action_deadline_expire( lib, expired );
+		} while ( expired );
+		result = IOT_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+iot_timestamp_t iot_action_deadline_next(
+	const iot_t *lib )
+{
+	iot_timestamp_t result = 0u;
+	if ( lib )
+	{
+		size_t i;
+		for ( i = 0u; i < IOT_ACTION_DEADLINE_SLOTS; ++i )
+		{
+			const struct iot_action_request *request;
+			for ( request = lib->deadline_wheel[i]; request;
+				request = request->deadline_next )
+				if ( result == 0u || request->deadline < result )
+					result = request->deadline;
+		}
+	}
+	return result;
+}
+
+void iot_action_deadline_expire(
+	struct iot *lib,
+	struct iot_action_request *request )
+{
+	char error[ IOT_NAME_MAX_LEN + 1u ];
+	struct iot_action_request timed_out;
+	iot_millisecond_t max_time_out = 0u;
+	iot_bool_t release;
+
+	IOT_LOG( lib, IOT_LOG_WARNING,
+		"Action %s exceeded its time limit of %u ms, cancelling",
+		request->name, (unsigned int)request->time_limit );
+
+	/* name, source & options are not changed while running */
+	os_memzero( &timed_out, sizeof( struct iot_action_request ) );
+	timed_out.lib = lib;
+	timed_out.name = request->name;
+	timed_out.source = request->source;
+	timed_out.option = request->option;
+	timed_out.option_count = request->option_count;
+	timed_out.flags = request->flags;
+	timed_out.time_limit = request->time_limit;
+	timed_out.result = IOT_STATUS_TIMED_OUT;
+	os_snprintf( error, IOT_NAME_MAX_LEN + 1u,
+		"time limit of %u ms exceeded",
+		(unsigned int)request->time_limit );
+	error[ IOT_NAME_MAX_LEN ] = '\0';
+	timed_out.error = error;
+	iot_plugin_perform( lib, NULL, &max_time_out,
+		IOT_OPERATION_ACTION_COMPLETE, NULL, &timed_out, NULL );
+
+#ifdef IOT_THREAD_SUPPORT
+	if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+		os_thread_mutex_lock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+	release = ( request->deadline_state == IOT_ACTION_DEADLINE_RELEASED );
+	request->deadline_state = IOT_ACTION_DEADLINE_EXPIRED;
+#ifdef IOT_THREAD_SUPPORT
+	if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+		os_thread_mutex_unlock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+
+	/* action returned while sending, it is now up to us to free it */
+	if ( release )
+		iot_action_request_free( request );
+}
+
+void iot_action_deadline_remove(
+	struct iot *lib,
+	struct iot_action_request *request )
+{
+	if ( request->deadline_state == IOT_ACTION_DEADLINE_SCHEDULED )
+	{
+		struct iot_action_request **link = &lib->deadline_wheel[
+			( request->deadline / IOT_ACTION_DEADLINE_TICK ) &
+			( IOT_ACTION_DEADLINE_SLOTS - 1u ) ];
+		while ( *link && *link != request )
+			link = &(*link)->deadline_next;
+		if ( *link )
+			*link = request->deadline_next;
+		request->deadline_next = NULL;
+		request->deadline_state = IOT_ACTION_DEADLINE_NONE;
+	}
+}
+
+void iot_action_deadline_schedule(
+	struct iot *lib,
+	struct iot_action_request *request,
+	iot_millisecond_t time_limit )
+{
+	iot_timestamp_t tick;
+
+	request->deadline = iot_timestamp_monotonic() + time_limit;
+	tick = request->deadline / IOT_ACTION_DEADLINE_TICK;
+
+	/* slot for this tick may have already been checked */
+	if ( tick < lib->deadline_tick )
+	{
+		tick = lib->deadline_tick;
+		request->deadline = tick * IOT_ACTION_DEADLINE_TICK;
+	}
+
+	request->deadline_next = lib->deadline_wheel[ tick &
+		( IOT_ACTION_DEADLINE_SLOTS - 1u ) ];
+	lib->deadline_wheel[ tick & ( IOT_ACTION_DEADLINE_SLOTS - 1u ) ] =
+		request;
+	request->deadline_state = IOT_ACTION_DEADLINE_SCHEDULED;
+}
+
 iot_status_t iot_action_deregister(
 	iot_action_t *action,
 	iot_transaction_t *txn,
@@ -546,144 +1047,8 @@ iot_status_t iot_action_execute_command(
 						}
 					}
 				}
-				switch( p->data.type )
-				{
-					case IOT_TYPE_NULL:
-						os_snprintf( param_pos,
-							space_left, "[NULL]" );
-						break;
-					case IOT_TYPE_BOOL:
-						os_snprintf( param_pos,
-							space_left, "%u",
-							p->data.value.boolean ==
-							IOT_FALSE ? 0u : 1u );
-						break;
-					case IOT_TYPE_FLOAT32:
-						os_snprintf( param_pos,
-							space_left, "%f",
-							(double)p->data.value.float32 );
-						break;
-					case IOT_TYPE_FLOAT64:
-						os_snprintf( param_pos,
-							space_left, "%f",
-							p->data.value.float64 );
-						break;
-					case IOT_TYPE_INT8:
-						os_snprintf( param_pos,
-							space_left, "%hhi",
-							p->data.value.int8 );
-						break;
-					case IOT_TYPE_INT16:
-						os_snprintf( param_pos,
-							space_left, "%hi",
-							p->data.value.int16 );
-						break;
-					case IOT_TYPE_INT32:
-						os_snprintf( param_pos,
-							space_left, "%i",
-							p->data.value.int32 );
-						break;
-					case IOT_TYPE_INT64:
-						os_snprintf( param_pos,
-							space_left, "%lli",
-							(long long int)p->data.value.int64 );
-						break;
-					case IOT_TYPE_LOCATION:
-					{
-						iot_float64_t lon = 0.0;
-						iot_float64_t lat = 0.0;
-						if ( p->data.value.location )
-						{
-							lon = p->data.value.location->longitude;
-							lat = p->data.value.location->latitude;
-						}
-						os_snprintf( param_pos,
-							space_left, "[%f,%f]",
-							lon, lat );
-						break;
-					}
-					case IOT_TYPE_RAW:
-					{
-						/* convert data to base64 */
-						const size_t min_size =
-							iot_base64_encode_size(
-								p->data.value.raw.length );
-						if ( space_left > min_size )
-						{
-							iot_base64_encode(
-								param_pos,
-								space_left,
-								(const uint8_t*)p->data.value.raw.ptr,
-								p->data.value.raw.length );
-							param_pos[min_size] = '\0';
-							param_pos += min_size;
-						}
-						break;
-					}
-					case IOT_TYPE_STRING:
-					{
-						const char *s = p->data.value.string;
-						if ( space_left > os_strlen( s ) + 2u )
-						{
-							*param_pos = '"';
-							++param_pos;
-							--space_left;
-							while ( space_left > 0u && *s != '\0' )
-							{
-								if ( *s == '"' || *s == '\\' )
-								{
-									if ( space_left > 1u )
-									{
-										*param_pos = '\\';
-										++param_pos;
-										*param_pos = *s;
-										++param_pos;
-										space_left -= 2u;
-										++s;
-									}
-									else
-										space_left = 0u;
-								}
-								else
-								{
-									*param_pos = *s;
-									++param_pos;
-									--space_left;
-									++s;
-								}
-							}
-							if ( space_left > 0u )
-							{
-								*param_pos = '"';
-								++param_pos;
-								--space_left;
-								if ( space_left > 0u )
-									*param_pos = '\0';
-							}
-						}
-						break;
-					}
-					case IOT_TYPE_UINT8:
-						os_snprintf( param_pos,
-							space_left, "%hhu",
-							p->data.value.uint8 );
-						break;
-					case IOT_TYPE_UINT16:
-						os_snprintf( param_pos,
-							space_left, "%hu",
-							p->data.value.uint16 );
-						break;
-					case IOT_TYPE_UINT32:
-						os_snprintf( param_pos,
-							space_left, "%u",
-							p->data.value.uint32 );
-						break;
-					case IOT_TYPE_UINT64:
-						os_snprintf( param_pos,
-							space_left, "%llu",
-							(long long unsigned int)p->data.value.uint64 );
-						break;
-				}
+				iot_action_parameter_format( p, param_pos,
+					space_left, IOT_TRUE );
 			}
 
 			/* script is returnable, set the output buffers */
@@ -719,6 +1084,18 @@ iot_status_t iot_action_execute_command(
 			args.cmd = command_with_params;
 			args.block = OS_TRUE;
 			args.opts.block.max_wait_time = max_time_out;
+#ifdef IOT_ACTION_RUNNER
+			/* use the runner process if it is available, it avoids
+			 * forking this process for each command */
+			system_res = OS_STATUS_FAILURE;
+			result = IOT_STATUS_NOT_INITIALIZED;
+			if ( !( action->flags & IOT_ACTION_NO_RETURN ) )
+				result = iot_action_execute_runner( action, request,
+					command_with_params, &args );
+			if ( result == IOT_STATUS_SUCCESS )
+				system_res = OS_STATUS_SUCCESS;
+			else if ( result == IOT_STATUS_NOT_INITIALIZED )
+#endif /* ifdef IOT_ACTION_RUNNER */
 			system_res = os_system_run( &args );
 			if ( system_res == OS_STATUS_SUCCESS )
 			{
@@ -775,6 +1152,82 @@ iot_status_t iot_action_execute_command(
 	return result;
 }
 
+#ifdef IOT_ACTION_RUNNER
+iot_status_t iot_action_execute_runner(
+	const struct iot_action *action,
+	const struct iot_action_request *request,
+	const char *command_line,
+	os_system_run_args_t *args )
+{
+	char arg_buf[ IOT_ACTION_RUNNER_ARG_LEN ];
+	const char *argv[ IOT_ACTION_RUNNER_ARG_MAX + 1u ];
+	size_t argc = 0u;
+	iot_status_t result = IOT_STATUS_SUCCESS;
+
+	if ( os_strpbrk( action->command,
+		IOT_ACTION_COMMAND_SHELL_CHARACTERS ) )
+	{
+		argv[argc++] = IOT_ACTION_COMMAND_SHELL;
+		argv[argc++] = "-c";
+		argv[argc++] = command_line;
+	}
+	else
+	{
+		size_t i;
+		size_t used = 0u;
+
+		argv[argc++] = action->command;
+		for ( i = 0u; i < request->parameter_count &&
+			result == IOT_STATUS_SUCCESS; ++i )
+		{
+			const struct iot_action_parameter *const p =
+				&request->parameter[i];
+			char *const arg = &arg_buf[used];
+			const size_t space = IOT_ACTION_RUNNER_ARG_LEN - used;
+			int len = 0;
+
+			if ( *p->name != '\0' )
+				len = os_snprintf( arg, space, "--%s=", p->name );
+			/* no quoting, a shell is not involved */
+			if ( len >= 0 && (size_t)len < space )
+				len += (int)iot_action_parameter_format( p,
+					&arg[len], space - (size_t)len, IOT_FALSE );
+
+			if ( len < 0 || (size_t)len >= space ||
+				argc >= IOT_ACTION_RUNNER_ARG_MAX )
+				result = IOT_STATUS_FULL;
+			else
+			{
+				argv[argc++] = arg;
+				used += (size_t)len + 1u;
+			}
+		}
+	}
+	argv[argc] = NULL;
+
+	/* too large for the runner, run it the regular way */
+	if ( result == IOT_STATUS_FULL )
+		result = IOT_STATUS_NOT_INITIALIZED;
+	else
+	{
+		result = iot_action_runner_run(
+			&action->lib->action_runner, argv,
+			args->opts.block.max_wait_time, &request->cancelled,
+			args->opts.block.std_out.buf,
+			args->opts.block.std_out.len,
+			args->opts.block.std_err.buf,
+			args->opts.block.std_err.len,
+			&args->return_code );
+		if ( result != IOT_STATUS_SUCCESS &&
+			result != IOT_STATUS_NOT_INITIALIZED )
+			IOT_LOG( action->lib, IOT_LOG_ERROR,
+				"Command \"%s\" failed in runner, reason: %s",
+				action->name, iot_error( result ) );
+	}
+	return result;
+}
+#endif /* ifdef IOT_ACTION_RUNNER */
+
 iot_status_t iot_action_flags_set(
 	iot_action_t *action,
 	iot_uint8_t flags )
@@ -870,6 +1323,69 @@ iot_status_t iot_action_free( iot_action_t *action,
 	return result;
 }
 
+iot_status_t iot_action_group_set(
+	iot_action_t *action,
+	const char *group,
+	iot_uint16_t max_running )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( action && action->lib && group && *group != '\0' )
+	{
+		iot_t *const lib = action->lib;
+		struct iot_action_group *grp = NULL;
+		iot_uint8_t i;
+
+		/* groups & counters are read by the worker threads */
+#ifdef IOT_THREAD_SUPPORT
+		if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+			os_thread_mutex_lock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		for ( i = 0u; !grp && i < lib->action_group_count; ++i )
+		{
+			if ( os_strncmp( lib->action_group[i].name, group,
+				IOT_NAME_MAX_LEN ) == 0 )
+				grp = &lib->action_group[i];
+		}
+
+		result = IOT_STATUS_FULL;
+		if ( !grp && lib->action_group_count < IOT_ACTION_GROUP_MAX )
+		{
+			grp = &lib->action_group[lib->action_group_count];
+			os_strncpy( grp->name, group, IOT_NAME_MAX_LEN );
+			grp->name[IOT_NAME_MAX_LEN] = '\0';
+			grp->running = 0u;
+			++lib->action_group_count;
+		}
+
+		if ( grp )
+		{
+			/* requests already running count against the new
+			 * group, so they are released from the right one */
+			if ( action->group != grp )
+			{
+				if ( action->group )
+				{
+					if ( action->group->running >
+						action->running )
+						action->group->running -=
+							action->running;
+					else
+						action->group->running = 0u;
+				}
+				grp->running += action->running;
+			}
+			grp->max_running = max_running;
+			action->group = grp;
+			result = IOT_STATUS_SUCCESS;
+		}
+#ifdef IOT_THREAD_SUPPORT
+		if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+			os_thread_mutex_unlock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+	}
+	return result;
+}
+
 iot_status_t iot_action_option_get(
 	const iot_action_t *action,
 	const char *name,
@@ -1153,6 +1669,136 @@ size_t iot_action_parameter_adjustment( char *command_param, const char *word )
 	return count;
 }
 
+size_t iot_action_parameter_format(
+	const struct iot_action_parameter *p,
+	char *buf,
+	size_t len,
+	iot_bool_t quote )
+{
+	size_t result = len;
+	int rc = -1;
+	switch( p->data.type )
+	{
+		case IOT_TYPE_NULL:
+			rc = os_snprintf( buf, len, "[NULL]" );
+			break;
+		case IOT_TYPE_BOOL:
+			rc = os_snprintf( buf, len, "%u",
+				p->data.value.boolean == IOT_FALSE ? 0u : 1u );
+			break;
+		case IOT_TYPE_FLOAT32:
+			rc = os_snprintf( buf, len, "%f",
+				(double)p->data.value.float32 );
+			break;
+		case IOT_TYPE_FLOAT64:
+			rc = os_snprintf( buf, len, "%f",
+				p->data.value.float64 );
+			break;
+		case IOT_TYPE_INT8:
+			rc = os_snprintf( buf, len, "%hhi",
+				p->data.value.int8 );
+			break;
+		case IOT_TYPE_INT16:
+			rc = os_snprintf( buf, len, "%hi",
+				p->data.value.int16 );
+			break;
+		case IOT_TYPE_INT32:
+			rc = os_snprintf( buf, len, "%i",
+				p->data.value.int32 );
+			break;
+		case IOT_TYPE_INT64:
+			rc = os_snprintf( buf, len, "%lli",
+				(long long int)p->data.value.int64 );
+			break;
+		case IOT_TYPE_LOCATION:
+		{
+			iot_float64_t lon = 0.0;
+			iot_float64_t lat = 0.0;
+			if ( p->data.value.location )
+			{
+				lon = p->data.value.location->longitude;
+				lat = p->data.value.location->latitude;
+			}
+			rc = os_snprintf( buf, len, "[%f,%f]", lon, lat );
+			break;
+		}
+		case IOT_TYPE_RAW:
+		{
+			/* convert data to base64 */
+			const size_t min_size = iot_base64_encode_size(
+				p->data.value.raw.length );
+			if ( len > min_size )
+			{
+				iot_base64_encode( buf, len,
+					(const uint8_t*)p->data.value.raw.ptr,
+					p->data.value.raw.length );
+				buf[min_size] = '\0';
+				/* may contain "\r\n" characters, which some
+				 * OSs (i.e. Windows) will not execute */
+				iot_action_parameter_adjustment( buf, "\r\n" );
+				rc = (int)os_strlen( buf );
+			}
+			break;
+		}
+		case IOT_TYPE_STRING:
+		{
+			const char *c;
+			size_t need = 0u;
+
+			/* quotes and backslashes are escaped within quotes */
+			for ( c = p->data.value.string; c && *c != '\0'; ++c )
+			{
+				++need;
+				if ( quote != IOT_FALSE && ( *c == '"' || *c == '\\' ) )
+					++need;
+			}
+			if ( quote != IOT_FALSE )
+				need += 2u;
+
+			if ( need < len )
+			{
+				size_t pos = 0u;
+				if ( quote != IOT_FALSE )
+					buf[pos++] = '"';
+				for ( c = p->data.value.string; c && *c != '\0'; ++c )
+				{
+					if ( quote != IOT_FALSE &&
+						( *c == '"' || *c == '\\' ) )
+						buf[pos++] = '\\';
+					buf[pos++] = *c;
+				}
+				if ( quote != IOT_FALSE )
+					buf[pos++] = '"';
+				buf[pos] = '\0';
+				rc = (int)pos;
+			}
+			break;
+		}
+		case IOT_TYPE_UINT8:
+			rc = os_snprintf( buf, len, "%hhu",
+				p->data.value.uint8 );
+			break;
+		case IOT_TYPE_UINT16:
+			rc = os_snprintf( buf, len, "%hu",
+				p->data.value.uint16 );
+			break;
+		case IOT_TYPE_UINT32:
+			rc = os_snprintf( buf, len, "%u",
+				p->data.value.uint32 );
+			break;
+		case IOT_TYPE_UINT64:
+			rc = os_snprintf( buf, len, "%llu",
+				(long long unsigned int)p->data.value.uint64 );
+			break;
+	}
+
+	if ( rc >= 0 && (size_t)rc < len )
+		result = (size_t)rc;
+	else if ( len > 0u )
+		*buf = '\0';
+	return result;
+}
+
 iot_status_t iot_action_parameter_get(
 	const iot_action_request_t *request,
 	const char *name,
@@ -1237,6 +1883,7 @@ iot_status_t iot_action_process(
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
 	if ( lib )
 	{
+		struct iot_action *action = NULL;
 		struct iot_action_request *request = NULL;
 
 		result = IOT_STATUS_NOT_FOUND;
@@ -1244,75 +1891,58 @@ iot_status_t iot_action_process(
 		if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
 		{
 			os_thread_mutex_lock( &lib->worker_mutex );
-			/* nothing to do, so wait for signal to do work */
-			if ( lib->request_queue_wait_count == 0u )
+			/* nothing able to run, so wait for signal to do work */
+			request = iot_action_request_dequeue( lib, &action );
+			if ( !request )
+			{
 				os_thread_condition_wait(
 					&lib->worker_signal,
 					&lib->worker_mutex );
-		}
-#endif /* ifdef IOT_THREAD_SUPPORT */
-		/* if this thread was not woke just to quit,
-		   then there must be a request */
-		if ( lib->request_queue_wait_count > 0u )
-		{
-			request = lib->request_queue_wait[0u];
-			--lib->request_queue_wait_count;
-
-			/* move all items up by 1 in request wait queue */
-			os_memcpy( &lib->request_queue_wait[0u],
-				&lib->request_queue_wait[1u],
-				sizeof( struct iot_action_request *) *
-					 lib->request_queue_wait_count );
-		}
-#ifdef IOT_THREAD_SUPPORT
-		if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+				request = iot_action_request_dequeue(
+					lib, &action );
+			}
 			os_thread_mutex_unlock( &lib->worker_mutex );
+		}
+		else
 #endif /* ifdef IOT_THREAD_SUPPORT */
+			request = iot_action_request_dequeue( lib, &action );
 
+		/* if this thread was not woke just to quit,
+		   then there may be a request */
 		if ( request )
 		{
-			size_t i;
-			const iot_action_t *action = NULL;
 			iot_status_t action_result = IOT_STATUS_NOT_FOUND;
-			for ( i = 0u; action == NULL &&
-				i < lib->action_count &&
-				i < IOT_ACTION_MAX; ++i )
-			{
-				action = lib->action_ptr[i];
-				if ( action && action->name )
-				{
-					if ( os_strncasecmp( action->name,
-						request->name,
-						IOT_NAME_MAX_LEN ) != 0 )
-						action = NULL;
-				}
-			}
+			iot_uint8_t deadline_state;
 
 			if ( lib->to_quit == IOT_FALSE && action )
 			{
-#ifdef IOT_THREAD_SUPPORT
-				/* lock to support exclusive actions */
-				if ( action->flags & IOT_ACTION_EXCLUSIVE_APP )
-					os_thread_rwlock_write_lock(
-						&lib->worker_thread_exclusive_lock );
-				else
-					os_thread_rwlock_read_lock(
-						&lib->worker_thread_exclusive_lock );
-#endif /* ifdef IOT_THREAD_SUPPORT */
 				IOT_LOG( lib, IOT_LOG_DEBUG,
 					"Executing action: %s", action->name );
-				action_result = iot_action_execute( action,
-					request, max_time_out );
-
+				if ( !( action->flags & IOT_ACTION_NO_TIME_LIMIT ) &&
+					action->time_limit > 0u )
+				{
 #ifdef IOT_THREAD_SUPPORT
-				/* done processing, unlock our operation */
-				if ( action->flags & IOT_ACTION_EXCLUSIVE_APP )
-					os_thread_rwlock_write_unlock(
-						&lib->worker_thread_exclusive_lock );
-				else
-					os_thread_rwlock_read_unlock(
-						&lib->worker_thread_exclusive_lock );
+					if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+						os_thread_mutex_lock(
+							&lib->worker_mutex );
 #endif /* ifdef IOT_THREAD_SUPPORT */
+					request->time_limit = action->time_limit;
+					iot_action_deadline_schedule( lib, request,
+						action->time_limit );
+#ifdef IOT_THREAD_SUPPORT
+					if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+					{
+						os_thread_mutex_unlock(
+							&lib->worker_mutex );
+						/* may be earlier than it waits for */
+						os_thread_condition_signal(
+							&lib->deadline_signal,
+							&lib->worker_mutex );
+					}
+#endif /* ifdef IOT_THREAD_SUPPORT */
+				}
+				action_result = iot_action_execute( action,
+					request, max_time_out );
 			}
 			else if ( lib->to_quit == IOT_FALSE )
 				IOT_LOG( lib, IOT_LOG_NOTICE,
@@ -1320,15 +1950,52 @@ iot_status_t iot_action_process(
 					"reason: %s", request->name,
 					iot_error( action_result ) );
 
-			/* send command execution result to the cloud */
-			iot_action_request_set_status( request,
-				action_result, NULL );
-			result = iot_plugin_perform( lib, NULL, &max_time_out,
-				IOT_OPERATION_ACTION_COMPLETE, action, request,
-				NULL );
+			/* stop the time limit, unless it has been exceeded,
+			 * and let waiting requests for the action run */
+#ifdef IOT_THREAD_SUPPORT
+			if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+				os_thread_mutex_lock( &lib->worker_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+			iot_action_deadline_remove( lib, request );
+			deadline_state = request->deadline_state;
+			if ( deadline_state == IOT_ACTION_DEADLINE_EXPIRING )
+				request->deadline_state =
+					IOT_ACTION_DEADLINE_RELEASED;
+			if ( action )
+				iot_action_concurrency_release( lib, action );
+#ifdef IOT_THREAD_SUPPORT
+			if ( !( lib->flags & IOT_FLAG_SINGLE_THREAD ) )
+			{
+				const iot_bool_t waiting =
+					lib->request_queue_wait_count > 0u;
+				os_thread_mutex_unlock( &lib->worker_mutex );
+				if ( action && waiting != IOT_FALSE )
+					os_thread_condition_broadcast(
+						&lib->worker_signal );
+			}
+#endif /* ifdef IOT_THREAD_SUPPORT */
+
+			if ( deadline_state == IOT_ACTION_DEADLINE_NONE )
+			{
+				/* send command execution result to the cloud */
+				iot_action_request_set_status( request,
+					action_result, NULL );
+				result = iot_plugin_perform( lib, NULL,
+					&max_time_out,
+					IOT_OPERATION_ACTION_COMPLETE, action,
+					request, NULL );
+			}
+			else
+				IOT_LOG( lib, IOT_LOG_NOTICE,
+					"Action %s returned after exceeding its "
+					"time limit; result: %s", request->name,
+					iot_error( action_result ) );
 
-			/* free memory associated with the request */
-			iot_action_request_free( request );
+			/* free memory associated with the request (if the
+			 * time out is still being reported, it is freed once
+			 * that is done) */
+			if ( deadline_state != IOT_ACTION_DEADLINE_EXPIRING )
+				iot_action_request_free( request );
 
 			result = IOT_STATUS_SUCCESS;
 		}
@@ -1438,13 +2105,18 @@ iot_action_request_t *iot_action_request_allocate(
 
 		if ( result )
 		{
+#ifdef IOT_STACK_ONLY
 			os_memzero( result, sizeof( struct iot_action_request ) );
 			result->lib = lib;
-#ifdef IOT_STACK_ONLY
 			result->name = result->_name;
 			result->source = result->_source;
 #else /* ifdef IOT_STACK_ONLY */
-			result->name = os_malloc( name_len + source_len + 2u );
+			/* contents of the arena don't need to be cleared */
+			os_memzero( result,
+				offsetof( struct iot_action_request, arena ) );
+			result->lib = lib;
+			result->name = iot_action_request_arena_alloc( result,
+				name_len + source_len + 2u );
 			if ( result->name )
 			{
 				if ( source_len > 0u )
@@ -1475,6 +2147,272 @@ iot_action_request_t *iot_action_request_allocate(
 	return result;
 }
 
+#ifndef IOT_STACK_ONLY
+void *iot_action_request_arena_alloc(
+	struct iot_action_request *request,
+	size_t size )
+{
+	void *result;
+	const size_t aligned = ( size + IOT_ACTION_REQUEST_ARENA_ALIGN - 1u ) &
+		~( (size_t)IOT_ACTION_REQUEST_ARENA_ALIGN - 1u );
+	if ( aligned <= IOT_ACTION_REQUEST_ARENA_SIZE - request->arena_used )
+	{
+		result = &request->arena.buf[request->arena_used];
+		request->arena_last = request->arena_used;
+		request->arena_used += aligned;
+	}
+	else
+		result = os_malloc( size );
+	return result;
+}
+
+void iot_action_request_arena_free(
+	struct iot_action_request *request,
+	void *ptr )
+{
+	if ( iot_action_request_arena_owns( request, ptr ) == IOT_FALSE )
+		os_free_null( (void **)&ptr );
+	else if ( (char *)ptr ==
+		&request->arena.buf[request->arena_last] )
+	{
+		/* most recent allocation, so it can be reused */
+		request->arena_used = request->arena_last;
+	}
+}
+
+iot_bool_t iot_action_request_arena_owns(
+	const struct iot_action_request *request,
+	const void *ptr )
+{
+	iot_bool_t result = IOT_FALSE;
+	if ( (const char *)ptr >= request->arena.buf &&
+		(const char *)ptr <
+		&request->arena.buf[IOT_ACTION_REQUEST_ARENA_SIZE] )
+		result = IOT_TRUE;
+	return result;
+}
+
+void *iot_action_request_arena_realloc(
+	struct iot_action_request *request,
+	void *ptr,
+	size_t old_size,
+	size_t size )
+{
+	void *result = NULL;
+	if ( !ptr )
+		result = iot_action_request_arena_alloc( request, size );
+	else if ( iot_action_request_arena_owns( request, ptr ) == IOT_FALSE )
+		result = os_realloc( ptr, size );
+	else
+	{
+		const size_t offset =
+			(size_t)( (char *)ptr - request->arena.buf );
+		const size_t aligned = ( size + IOT_ACTION_REQUEST_ARENA_ALIGN - 1u ) &
+			~( (size_t)IOT_ACTION_REQUEST_ARENA_ALIGN - 1u );
+
+		/* most recent allocation can grow in place */
+		if ( offset == request->arena_last &&
+			aligned <= IOT_ACTION_REQUEST_ARENA_SIZE - offset )
+		{
+			request->arena_used = offset + aligned;
+			result = ptr;
+		}
+		else
+		{
+			result = iot_action_request_arena_alloc( request, size );
+			if ( result )
+				os_memcpy( result, ptr,
+					old_size < size ? old_size : size );
+		}
+	}
+	return result;
+}
+#endif /* ifndef IOT_STACK_ONLY */
+
+iot_bool_t iot_action_request_cancelled(
+	const iot_action_request_t *request )
+{
+	iot_bool_t result = IOT_TRUE;
+	if ( request && request->lib )
+	{
+		result = request->cancelled;
+		if ( request->lib->to_quit != IOT_FALSE ||
+			( request->deadline > 0u &&
+			  iot_timestamp_monotonic() >= request->deadline ) )
+			result = IOT_TRUE;
+	}
+	return result;
+}
+
+#ifndef IOT_STACK_ONLY
+iot_status_t iot_action_request_data_store(
+	struct iot_action_request *request,
+	struct iot_data *data,
+	const struct iot_data *old )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	const void *value = NULL;
+	size_t size = 0u;
+	size_t old_size = 0u;
+	void *old_ptr = NULL;
+
+	if ( data->has_value != IOT_FALSE )
+	{
+		if ( data->type == IOT_TYPE_STRING )
+		{
+			/* supporting blank string from the cloud */
+			value = data->value.string;
+			size = 1u;
+			if ( value )
+				size += os_strlen( data->value.string );
+		}
+		else if ( data->type == IOT_TYPE_RAW )
+		{
+			value = data->value.raw.ptr;
+			size = data->value.raw.length;
+		}
+		else if ( data->type == IOT_TYPE_LOCATION )
+		{
+			value = data->value.location;
+			size = sizeof( struct iot_location );
+		}
+	}
+
+	/* storage of the old value can't be reused if it holds the new one */
+	if ( old && old->type == data->type )
+		old_ptr = iot_action_request_data_storage( request, old,
+			&old_size );
+	if ( old_ptr && value &&
+		(const char *)value + size > (const char *)old_ptr &&
+		(const char *)value < (const char *)old_ptr + old_size )
+		old_ptr = NULL;
+
+	data->heap_storage = NULL;
+	if ( size > 0u )
+	{
+		void *ptr;
+		if ( old_ptr && size <= old_size )
+			ptr = old_ptr;
+		else if ( old_ptr && iot_action_request_arena_owns( request,
+			old_ptr ) != IOT_FALSE )
+			ptr = iot_action_request_arena_realloc( request,
+				old_ptr, 0u, size );
+		else
+			ptr = iot_action_request_arena_alloc( request, size );
+		result = IOT_STATUS_NO_MEMORY;
+		if ( ptr )
+		{
+			if ( value )
+				os_memcpy( ptr, value, size );
+			else
+				*(char *)ptr = '\0';
+
+			if ( data->type == IOT_TYPE_STRING )
+				data->value.string = ptr;
+			else if ( data->type == IOT_TYPE_RAW )
+				data->value.raw.ptr = ptr;
+			else
+				data->value.location = ptr;
+
+			/* heap storage is freed with the request */
+			if ( iot_action_request_arena_owns( request, ptr )
+				== IOT_FALSE )
+				data->heap_storage = ptr;
+			result = IOT_STATUS_SUCCESS;
+		}
+	}
+	return result;
+}
+
+void *iot_action_request_data_storage(
+	const struct iot_action_request *request,
+	const struct iot_data *data,
+	size_t *size )
+{
+	void *result = NULL;
+	*size = 0u;
+	if ( data->has_value != IOT_FALSE )
+	{
+		if ( data->type == IOT_TYPE_STRING && data->value.string )
+		{
+			result = (void *)data->value.string;
+			*size = os_strlen( data->value.string ) + 1u;
+		}
+		else if ( data->type == IOT_TYPE_RAW )
+		{
+			result = (void *)data->value.raw.ptr;
+			*size = data->value.raw.length;
+		}
+		else if ( data->type == IOT_TYPE_LOCATION )
+		{
+			result = (void *)data->value.location;
+			*size = sizeof( struct iot_location );
+		}
+	}
+
+	/* only storage copied into the request can be reused */
+	if ( result && result != data->heap_storage &&
+		iot_action_request_arena_owns( request, result ) == IOT_FALSE )
+		result = NULL;
+	if ( !result )
+		*size = 0u;
+	return result;
+}
+#endif /* ifndef IOT_STACK_ONLY */
+
+struct iot_action_request *iot_action_request_dequeue(
+	struct iot *lib,
+	struct iot_action **action )
+{
+	struct iot_action_request *result = NULL;
+	iot_bool_t blocked = IOT_FALSE;
+	size_t i;
+
+	*action = NULL;
+	for ( i = 0u; !result && blocked == IOT_FALSE &&
+		i < lib->request_queue_wait_count; ++i )
+	{
+		struct iot_action_request *const request =
+			lib->request_queue_wait[i];
+		struct iot_action *req_action = NULL;
+		size_t j;
+
+		for ( j = 0u; req_action == NULL &&
+			j < lib->action_count &&
+			j < IOT_ACTION_MAX; ++j )
+		{
+			req_action = lib->action_ptr[j];
+			if ( req_action && req_action->name )
+			{
+				if ( os_strncasecmp( req_action->name,
+					request->name,
+					IOT_NAME_MAX_LEN ) != 0 )
+					req_action = NULL;
+			}
+		}
+
+		/* requests that won't be run don't need a place */
+		if ( lib->to_quit != IOT_FALSE )
+			req_action = NULL;
+		if ( !req_action || iot_action_concurrency_acquire(
+			lib, req_action ) != IOT_FALSE )
+		{
+			result = request;
+			*action = req_action;
+			--lib->request_queue_wait_count;
+
+			/* move later items up by 1 in request wait queue */
+			os_memmove( &lib->request_queue_wait[i],
+				&lib->request_queue_wait[i + 1u],
+				sizeof( struct iot_action_request *) *
+					( lib->request_queue_wait_count - i ) );
+		}
+		else if ( req_action->flags & IOT_ACTION_EXCLUSIVE_APP )
+			blocked = IOT_TRUE;
+	}
+	return result;
+}
+
 iot_status_t iot_action_request_option_get(
 	const iot_action_request_t *request,
 	const char *name,
@@ -1514,7 +2452,12 @@ iot_status_t iot_action_request_option_set(
 		struct iot_data data;
 		os_memzero( &data, sizeof( struct iot_data ) );
 		va_start( args, type );
+#ifdef IOT_STACK_ONLY
 		result = iot_common_arg_set( &data, IOT_TRUE, type, args );
+#else /* ifdef IOT_STACK_ONLY */
+		/* value is copied into the request when it is stored */
+		result = iot_common_arg_set( &data, IOT_FALSE, type, args );
+#endif /* else IOT_STACK_ONLY */
 		va_end( args );
 		if ( result == IOT_STATUS_SUCCESS )
 			result = iot_action_request_option_set_data(
@@ -1533,6 +2476,9 @@ iot_status_t iot_action_request_option_set_data(
 	{
 		unsigned int i;
 		struct iot_option *opt = NULL;
+#ifndef IOT_STACK_ONLY
+		iot_bool_t added = IOT_FALSE;
+#endif /* ifndef IOT_STACK_ONLY */
 
 		/* see if this is an option update */
 		for ( i = 0u; opt == NULL && i < request->option_count; ++i )
@@ -1546,7 +2492,9 @@ iot_status_t iot_action_request_option_set_data(
 		if ( !opt && request->option_count < IOT_OPTION_MAX )
 		{
 #ifndef IOT_STACK_ONLY
-			void *ptr = os_realloc( request->option,
+			void *ptr = iot_action_request_arena_realloc( request,
+				request->option,
+				sizeof( struct iot_option ) * request->option_count,
 				sizeof( struct iot_option ) *
 					( request->option_count + 1u ) );
 			if ( ptr )
@@ -1580,13 +2528,16 @@ iot_status_t iot_action_request_option_set_data(
 				if ( name_len > IOT_NAME_MAX_LEN )
 					name_len = IOT_NAME_MAX_LEN;
 #ifndef IOT_STACK_ONLY
-				opt->name = os_malloc( name_len + 1u );
+				opt->name = iot_action_request_arena_alloc(
+					request, name_len + 1u );
 				if ( !opt->name )
 				{
 					result = IOT_STATUS_NO_MEMORY;
 					--request->option_count;
 				}
 				else
+					added = IOT_TRUE;
+				if ( opt->name )
 #endif /* ifndef IOT_STACK_ONLY */
 				{
 					os_strncpy( opt->name, name, name_len );
@@ -1596,18 +2547,36 @@ iot_status_t iot_action_request_option_set_data(
 
 			if ( result != IOT_STATUS_NO_MEMORY )
 			{
-				if ( opt->data.heap_storage )
-					os_free( opt->data.heap_storage );
-				os_memcpy( &opt->data, data,
+				struct iot_data value;
+				os_memcpy( &value, data,
 					sizeof( struct iot_data ) );
-				result = IOT_STATUS_SUCCESS;
-			}
-		}
-
 #ifndef IOT_STACK_ONLY
-		if ( result != IOT_STATUS_SUCCESS && data->heap_storage )
-			os_free( data->heap_storage );
+				result = iot_action_request_data_store(
+					request, &value,
+					added == IOT_FALSE ? &opt->data : NULL );
+				if ( result == IOT_STATUS_SUCCESS )
 #endif /* ifndef IOT_STACK_ONLY */
+				{
+					if ( opt->data.heap_storage &&
+						opt->data.heap_storage !=
+						value.heap_storage )
+						os_free( opt->data.heap_storage );
+					os_memcpy( &opt->data, &value,
+						sizeof( struct iot_data ) );
+					result = IOT_STATUS_SUCCESS;
+				}
+#ifndef IOT_STACK_ONLY
+				else if ( added != IOT_FALSE )
+				{
+					/* don't leave an option without a value */
+					iot_action_request_arena_free( request,
+						opt->name );
+					opt->name = NULL;
+					--request->option_count;
+				}
+#endif /* ifndef IOT_STACK_ONLY */
+			}
+		}
 	}
 	return result;
 }
@@ -1819,27 +2788,30 @@ iot_status_t iot_action_request_free(
 #ifndef IOT_STACK_ONLY
 		size_t i;
 
-		/* free any space allocated */
+		/* free any space allocated from the heap, the arena is
+		 * reclaimed by resetting the request */
 		for ( i = 0u; i < request->option_count; ++i )
 		{
-			os_free_null( (void**)&request->option[i].name );
+			iot_action_request_arena_free( request,
+				request->option[i].name );
 			os_free_null( (void**)&request->option[i].data.heap_storage );
 		}
 		for ( i = 0u; i < request->parameter_count; ++i )
 		{
-			os_free_null( (void**)&request->parameter[i].name );
+			iot_action_request_arena_free( request,
+				request->parameter[i].name );
 			os_free_null( (void**)&request->parameter[i].data.heap_storage );
 		}
 
-		request->option_count = 0u;
-		request->parameter_count = 0u;
-		os_free_null( (void**)&request->option );
-		os_free_null( (void**)&request->parameter );
-		os_free_null( (void**)&request->error );
-		os_free_null( (void**)&request->name );
-#endif /* ifndef IOT_STACK_ONLY */
-
+		iot_action_request_arena_free( request, request->option );
+		iot_action_request_arena_free( request, request->parameter );
+		iot_action_request_arena_free( request, request->error );
+		iot_action_request_arena_free( request, request->name );
+		os_memzero( request,
+			offsetof( struct iot_action_request, arena ) );
+#else /* ifndef IOT_STACK_ONLY */
 		os_memzero( request, sizeof( struct iot_action_request ) );
+#endif /* else IOT_STACK_ONLY */
 
 		/* mark request spot as clear */
 #ifdef IOT_THREAD_SUPPORT
@@ -2077,27 +3049,36 @@ iot_status_t iot_action_request_parameter_set_args(
 					p = &request->parameter[request->parameter_count];
 					p_name = p->_name;
 #else /* ifdef IOT_STACK_ONLY */
-					p = os_realloc( request->parameter,
-						sizeof( struct iot_action_parameter )
-						* ( request->parameter_count + 1u ) );
-					p_name = os_malloc( sizeof( char ) * name_len + 1u );
-					if ( p && p_name )
+					/* space for all parameters is reserved in the
+					 * arena on the first, so it never needs to grow */
+					if ( !request->parameter )
+						request->parameter =
+							iot_action_request_arena_alloc(
+							request,
+							sizeof( struct iot_action_parameter )
+							* IOT_PARAMETER_MAX );
+					else if ( iot_action_request_arena_owns( request,
+						request->parameter ) == IOT_FALSE )
 					{
-						request->parameter = p;
-						p = &request->parameter[request->parameter_count];
+						p = os_realloc( request->parameter,
+							sizeof( struct iot_action_parameter )
+							* ( request->parameter_count + 1u ) );
+						if ( !p )
+							result = IOT_STATUS_NO_MEMORY;
+						else
+							request->parameter = p;
+						p = NULL;
 					}
+					p_name = iot_action_request_arena_alloc(
+						request, name_len + 1u );
+					if ( request->parameter && p_name &&
+						result != IOT_STATUS_NO_MEMORY )
+						p = &request->parameter[request->parameter_count];
 					else
 					{
-						if ( p )
-						{
-							os_free( p );
-							p = NULL;
-						}
-						if ( p_name )
-						{
-							os_free( p_name );
-							p_name = NULL;
-						}
+						iot_action_request_arena_free(
+							request, p_name );
+						p_name = NULL;
 						result = IOT_STATUS_NO_MEMORY;
 					}
 #endif /* else IOT_STACK_ONLY */
@@ -2118,9 +3099,28 @@ iot_status_t iot_action_request_parameter_set_args(
 				result = IOT_STATUS_FULL;
 				if ( p )
 				{
+#ifdef IOT_STACK_ONLY
 					p->type = IOT_PARAMETER_OUT;
 					result = iot_common_arg_set(
 						&p->data, IOT_TRUE, type, args );
+#else /* ifdef IOT_STACK_ONLY */
+					struct iot_data old;
+					os_memcpy( &old, &p->data,
+						sizeof( struct iot_data ) );
+					p->type = IOT_PARAMETER_OUT;
+					result = iot_common_arg_set(
+						&p->data, IOT_FALSE, type, args );
+					if ( result == IOT_STATUS_SUCCESS )
+						result = iot_action_request_data_store(
+							request, &p->data,
+							add_parameter == IOT_FALSE ?
+							&old : NULL );
+					if ( old.heap_storage &&
+						add_parameter == IOT_FALSE &&
+						old.heap_storage !=
+						p->data.heap_storage )
+						os_free( old.heap_storage );
+#endif /* else IOT_STACK_ONLY */
 					if ( result == IOT_STATUS_SUCCESS &&
 						add_parameter != IOT_FALSE )
 					{
@@ -2144,8 +3144,8 @@ void iot_action_request_set_status(
 		if ( status == IOT_STATUS_SUCCESS || !err_msg_fmt )
 		{
 #ifndef IOT_STACK_ONLY
-			if ( request->error )
-				os_free( request->error );
+			iot_action_request_arena_free( request,
+				request->error );
 #endif
 			request->error = NULL;
 		}
@@ -2166,8 +3166,14 @@ void iot_action_request_set_status(
 			va_end( args );
 			if ( err_len > 0 )
 			{
-				char *err_msg = os_realloc(
-					request->error, (unsigned int)err_len + 2u );
+				char *err_msg;
+
+				/* previous message is no longer needed */
+				iot_action_request_arena_free( request,
+					request->error );
+				request->error = NULL;
+				err_msg = iot_action_request_arena_alloc( request,
+					(unsigned int)err_len + 2u );
 				if ( err_msg )
 				{
 					request->error = err_msg;
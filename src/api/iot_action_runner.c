@@ -0,0 +1,919 @@
+/**
+ * @file
+ * @brief source file for the persistent command action runner process
+ *
+ * The runner is a small process forked the first time a command action is
+ * executed.  It receives the arguments of a command over a socket pair, along
+ * with the pipes to use for the command's status, standard output and
+ * standard error, and launches the command.  This avoids forking the (much
+ * larger, multi-threaded) application for each command.
+ *
+ * The application may already be running threads when the runner is forked,
+ * so the runner only uses async-signal-safe calls: it never allocates memory,
+ * and searches the path for a command itself instead of using execvp or
+ * posix_spawnp.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "iot_action_runner.h"
+
+#include <errno.h>       /* for errno, EINTR */
+#include <fcntl.h>       /* for O_CLOEXEC, O_NONBLOCK, O_RDONLY */
+#include <poll.h>        /* for poll */
+#include <signal.h>      /* for kill, sigaction, sigprocmask */
+#include <sys/socket.h>  /* for socketpair, sendmsg, recvmsg */
+#include <sys/syscall.h> /* for SYS_close_range */
+#include <sys/wait.h>    /* for waitpid */
+#include <time.h>        /* for clock_gettime */
+#include <unistd.h>      /* for close, execve, fork, pipe2, read, write */
+
+/** @brief Number of file descriptors passed with each request */
+#define IOT_ACTION_RUNNER_FD_COUNT               3u
+/** @brief Maximum number of commands the runner tracks at the same time */
+#define IOT_ACTION_RUNNER_CHILD_MAX              ( IOT_WORKER_THREADS + 1u )
+/** @brief Descriptors to close in the runner if the limit is unknown */
+#define IOT_ACTION_RUNNER_FD_MAX                 1024
+/** @brief Time to wait for output to close after a command is killed */
+#define IOT_ACTION_RUNNER_KILL_WAIT              IOT_MILLISECONDS_IN_SECOND
+/** @brief Path searched for commands if the environment has none */
+#define IOT_ACTION_RUNNER_PATH                   "/usr/local/bin:/usr/bin:/bin"
+/** @brief Size of the buffer used to read command output */
+#define IOT_ACTION_RUNNER_READ_SIZE              512u
+/** @brief Interval to check if a running command has been cancelled */
+#define IOT_ACTION_RUNNER_CANCEL_POLL            100
+
+/** @brief Environment passed to commands */
+extern char **environ;
+
+/**
+ * @brief Write end of the pipe used to signal that a command has exited
+ */
+static int IOT_ACTION_RUNNER_SIGCHLD_FD = -1;
+
+/**
+ * @brief Executes a command, searching the path if required
+ *
+ * @note Only returns if the command could not be executed (errno is set)
+ *
+ * @param[in]      argv                null-terminated list of arguments, the
+ *                                     first being the command to execute
+ */
+static IOT_SECTION void iot_action_runner_exec(
+	char *const argv[] );
+
+/**
+ * @brief Closes the file descriptors inherited by the runner process
+ *
+ * The runner is forked from the application, so it would otherwise keep
+ * open every file and socket the application had open at that time.
+ *
+ * @param[in]      keep                descriptor to leave open (the socket
+ *                                     requests are received on)
+ * @param[in]      fd_max              maximum number of open descriptors
+ *                                     (obtained before forking)
+ */
+static IOT_SECTION void iot_action_runner_fd_close(
+	int keep,
+	long fd_max );
+
+/**
+ * @brief Reads the output of a command into a buffer
+ *
+ * @param[in,out]  fd                  file descriptor to read from (set to -1
+ *                                     when the end of the output is reached)
+ * @param[in,out]  buf                 buffer to append output to
+ * @param[in]      buf_len             size of the output buffer
+ * @param[in,out]  pos                 amount of output in the buffer
+ */
+static IOT_SECTION void iot_action_runner_output_read(
+	int *fd,
+	char *buf,
+	size_t buf_len,
+	size_t *pos );
+
+/**
+ * @brief Main loop of the runner process
+ *
+ * @param[in]      fd                  socket to receive requests on
+ *
+ * @return exit code of the runner process
+ */
+static IOT_SECTION int iot_action_runner_main(
+	int fd );
+
+/**
+ * @brief Handles a single request in the runner process
+ *
+ * @param[in]      fd                  socket to receive the request on
+ * @param[in,out]  child_pid           process ids of running commands
+ * @param[in,out]  child_fd            status pipe of running commands
+ * @param[in,out]  child_end           time when running commands are killed
+ *                                     (0 = no time limit)
+ *
+ * @retval IOT_FALSE                   socket closed, runner should exit
+ * @retval IOT_TRUE                    request handled
+ */
+static IOT_SECTION iot_bool_t iot_action_runner_request(
+	int fd,
+	pid_t *child_pid,
+	int *child_fd,
+	iot_timestamp_t *child_end );
+
+/**
+ * @brief Signal handler called when a command exits
+ *
+ * @param[in]      sig                 signal received
+ */
+static IOT_SECTION void iot_action_runner_sigchld(
+	int sig );
+
+/**
+ * @brief Launches a command from the runner process
+ *
+ * The command is started in its own process group, with standard input
+ * read from the null device and default signal handling.
+ *
+ * @param[in]      argv                null-terminated list of arguments, the
+ *                                     first being the command to execute
+ * @param[in]      fds                 status, standard output and standard
+ *                                     error pipes of the command
+ *
+ * @return process id of the command, -1 if it could not be executed
+ */
+static IOT_SECTION pid_t iot_action_runner_spawn(
+	char *const argv[],
+	const int *fds );
+
+/**
+ * @brief Returns a monotonic time stamp in milliseconds
+ *
+ * @return the current monotonic time in milliseconds
+ */
+static IOT_SECTION iot_timestamp_t iot_action_runner_time(
+	void );
+
+
+void iot_action_runner_exec(
+	char *const argv[] )
+{
+	if ( os_strrchr( argv[0], '/' ) )
+		execve( argv[0], argv, environ );
+	else
+	{
+		const char *path = NULL;
+		const size_t cmd_len = os_strlen( argv[0] );
+		int error = ENOENT;
+		size_t i;
+
+		for ( i = 0u; environ && environ[i] && !path; ++i )
+			if ( os_strncmp( environ[i], "PATH=", 5u ) == 0 )
+				path = environ[i] + 5u;
+		if ( !path )
+			path = IOT_ACTION_RUNNER_PATH;
+
+		/* try each directory in turn, reporting the first error
+		 * other than the command not being found */
+		while ( *path != '\0' )
+		{
+			char file[ PATH_MAX + 1u ];
+			size_t dir_len = 0u;
+
+			while ( path[dir_len] != '\0' && path[dir_len] != ':' )
+				++dir_len;
+			if ( dir_len == 0u )
+				file[dir_len++] = '.';
+			else if ( dir_len <= PATH_MAX )
+				os_memcpy( file, path, dir_len );
+
+			if ( dir_len + cmd_len + 1u <= PATH_MAX )
+			{
+				file[dir_len] = '/';
+				os_memcpy( &file[dir_len + 1u], argv[0],
+					cmd_len + 1u );
+				execve( file, argv, environ );
+				if ( errno != ENOENT && errno != ENOTDIR &&
+					error == ENOENT )
+					error = errno;
+			}
+
+			while ( *path != '\0' && *path != ':' )
+				++path;
+			if ( *path == ':' )
+				++path;
+		}
+		errno = error;
+	}
+}
+
+void iot_action_runner_fd_close(
+	int keep,
+	long fd_max )
+{
+	iot_bool_t closed = IOT_FALSE;
+	long fd;
+
+#ifdef SYS_close_range
+	/* close all descriptors above the standard streams except keep */
+	if ( ( keep <= STDERR_FILENO + 1 ||
+		syscall( SYS_close_range, (unsigned int)STDERR_FILENO + 1u,
+			(unsigned int)keep - 1u, 0u ) == 0 ) &&
+		syscall( SYS_close_range, (unsigned int)keep + 1u, ~0u,
+			0u ) == 0 )
+		closed = IOT_TRUE;
+#endif /* ifdef SYS_close_range */
+
+	/* not supported by the kernel, try every possible descriptor */
+	for ( fd = STDERR_FILENO + 1; closed == IOT_FALSE && fd < fd_max;
+		++fd )
+		if ( fd != keep )
+			close( (int)fd );
+}
+
+void iot_action_runner_output_read(
+	int *fd,
+	char *buf,
+	size_t buf_len,
+	size_t *pos )
+{
+	char scratch[ IOT_ACTION_RUNNER_READ_SIZE ];
+	char *dest = scratch;
+	size_t dest_len = sizeof( scratch );
+	ssize_t rc;
+
+	/* output that doesn't fit is read and discarded */
+	if ( buf && *pos + 1u < buf_len )
+	{
+		dest = &buf[*pos];
+		dest_len = buf_len - *pos - 1u;
+	}
+
+	rc = read( *fd, dest, dest_len );
+	if ( rc > 0 )
+	{
+		if ( dest != scratch )
+		{
+			*pos += (size_t)rc;
+			buf[*pos] = '\0';
+		}
+	}
+	else if ( rc == 0 || errno != EINTR )
+	{
+		close( *fd );
+		*fd = -1;
+	}
+}
+
+int iot_action_runner_main(
+	int fd )
+{
+	int sig_pipe[2u];
+	pid_t child_pid[ IOT_ACTION_RUNNER_CHILD_MAX ];
+	int child_fd[ IOT_ACTION_RUNNER_CHILD_MAX ];
+	iot_timestamp_t child_end[ IOT_ACTION_RUNNER_CHILD_MAX ];
+	iot_bool_t running = IOT_FALSE;
+	struct sigaction sa;
+	sigset_t mask;
+	int sig;
+	size_t i;
+
+	for ( i = 0u; i < IOT_ACTION_RUNNER_CHILD_MAX; ++i )
+	{
+		child_pid[i] = 0;
+		child_fd[i] = -1;
+		child_end[i] = 0u;
+	}
+
+	/* don't run any signal handler of the application, don't be
+	 * stopped by writing to a pipe the application closed */
+	os_memzero( &sa, sizeof( struct sigaction ) );
+	sigemptyset( &sa.sa_mask );
+	sa.sa_handler = SIG_DFL;
+	for ( sig = 1; sig < NSIG; ++sig )
+		sigaction( sig, &sa, NULL );
+	sa.sa_handler = SIG_IGN;
+	sigaction( SIGPIPE, &sa, NULL );
+	sigemptyset( &mask );
+	sigprocmask( SIG_SETMASK, &mask, NULL );
+
+	if ( pipe2( sig_pipe, O_CLOEXEC | O_NONBLOCK ) == 0 )
+	{
+		sa.sa_handler = iot_action_runner_sigchld;
+		sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+		IOT_ACTION_RUNNER_SIGCHLD_FD = sig_pipe[1];
+		if ( sigaction( SIGCHLD, &sa, NULL ) == 0 )
+			running = IOT_TRUE;
+	}
+
+	while ( running != IOT_FALSE )
+	{
+		struct pollfd fds[ 2u + IOT_ACTION_RUNNER_CHILD_MAX ];
+		const iot_timestamp_t now = iot_action_runner_time();
+		int wait_time = -1;
+		int rc;
+
+		fds[0].fd = fd;
+		fds[0].events = POLLIN;
+		fds[0].revents = 0;
+		fds[1].fd = sig_pipe[0];
+		fds[1].events = POLLIN;
+		fds[1].revents = 0;
+
+		/* kill commands past their time limit, or that the
+		 * application stopped waiting for (status pipe closed) */
+		for ( i = 0u; i < IOT_ACTION_RUNNER_CHILD_MAX; ++i )
+		{
+			if ( child_pid[i] > 0 && child_end[i] > 0u )
+			{
+				if ( now >= child_end[i] )
+				{
+					kill( -child_pid[i], SIGKILL );
+					child_end[i] = 0u;
+				}
+				else if ( wait_time < 0 ||
+					child_end[i] - now < (iot_timestamp_t)wait_time )
+					wait_time = (int)( child_end[i] - now );
+			}
+			fds[2u + i].fd = child_fd[i];
+			fds[2u + i].events = 0;
+			fds[2u + i].revents = 0;
+		}
+
+		rc = poll( fds, 2u + IOT_ACTION_RUNNER_CHILD_MAX, wait_time );
+		if ( rc > 0 )
+		{
+			for ( i = 0u; i < IOT_ACTION_RUNNER_CHILD_MAX; ++i )
+			{
+				if ( fds[2u + i].revents & ( POLLERR | POLLHUP ) )
+				{
+					kill( -child_pid[i], SIGKILL );
+					close( child_fd[i] );
+					child_fd[i] = -1;
+					child_end[i] = 0u;
+				}
+			}
+
+			/* report the exit status of finished commands */
+			if ( fds[1].revents & POLLIN )
+			{
+				char c;
+				pid_t pid;
+				int status;
+				while ( read( sig_pipe[0], &c, 1u ) > 0 );
+				while ( ( pid = waitpid( -1, &status, WNOHANG ) ) > 0 )
+				{
+					for ( i = 0u; i < IOT_ACTION_RUNNER_CHILD_MAX; ++i )
+					{
+						if ( child_pid[i] == pid )
+						{
+							int code = 128 + WTERMSIG( status );
+							if ( WIFEXITED( status ) )
+								code = WEXITSTATUS( status );
+							if ( child_fd[i] >= 0 &&
+								write( child_fd[i], &code,
+								sizeof( int ) ) < 0 )
+							{
+								/* application stopped waiting */
+							}
+							if ( child_fd[i] >= 0 )
+								close( child_fd[i] );
+							child_fd[i] = -1;
+							child_pid[i] = 0;
+							child_end[i] = 0u;
+						}
+					}
+				}
+			}
+
+			if ( fds[0].revents & ( POLLIN | POLLHUP | POLLERR ) )
+				running = iot_action_runner_request( fd,
+					child_pid, child_fd, child_end );
+		}
+		else if ( rc < 0 && errno != EINTR )
+			running = IOT_FALSE;
+	}
+	return 0;
+}
+
+iot_status_t iot_action_runner_initialize(
+	struct iot_action_runner *runner )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( runner )
+	{
+		runner->fd = -1;
+		runner->pid = 0;
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_create( &runner->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		result = IOT_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+iot_status_t iot_action_runner_run(
+	struct iot_action_runner *runner,
+	const char *const argv[],
+	iot_millisecond_t max_time_out,
+	const volatile iot_bool_t *cancel,
+	char *out,
+	size_t out_len,
+	char *err,
+	size_t err_len,
+	int *return_code )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( runner && argv && argv[0] && return_code )
+	{
+		char msg[ sizeof( iot_millisecond_t ) + IOT_ACTION_RUNNER_ARG_LEN ];
+		size_t msg_len = sizeof( iot_millisecond_t );
+		size_t i;
+
+		if ( out && out_len > 0u )
+			*out = '\0';
+		if ( err && err_len > 0u )
+			*err = '\0';
+
+		/* time limit (enforced by the runner as well), followed by
+		 * the arguments as a list of null-terminated strings */
+		os_memcpy( msg, &max_time_out, sizeof( iot_millisecond_t ) );
+		result = IOT_STATUS_NOT_INITIALIZED;
+		for ( i = 0u; argv[i] && result == IOT_STATUS_NOT_INITIALIZED; ++i )
+		{
+			const size_t arg_len = os_strlen( argv[i] ) + 1u;
+			if ( i >= IOT_ACTION_RUNNER_ARG_MAX ||
+				msg_len + arg_len > sizeof( msg ) )
+				result = IOT_STATUS_FULL;
+			else
+			{
+				os_memcpy( &msg[msg_len], argv[i], arg_len );
+				msg_len += arg_len;
+			}
+		}
+
+		if ( result == IOT_STATUS_FULL )
+			result = IOT_STATUS_NOT_INITIALIZED;
+		else if ( iot_action_runner_start( runner ) ==
+			IOT_STATUS_SUCCESS )
+		{
+			int pipes[IOT_ACTION_RUNNER_FD_COUNT][2u];
+			size_t pipe_count;
+
+			/* pipes: status, standard output, standard error */
+			for ( pipe_count = 0u;
+				pipe_count < IOT_ACTION_RUNNER_FD_COUNT &&
+				pipe2( pipes[pipe_count], O_CLOEXEC ) == 0;
+				++pipe_count );
+
+			result = IOT_STATUS_FAILURE;
+			if ( pipe_count == IOT_ACTION_RUNNER_FD_COUNT )
+			{
+				union
+				{
+					struct cmsghdr align;
+					char buf[ CMSG_SPACE(
+						sizeof( int ) *
+						IOT_ACTION_RUNNER_FD_COUNT ) ];
+				} control;
+				struct cmsghdr *cmsg;
+				struct iovec iov;
+				struct msghdr hdr;
+				int fds[ IOT_ACTION_RUNNER_FD_COUNT ];
+
+				iov.iov_base = msg;
+				iov.iov_len = msg_len;
+				os_memzero( &hdr, sizeof( struct msghdr ) );
+				os_memzero( &control, sizeof( control ) );
+				hdr.msg_iov = &iov;
+				hdr.msg_iovlen = 1u;
+				hdr.msg_control = control.buf;
+				hdr.msg_controllen = sizeof( control.buf );
+				cmsg = CMSG_FIRSTHDR( &hdr );
+				cmsg->cmsg_level = SOL_SOCKET;
+				cmsg->cmsg_type = SCM_RIGHTS;
+				cmsg->cmsg_len = CMSG_LEN( sizeof( fds ) );
+				for ( i = 0u; i < IOT_ACTION_RUNNER_FD_COUNT; ++i )
+					fds[i] = pipes[i][1];
+				os_memcpy( CMSG_DATA( cmsg ), fds, sizeof( fds ) );
+
+				/* each request is a single message on the socket,
+				 * so worker threads can share it without a lock */
+				result = IOT_STATUS_NOT_INITIALIZED;
+				if ( sendmsg( runner->fd, &hdr, MSG_NOSIGNAL ) >= 0 )
+					result = IOT_STATUS_SUCCESS;
+			}
+
+			/* the write ends are now owned by the runner */
+			for ( i = 0u; i < pipe_count; ++i )
+				close( pipes[i][1] );
+
+			if ( result == IOT_STATUS_SUCCESS )
+			{
+				iot_timestamp_t end = 0u;
+				int status[2u] = { 0, 0 };
+				size_t status_len = 0u;
+				size_t out_pos = 0u;
+				size_t err_pos = 0u;
+
+				if ( max_time_out > 0u )
+					end = iot_action_runner_time() +
+						max_time_out;
+
+				/* stream status & output until all are closed */
+				while ( pipes[0][0] >= 0 || pipes[1][0] >= 0 ||
+					pipes[2][0] >= 0 )
+				{
+					struct pollfd pfd[IOT_ACTION_RUNNER_FD_COUNT];
+					iot_timestamp_t now;
+					int wait_time = -1;
+					int rc;
+
+					for ( i = 0u; i < IOT_ACTION_RUNNER_FD_COUNT; ++i )
+					{
+						pfd[i].fd = pipes[i][0];
+						pfd[i].events = POLLIN;
+						pfd[i].revents = 0;
+					}
+
+					if ( end > 0u )
+					{
+						now = iot_action_runner_time();
+						wait_time = 0;
+						if ( end > now )
+							wait_time = (int)( end - now );
+					}
+					if ( cancel && ( wait_time < 0 ||
+						wait_time > IOT_ACTION_RUNNER_CANCEL_POLL ) )
+						wait_time = IOT_ACTION_RUNNER_CANCEL_POLL;
+
+					rc = poll( pfd, IOT_ACTION_RUNNER_FD_COUNT,
+						wait_time );
+					now = iot_action_runner_time();
+					if ( rc > 0 )
+					{
+						if ( pfd[0].revents )
+						{
+							const ssize_t s = read( pipes[0][0],
+								(char *)status + status_len,
+								sizeof( status ) - status_len );
+							if ( s > 0 )
+								status_len += (size_t)s;
+							else if ( s == 0 || errno != EINTR )
+							{
+								close( pipes[0][0] );
+								pipes[0][0] = -1;
+							}
+						}
+						if ( pfd[1].revents )
+							iot_action_runner_output_read(
+								&pipes[1][0], out, out_len,
+								&out_pos );
+						if ( pfd[2].revents )
+							iot_action_runner_output_read(
+								&pipes[2][0], err, err_len,
+								&err_pos );
+					}
+
+					if ( result != IOT_STATUS_TIMED_OUT &&
+						( ( end > 0u && now >= end ) ||
+						( cancel && *cancel != IOT_FALSE ) ) )
+					{
+						/* kill the command's process group if
+						 * its id was received, otherwise closing
+						 * the status pipe has the runner kill it;
+						 * then give it time to close its output */
+						if ( status_len >= sizeof( int ) &&
+							status_len < sizeof( status ) &&
+							status[0] > 0 )
+							kill( -(pid_t)status[0], SIGKILL );
+						else if ( pipes[0][0] >= 0 )
+						{
+							close( pipes[0][0] );
+							pipes[0][0] = -1;
+						}
+						result = IOT_STATUS_TIMED_OUT;
+						end = now + IOT_ACTION_RUNNER_KILL_WAIT;
+					}
+					else if ( ( rc == 0 && end > 0u && now >= end ) ||
+						( rc < 0 && errno != EINTR ) )
+					{
+						/* output held open by another process */
+						for ( i = 0u; i < IOT_ACTION_RUNNER_FD_COUNT; ++i )
+						{
+							if ( pipes[i][0] >= 0 )
+								close( pipes[i][0] );
+							pipes[i][0] = -1;
+						}
+						if ( rc != 0 )
+							result = IOT_STATUS_FAILURE;
+					}
+				}
+
+				/* status: process id, then the exit code; no
+				 * process id when the runner has no free slot or
+				 * could not launch the command */
+				if ( status_len < sizeof( int ) || status[0] <= 0 )
+				{
+					if ( result != IOT_STATUS_TIMED_OUT )
+						result = IOT_STATUS_NOT_INITIALIZED;
+				}
+				else if ( result == IOT_STATUS_SUCCESS &&
+					status_len < sizeof( status ) )
+					result = IOT_STATUS_FAILURE;
+				*return_code = status[1];
+			}
+			else
+			{
+				for ( i = 0u; i < pipe_count; ++i )
+					close( pipes[i][0] );
+			}
+		}
+	}
+	return result;
+}
+
+iot_bool_t iot_action_runner_request(
+	int fd,
+	pid_t *child_pid,
+	int *child_fd,
+	iot_timestamp_t *child_end )
+{
+	union
+	{
+		struct cmsghdr align;
+		char buf[ CMSG_SPACE(
+			sizeof( int ) * IOT_ACTION_RUNNER_FD_COUNT ) ];
+	} control;
+	char msg[ sizeof( iot_millisecond_t ) +
+		IOT_ACTION_RUNNER_ARG_LEN + 1u ];
+	struct iovec iov;
+	struct msghdr hdr;
+	ssize_t msg_len;
+	iot_bool_t result = IOT_TRUE;
+
+	iov.iov_base = msg;
+	iov.iov_len = sizeof( msg ) - 1u;
+	os_memzero( &hdr, sizeof( struct msghdr ) );
+	hdr.msg_iov = &iov;
+	hdr.msg_iovlen = 1u;
+	hdr.msg_control = control.buf;
+	hdr.msg_controllen = sizeof( control.buf );
+
+	msg_len = recvmsg( fd, &hdr, MSG_CMSG_CLOEXEC );
+	if ( msg_len > 0 )
+	{
+		struct cmsghdr *const cmsg = CMSG_FIRSTHDR( &hdr );
+		if ( cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+			cmsg->cmsg_type == SCM_RIGHTS &&
+			cmsg->cmsg_len == CMSG_LEN(
+				sizeof( int ) * IOT_ACTION_RUNNER_FD_COUNT ) )
+		{
+			char *argv[ IOT_ACTION_RUNNER_ARG_MAX + 1u ];
+			int fds[ IOT_ACTION_RUNNER_FD_COUNT ];
+			iot_millisecond_t time_out = 0u;
+			size_t argc = 0u;
+			size_t slot;
+			ssize_t i;
+			pid_t pid = -1;
+			int status;
+
+			os_memcpy( fds, CMSG_DATA( cmsg ), sizeof( fds ) );
+
+			/* time limit, then the null-terminated arguments */
+			msg[msg_len] = '\0';
+			if ( msg_len > (ssize_t)sizeof( iot_millisecond_t ) )
+			{
+				os_memcpy( &time_out, msg,
+					sizeof( iot_millisecond_t ) );
+				argv[argc++] = &msg[sizeof( iot_millisecond_t )];
+				for ( i = (ssize_t)sizeof( iot_millisecond_t );
+					i < msg_len - 1 &&
+					argc < IOT_ACTION_RUNNER_ARG_MAX; ++i )
+					if ( msg[i] == '\0' )
+						argv[argc++] = &msg[i + 1];
+			}
+			argv[argc] = NULL;
+
+			for ( slot = 0u; slot < IOT_ACTION_RUNNER_CHILD_MAX &&
+				child_pid[slot] != 0; ++slot );
+
+			if ( argc > 0u && slot < IOT_ACTION_RUNNER_CHILD_MAX )
+				pid = iot_action_runner_spawn( argv, fds );
+
+			/* first value on the status pipe is the process id */
+			status = (int)pid;
+			if ( write( fds[0], &status, sizeof( int ) ) < 0 )
+			{
+				/* application stopped waiting, still track it */
+			}
+			if ( pid > 0 )
+			{
+				child_pid[slot] = pid;
+				child_fd[slot] = fds[0];
+				/* the application kills the command once the
+				 * time limit passes, this is in case it can't */
+				child_end[slot] = 0u;
+				if ( time_out > 0u )
+					child_end[slot] = iot_action_runner_time() +
+						time_out + IOT_ACTION_RUNNER_KILL_WAIT;
+			}
+			else
+				close( fds[0] );
+			close( fds[1] );
+			close( fds[2] );
+		}
+		else if ( cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+			cmsg->cmsg_type == SCM_RIGHTS )
+		{
+			/* unexpected number of descriptors, drop them */
+			const int *const fds = (const int *)CMSG_DATA( cmsg );
+			const size_t count = ( cmsg->cmsg_len - CMSG_LEN( 0u ) ) /
+				sizeof( int );
+			size_t i;
+			for ( i = 0u; i < count; ++i )
+				close( fds[i] );
+		}
+	}
+	else if ( msg_len == 0 || errno != EINTR )
+		result = IOT_FALSE; /* application closed the socket */
+	return result;
+}
+
+void iot_action_runner_sigchld(
+	int UNUSED(sig) )
+{
+	const int saved_errno = errno;
+	const char c = 0;
+	if ( write( IOT_ACTION_RUNNER_SIGCHLD_FD, &c, 1u ) < 0 )
+	{
+		/* pipe is full, the runner is already signalled */
+	}
+	errno = saved_errno;
+}
+
+pid_t iot_action_runner_spawn(
+	char *const argv[],
+	const int *fds )
+{
+	int exec_pipe[2u];
+	pid_t pid = -1;
+
+	/* closed on a successful exec, otherwise receives the error */
+	if ( pipe2( exec_pipe, O_CLOEXEC ) == 0 )
+	{
+		pid = fork();
+		if ( pid == 0 )
+		{
+			/* command process */
+			struct sigaction sa;
+			sigset_t mask;
+			int error;
+			int null_fd;
+
+			/* own process group, so any processes started by
+			 * the command are killed with it */
+			setpgid( 0, 0 );
+			os_memzero( &sa, sizeof( struct sigaction ) );
+			sigemptyset( &sa.sa_mask );
+			sa.sa_handler = SIG_DFL;
+			sigaction( SIGCHLD, &sa, NULL );
+			sigaction( SIGPIPE, &sa, NULL );
+			sigemptyset( &mask );
+			sigprocmask( SIG_SETMASK, &mask, NULL );
+
+			null_fd = open( "/dev/null", O_RDONLY );
+			if ( null_fd >= 0 && null_fd != STDIN_FILENO )
+			{
+				dup2( null_fd, STDIN_FILENO );
+				close( null_fd );
+			}
+			dup2( fds[1], STDOUT_FILENO );
+			dup2( fds[2], STDERR_FILENO );
+
+			iot_action_runner_exec( argv );
+			error = errno;
+			if ( write( exec_pipe[1], &error, sizeof( int ) ) < 0 )
+			{
+				/* runner reports the command as not launched */
+			}
+			_exit( 127 );
+		}
+
+		close( exec_pipe[1] );
+		if ( pid > 0 )
+		{
+			int error;
+			ssize_t rc;
+
+			/* also set here, in case the command is killed
+			 * before it has set its own process group */
+			setpgid( pid, pid );
+			do
+				rc = read( exec_pipe[0], &error, sizeof( int ) );
+			while ( rc < 0 && errno == EINTR );
+			if ( rc > 0 )
+			{
+				waitpid( pid, NULL, 0 );
+				pid = -1;
+			}
+		}
+		close( exec_pipe[0] );
+	}
+	return pid;
+}
+
+iot_status_t iot_action_runner_start(
+	struct iot_action_runner *runner )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( runner )
+	{
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_lock( &runner->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		result = IOT_STATUS_SUCCESS;
+		if ( runner->pid == 0 )
+		{
+			/* obtained before forking: sysconf is not
+			 * async-signal-safe */
+			long fd_max = sysconf( _SC_OPEN_MAX );
+			int sv[2u];
+
+			if ( fd_max <= 0 )
+				fd_max = IOT_ACTION_RUNNER_FD_MAX;
+
+			/* not retried if it fails */
+			result = IOT_STATUS_FAILURE;
+			runner->pid = -1;
+			if ( socketpair( AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC,
+				0, sv ) == 0 )
+			{
+				const pid_t pid = fork();
+				if ( pid == 0 )
+				{
+					/* runner process */
+					iot_action_runner_fd_close( sv[1], fd_max );
+					_exit( iot_action_runner_main( sv[1] ) );
+				}
+
+				close( sv[1] );
+				if ( pid > 0 )
+				{
+					runner->fd = sv[0];
+					runner->pid = (int)pid;
+					result = IOT_STATUS_SUCCESS;
+				}
+				else
+					close( sv[0] );
+			}
+		}
+		else if ( runner->pid < 0 )
+			result = IOT_STATUS_FAILURE;
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_unlock( &runner->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+	}
+	return result;
+}
+
+iot_status_t iot_action_runner_terminate(
+	struct iot_action_runner *runner )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( runner )
+	{
+		/* closing the socket causes the runner to exit */
+		if ( runner->pid > 0 )
+		{
+			close( runner->fd );
+			waitpid( (pid_t)runner->pid, NULL, 0 );
+		}
+		runner->fd = -1;
+		runner->pid = 0;
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_destroy( &runner->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		result = IOT_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+iot_timestamp_t iot_action_runner_time( void )
+{
+	struct timespec ts;
+	iot_timestamp_t result = 0u;
+	if ( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+		result = (iot_timestamp_t)ts.tv_sec * IOT_MILLISECONDS_IN_SECOND +
+			(iot_timestamp_t)ts.tv_nsec / 1000000u;
+	return result;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @brief header file for the persistent command action runner process
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+#ifndef IOT_ACTION_RUNNER_H
+#define IOT_ACTION_RUNNER_H
+
+#include "shared/iot_types.h"
+
+#ifdef IOT_ACTION_RUNNER
+/** @brief Maximum number of arguments passed to the runner for a command */
+#define IOT_ACTION_RUNNER_ARG_MAX                32u
+/** @brief Maximum size of all arguments passed to the runner for a command */
+#define IOT_ACTION_RUNNER_ARG_LEN                ( PATH_MAX * 2u )
+
+/**
+ * @brief Prepares the runner process, without starting it
+ *
+ * @param[out]     runner              runner process to prepare
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_action_runner_start
+ * @see iot_action_runner_terminate
+ */
+IOT_SECTION iot_status_t iot_action_runner_initialize(
+	struct iot_action_runner *runner );
+
+/**
+ * @brief Executes a command using the runner process
+ *
+ * The runner is started by the first command, if it was not already.  The
+ * command is executed directly by the runner: it does not start a shell, so
+ * a command requiring one must be passed as arguments to a shell.  Its
+ * standard output and standard error are streamed back into the buffers
+ * provided as the command produces them.  The command is started in its own
+ * process group, which is killed if the command times out or is cancelled
+ * (by the runner itself if the process id of the command was not yet
+ * received).  Output beyond the size of a buffer is discarded.  Both buffers
+ * are always null-terminated.
+ *
+ * @param[in]      runner              runner process to use
+ * @param[in]      argv                null-terminated list of arguments, the
+ *                                     first being the command to execute
+ * @param[in]      max_time_out        maximum time to wait for the command in
+ *                                     milliseconds (0 = wait indefinitely)
+ * @param[in]      cancel              flag set by another thread to kill the
+ *                                     command before it completes (optional)
+ * @param[out]     out                 buffer to hold standard output
+ *                                     (optional)
+ * @param[in]      out_len             size of the standard output buffer
+ * @param[out]     err                 buffer to hold standard error
+ *                                     (optional)
+ * @param[in]      err_len             size of the standard error buffer
+ * @param[out]     return_code         return code of the command
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_FAILURE          error communicating with the command
+ * @retval IOT_STATUS_NOT_INITIALIZED  runner process is not available, is
+ *                                     running its maximum number of commands
+ *                                     or could not launch the command (the
+ *                                     caller should fall back to running the
+ *                                     command itself)
+ * @retval IOT_STATUS_SUCCESS          command ran to completion
+ * @retval IOT_STATUS_TIMED_OUT        command was killed after the time out,
+ *                                     or was cancelled
+ *
+ * @see iot_action_runner_start
+ */
+IOT_SECTION iot_status_t iot_action_runner_run(
+	struct iot_action_runner *runner,
+	const char *const argv[],
+	iot_millisecond_t max_time_out,
+	const volatile iot_bool_t *cancel,
+	char *out,
+	size_t out_len,
+	char *err,
+	size_t err_len,
+	int *return_code );
+
+/**
+ * @brief Starts the runner process, if it is not already running
+ *
+ * The runner is forked from the calling process, which may be running other
+ * threads: the runner only uses async-signal-safe calls.  Starting is not
+ * retried once it has failed.
+ *
+ * @param[in,out]  runner              runner process to start
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_FAILURE          failed to start the runner process
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_action_runner_terminate
+ */
+IOT_SECTION iot_status_t iot_action_runner_start(
+	struct iot_action_runner *runner );
+
+/**
+ * @brief Stops the runner process, if it was started
+ *
+ * @param[in,out]  runner              runner process to stop
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_action_runner_initialize
+ */
+IOT_SECTION iot_status_t iot_action_runner_terminate(
+	struct iot_action_runner *runner );
+#endif /* ifdef IOT_ACTION_RUNNER */
+
+#endif /* ifndef IOT_ACTION_RUNNER_H */
@@ -0,0 +1,416 @@
+/**
+ * @file
+ * @brief Contains implementations for archiving a directory as it is uploaded
+ *
+ * The archive is pulled rather than pushed: each read adds the next piece of
+ * a file (or the next file) to the archive, and libarchive's output is held
+ * until it is read.  The whole archive never exists on disk, and only the
+ * data of one step is held in memory.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "shared/iot_archive.h"
+
+#include "shared/iot_defs.h"       /* for UNUSED */
+
+#include <archive.h>               /* for archiving functions */
+#include <archive_entry.h>         /* for adding files to an archive */
+#include <sys/stat.h>              /* for stat */
+
+/** @brief Initial size of the buffer holding archive data not yet read */
+#define IOT_ARCHIVE_BUFFER_SIZE                  65536u
+
+/** @brief Archive of a directory, produced as it is read */
+struct iot_archive_stream
+{
+	/** @brief libarchive writer producing the archive */
+	struct archive *archive;
+	/** @brief archive data produced but not yet read */
+	unsigned char *buf;
+	/** @brief bytes of archive data in the buffer */
+	size_t buf_len;
+	/** @brief offset of the next byte to read from the buffer */
+	size_t buf_pos;
+	/** @brief size of the buffer */
+	size_t buf_size;
+	/** @brief directory being archived (NULL once all files are added) */
+	os_dir_t *dir;
+	/** @brief bytes of the files archived so far */
+	iot_uint64_t done;
+	/** @brief file being added to the archive */
+	os_file_t file;
+	/** @brief bytes of the file being added still to archive */
+	iot_uint64_t remaining;
+	/** @brief IOT_STATUS_TRY_AGAIN until the archive is complete */
+	iot_status_t status;
+	/** @brief file data being added to the archive */
+	unsigned char step[ IOT_ARCHIVE_STEP_SIZE ];
+	/** @brief bytes of all files in the directory */
+	iot_uint64_t total;
+};
+
+/**
+ * @brief Starts adding the next file of the directory to the archive
+ *
+ * @param[in,out]  stream              stream producing the archive
+ *
+ * @retval IOT_STATUS_FAILURE          failed to add the file
+ * @retval IOT_STATUS_TRY_AGAIN        file added (or all files were added)
+ */
+static iot_status_t iot_archive_file_add(
+	struct iot_archive_stream *stream );
+
+/**
+ * @brief Returns the total size of the files in a directory
+ *
+ * @param[in]      path                directory to measure
+ *
+ * @return the number of bytes in all files of the directory
+ */
+static iot_uint64_t iot_archive_size(
+	const char *path );
+
+/**
+ * @brief Produces the next part of the archive
+ *
+ * @param[in,out]  stream              stream producing the archive
+ */
+static void iot_archive_step(
+	struct iot_archive_stream *stream );
+
+/**
+ * @brief Called by libarchive to output part of the archive
+ *
+ * @param[in]      archive             libarchive writer
+ * @param[in,out]  client              stream producing the archive
+ * @param[in]      buf                 archive data
+ * @param[in]      len                 size of the archive data
+ *
+ * @return the number of bytes kept, -1 on failure
+ */
+static la_ssize_t iot_archive_write(
+	struct archive *archive,
+	void *client,
+	const void *buf,
+	size_t len );
+
+
+const char *iot_archive_extension(
+	iot_archive_type_t type )
+{
+	const char *result = "";
+	switch ( type )
+	{
+	case IOT_ARCHIVE_TAR:
+		result = ".tar";
+		break;
+	case IOT_ARCHIVE_TAR_GZIP:
+		result = ".tar.gz";
+		break;
+	case IOT_ARCHIVE_TAR_ZSTD:
+		result = ".tar.zst";
+		break;
+	case IOT_ARCHIVE_NONE:
+	default:
+		break;
+	}
+	return result;
+}
+
+iot_status_t iot_archive_file_add(
+	struct iot_archive_stream *stream )
+{
+	iot_status_t result = IOT_STATUS_TRY_AGAIN;
+	char file_path[ PATH_MAX + 1u ];
+
+	if ( os_directory_next( stream->dir, IOT_TRUE, file_path,
+		PATH_MAX ) == OS_STATUS_SUCCESS )
+	{
+		struct stat file_stat;
+
+		/* files that disappeared or can't be read are skipped */
+		file_path[ PATH_MAX ] = '\0';
+		if ( stat( file_path, &file_stat ) == 0 )
+			stream->file = os_file_open( file_path, OS_READ );
+		if ( stream->file )
+		{
+			struct archive_entry *const entry = archive_entry_new();
+
+			result = IOT_STATUS_FAILURE;
+			if ( entry )
+			{
+				/* Note: set the file details individually.  Calling archive_entry_copy_stat(
+				 * entry, &file_stat ) is easier but it corrupts archives on 32b architectures,
+				 * e.g. quark. */
+				archive_entry_set_size( entry, file_stat.st_size );
+				archive_entry_set_filetype( entry, AE_IFREG );
+				archive_entry_set_perm( entry, 0644 );
+				archive_entry_set_pathname( entry, file_path );
+
+				/* stat struct does not store
+				 * the birthtime.  That is part of the file system */
+				archive_entry_set_atime( entry, file_stat.st_atime, 0 );
+				archive_entry_set_birthtime( entry, file_stat.st_ctime, 0 );
+				archive_entry_set_ctime( entry, file_stat.st_ctime, 0 );
+				archive_entry_set_mtime( entry, file_stat.st_mtime, 0 );
+
+				/* a file growing while it is archived is cut at the
+				 * size recorded, one shrinking is padded by libarchive */
+				stream->remaining = (iot_uint64_t)file_stat.st_size;
+				if ( archive_write_header( stream->archive, entry ) ==
+					ARCHIVE_OK )
+					result = IOT_STATUS_TRY_AGAIN;
+				archive_entry_free( entry );
+			}
+		}
+	}
+	else
+	{
+		os_directory_close( stream->dir );
+		stream->dir = NULL;
+	}
+	return result;
+}
+
+iot_uint64_t iot_archive_size(
+	const char *path )
+{
+	iot_uint64_t result = 0u;
+	os_dir_t *const dir = os_directory_open( path );
+	if ( dir )
+	{
+		char file_path[ PATH_MAX + 1u ];
+
+		while ( os_directory_next( dir, IOT_TRUE, file_path,
+			PATH_MAX ) == OS_STATUS_SUCCESS )
+		{
+			struct stat file_stat;
+			file_path[ PATH_MAX ] = '\0';
+			if ( stat( file_path, &file_stat ) == 0 )
+				result += (iot_uint64_t)file_stat.st_size;
+		}
+		os_directory_close( dir );
+	}
+	return result;
+}
+
+iot_status_t iot_archive_stream_close(
+	iot_archive_stream_t *stream )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( stream )
+	{
+		result = IOT_STATUS_FAILURE;
+		if ( stream->status == IOT_STATUS_SUCCESS )
+			result = IOT_STATUS_SUCCESS;
+
+		if ( stream->archive )
+			archive_write_free( stream->archive );
+		if ( stream->file )
+			os_file_close( stream->file );
+		if ( stream->dir )
+			os_directory_close( stream->dir );
+		if ( stream->buf )
+			os_free( stream->buf );
+		os_free( stream );
+	}
+	return result;
+}
+
+iot_archive_stream_t *iot_archive_stream_open(
+	const char *path,
+	iot_archive_type_t type )
+{
+	struct iot_archive_stream *stream = NULL;
+	if ( path && type != IOT_ARCHIVE_NONE )
+	{
+		stream = (struct iot_archive_stream *)os_malloc(
+			sizeof( struct iot_archive_stream ) );
+		if ( stream )
+		{
+			int filter = ARCHIVE_FATAL;
+
+			os_memzero( stream, sizeof( struct iot_archive_stream ) );
+			stream->status = IOT_STATUS_TRY_AGAIN;
+			stream->total = iot_archive_size( path );
+			stream->dir = os_directory_open( path );
+			stream->archive = archive_write_new();
+			if ( stream->archive )
+			{
+				switch ( type )
+				{
+				case IOT_ARCHIVE_TAR:
+					filter = archive_write_add_filter_none(
+						stream->archive );
+					break;
+				case IOT_ARCHIVE_TAR_GZIP:
+					filter = archive_write_add_filter_gzip(
+						stream->archive );
+					break;
+				case IOT_ARCHIVE_TAR_ZSTD:
+#if ARCHIVE_VERSION_NUMBER >= 3003003
+					filter = archive_write_add_filter_zstd(
+						stream->archive );
+#endif /* if ARCHIVE_VERSION_NUMBER >= 3003003 */
+					break;
+				case IOT_ARCHIVE_NONE:
+				default:
+					break;
+				}
+			}
+
+			/* only an uncompressed archive is padded to a whole
+			 * block, as tar expects */
+			if ( filter == ARCHIVE_OK && type != IOT_ARCHIVE_TAR )
+				archive_write_set_bytes_in_last_block(
+					stream->archive, 1 );
+
+			if ( !stream->dir || filter != ARCHIVE_OK ||
+				archive_write_set_format_pax_restricted(
+					stream->archive ) != ARCHIVE_OK ||
+				archive_write_open( stream->archive, stream, NULL,
+					iot_archive_write, NULL ) != ARCHIVE_OK )
+			{
+				stream->status = IOT_STATUS_FAILURE;
+				iot_archive_stream_close( stream );
+				stream = NULL;
+			}
+		}
+	}
+	return stream;
+}
+
+iot_status_t iot_archive_stream_progress(
+	const iot_archive_stream_t *stream,
+	iot_uint64_t *done,
+	iot_uint64_t *total )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( stream )
+	{
+		if ( done )
+			*done = stream->done;
+		if ( total )
+			*total = stream->total;
+		result = IOT_STATUS_SUCCESS;
+		if ( stream->status == IOT_STATUS_FAILURE )
+			result = IOT_STATUS_FAILURE;
+	}
+	return result;
+}
+
+size_t iot_archive_stream_read(
+	void *buf,
+	size_t size,
+	size_t nmemb,
+	void *stream )
+{
+	size_t result = 0u;
+	struct iot_archive_stream *const s =
+		(struct iot_archive_stream *)stream;
+	if ( buf && s && size > 0u )
+	{
+		size_t len;
+
+		/* produce the archive until some of it can be read */
+		while ( s->buf_pos == s->buf_len &&
+			s->status == IOT_STATUS_TRY_AGAIN )
+		{
+			s->buf_len = s->buf_pos = 0u;
+			iot_archive_step( s );
+		}
+
+		len = s->buf_len - s->buf_pos;
+		if ( len > size * nmemb )
+			len = size * nmemb;
+		result = len / size;
+		len = result * size;
+		os_memcpy( buf, &s->buf[s->buf_pos], len );
+		s->buf_pos += len;
+	}
+	return result;
+}
+
+void iot_archive_step(
+	struct iot_archive_stream *stream )
+{
+	if ( stream->file && stream->remaining > 0u )
+	{
+		size_t len = sizeof( stream->step );
+		if ( stream->remaining < (iot_uint64_t)len )
+			len = (size_t)stream->remaining;
+		len = os_file_read( stream->step, 1u, len, stream->file );
+		if ( len == 0u )
+			stream->remaining = 0u;
+		else if ( archive_write_data( stream->archive, stream->step,
+			len ) < 0 )
+			stream->status = IOT_STATUS_FAILURE;
+		else
+		{
+			stream->done += len;
+			stream->remaining -= len;
+		}
+	}
+	else if ( stream->file )
+	{
+		os_file_close( stream->file );
+		stream->file = NULL;
+	}
+	else if ( stream->dir )
+		stream->status = iot_archive_file_add( stream );
+	else
+	{
+		/* all files were added, output the end of the archive */
+		stream->status = IOT_STATUS_FAILURE;
+		if ( archive_write_close( stream->archive ) == ARCHIVE_OK )
+			stream->status = IOT_STATUS_SUCCESS;
+	}
+}
+
+la_ssize_t iot_archive_write(
+	struct archive *UNUSED(archive),
+	void *client,
+	const void *buf,
+	size_t len )
+{
+	la_ssize_t result = -1;
+	struct iot_archive_stream *const stream =
+		(struct iot_archive_stream *)client;
+	size_t buf_size = stream->buf_size;
+
+	/* the buffer only grows when a single step outputs more than it
+	 * holds, and it is emptied before the next step */
+	if ( buf_size == 0u )
+		buf_size = IOT_ARCHIVE_BUFFER_SIZE;
+	while ( buf_size < stream->buf_len + len )
+		buf_size *= 2u;
+	if ( buf_size != stream->buf_size )
+	{
+		unsigned char *const buf_new =
+			(unsigned char *)os_realloc( stream->buf, buf_size );
+		if ( buf_new )
+		{
+			stream->buf = buf_new;
+			stream->buf_size = buf_size;
+		}
+	}
+
+	if ( stream->buf_len + len <= stream->buf_size )
+	{
+		os_memcpy( &stream->buf[stream->buf_len], buf, len );
+		stream->buf_len += len;
+		result = (la_ssize_t)len;
+	}
+	return result;
+}
@@ -17,17 +17,38 @@
 
 #include "iot_build.h"            /* for version information from build */
 
+#include "iot_action_runner.h"
 #include "iot_common.h"
 #include "public/iot_json.h"      /* for iot json library structures */
 #include "shared/iot_types.h"     /* for internal library structures */
 
 #include <os.h>
 #include <stdarg.h> /* for va_arg */
+#ifndef _WIN32
+#include <time.h>   /* for clock_gettime */
+#endif /* ifndef _WIN32 */
 
 /** @brief Maximum log message line length */
 #define IOT_LOG_MSG_MAX 16384u
 /** @brief Size of read chunk to use when reading configuration file */
 #define IOT_READ_BLOCK_SIZE 512u
+/** @brief Maximum length of a key (including parent keys) in a configuration file */
+#define IOT_CONFIG_KEY_MAX 256u
+/** @brief Maximum depth of nested objects read from a configuration file */
+#define IOT_CONFIG_DEPTH_MAX 16u
+
+/** @brief State while reading a configuration file */
+struct iot_base_configuration
+{
+	/** @brief library handle */
+	iot_t *lib;
+	/** @brief key of the current item, prefixed by the keys of its parents */
+	char key[IOT_CONFIG_KEY_MAX];
+	/** @brief length of the key prefix for items at each depth */
+	size_t key_len[IOT_CONFIG_DEPTH_MAX];
+	/** @brief depth within an item being ignored (0 if none) */
+	unsigned int skip;
+};
 
 #ifdef IOT_STACK_ONLY
 /** @brief static library on the stack */
@@ -115,6 +136,15 @@ static OS_THREAD_DECL iot_base_main_thread( void *user_data );
  * @retval NULL    always on thread termination
  */
 static OS_THREAD_DECL iot_base_worker_thread_main( void *user_data );
+/**
+ * @brief thread reporting action requests exceeding their time limit, it
+ *        waits until the earliest deadline (or for a new one) before checking
+ *
+ * @param[in,out]  user_data           pointer to the library instance
+ *
+ * @retval NULL    always on thread termination
+ */
+static OS_THREAD_DECL iot_base_deadline_thread_main( void *user_data );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 /**
@@ -160,42 +190,51 @@ static IOT_SECTION iot_status_t iot_base_configuration_read(
 	iot_millisecond_t *max_time_out );
 
 /**
- * @brief Parses the configuration file
+ * @brief Handles an item read from the configuration file
  *
- * @param[in,out]  lib                 library handle
- * @param[in]      file_path           path of configuration file read
- * @param[in]      buf                 configuration file contents
- * @param[in]      len                 buffer length
+ * Values within objects are set as configuration options, using the keys of
+ * parent objects joined with a '.' as the name of the option.  Arrays and
+ * null values are ignored.
+ *
+ * @param[in,out]  user_data           configuration file state
+ * @param[in]      event               event being reported
+ * @param[in]      type                type of the item
+ * @param[in]      depth               depth of the item
+ * @param[in]      key                 key of the item (optional)
+ * @param[in]      key_len             length of the key
+ * @param[in]      value               text of the value (optional)
+ * @param[in]      value_len           length of the value text
  *
  * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
- * @retval IOT_STATUS_PARSE_ERROR      failed to parse configuration file
  * @retval IOT_STATUS_SUCCESS          on success
  */
 static IOT_SECTION iot_status_t iot_base_configuration_parse(
-	iot_t *lib,
-	const char *file_path,
-	const char *buf,
-	const size_t len );
+	void *user_data,
+	iot_json_stream_event_t event,
+	iot_json_type_t type,
+	unsigned int depth,
+	const char *key,
+	size_t key_len,
+	const char *value,
+	size_t value_len );
 
 /**
- * @brief Parses the base object in a configuration file
+ * @brief Converts the text of an integer in the configuration file
  *
- * @param[in,out]  lib                 library handle
- * @param[in]      json                json decoder
- * @param[in]      obj                 object being parsed
- * @param[in]      key                 current object key
- * @param[in]      key_len             length of the key
+ * The whole text must be a base 10 integer that fits in 64 bits, independent
+ * of the size of a long on the platform.
  *
- * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
- * @retval IOT_STATUS_FAILURE          on failure
+ * @param[in]      value               text of the value
+ * @param[in]      value_len           length of the value text
+ * @param[out]     out                 converted value
+ *
+ * @retval IOT_STATUS_BAD_REQUEST      text is not an integer, or out of range
  * @retval IOT_STATUS_SUCCESS          on success
  */
-static IOT_SECTION iot_status_t iot_base_configuration_parse_object(
-	iot_t *lib,
-	iot_json_decoder_t *json,
-	const iot_json_item_t *obj,
-	char *key,
-	size_t key_len );
+static IOT_SECTION iot_status_t iot_base_configuration_integer(
+	const char *value,
+	size_t value_len,
+	iot_int64_t *out );
 
 /**
  * @brief Sets the device id from a file (or generates one if file doesn't exist)
@@ -303,32 +342,35 @@ iot_status_t iot_base_configuration_read(
 
 			if ( fd != OS_FILE_INVALID )
 			{
-				char *buf = NULL;
-				size_t buf_len = 0u;
-				iot_bool_t more_to_read = IOT_TRUE;
-
-				result = IOT_STATUS_SUCCESS;
-				while ( result == IOT_STATUS_SUCCESS &&
-					more_to_read == IOT_TRUE )
-				{
-					char *new_buf;
+				struct iot_base_configuration cfg;
+				char err_msg[64u];
+				iot_json_stream_t *json;
 #ifdef IOT_STACK_ONLY
-					char stack_buf[IOT_READ_BLOCK_SIZE * 2u];
-					new_buf = stack_buf;
-					if ( buf_len < IOT_READ_BLOCK_SIZE * 2u )
+				char buffer[1024u];
+				json = iot_json_stream_initialize( buffer, 1024u, 0u,
+					iot_base_configuration_parse, &cfg );
 #else
-					new_buf = os_realloc( buf,
-						sizeof( char ) *
-						( buf_len + IOT_READ_BLOCK_SIZE ) );
-					if ( new_buf )
+				json = iot_json_stream_initialize( NULL, 0u,
+					IOT_JSON_FLAG_DYNAMIC,
+					iot_base_configuration_parse, &cfg );
 #endif /* ifdef IOT_STACK_ONLY */
-					{
-						size_t bytes;
 
-						buf = new_buf;
-						bytes = os_file_read(
-							&buf[buf_len],
-							sizeof(char),
+				os_memzero( &cfg, sizeof( struct iot_base_configuration ) );
+				cfg.lib = lib;
+				*err_msg = '\0';
+				result = IOT_STATUS_NO_MEMORY;
+				if ( json )
+				{
+					iot_bool_t more_to_read = IOT_TRUE;
+
+					/* process configuration file as it is read */
+					result = IOT_STATUS_SUCCESS;
+					while ( result == IOT_STATUS_SUCCESS &&
+						more_to_read == IOT_TRUE )
+					{
+						char buf[IOT_READ_BLOCK_SIZE];
+						const size_t bytes = os_file_read(
+							buf, sizeof( char ),
 							IOT_READ_BLOCK_SIZE, fd );
 						if ( bytes == 0u )
 						{
@@ -337,25 +379,20 @@ iot_status_t iot_base_configuration_read(
 							more_to_read = IOT_FALSE;
 						}
 						else
-							buf_len += bytes;
+							result = iot_json_stream_parse(
+								json, buf, bytes,
+								err_msg, sizeof( err_msg ) );
 					}
-					else
-					{
-						result = IOT_STATUS_NO_MEMORY;
-					}
-				}
 
-				if ( result == IOT_STATUS_SUCCESS )
-				{
-					/* process configuration file */
-					result = iot_base_configuration_parse(
-						lib, file_path, buf, buf_len );
+					if ( result == IOT_STATUS_SUCCESS )
+						result = iot_json_stream_finish( json,
+							err_msg, sizeof( err_msg ) );
+					if ( result == IOT_STATUS_PARSE_ERROR )
+						IOT_LOG( lib, IOT_LOG_ERROR,
+							"Failed to parse configuration file: %s (%s)",
+							file_path, err_msg );
+					iot_json_stream_terminate( json );
 				}
-
-#ifndef IOT_STACK_ONLY
-				if ( buf )
-					os_free( buf );
-#endif /* ifndef IOT_STACK_ONLY */
 				os_file_close ( fd );
 			}
 
@@ -374,146 +411,183 @@ iot_status_t iot_base_configuration_read(
 }
 
 iot_status_t iot_base_configuration_parse(
-	iot_t *lib,
-	const char *file_path,
-	const char *buf,
-	const size_t len )
+	void *user_data,
+	iot_json_stream_event_t event,
+	iot_json_type_t type,
+	unsigned int depth,
+	const char *key,
+	size_t key_len,
+	const char *value,
+	size_t value_len )
 {
+	struct iot_base_configuration *const cfg =
+		(struct iot_base_configuration *)user_data;
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
-	if ( lib && file_path && buf && len > 0 )
+	if ( cfg )
 	{
-		iot_json_decoder_t *json;
-		const iot_json_item_t *root;
-		char err_msg[32u];
-
-#ifdef IOT_STACK_ONLY
-		char buffer[1024u];
-		json = iot_json_decode_initialize( buffer, 1024u, 0 );
-#else
-		json = iot_json_decode_initialize( NULL, 0u,
-			IOT_JSON_FLAG_DYNAMIC );
-#endif
-		if ( json &&
-			iot_json_decode_parse( json, buf, len, &root,
-				err_msg, 32u ) == IOT_STATUS_SUCCESS )
+		result = IOT_STATUS_SUCCESS;
+		if ( cfg->skip > 0u )
 		{
-			char key_buff[256u];
-			*key_buff = '\0';
-			os_fprintf( OS_STDERR, "Current Configuration:\n" );
-			iot_base_configuration_parse_object(
-				lib, json, root, key_buff, 0u );
-			result = IOT_STATUS_SUCCESS;
+			/* within an array (or an object nested too deeply) */
+			if ( event == IOT_JSON_STREAM_START )
+				++cfg->skip;
+			else if ( event == IOT_JSON_STREAM_END )
+				--cfg->skip;
+		}
+		else if ( depth == 0u )
+		{
+			/* only an object at the root contains options */
+			if ( event == IOT_JSON_STREAM_START &&
+				type == IOT_JSON_TYPE_OBJECT )
+			{
+				cfg->key_len[1] = 0u;
+				os_fprintf( OS_STDERR, "Current Configuration:\n" );
+			}
+			else if ( event == IOT_JSON_STREAM_START )
+				cfg->skip = 1u;
 		}
 		else
 		{
-			IOT_LOG( lib, IOT_LOG_ERROR,
-				"Failed to parse configuration file: %s (%s)",
-					file_path, err_msg );
-			result = IOT_STATUS_PARSE_ERROR;
+			const size_t prefix_len = cfg->key_len[depth];
+			char *const cur_key = cfg->key;
+
+			if ( key &&
+				prefix_len + key_len + 1u < IOT_CONFIG_KEY_MAX )
+			{
+				os_memcpy( &cur_key[prefix_len], key, key_len );
+				key_len += prefix_len;
+				cur_key[key_len] = '\0';
+			}
+			else
+				key = NULL;
+
+			if ( event == IOT_JSON_STREAM_START )
+			{
+				if ( key && type == IOT_JSON_TYPE_OBJECT &&
+					depth + 1u < IOT_CONFIG_DEPTH_MAX )
+				{
+					cur_key[key_len] = '.';
+					cfg->key_len[depth + 1u] = key_len + 1u;
+				}
+				else
+					cfg->skip = 1u;
+			}
+			else if ( key && value )
+			{
+				char num[32u];
+				if ( type == IOT_JSON_TYPE_REAL )
+				{
+					if ( value_len >= sizeof( num ) )
+						value_len = sizeof( num ) - 1u;
+					os_memcpy( num, value, value_len );
+					num[value_len] = '\0';
+				}
+
+				switch ( type )
+				{
+				case IOT_JSON_TYPE_BOOL:
+				{
+					const iot_bool_t v = ( *value == 't' ?
+						IOT_TRUE : IOT_FALSE );
+					iot_config_set( cfg->lib, cur_key,
+						IOT_TYPE_BOOL, v );
+					os_fprintf( OS_STDERR, "%s: %s\n", cur_key,
+						(v == IOT_FALSE ? "false" : "true" ) );
+					break;
+				}
+				case IOT_JSON_TYPE_INTEGER:
+				{
+					iot_int64_t v = 0;
+					if ( iot_base_configuration_integer( value,
+						value_len, &v ) == IOT_STATUS_SUCCESS )
+					{
+						iot_config_set( cfg->lib, cur_key,
+							IOT_TYPE_INT64, v );
+						os_fprintf( OS_STDERR, "%s: %lld\n",
+							cur_key, (long long int)v );
+					}
+					else
+						os_fprintf( OS_STDERR,
+							"%s: integer out of range\n",
+							cur_key );
+					break;
+				}
+				case IOT_JSON_TYPE_REAL:
+				{
+					const iot_float64_t v =
+						(iot_float64_t)os_atof( num );
+					iot_config_set( cfg->lib, cur_key,
+						IOT_TYPE_FLOAT64, v );
+					os_fprintf( OS_STDERR, "%s: %f\n", cur_key, v );
+					break;
+				}
+				case IOT_JSON_TYPE_STRING:
+				{
+					char *const v_ptr = os_malloc( value_len + 1u );
+					if ( v_ptr )
+					{
+						os_memcpy( v_ptr, value, value_len );
+						v_ptr[value_len] = '\0';
+						iot_config_set( cfg->lib, cur_key,
+							IOT_TYPE_STRING, v_ptr );
+						os_fprintf( OS_STDERR, "%s: %s\n",
+							cur_key, v_ptr );
+						os_free( v_ptr );
+					}
+					break;
+				}
+				case IOT_JSON_TYPE_ARRAY:
+				case IOT_JSON_TYPE_OBJECT:
+				case IOT_JSON_TYPE_NULL:
+				default:
+					break;
+				}
+			}
 		}
-		iot_json_decode_terminate( json );
 	}
 	return result;
 }
 
-iot_status_t iot_base_configuration_parse_object(
-	iot_t *lib,
-	iot_json_decoder_t *json,
-	const iot_json_item_t *obj,
-	char *key,
-	size_t key_len )
+iot_status_t iot_base_configuration_integer(
+	const char *value,
+	size_t value_len,
+	iot_int64_t *out )
 {
-	const iot_json_object_iterator_t *iter =
-		iot_json_decode_object_iterator( json, obj );
+	iot_status_t result = IOT_STATUS_BAD_REQUEST;
+	iot_bool_t negative = IOT_FALSE;
+	iot_uint64_t limit = (iot_uint64_t)INT64_MAX;
+	iot_uint64_t v = 0u;
+	size_t i = 0u;
 
-	if ( key_len )
+	if ( value_len > 0u && value[0] == '-' )
 	{
-		key[key_len] = '.';
-		++key_len;
+		negative = IOT_TRUE;
+		limit += 1u;
+		++i;
 	}
-
-	while( iter )
+	if ( i < value_len )
+		result = IOT_STATUS_SUCCESS;
+	for ( ; i < value_len && result == IOT_STATUS_SUCCESS; ++i )
 	{
-		const char *cur_key = NULL;
-		size_t cur_key_len = 0u;
-		const iot_json_item_t *item = NULL;
-		iot_json_type_t type;
-
-		iot_json_decode_object_iterator_key( json,
-			obj, iter, &cur_key, &cur_key_len );
-
-		if ( cur_key )
-		{
-			os_strncpy( &key[key_len], cur_key, cur_key_len );
-			cur_key_len += key_len;
-			key[cur_key_len] = '\0';
-		}
-
-		iot_json_decode_object_iterator_value( json, obj,
-			iter, &item );
-		type = iot_json_decode_type( json, item );
+		const iot_uint64_t digit =
+			(iot_uint64_t)( value[i] - '0' );
+		if ( value[i] < '0' || value[i] > '9' ||
+			v > ( limit - digit ) / 10u )
+			result = IOT_STATUS_BAD_REQUEST;
+		else
+			v = v * 10u + digit;
+	}
 
-		switch ( type )
-		{
-		case IOT_JSON_TYPE_BOOL:
-		{
-			iot_bool_t value = IOT_FALSE;
-			iot_json_decode_bool( json, item, &value );
-			iot_config_set( lib, key, IOT_TYPE_BOOL, value );
-			os_fprintf( OS_STDERR, "%s: %s\n", key,
-				(value == IOT_FALSE ? "false" : "true" ) );
-			break;
-		}
-		case IOT_JSON_TYPE_INTEGER:
-		{
-			iot_int64_t value = 0;
-			iot_json_decode_integer( json, item, &value );
-			iot_config_set( lib, key, IOT_TYPE_INT64, value );
-			os_fprintf( OS_STDERR, "%s: %llu\n", key,
-				(long long int)value );
-			break;
-		}
-		case IOT_JSON_TYPE_REAL:
-		{
-			iot_float64_t value = 0.0;
-			iot_json_decode_real( json, item, &value );
-			iot_config_set( lib, key, IOT_TYPE_FLOAT64, value );
-			os_fprintf( OS_STDERR, "%s: %f\n", key, value );
-			break;
-		}
-		case IOT_JSON_TYPE_STRING:
-		{
-			char *v_ptr;
-			const char *value = NULL;
-			size_t value_len = 0u;
-			iot_json_decode_string( json, item, &value, &value_len );
-			v_ptr = os_malloc( value_len + 1u );
-			if ( v_ptr )
-			{
-				if ( value )
-					os_strncpy( v_ptr, value, value_len );
-				v_ptr[value_len] = '\0';
-				iot_config_set( lib, key,
-					IOT_TYPE_STRING, v_ptr );
-				os_fprintf( OS_STDERR, "%s: %s\n", key, v_ptr );
-				os_free( v_ptr );
-			}
-			break;
-		}
-		case IOT_JSON_TYPE_OBJECT:
-		{
-			iot_base_configuration_parse_object( lib, json,
-				item, key, cur_key_len );
-			break;
-		}
-		case IOT_JSON_TYPE_ARRAY:
-		case IOT_JSON_TYPE_NULL:
-		default:
-			break;
-		}
-		iter = iot_json_decode_object_iterator_next( json, obj, iter );
+	if ( result == IOT_STATUS_SUCCESS )
+	{
+		if ( negative == IOT_FALSE )
+			*out = (iot_int64_t)v;
+		else if ( v == limit )
+			*out = INT64_MIN;
+		else
+			*out = -(iot_int64_t)v;
 	}
-	return IOT_STATUS_SUCCESS;
+	return result;
 }
 
 iot_status_t iot_base_device_id_set(
@@ -619,6 +693,36 @@ OS_THREAD_DECL iot_base_main_thread( void *user_data )
 	return (OS_THREAD_RETURN)0;
 }
 
+OS_THREAD_DECL iot_base_deadline_thread_main( void *user_data )
+{
+	struct iot *lib = (struct iot *)user_data;
+	os_status_t wait_result = OS_STATUS_SUCCESS;
+	while ( lib && lib->to_quit == IOT_FALSE &&
+		wait_result == OS_STATUS_SUCCESS )
+	{
+		os_thread_mutex_lock( &lib->worker_mutex );
+		if ( lib->to_quit == IOT_FALSE )
+		{
+			const iot_timestamp_t next =
+				iot_action_deadline_next( lib );
+			const iot_timestamp_t now = iot_timestamp_monotonic();
+			/* stop if unable to wait for a deadline */
+			if ( next == 0u )
+				wait_result = os_thread_condition_wait(
+					&lib->deadline_signal,
+					&lib->worker_mutex );
+			else if ( next > now )
+				os_thread_condition_timed_wait(
+					&lib->deadline_signal,
+					&lib->worker_mutex,
+					(iot_millisecond_t)( next - now ) );
+		}
+		os_thread_mutex_unlock( &lib->worker_mutex );
+		iot_action_deadline_check( lib );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
 OS_THREAD_DECL iot_base_worker_thread_main( void *user_data )
 {
 	struct iot *lib = (struct iot *)user_data;
@@ -969,7 +1073,7 @@ iot_t *iot_initialize(
 				os_thread_mutex_create( &result->alarm_mutex );
 				os_thread_mutex_create( &result->worker_mutex );
 				os_thread_condition_create( &result->worker_signal );
-				os_thread_rwlock_create( &result->worker_thread_exclusive_lock );
+				os_thread_condition_create( &result->deadline_signal );
 #endif /* ifndef IOT_THREAD_SUPPORT */
 
 				/*os_socket_initialize();*/
@@ -992,6 +1096,12 @@ iot_t *iot_initialize(
 				}
 				else
 				{
+#ifdef IOT_ACTION_RUNNER
+					/* runner is started by the first command,
+					 * commands are run directly if it fails */
+					iot_action_runner_initialize(
+						&result->action_runner );
+#endif /* ifdef IOT_ACTION_RUNNER */
 					iot_plugin_builtin_load( result, IOT_PLUGIN_MAX );
 
 					/* initialize all builtin plug-ins */
@@ -1147,6 +1257,10 @@ iot_status_t iot_loop_iteration( iot_t *lib, iot_millisecond_t max_time_out )
 		result = iot_plugin_perform( lib, NULL, &max_time_out,
 			IOT_OPERATION_ITERATION, NULL, NULL, NULL );
 
+		/* report actions running past their time limit (also
+		 * done as they pass by the deadline thread, if started) */
+		iot_action_deadline_check( lib );
+
 		if ( result == IOT_STATUS_SUCCESS
 #ifdef IOT_THREAD_SUPPORT
 			&& ( lib->flags & IOT_FLAG_SINGLE_THREAD )
@@ -1194,6 +1308,11 @@ iot_status_t iot_loop_start( iot_t *lib )
 					&lib->worker_thread[i],
 					iot_base_worker_thread_main, lib,
 					stack_size );
+			if ( os_result == OS_STATUS_SUCCESS )
+				os_result = os_thread_create(
+					&lib->deadline_thread,
+					iot_base_deadline_thread_main, lib,
+					stack_size );
 			if ( os_result == OS_STATUS_SUCCESS )
 				result = IOT_STATUS_SUCCESS;
 		}
@@ -1214,13 +1333,17 @@ iot_status_t iot_loop_stop( iot_t *lib, iot_bool_t force )
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
 	if ( lib )
 	{
+		size_t i;
 		lib->to_quit = IOT_TRUE;
+
+		/* ask running actions to stop */
+		for ( i = 0u; i < IOT_ACTION_QUEUE_MAX; ++i )
+			lib->request_queue[i].cancelled = IOT_TRUE;
 #ifdef IOT_THREAD_SUPPORT
 		if ( lib->flags & IOT_FLAG_SINGLE_THREAD )
 			result = IOT_STATUS_NOT_SUPPORTED;
 		else
 		{
-			size_t i;
 			if ( lib->main_thread != 0 )
 			{
 				if ( force == IOT_FALSE )
@@ -1250,6 +1373,20 @@ iot_status_t iot_loop_stop( iot_t *lib, iot_bool_t force )
 					lib->worker_thread[i] = 0;
 				}
 			}
+
+			/* signalling takes the worker mutex, the deadline
+			 * thread checks to_quit while holding it */
+			if ( lib->deadline_thread != 0 )
+			{
+				os_thread_condition_signal(
+					&lib->deadline_signal,
+					&lib->worker_mutex );
+				if ( force == IOT_FALSE )
+					os_thread_wait( &lib->deadline_thread );
+				else
+					os_thread_destroy( &lib->deadline_thread );
+				lib->deadline_thread = 0;
+			}
 			result = IOT_STATUS_SUCCESS;
 		}
 #else
@@ -1338,14 +1475,17 @@ iot_status_t iot_terminate(
 			iot_plugin_terminate( lib, &lib->plugin[i - 1u] );
 		result = IOT_STATUS_SUCCESS;
 
+#ifdef IOT_ACTION_RUNNER
+		iot_action_runner_terminate( &lib->action_runner );
+#endif /* ifdef IOT_ACTION_RUNNER */
+
 #ifdef IOT_THREAD_SUPPORT
 		os_thread_mutex_destroy( &lib->log_mutex );
 		os_thread_mutex_destroy( &lib->telemetry_mutex );
 		os_thread_mutex_destroy( &lib->alarm_mutex );
 		os_thread_mutex_destroy( &lib->worker_mutex );
 		os_thread_condition_destroy( &lib->worker_signal );
-		os_thread_rwlock_destroy(
-			&lib->worker_thread_exclusive_lock );
+		os_thread_condition_destroy( &lib->deadline_signal );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 #ifndef IOT_STACK_ONLY
@@ -1359,6 +1499,23 @@ iot_status_t iot_terminate(
 	return result;
 }
 
+iot_timestamp_t iot_timestamp_monotonic( void )
+{
+	iot_timestamp_t time_stamp = 0u;
+#if defined( _WIN32 )
+	time_stamp = (iot_timestamp_t)GetTickCount64();
+#elif defined( CLOCK_MONOTONIC )
+	struct timespec ts;
+	if ( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+		time_stamp = (iot_timestamp_t)ts.tv_sec *
+			IOT_MILLISECONDS_IN_SECOND +
+			(iot_timestamp_t)ts.tv_nsec / 1000000u;
+#else
+	os_time( &time_stamp, NULL );
+#endif
+	return time_stamp;
+}
+
 iot_timestamp_t iot_timestamp_now( void )
 {
 	iot_timestamp_t time_stamp = 0u;
@@ -24,8 +24,6 @@
 #include "shared/iot_types.h"      /* for struct iot */
 
 #include <os.h>                    /* operating system abstraction */
-#include <archive.h>               /* for archiving functions */
-#include <archive_entry.h>         /* for adding files to an archive */
 
 /**
  * @brief Default download subdirectory
@@ -76,98 +74,6 @@ static iot_status_t iot_file_transfer(
 	iot_file_progress_callback_t *func,
 	void *user_data );
 
-/**
- * @brief Build an archive from a directory for the cloud
- *
- * @param[in]      archive_path        name of the archive file to produce
- * @param[in]      path                path to the directory to archive
- *
- * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed
- * @retval IOT_STATUS_FAILURE          internal system failure
- * @retval IOT_STATUS_SUCCESS          operation successful
- */
-static iot_status_t iot_file_archive_directory(
-	const char *archive_path,
-	const char *path );
-
-
-iot_status_t iot_file_archive_directory(
-	const char *archive_path,
-	const char *path )
-{
-	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
-	if ( archive_path && path )
-	{
-		os_dir_t *dir = NULL;
-		struct archive *archive;
-
-		/* compress all files in upload directories */
-		archive = archive_write_new();
-		archive_write_add_filter_none( archive );
-		archive_write_set_format_pax_restricted( archive );
-		archive_write_open_filename( archive, archive_path );
-
-		if ( ( dir = os_directory_open( path ) ) != NULL )
-		{
-			char file_name[ PATH_MAX + 1u ];
-			iot_bool_t walk_directory = IOT_TRUE;
-
-			while ( walk_directory )
-			{
-				char file_path[ PATH_MAX + 1u ];
-				os_file_t input_file;
-				struct stat file_stat;
-
-				os_directory_next( dir, IOT_TRUE, file_name, PATH_MAX );
-
-				os_snprintf( file_path, PATH_MAX, "%s%c%s", path, OS_DIR_SEP, file_name );
-
-				stat( file_name, &file_stat );
-				input_file = os_file_open( file_name, OS_READ );
-				if ( input_file )
-				{
-					/* create an archive of all files */
-					char buff[1024];
-					size_t buff_len;
-					struct archive_entry *entry;
-
-					entry = archive_entry_new();
-
-					/* Note: set the file details individually.  Calling archive_entry_copy_stat(
-					 * entry, &file_stat ) is easier but it corrupts archives on 32b architectures,
-					 * e.g. quark. */
-					archive_entry_set_size(entry, file_stat.st_size );
-					archive_entry_set_filetype(entry, AE_IFREG );
-					archive_entry_set_perm(entry, 0644 );
-					archive_entry_set_pathname( entry, file_name );
-
-					/* stat struct does not store
-					 * the birthtime.  That is part of the file system */
-					archive_entry_set_atime( entry, file_stat.st_atime, 0 );
-					archive_entry_set_birthtime( entry, file_stat.st_ctime, 0 );
-					archive_entry_set_ctime( entry, file_stat.st_ctime, 0 );
-					archive_entry_set_mtime( entry, file_stat.st_mtime, 0 );
-
-					archive_write_header( archive, entry );
-					while ( ( buff_len = os_file_read( buff, 1, sizeof( buff ), input_file ) ) )
-						archive_write_data( archive, buff, buff_len );
-
-					archive_entry_free( entry );
-					os_file_close( input_file );
-					result = IOT_STATUS_SUCCESS;
-				}
-				else
-					walk_directory = IOT_FALSE;
-			}
-			os_directory_close( dir );
-		}
-
-		archive_write_close( archive );
-		archive_write_free( archive );
-	}
-	return result;
-}
-
 iot_status_t iot_file_download(
 	iot_t *lib,
 	iot_transaction_t *txn,
@@ -248,16 +154,34 @@ iot_status_t iot_file_transfer(
 			}
 		}
 
+		/* a directory is uploaded as an archive, produced as it
+		 * is sent */
+		if ( transfer.path && os_directory_exists( transfer.path ) )
+		{
+			const char *compression = NULL;
+
+			transfer.archive = IOT_ARCHIVE_TAR;
+			iot_options_get_string( options, "compression",
+				IOT_FALSE, &compression );
+			if ( compression &&
+				os_strcmp( compression, "gzip" ) == 0 )
+				transfer.archive = IOT_ARCHIVE_TAR_GZIP;
+			else if ( compression &&
+				os_strcmp( compression, "zstd" ) == 0 )
+				transfer.archive = IOT_ARCHIVE_TAR_ZSTD;
+		}
+
 		/* Use the file_name to rename it on the cloud */
 		if ( file_name && file_name[0] != '\0' )
 			transfer.name = file_name;
 		else
 		{
 			/* if it's a directory, use the path's name
-			 * with dashes and tar extension */
-			if ( os_directory_exists( transfer.path ) )
+			 * with dashes and archive extension */
+			if ( transfer.archive != IOT_ARCHIVE_NONE )
 			{
-				const char *const ext = ".tar";
+				const char *const ext =
+					iot_archive_extension( transfer.archive );
 				size_t path_len = os_strlen(
 					transfer.path );
 				const size_t heap_len = path_len +
@@ -312,53 +236,8 @@ iot_status_t iot_file_transfer(
 		}
 		if ( op == IOT_OPERATION_FILE_UPLOAD )
 		{
-			if ( os_directory_exists( transfer.path ) )
-			{
-				size_t archive_len = 0u;
-				char *archive_path = NULL;
-				const char *const ext = ".tar";
-				const char *const file_name_format =
-					"fileXXXXXX";
-
-				/* get runtime directory name */
-				archive_len = iot_directory_name_get(
-					IOT_DIR_RUNTIME, NULL, 0u );
-
-				/* +1 for directory seperator */
-				archive_len += os_strlen( file_name_format ) +
-					os_strlen( ext ) + 1u;
-
-				/* get a temporary file name */
-				archive_path = os_malloc( archive_len + 1u );
-
-				result = IOT_STATUS_NO_MEMORY;
-				if ( archive_path )
-				{
-					const size_t dir_len =
-						iot_directory_name_get(
-							IOT_DIR_RUNTIME,
-							archive_path,
-							archive_len );
-					os_snprintf( &archive_path[dir_len],
-						archive_len - dir_len + 1u,
-						"%c%s%s", OS_DIR_SEP,
-						file_name_format, ext );
-					archive_path[ archive_len ] = '\0';
-					os_file_temp( archive_path,
-						os_strlen(ext) );
-
-					result = iot_file_archive_directory(
-						archive_path, transfer.path );
-					if ( result == IOT_STATUS_SUCCESS )
-					{
-						transfer.path = archive_path;
-						os_free( heap_path );
-						heap_path = archive_path;
-					}
-					else
-						os_free( archive_path );
-				}
-			}
+			if ( transfer.archive != IOT_ARCHIVE_NONE )
+				result = IOT_STATUS_SUCCESS;
 			else if ( os_file_exists( transfer.path ) )
 				result = IOT_STATUS_SUCCESS;
 			else
@@ -48,6 +48,22 @@ const char *iot_json_encode_dump(
 	return app_json_encode_dump( (app_json_encoder_t *)encoder );
 }
 
+size_t iot_json_encode_estimate(
+	const iot_json_encoder_t *encoder,
+	const char *key,
+	const char *value,
+	size_t value_len )
+{
+	return app_json_encode_estimate(
+		(const app_json_encoder_t *)encoder, key, value, value_len );
+}
+
+iot_status_t iot_json_encode_flush(
+	iot_json_encoder_t *encoder )
+{
+	return app_json_encode_flush( (app_json_encoder_t *)encoder );
+}
+
 iot_json_encoder_t *iot_json_encode_initialize(
 	void *buf,
 	size_t len,
@@ -104,6 +120,22 @@ iot_status_t iot_json_encode_real(
 		(app_json_encoder_t *)encoder, key, value );
 }
 
+iot_status_t iot_json_encode_reserve(
+	iot_json_encoder_t *encoder,
+	size_t len )
+{
+	return app_json_encode_reserve( (app_json_encoder_t *)encoder, len );
+}
+
+iot_status_t iot_json_encode_sink_set(
+	iot_json_encoder_t *encoder,
+	iot_json_encode_sink_t sink,
+	void *user_data )
+{
+	return app_json_encode_sink_set( (app_json_encoder_t *)encoder,
+		(app_json_encode_sink_t)sink, user_data );
+}
+
 iot_status_t iot_json_encode_string(
 	iot_json_encoder_t *encoder,
 	const char *key,
@@ -0,0 +1,60 @@
+/**
+ * @file
+ * @brief source file for IoT library json path functionality
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "api/public/iot_json.h"
+#include "utilities/app_json.h"
+
+iot_json_path_t *iot_json_path_compile(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	const char *expr )
+{
+	return (iot_json_path_t *)app_json_path_compile( buf, len, flags,
+		expr );
+}
+
+iot_status_t iot_json_path_extract(
+	const iot_json_decoder_t *decoder,
+	const iot_json_item_t *item,
+	const iot_json_path_t *const *paths,
+	size_t count,
+	const iot_json_item_t **out )
+{
+	return app_json_path_extract( (const app_json_decoder_t *)decoder,
+		(const app_json_item_t *)item,
+		(const app_json_path_t *const *)paths, count,
+		(const app_json_item_t **)out );
+}
+
+iot_status_t iot_json_path_match(
+	const iot_json_decoder_t *decoder,
+	const iot_json_item_t *item,
+	const iot_json_path_t *path,
+	iot_json_path_callback_t callback,
+	void *user_data )
+{
+	return app_json_path_match( (const app_json_decoder_t *)decoder,
+		(const app_json_item_t *)item, (const app_json_path_t *)path,
+		(app_json_path_callback_t)callback, user_data );
+}
+
+void iot_json_path_terminate(
+	iot_json_path_t *path )
+{
+	app_json_path_terminate( (app_json_path_t *)path );
+}
@@ -0,0 +1,56 @@
+/**
+ * @file
+ * @brief source file for IoT library json streaming functionality
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "api/public/iot_json.h"
+#include "utilities/app_json.h"
+
+iot_status_t iot_json_stream_finish(
+	iot_json_stream_t *stream,
+	char *error,
+	size_t error_len )
+{
+	return app_json_stream_finish( (app_json_stream_t *)stream,
+		error, error_len );
+}
+
+iot_json_stream_t *iot_json_stream_initialize(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	iot_json_stream_callback_t callback,
+	void *user_data )
+{
+	return (iot_json_stream_t *)app_json_stream_initialize( buf, len,
+		flags, (app_json_stream_callback_t)callback, user_data );
+}
+
+iot_status_t iot_json_stream_parse(
+	iot_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	char *error,
+	size_t error_len )
+{
+	return app_json_stream_parse( (app_json_stream_t *)stream,
+		js, len, error, error_len );
+}
+
+void iot_json_stream_terminate(
+	iot_json_stream_t *stream )
+{
+	app_json_stream_terminate( (app_json_stream_t *)stream );
+}
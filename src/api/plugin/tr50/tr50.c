@@ -15,6 +15,7 @@
  * OR CONDITIONS OF ANY KIND, either express or implied."
  */
 
+#include "../../shared/iot_archive.h"
 #include "../../shared/iot_base64.h"
 #include "../../shared/iot_defs.h"
 #include "../../shared/iot_types.h"
@@ -25,16 +26,31 @@
 #include <iot_plugin.h>
 #include <os.h>
 #include <curl/curl.h>
+#include <limits.h> /* for LONG_MAX */
 
 #ifdef IOT_STACK_ONLY
 #define TR50_IN_BUFFER_SIZE                 1024u
 #endif /* ifdef IOT_STACK_ONLY */
 
-/** @brief Maximum concurrent file transfers */
+/** @brief Default maximum time in milliseconds to hold an action
+ *         acknowledgement before sending it to the cloud */
+#define TR50_ACK_DELAY_MS                   100u
+/** @brief Maximum number of action acknowledgements sent in a message */
+#define TR50_ACK_BATCH_MAX                  16u
+/** @brief Size of the buffer holding batched action acknowledgements */
+#define TR50_ACK_BATCH_BUFFER_SIZE          4096u
+
+#ifndef IOT_STACK_ONLY
+/** @brief Space for the envelope of a published message (transaction id,
+ *         command name, "params" object and time stamp) */
+#define TR50_ENVELOPE_SIZE                  128u
+#endif /* ifndef IOT_STACK_ONLY */
+
+/** @brief Default maximum number of file transfers in progress at once */
 #define TR50_FILE_TRANSFER_MAX              10u
-/** @brief Time interval in seconds to check file
- *         transfer queue */
-#define TR50_FILE_QUEUE_CHECK_INTERVAL      30u * IOT_MILLISECONDS_IN_SECOND /* 30 seconds */
+/** @brief Default maximum number of file transfers queued (including the
+ *         ones in progress) */
+#define TR50_FILE_TRANSFER_BACKLOG          64u
 /** @brief Time interval in seconds for a file
  *         transfer to expire if it keeps failing */
 #define TR50_FILE_TRANSFER_EXPIRY_TIME      1u * IOT_MINUTES_IN_HOUR * \
@@ -42,6 +58,10 @@
                                             IOT_MILLISECONDS_IN_SECOND /* 1 hour */
 /** @brief Amount to offset the request id by */
 #define TR50_FILE_REQUEST_ID_OFFSET         256u
+/** @brief Number of request ids given to file transfers in turn */
+#define TR50_FILE_REQUEST_ID_COUNT          65536u
+/** @brief Extension for temporary downloaded file */
+#define TR50_DOWNLOAD_EXTENSION             IOT_TRANSFER_PART_EXTENSION
 /** @brief number of seconds before sending a keep alive message */
 #define TR50_MQTT_KEEP_ALIVE                60u
 /** @brief Time interval to send a ping if not data received */
@@ -60,6 +80,8 @@
 #define TR50_TIMEOUT_RECONNECT_MS           5u * IOT_MILLISECONDS_IN_SECOND /* 5 seconds */
 /** @brief Maximum length for a "thingkey" */
 #define TR50_THING_KEY_MAX_LEN              ( IOT_ID_MAX_LEN * 2u ) + 1u
+/** @brief Size of the memory holding each compiled mailbox message path */
+#define TR50_MSG_PATH_SIZE                  160u
 
 #ifdef IOT_THREAD_SUPPORT
 /** @brief File transfer progress interval in seconds */
@@ -68,41 +90,170 @@
 #define TR50_DEFAULT_SSL_VERIFY_HOST        2u
 /** @brief Default value for ssl verify peer */
 #define TR50_DEFAULT_SSL_VERIFY_PEER        1u
-/** @brief Extension for temporary downloaded file */
-#define TR50_DOWNLOAD_EXTENSION             ".part"
+/** @brief Time in milliseconds before the first retry of a failed transfer
+ *         (doubled for each following retry) */
+#define TR50_FILE_TRANSFER_RETRY_MS         ( 10u * IOT_MILLISECONDS_IN_SECOND )
+/** @brief Maximum time in milliseconds between retries of a transfer */
+#define TR50_FILE_TRANSFER_RETRY_MAX_MS     ( 5u * IOT_SECONDS_IN_MINUTE * \
+                                              IOT_MILLISECONDS_IN_SECOND )
+/** @brief Maximum time in milliseconds the transfer thread waits for
+ *         activity on the transfers in progress */
+#define TR50_FILE_TRANSFER_WAIT_MS          1000
+/** @brief Maximum number of idle curl handles kept for later transfers */
+#define TR50_FILE_TRANSFER_POOL_MAX         TR50_FILE_TRANSFER_MAX
+/** @brief Time in milliseconds between adjustments of the speed of the
+ *         transfers in progress */
+#define TR50_FILE_TRANSFER_SCHEDULE_MS      500u
+/** @brief Slowest speed a running transfer is limited to (bytes/second) */
+#define TR50_FILE_TRANSFER_SPEED_MIN        1024
+/** @brief Size of the chunks a segmented download is tracked in (bytes) */
+#define TR50_FILE_SEGMENT_CHUNK_SIZE        ( 1024u * 1024u )
+/** @brief Smallest download fetched as several ranges (bytes) */
+#define TR50_FILE_SEGMENT_MIN_SIZE          ( 16u * TR50_FILE_SEGMENT_CHUNK_SIZE )
+/** @brief Extension for the chunks received of a segmented download */
+#define TR50_DOWNLOAD_MAP_EXTENSION         ".map"
+/** @brief Identifies the file holding the chunks received (and version) */
+#define TR50_DOWNLOAD_MAP_MAGIC             "TR50MAP1"
+/** @brief Size of the header of the file holding the chunks received:
+ *         magic, file size, crc32 and chunk size */
+#define TR50_DOWNLOAD_MAP_HEADER_SIZE       24u
 #endif /* ifdef IOT_THREAD_SUPPORT */
+/** @brief Maximum number of ranges of a download fetched at once */
+#define TR50_FILE_SEGMENT_MAX               8u
+/** @brief Priority of a background transfer, paused while a transfer of
+ *         higher priority is in progress */
+#define TR50_FILE_PRIORITY_LOW              0
+/** @brief Default priority of a transfer */
+#define TR50_FILE_PRIORITY_NORMAL           1
+/** @brief Priority of an urgent transfer (e.g. a software update) */
+#define TR50_FILE_PRIORITY_HIGH             2
+
+/** @brief fields read from each message in a mailbox.check reply */
+enum tr50_msg_path
+{
+	TR50_MSG_PATH_ID = 0,           /**< @brief "id" */
+	TR50_MSG_PATH_PARAMS,           /**< @brief "params" */
+	TR50_MSG_PATH_METHOD,           /**< @brief "params.method" */
+	TR50_MSG_PATH_ARGS,             /**< @brief "params.params" */
+	TR50_MSG_PATH_COUNT             /**< @brief number of fields */
+};
+
+/** @brief paths of the fields read from each mailbox message */
+static const char *const TR50_MSG_PATHS[ TR50_MSG_PATH_COUNT ] = {
+	"id", "params", "params.method", "params.params" };
+
+/** @brief states of a file transfer in the queue */
+enum tr50_file_transfer_state
+{
+	TR50_FILE_TRANSFER_FREE = 0,    /**< @brief not queued yet */
+	TR50_FILE_TRANSFER_REQUESTED,   /**< @brief waiting for file details */
+	TR50_FILE_TRANSFER_PENDING,     /**< @brief waiting to start (or retry) */
+	TR50_FILE_TRANSFER_ACTIVE,      /**< @brief transfer is in progress */
+	TR50_FILE_TRANSFER_COMPLETE     /**< @brief waiting to report result */
+};
+
+struct tr50_file_transfer;
+
+/** @brief a range of a download fetched on its own connection */
+struct tr50_file_segment
+{
+	/** @brief index of the chunk being received */
+	iot_uint64_t chunk;
+	/** @brief index of the chunk after the range */
+	iot_uint64_t chunk_end;
+	/** @brief offset after the range */
+	iot_uint64_t end;
+	/** @brief curl handle fetching the range (NULL if idle) */
+	CURL *lib_curl;
+	/** @brief offset of the next byte received */
+	iot_uint64_t offset;
+	/** @brief transfer the range belongs to */
+	struct tr50_file_transfer *transfer;
+};
 
 /** @brief structure containing informaiton about a file transfer */
 struct tr50_file_transfer
 {
+	/** @brief format of the archive uploaded, if the path is a directory */
+	iot_archive_type_t archive;
+	/** @brief archive of the directory being uploaded */
+	iot_archive_stream_t *archive_stream;
+	/** @brief bytes sent or received, over all attempts */
+	iot_uint64_t bytes;
+	/** @brief value of bytes when the speed was last adjusted */
+	iot_uint64_t bytes_scheduled;
 	/** @brief progress function callback */
 	iot_file_progress_callback_t *callback;
 	/** @brief flag to cancel transfer */
 	iot_bool_t cancel;
+	/** @brief checksum of the data downloaded so far */
+	iot_checksum_context_t checksum;
+	/** @brief number of chunks of a segmented download */
+	iot_uint64_t chunk_count;
+	/** @brief bitmap of the chunks of a segmented download received */
+	unsigned char *chunk_map;
+	/** @brief handle of the file recording the chunks received */
+	os_file_t chunk_map_handle;
+	/** @brief maximum number of chunks requested at once by a segment */
+	iot_uint64_t chunk_span;
 	/** @brief crc32 checksum */
 	iot_uint64_t crc32;
+	/** @brief next transfer in a list private to the file transfer thread */
+	struct tr50_file_transfer *engine_next;
 	/** @brief time when transfer expired */
 	iot_timestamp_t expiry_time;
+	/** @brief handle of the local file being transferred */
+	os_file_t file_handle;
+	/** @brief local file being transferred (temporary file for downloads) */
+	char *file_path;
+	/** @brief id of the file.get or file.put request */
+	unsigned int id;
 	/** @brief last time progress was sent */
 	double last_update_time;
 	/** @brief curl handle */
 	CURL *lib_curl;
 	/** @brief cloud's file name */
-	char name[ PATH_MAX + 1u ];
+	char *name;
+	/** @brief next transfer in the queue */
+	struct tr50_file_transfer *next;
 	/** @brief file operation (get/put) */
 	iot_operation_t op;
 	/** @brief local file path */
-	char path[ PATH_MAX + 1u ];
+	char *path;
+	/** @brief transfer is paused for one of higher priority */
+	iot_bool_t paused;
+	/** @brief importance of the transfer (TR50_FILE_PRIORITY_*) */
+	iot_uint8_t priority;
 	/** @brief total byte transfered in previous session(s) */
 	long prev_byte;
 	/** @brief pointer to plugin data */
 	void *plugin_data;
+	/** @brief result of the transfer (once complete) */
+	iot_status_t result;
+	/** @brief number of times the transfer has been retried */
+	iot_int64_t retry;
 	/** @brief file size */
 	iot_uint64_t size;
+	/** @brief headers added to the request (upload of an archive) */
+	struct curl_slist *request_headers;
 	/** @brief next time transfer is retried */
 	iot_timestamp_t retry_time;
-	/** @brief cloud download url */
-	char url[ PATH_MAX + 1u ];
+	/** @brief ranges of a segmented download being fetched */
+	struct tr50_file_segment segment[ TR50_FILE_SEGMENT_MAX ];
+	/** @brief bytes of a segmented download received in this session */
+	iot_uint64_t segment_bytes;
+	/** @brief number of ranges fetched at once (0: a single stream) */
+	iot_uint8_t segment_count;
+	/** @brief server ignored a range request, use a single stream */
+	iot_bool_t segment_fallback;
+	/** @brief file is written in order, so it can be read as it downloads */
+	iot_bool_t sequential;
+	/** @brief maximum speed of the transfer (bytes/second, 0: unlimited) */
+	curl_off_t speed_limit;
+	/** @brief state of the transfer */
+	enum tr50_file_transfer_state state;
+	/** @brief cloud download url (once the request is answered) */
+	char *url;
 	/** @brief Use global file store */
 	iot_bool_t use_global_store;
 	/** @brief callback's user data */
@@ -114,16 +265,77 @@ struct tr50_file_transfer
 /** @brief internal data required for the plug-in */
 struct tr50_data
 {
+	/** @brief pending action acknowledgements (multi-command message) */
+	char ack_buf[ TR50_ACK_BATCH_BUFFER_SIZE + 1u ];
+	/** @brief number of pending action acknowledgements */
+	iot_uint8_t ack_count;
+	/** @brief maximum time to hold an action acknowledgement */
+	iot_millisecond_t ack_delay;
+	/** @brief length of the pending action acknowledgement message */
+	size_t ack_len;
+#ifdef IOT_THREAD_SUPPORT
+	/** @brief mutex protecting pending action acknowledgements */
+	os_thread_mutex_t ack_mutex;
+	/** @brief signalled when an acknowledgement starts a new batch */
+	os_thread_condition_t ack_signal;
+	/** @brief whether the acknowledgement timer thread is running */
+	iot_bool_t ack_running;
+	/** @brief thread sending batches once their delay expires */
+	os_thread_t ack_thread;
+#endif /* IOT_THREAD_SUPPORT */
+	/** @brief time when the first pending acknowledgement was queued */
+	iot_timestamp_t ack_time;
+	/** @brief transactions of pending action acknowledgements */
+	iot_transaction_t ack_txn[ TR50_ACK_BATCH_MAX ];
+	/** @brief number of pending acknowledgements with a transaction */
+	iot_uint8_t ack_txn_count;
 	/** @brief number of times connection lost reported */
 	iot_uint32_t connection_lost_msg_count;
-	/** @brief file transfer queue */
-	struct tr50_file_transfer file_transfer_queue[ TR50_FILE_TRANSFER_MAX ];
-	/** @brief number of ongoing file transfer */
-	iot_uint8_t file_transfer_count;
-	/** @brief time when file transfer queue is last checked */
-	iot_timestamp_t file_queue_last_checked;
+	/** @brief file transfer queue (oldest first) */
+	struct tr50_file_transfer *file_transfer_queue;
+	/** @brief maximum number of file transfers queued */
+	unsigned int file_transfer_backlog;
+	/** @brief number of file transfers queued */
+	unsigned int file_transfer_count;
+	/** @brief number of file transfer requests sent */
+	unsigned int file_transfer_id;
+#ifdef IOT_THREAD_SUPPORT
+	/** @brief multi handle performing all file transfers */
+	CURLM *transfer_multi;
+	/** @brief data shared between file transfers (dns, ssl sessions and
+	 *         connections) */
+	CURLSH *transfer_share;
+	/** @brief idle curl handles, kept to be reused by later transfers */
+	CURL *transfer_pool[ TR50_FILE_TRANSFER_POOL_MAX ];
+	/** @brief number of idle curl handles */
+	iot_uint8_t transfer_pool_count;
+	/** @brief maximum number of file transfers in progress at once */
+	unsigned int transfer_active_max;
+	/** @brief maximum speed of all file transfers together
+	 *         (bytes/second, 0: unlimited) */
+	iot_int64_t transfer_max_speed;
+	/** @brief time when the speed of the transfers was last adjusted */
+	iot_timestamp_t transfer_schedule_time;
+	/** @brief bytes the transfers can still move before exceeding the
+	 *         maximum speed (negative once exceeded) */
+	iot_int64_t transfer_tokens;
+	/** @brief mutex protecting the file transfer queue */
+	os_thread_mutex_t transfer_mutex;
+	/** @brief whether the file transfer thread is running */
+	iot_bool_t transfer_running;
+	/** @brief thread performing all file transfers */
+	os_thread_t transfer_thread;
+#endif /* ifdef IOT_THREAD_SUPPORT */
 	/** @brief library handle */
 	iot_t *lib;
+	/** @brief compiled paths of the fields read from mailbox messages */
+	const iot_json_path_t *msg_paths[ TR50_MSG_PATH_COUNT ];
+	/** @brief memory holding the compiled mailbox message paths */
+	char msg_path_buf[ TR50_MSG_PATH_COUNT ][ TR50_MSG_PATH_SIZE ];
+#ifndef IOT_STACK_ONLY
+	/** @brief decoder reused to parse each incoming message */
+	iot_json_decoder_t *msg_decoder;
+#endif /* ifndef IOT_STACK_ONLY */
 #ifdef IOT_THREAD_SUPPORT
 	/** @brief mail related mutex to prevent concurrent checks */
 	os_thread_mutex_t mail_check_mutex;
@@ -156,6 +368,80 @@ enum tr50_transaction_status
 };
 
 
+/**
+ * @brief sends any pending action acknowledgements to the cloud
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in]      force               send even if the maximum delay for
+ *                                     the batch has not yet expired
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_FAILURE          on failure
+ * @retval IOT_STATUS_SUCCESS          on success (or nothing to send)
+ *
+ * @see tr50_action_ack_queue
+ */
+static IOT_SECTION iot_status_t tr50_action_ack_flush(
+	struct tr50_data *data,
+	iot_bool_t force );
+
+/**
+ * @brief adds an action acknowledgement to the pending batch
+ *
+ * Acknowledgements are combined into a single multi-command message which
+ * is sent once the batch is full or the configured maximum delay expires.
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in]      cmd                 json encoded command to send
+ * @param[in]      txn                 transaction status information
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_FAILURE          on failure
+ * @retval IOT_STATUS_FULL             command too large to be sent
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see tr50_action_ack_flush
+ */
+static IOT_SECTION iot_status_t tr50_action_ack_queue(
+	struct tr50_data *data,
+	const char *cmd,
+	const iot_transaction_t *txn );
+
+/**
+ * @brief sends the pending batch of action acknowledgements
+ *
+ * @note the caller must hold the acknowledgement lock
+ *
+ * @param[in,out]  data                plug-in specific data
+ *
+ * @retval IOT_STATUS_FAILURE          on failure
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see tr50_action_ack_flush
+ */
+static IOT_SECTION iot_status_t tr50_action_ack_send(
+	struct tr50_data *data );
+
+#ifdef IOT_THREAD_SUPPORT
+/**
+ * @brief thread sending each batch of action acknowledgements once its
+ *        maximum delay expires
+ *
+ * The thread is started by the first acknowledgement queued, and waits
+ * until the oldest pending acknowledgement is due, so that a batch is not
+ * held until the next iteration of the main loop.
+ *
+ * @param[in,out]  arg                 plug-in specific data
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see tr50_action_ack_queue
+ */
+static IOT_SECTION OS_THREAD_DECL tr50_action_ack_timer(
+	void *arg );
+#endif /* IOT_THREAD_SUPPORT */
+
 /**
  * @brief function called to respond to the cloud on an action complete
  *
@@ -418,6 +704,8 @@ iot_status_t tr50_execute(
  *
  * @retval IOT_STATUS_BAD_PARAMETER    bad params
  * @retval IOT_STATUS_FAILURE          on failure
+ * @retval IOT_STATUS_FULL             too many file transfers queued
+ * @retval IOT_STATUS_NO_MEMORY        not enough memory for the transfer
  * @retval IOT_STATUS_SUCCESS          on success
  */
 static IOT_SECTION iot_status_t tr50_file_request_send(
@@ -428,17 +716,242 @@ static IOT_SECTION iot_status_t tr50_file_request_send(
 
 #ifdef IOT_THREAD_SUPPORT
 /**
- * @brief a thread to perform file transfer
+ * @brief Callback called to read the next part of a directory archive being
+ *        uploaded
  *
- * @param[in]      arg                 info required to transfer file
+ * @param[out]     ptr                 destination for the data to send
+ * @param[in]      size                size of each item
+ * @param[in]      nmemb               number of items requested
+ * @param[in,out]  user_data           pointer to information about the transfer
+ *
+ * @return the number of items read, CURL_READFUNC_ABORT if the archive
+ *         could not be produced
+ */
+static IOT_SECTION size_t tr50_file_archive_read(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data );
+
+/**
+ * @brief selects the next range of a segmented download to fetch: a run of
+ *        chunks that are neither received nor being fetched by another
+ *        segment
+ *
+ * @param[in]      transfer            segmented download
+ * @param[in,out]  segment             segment to fetch the range
+ *
+ * @retval IOT_FALSE                   no chunks are left to fetch
+ * @retval IOT_TRUE                    a range was selected
+ */
+static IOT_SECTION iot_bool_t tr50_file_segment_assign(
+	const struct tr50_file_transfer *transfer,
+	struct tr50_file_segment *segment );
+
+/**
+ * @brief handles the end of a request for a range of a segmented download,
+ *        moving on to the next range or ending the attempt
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in,out]  transfer            segmented download
+ * @param[in]      lib_curl            curl handle that fetched the range
+ * @param[in]      curl_result         result of the request
+ */
+static IOT_SECTION void tr50_file_segment_done(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	CURL *lib_curl,
+	CURLcode curl_result );
+
+/**
+ * @brief requests the range selected for a segment
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in]      segment             segment to fetch the range
+ *
+ * @retval IOT_STATUS_FAILURE          on failure
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static IOT_SECTION iot_status_t tr50_file_segment_request(
+	struct tr50_data *data,
+	const struct tr50_file_segment *segment );
+
+/**
+ * @brief Callback called to write a range of a segmented download at its
+ *        place in the file, recording each chunk once it is complete
+ *
+ * @param[in]      ptr                 data received
+ * @param[in]      size                size of each item
+ * @param[in]      nmemb               number of items received
+ * @param[in,out]  user_data           pointer to the segment
+ *
+ * @return the number of bytes written
+ */
+static IOT_SECTION size_t tr50_file_segment_write(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data );
+
+/**
+ * @brief starts (or retries) a segmented download: the chunks not yet
+ *        received are fetched as several ranges at once
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in,out]  transfer            segmented download
  *
- * @retval IOT_STATUS_BAD_PARAMETER    bad params
  * @retval IOT_STATUS_FAILURE          on failure
+ * @retval IOT_STATUS_FILE_OPEN_FAILED failed to open the local files
+ * @retval IOT_STATUS_NO_MEMORY        not enough memory to track chunks
  * @retval IOT_STATUS_SUCCESS          on success
  */
-static IOT_SECTION OS_THREAD_DECL tr50_file_transfer(
+static IOT_SECTION iot_status_t tr50_file_segments_start(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer );
+
+/**
+ * @brief stops the ranges of a segmented download being fetched
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in,out]  transfer            segmented download
+ */
+static IOT_SECTION void tr50_file_segments_stop(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer );
+
+/**
+ * @brief handles the end of an attempt to perform a file transfer, either
+ *        scheduling a retry or completing the transfer
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in,out]  transfer            transfer that ended
+ * @param[in]      curl_result         result of the attempt
+ */
+static IOT_SECTION void tr50_file_transfer_done(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	CURLcode curl_result );
+
+/**
+ * @brief thread performing all file transfers using a single curl multi
+ *        handle
+ *
+ * @param[in]      arg                 plug-in specific data
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    bad params
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static IOT_SECTION OS_THREAD_DECL tr50_file_transfer_engine(
 	void* arg );
 
+/**
+ * @brief completes a file transfer: checks the downloaded file, releases the
+ *        resources used and queues the result to be reported
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in,out]  transfer            transfer to complete
+ * @param[in]      result              result of the transfer
+ */
+static IOT_SECTION void tr50_file_transfer_finish(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	iot_status_t result );
+
+/**
+ * @brief obtains a curl handle for a file transfer, reusing an idle handle
+ *        if one is available
+ *
+ * @note only called from the file transfer thread
+ *
+ * @param[in,out]  data                plug-in specific data
+ *
+ * @return a curl handle sharing data with the other transfers, NULL on
+ *         failure
+ */
+static IOT_SECTION CURL *tr50_file_transfer_handle_get(
+	struct tr50_data *data );
+
+/**
+ * @brief returns a curl handle that is no longer used by a transfer, keeping
+ *        it to be reused if there is room
+ *
+ * @note only called from the file transfer thread
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in]      lib_curl            curl handle to return
+ */
+static IOT_SECTION void tr50_file_transfer_handle_release(
+	struct tr50_data *data,
+	CURL *lib_curl );
+
+/**
+ * @brief sets the options common to all requests of a file transfer
+ *        (address, certificates, proxy and progress)
+ *
+ * @param[in]      data                plug-in specific data
+ * @param[in]      transfer            file transfer
+ * @param[in,out]  lib_curl            curl handle to set up
+ */
+static IOT_SECTION void tr50_file_transfer_options(
+	const struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	CURL *lib_curl );
+
+/**
+ * @brief adjusts the speed of the transfers in progress
+ *
+ * Transfers share the maximum speed configured in proportion to their
+ * priority, through a token bucket refilled at that speed: speed not used
+ * in one period (e.g. a transfer limited by the server) is given out in the
+ * next, and bytes moved above the maximum are taken back.
+ * Background transfers are paused while one of higher priority is in
+ * progress.
+ *
+ * @note only called from the file transfer thread
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in]      changed             transfers started or ended, adjust
+ *                                     the speeds now
+ */
+static IOT_SECTION void tr50_file_transfer_schedule(
+	struct tr50_data *data,
+	iot_bool_t changed );
+
+/**
+ * @brief starts (or retries) a file transfer on the curl multi handle
+ *
+ * @param[in,out]  data                plug-in specific data
+ * @param[in,out]  transfer            transfer to start
+ *
+ * @retval IOT_STATUS_FAILURE          on failure (transfer is completed)
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static IOT_SECTION iot_status_t tr50_file_transfer_start(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer );
+
+/**
+ * @brief applies the speed and pause state of a transfer to one of its
+ *        curl handles
+ *
+ * @param[in]      transfer            file transfer
+ * @param[in,out]  lib_curl            curl handle of the transfer
+ */
+static IOT_SECTION void tr50_file_transfer_throttle(
+	const struct tr50_file_transfer *transfer,
+	CURL *lib_curl );
+
+/**
+ * @brief wakes the file transfer thread, starting it if it isn't running
+ *
+ * @param[in,out]  data                plug-in specific data
+ *
+ * @retval IOT_STATUS_FAILURE          failed to start the thread
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static IOT_SECTION iot_status_t tr50_file_transfer_wakeup(
+	struct tr50_data *data );
+
 /**
  * @brief Callback called for progress updates (and to cancel transfers)
  *
@@ -472,16 +985,77 @@ static IOT_SECTION int tr50_file_progress_old(
 	void *user_data,
 	double down_total, double down_now,
 	double up_total, double up_now );
+
+/**
+ * @brief Callback called to read the data of a file being uploaded
+ *
+ * @param[out]     ptr                 destination for the data to send
+ * @param[in]      size                size of each item
+ * @param[in]      nmemb               number of items requested
+ * @param[in,out]  user_data           pointer to information about the transfer
+ *
+ * @return the number of items read
+ */
+static IOT_SECTION size_t tr50_file_read(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data );
+
+/**
+ * @brief Callback called to write downloaded data, updating the checksum of
+ *        the file as it is written
+ *
+ * @param[in]      ptr                 data received
+ * @param[in]      size                size of each item
+ * @param[in]      nmemb               number of items received
+ * @param[in,out]  user_data           pointer to information about the transfer
+ *
+ * @return the number of items written
+ */
+static IOT_SECTION size_t tr50_file_write(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 /**
- * @brief checks file transfer queue and execute those which need retrying
+ * @brief reports the result of completed file transfers and removes them
+ *        from the file transfer queue
  *
  * @param[in]      data                plug-in specific data
  */
 static IOT_SECTION void tr50_file_queue_check(
 	struct tr50_data *data );
 
+/**
+ * @brief allocates a file transfer, its strings are stored (with their
+ *        exact size) in the same block of memory
+ *
+ * @param[in]      name                cloud's file name
+ * @param[in]      path                local file path
+ * @param[in]      op                  file operation (get/put)
+ *
+ * @return the file transfer, NULL if not enough memory
+ *
+ * @see tr50_file_transfer_free
+ */
+static IOT_SECTION struct tr50_file_transfer *tr50_file_transfer_alloc(
+	const char *name,
+	const char *path,
+	iot_operation_t op );
+
+/**
+ * @brief frees a file transfer
+ *
+ * @param[in]      transfer            file transfer to free
+ *
+ * @see tr50_file_transfer_alloc
+ */
+static IOT_SECTION void tr50_file_transfer_free(
+	struct tr50_file_transfer *transfer );
+
 /**
  * @brief plug-in function called to initialize the plug-in
  *
@@ -655,45 +1229,222 @@ static void tr50_transaction_status_set(
 	enum tr50_transaction_status tx_status );
 
 
-iot_status_t tr50_action_complete(
+iot_status_t tr50_action_ack_flush(
 	struct tr50_data *data,
-	const iot_action_t *UNUSED(action),
-	const iot_action_request_t *request,
-	const iot_transaction_t *txn,
-	const iot_options_t *UNUSED(options) )
+	iot_bool_t force )
 {
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
 	if ( data )
 	{
-		const char *source = iot_action_request_source( request );
+		result = IOT_STATUS_SUCCESS;
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_lock( &data->ack_mutex );
+#endif /* IOT_THREAD_SUPPORT */
+		if ( data->ack_count > 0u && ( force != IOT_FALSE ||
+			data->ack_count >= TR50_ACK_BATCH_MAX ||
+			iot_timestamp_now() - data->ack_time >= data->ack_delay ) )
+			result = tr50_action_ack_send( data );
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_unlock( &data->ack_mutex );
+#endif /* IOT_THREAD_SUPPORT */
+	}
+	return result;
+}
+
+iot_status_t tr50_action_ack_queue(
+	struct tr50_data *data,
+	const char *cmd,
+	const iot_transaction_t *txn )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( data && cmd )
+	{
+		char key[11u];
+		size_t entry_len;
+#ifdef IOT_THREAD_SUPPORT
+		iot_bool_t timer_wake = IOT_FALSE;
+#endif /* IOT_THREAD_SUPPORT */
+
+		/* each command in a message requires a unique key */
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_lock( &data->ack_mutex );
+#endif /* IOT_THREAD_SUPPORT */
+		if ( txn )
+			os_snprintf( key, sizeof(key), "%u", (unsigned int)(*txn) );
+		else
+			os_snprintf( key, sizeof(key), "ack%u",
+				(unsigned int)data->ack_count );
+
+		/* entry: {"<key>":<cmd> or ,"<key>":<cmd> (+ closing brace) */
+		entry_len = os_strlen( key ) + os_strlen( cmd ) + 5u;
 
+		/* send the batch first if this entry does not fit */
 		result = IOT_STATUS_SUCCESS;
-		if ( source && os_strncmp( source, "tr50", 4 ) == 0 )
+		if ( data->ack_count > 0u && ( data->ack_len + entry_len >
+			TR50_ACK_BATCH_BUFFER_SIZE ||
+			data->ack_count >= TR50_ACK_BATCH_MAX ||
+			data->ack_txn_count >= TR50_ACK_BATCH_MAX ) )
+			result = tr50_action_ack_send( data );
+
+		if ( entry_len > TR50_ACK_BATCH_BUFFER_SIZE )
 		{
-			const char *req_id;
-			result = iot_action_request_option_get(
-				request, "id", IOT_FALSE, IOT_TYPE_STRING, &req_id );
-			if ( data && result == IOT_STATUS_SUCCESS && req_id && *req_id )
+			IOT_LOG( data->lib, IOT_LOG_ERROR, "tr50: %s",
+				"action acknowledgement too large to send" );
+			result = IOT_STATUS_FULL;
+		}
+		else
+		{
+			/* key may have changed if the batch was sent */
+			if ( !txn )
+				os_snprintf( key, sizeof(key), "ack%u",
+					(unsigned int)data->ack_count );
+			if ( data->ack_count == 0u )
 			{
-				char buf[ 512u ];
-				iot_json_encoder_t *json;
-				json = iot_json_encode_initialize( buf, 512u, 0 );
-				result = IOT_STATUS_NO_MEMORY;
-				if ( json )
+				data->ack_time = iot_timestamp_now();
+#ifdef IOT_THREAD_SUPPORT
+				/* have the timer wait for this batch */
+				if ( data->ack_running == IOT_FALSE )
 				{
-					char id[11u];
-					const char *msg = NULL;
-					iot_status_t status;
-					iot_action_request_parameter_iterator_t  iter;
+					size_t stack_size = 0u;
+#if defined( __VXWORKS__ )
+					stack_size = deviceCloudStackSizeGet();
+#endif /* if defined( __VXWORKS__ ) */
+					data->ack_running = IOT_TRUE;
+					if ( os_thread_create( &data->ack_thread,
+						tr50_action_ack_timer, data,
+						stack_size ) != 0 )
+					{
+						IOT_LOG( data->lib, IOT_LOG_WARNING,
+							"tr50: %s", "Failed to create "
+							"the acknowledgement thread" );
+						data->ack_running = IOT_FALSE;
+					}
+				}
+				else
+					timer_wake = IOT_TRUE;
+#endif /* IOT_THREAD_SUPPORT */
+			}
+			data->ack_len += (size_t)os_snprintf(
+				&data->ack_buf[data->ack_len],
+				TR50_ACK_BATCH_BUFFER_SIZE + 1u - data->ack_len,
+				"%c\"%s\":%s",
+				( data->ack_count == 0u ? '{' : ',' ), key, cmd );
+			if ( txn )
+				data->ack_txn[data->ack_txn_count++] = *txn;
+			++data->ack_count;
+		}
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_unlock( &data->ack_mutex );
+		/* signalling takes the lock */
+		if ( timer_wake != IOT_FALSE )
+			os_thread_condition_signal( &data->ack_signal,
+				&data->ack_mutex );
+#endif /* IOT_THREAD_SUPPORT */
 
-					if ( txn )
-						os_snprintf( id, sizeof(id), "%u", (unsigned int)(*txn) );
-					else
-						os_snprintf( id, sizeof(id), "cmd" );
+		/* send now if the batch is full or delay has expired */
+		if ( result == IOT_STATUS_SUCCESS )
+			result = tr50_action_ack_flush( data, IOT_FALSE );
+	}
+	return result;
+}
+
+iot_status_t tr50_action_ack_send(
+	struct tr50_data *data )
+{
+	iot_status_t result;
+	iot_uint8_t i;
+
+	/* close the multi-command message */
+	data->ack_buf[data->ack_len++] = '}';
+	data->ack_buf[data->ack_len] = '\0';
+
+	/* the mqtt message callback never takes the acknowledgement lock,
+	 * so it is safe to publish while holding it */
+	result = tr50_mqtt_publish( data, "api", data->ack_buf,
+		data->ack_len, NULL );
+
+	/* on success, the reply from the cloud sets the status (it may
+	 * already have) */
+	if ( result != IOT_STATUS_SUCCESS )
+		for ( i = 0u; i < data->ack_txn_count; ++i )
+			tr50_transaction_status_set( data,
+				(iot_uint8_t)data->ack_txn[i],
+				TR50_TRANSACTION_FAILURE );
+
+	data->ack_count = 0u;
+	data->ack_len = 0u;
+	data->ack_txn_count = 0u;
+	return result;
+}
+
+#ifdef IOT_THREAD_SUPPORT
+OS_THREAD_DECL tr50_action_ack_timer(
+	void *arg )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	struct tr50_data *const data = (struct tr50_data *)arg;
+	if ( data )
+	{
+		result = IOT_STATUS_SUCCESS;
+		os_thread_mutex_lock( &data->ack_mutex );
+		while ( data->ack_running != IOT_FALSE )
+		{
+			if ( data->ack_count == 0u )
+				os_thread_condition_wait( &data->ack_signal,
+					&data->ack_mutex );
+			else
+			{
+				const iot_timestamp_t elapsed =
+					iot_timestamp_now() - data->ack_time;
+				if ( elapsed >= data->ack_delay )
+					tr50_action_ack_send( data );
+				else
+					os_thread_condition_timed_wait(
+						&data->ack_signal,
+						&data->ack_mutex,
+						(os_millisecond_t)(
+						data->ack_delay - elapsed ) );
+			}
+		}
+		os_thread_mutex_unlock( &data->ack_mutex );
+	}
+	return (OS_THREAD_RETURN)result;
+}
+#endif /* IOT_THREAD_SUPPORT */
+
+iot_status_t tr50_action_complete(
+	struct tr50_data *data,
+	const iot_action_t *UNUSED(action),
+	const iot_action_request_t *request,
+	const iot_transaction_t *txn,
+	const iot_options_t *UNUSED(options) )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( data )
+	{
+		const char *source = iot_action_request_source( request );
+
+		result = IOT_STATUS_SUCCESS;
+		if ( source && os_strncmp( source, "tr50", 4 ) == 0 )
+		{
+			const char *req_id;
+			result = iot_action_request_option_get(
+				request, "id", IOT_FALSE, IOT_TYPE_STRING, &req_id );
+			if ( data && result == IOT_STATUS_SUCCESS && req_id && *req_id )
+			{
+				char buf[ 512u ];
+				iot_json_encoder_t *json;
+				json = iot_json_encode_initialize( buf, 512u, 0 );
+				result = IOT_STATUS_NO_MEMORY;
+				if ( json )
+				{
+					const char *msg = NULL;
+					iot_status_t status;
+					iot_action_request_parameter_iterator_t  iter;
 
 					status = iot_action_request_status( request, &msg );
 
-					iot_json_encode_object_start( json, id );
+					/* command key is added when batched */
 					iot_json_encode_string( json, "command", "mailbox.ack" );
 					iot_json_encode_object_start( json, "params" );
 					iot_json_encode_string( json, "id", req_id );
@@ -797,16 +1548,10 @@ iot_status_t tr50_action_complete(
 						iot_json_encode_object_end( json );
 					}
 
-					iot_json_encode_object_end( json );
 					iot_json_encode_object_end( json );
 
 					msg = iot_json_encode_dump( json );
-					result = tr50_mqtt_publish(
-						data,
-						"api",
-						msg,
-						os_strlen( msg ),
-						txn );
+					result = tr50_action_ack_queue( data, msg, txn );
 					iot_json_encode_terminate( json );
 				}
 			}
@@ -934,6 +1679,12 @@ void tr50_append_value_raw(
 		}
 	}
 
+#ifndef IOT_STACK_ONLY
+	/* values may be large, allocate for them in one step */
+	iot_json_encode_reserve( json,
+		iot_json_encode_estimate( json, key, (const char *)value, 0u ) );
+#endif /* ifndef IOT_STACK_ONLY */
+
 	/* write raw or string data */
 	iot_json_encode_string( json, key, (const char *)value );
 
@@ -965,6 +1716,16 @@ iot_status_t tr50_attribute_publish(
 			char id[11u];
 			const char *msg;
 
+#ifndef IOT_STACK_ONLY
+			/* size the output for the whole message up front */
+			iot_json_encode_reserve( json, TR50_ENVELOPE_SIZE +
+				iot_json_encode_estimate( json, "thingKey",
+					data->thing_key, 0u ) +
+				iot_json_encode_estimate( json, "key", key, 0u ) +
+				iot_json_encode_estimate( json, "value",
+					value, 0u ) );
+#endif /* ifndef IOT_STACK_ONLY */
+
 			if ( txn )
 				os_snprintf( id, sizeof(id), "%u", (unsigned int)(*txn) );
 			else
@@ -1085,6 +1846,8 @@ iot_status_t tr50_connect(
 		const char *proxy_type = NULL;
 		char fail_reason[128u] = { '\0' };
 		iot_int64_t port = 0;
+		iot_int64_t ack_delay = TR50_ACK_DELAY_MS;
+		iot_int64_t transfer_limit = 0;
 		iot_mqtt_ssl_t ssl_conf;
 		iot_mqtt_proxy_t proxy_conf;
 		iot_mqtt_proxy_t *proxy_conf_p = NULL;
@@ -1102,6 +1865,27 @@ iot_status_t tr50_connect(
 			ca_bundle = IOT_DEFAULT_CERT_PATH;
 		iot_config_get( lib, "validate_cloud_cert", IOT_FALSE,
 			IOT_TYPE_BOOL, &validate_cert );
+		iot_config_get( lib, "action_ack_delay", IOT_FALSE,
+			IOT_TYPE_INT64, &ack_delay );
+		if ( ack_delay < 0 )
+			ack_delay = 0;
+		data->ack_delay = (iot_millisecond_t)ack_delay;
+		if ( iot_config_get( lib, "file_transfer_backlog", IOT_FALSE,
+			IOT_TYPE_INT64, &transfer_limit ) == IOT_STATUS_SUCCESS &&
+			transfer_limit > 0 )
+			data->file_transfer_backlog = (unsigned int)transfer_limit;
+#ifdef IOT_THREAD_SUPPORT
+		transfer_limit = 0;
+		if ( iot_config_get( lib, "file_transfer_max", IOT_FALSE,
+			IOT_TYPE_INT64, &transfer_limit ) == IOT_STATUS_SUCCESS &&
+			transfer_limit > 0 )
+			data->transfer_active_max = (unsigned int)transfer_limit;
+		data->transfer_max_speed = 0;
+		iot_config_get( lib, "file_transfer_max_speed", IOT_FALSE,
+			IOT_TYPE_INT64, &data->transfer_max_speed );
+		if ( data->transfer_max_speed < 0 )
+			data->transfer_max_speed = 0;
+#endif /* ifdef IOT_THREAD_SUPPORT */
 
 		os_memzero( &ssl_conf, sizeof( iot_mqtt_ssl_t ) );
 		ssl_conf.ca_path = ca_bundle;
@@ -1248,6 +2032,7 @@ iot_status_t tr50_disconnect(
 	if ( data )
 	{
 		data->reconnect_count = 0u; /* don't reconnect */
+		tr50_action_ack_flush( data, IOT_TRUE );
 		result = iot_mqtt_disconnect( data->mqtt );
 	}
 	return result;
@@ -1399,6 +2184,7 @@ iot_status_t tr50_execute(
 				if ( data )
 					iot_mqtt_loop( data->mqtt, max_time_out );
 				tr50_ping( lib, data, txn, max_time_out );
+				tr50_action_ack_flush( data, IOT_FALSE );
 				tr50_file_queue_check( data );
 				break;
 			case IOT_OPERATION_ACTION_CHECK:
@@ -1452,25 +2238,72 @@ iot_status_t tr50_file_request_send(
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
 	if ( data && file_transfer )
 	{
-		result = IOT_STATUS_FULL;
-		if ( data->file_transfer_count < TR50_FILE_TRANSFER_MAX )
+		struct tr50_file_transfer **link;
+		struct tr50_file_transfer *transfer =
+			tr50_file_transfer_alloc( file_transfer->name,
+				file_transfer->path, op );
+
+		/* add the transfer to the end of the queue, if there is room */
+		result = IOT_STATUS_NO_MEMORY;
+		if ( transfer )
+		{
+#ifdef IOT_THREAD_SUPPORT
+			os_thread_mutex_lock( &data->transfer_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+			result = IOT_STATUS_FULL;
+			if ( data->file_transfer_count <
+				data->file_transfer_backlog )
+			{
+				transfer->id = TR50_FILE_REQUEST_ID_OFFSET +
+					data->file_transfer_id %
+					TR50_FILE_REQUEST_ID_COUNT;
+				transfer->state = TR50_FILE_TRANSFER_REQUESTED;
+				++data->file_transfer_id;
+				for ( link = &data->file_transfer_queue; *link;
+					link = &(*link)->next );
+				*link = transfer;
+				++data->file_transfer_count;
+				result = IOT_STATUS_SUCCESS;
+			}
+#ifdef IOT_THREAD_SUPPORT
+			os_thread_mutex_unlock( &data->transfer_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+			if ( result != IOT_STATUS_SUCCESS )
+			{
+				tr50_file_transfer_free( transfer );
+				transfer = NULL;
+			}
+		}
+
+		if ( transfer )
 		{
 			char buf[ 512u ];
 			const char *msg;
-			struct tr50_file_transfer transfer;
+			iot_int64_t priority = TR50_FILE_PRIORITY_NORMAL;
 
 			iot_json_encoder_t *json =
 				iot_json_encode_initialize( buf, sizeof( buf ), 0u);
 
-			os_memzero( &transfer, sizeof( struct tr50_file_transfer ) );
-			os_strncpy( transfer.name, file_transfer->name, PATH_MAX );
-			os_strncpy( transfer.path, file_transfer->path, PATH_MAX );
-			transfer.callback = file_transfer->callback;
-			transfer.user_data = file_transfer->user_data;
-			transfer.op = op;
-			transfer.use_global_store = IOT_FALSE;
+			transfer->archive = file_transfer->archive;
+			transfer->callback = file_transfer->callback;
+			transfer->user_data = file_transfer->user_data;
+			transfer->plugin_data = (void*)data;
+			transfer->use_global_store = IOT_FALSE;
 			iot_options_get_bool( options, "global", IOT_FALSE,
-				&transfer.use_global_store );
+				&transfer->use_global_store );
+			transfer->sequential = IOT_FALSE;
+			iot_options_get_bool( options, "sequential", IOT_FALSE,
+				&transfer->sequential );
+			transfer->priority = TR50_FILE_PRIORITY_NORMAL;
+			if ( iot_options_get_integer( options, "priority", IOT_TRUE,
+				&priority ) == IOT_STATUS_SUCCESS )
+			{
+				if ( priority < TR50_FILE_PRIORITY_LOW )
+					priority = TR50_FILE_PRIORITY_LOW;
+				if ( priority > TR50_FILE_PRIORITY_HIGH )
+					priority = TR50_FILE_PRIORITY_HIGH;
+				transfer->priority = (iot_uint8_t)priority;
+			}
 
 			result = IOT_STATUS_FAILURE;
 			if ( json )
@@ -1478,14 +2311,13 @@ iot_status_t tr50_file_request_send(
 				char id[11u];
 				char global_name[PATH_MAX];
 
-				/* create json string request for file.get/file.put */
-				os_snprintf( id, sizeof(id), "%u",
-					(data->file_transfer_count +
-					TR50_FILE_REQUEST_ID_OFFSET) );
+				/* create json string request for file.get/file.put,
+				 * the id identifies the transfer in the queue */
+				os_snprintf( id, sizeof(id), "%u", transfer->id );
 
 				iot_json_encode_object_start( json, id );
 				iot_json_encode_string( json, "command",
-					(transfer.op == IOT_OPERATION_FILE_UPLOAD)?
+					(transfer->op == IOT_OPERATION_FILE_UPLOAD)?
 						"file.put" : "file.get" );
 
 				iot_json_encode_object_start( json, "params" );
@@ -1493,376 +2325,1307 @@ iot_status_t tr50_file_request_send(
 				/* Use the global file store if true */
 
 				iot_json_encode_bool( json, "global",
-					transfer.use_global_store);
+					transfer->use_global_store);
 
 				/* prepend a thing key if this is
 				 * global, but strip any path information in the file.  It is not
 				 * valid to upload a file with a path name */
-				if ( transfer.op == IOT_OPERATION_FILE_UPLOAD &&
-					transfer.use_global_store == IOT_TRUE )
+				if ( transfer->op == IOT_OPERATION_FILE_UPLOAD &&
+					transfer->use_global_store == IOT_TRUE )
 				{
 					os_snprintf( global_name, PATH_MAX,
-						"%s_%s", data->thing_key, transfer.name);
+						"%s_%s", data->thing_key, transfer->name);
 					iot_json_encode_string( json, "fileName", global_name );
 				}
 				else
-					iot_json_encode_string( json, "fileName", transfer.name );
+					iot_json_encode_string( json, "fileName", transfer->name );
 
 				iot_json_encode_string( json, "thingKey", data->thing_key );
 
-				if ( transfer.op == IOT_OPERATION_FILE_UPLOAD )
+				if ( transfer->op == IOT_OPERATION_FILE_UPLOAD )
 					iot_json_encode_bool( json, "public", IOT_FALSE );
 
-				iot_json_encode_object_end( json );
-				iot_json_encode_object_end( json );
+				iot_json_encode_object_end( json );
+				iot_json_encode_object_end( json );
+
+				msg = iot_json_encode_dump( json );
+
+				/* publish */
+				result = iot_mqtt_publish( data->mqtt, "api",
+					msg, os_strlen( msg ), TR50_MQTT_QOS,
+					IOT_FALSE, NULL );
+				if ( result != IOT_STATUS_SUCCESS )
+					IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
+						"Failed send file request" );
+
+				iot_json_encode_terminate( json );
+			}
+			else
+				IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
+					"Failed to encode json" );
+
+			/* remove the transfer if the request wasn't sent */
+			if ( result != IOT_STATUS_SUCCESS )
+			{
+#ifdef IOT_THREAD_SUPPORT
+				os_thread_mutex_lock( &data->transfer_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+				for ( link = &data->file_transfer_queue;
+					*link != transfer; link = &(*link)->next );
+				*link = transfer->next;
+				--data->file_transfer_count;
+#ifdef IOT_THREAD_SUPPORT
+				os_thread_mutex_unlock( &data->transfer_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+				tr50_file_transfer_free( transfer );
+			}
+		}
+		else if ( result == IOT_STATUS_FULL )
+			IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
+				"Maximum file transfer reached" );
+		else
+			IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
+				"Failed to allocate file transfer" );
+	}
+	return result;
+}
+
+#ifdef IOT_THREAD_SUPPORT
+size_t tr50_file_archive_read(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data )
+{
+	struct tr50_file_transfer *const transfer =
+		(struct tr50_file_transfer *)user_data;
+	size_t result = iot_archive_stream_read( ptr, size, nmemb,
+		transfer->archive_stream );
+
+	/* an archive that failed must not be sent as if it was complete */
+	transfer->bytes += size * result;
+	if ( result == 0u && iot_archive_stream_progress(
+		transfer->archive_stream, NULL, NULL ) != IOT_STATUS_SUCCESS )
+		result = CURL_READFUNC_ABORT;
+	return result;
+}
+
+iot_bool_t tr50_file_segment_assign(
+	const struct tr50_file_transfer *transfer,
+	struct tr50_file_segment *segment )
+{
+	iot_bool_t result = IOT_FALSE;
+	iot_bool_t run_end = IOT_FALSE;
+	iot_uint64_t chunk;
+
+	for ( chunk = 0u; chunk < transfer->chunk_count &&
+		run_end == IOT_FALSE; ++chunk )
+	{
+		iot_bool_t available = IOT_TRUE;
+		iot_uint8_t i;
+
+		if ( transfer->chunk_map[chunk / 8u] & ( 1u << ( chunk % 8u ) ) )
+			available = IOT_FALSE;
+		for ( i = 0u; available != IOT_FALSE &&
+			i < transfer->segment_count; ++i )
+		{
+			const struct tr50_file_segment *const other =
+				&transfer->segment[i];
+			if ( other != segment && other->lib_curl &&
+				chunk >= other->chunk && chunk < other->chunk_end )
+				available = IOT_FALSE;
+		}
+
+		if ( available != IOT_FALSE && result == IOT_FALSE )
+		{
+			segment->chunk = chunk;
+			segment->chunk_end = chunk + 1u;
+			result = IOT_TRUE;
+		}
+		else if ( available != IOT_FALSE &&
+			segment->chunk_end - segment->chunk < transfer->chunk_span )
+			segment->chunk_end = chunk + 1u;
+		else if ( result != IOT_FALSE )
+			run_end = IOT_TRUE;
+	}
+
+	if ( result != IOT_FALSE )
+	{
+		segment->offset = segment->chunk * TR50_FILE_SEGMENT_CHUNK_SIZE;
+		segment->end = segment->chunk_end * TR50_FILE_SEGMENT_CHUNK_SIZE;
+		if ( segment->end > transfer->size )
+			segment->end = transfer->size;
+	}
+	return result;
+}
+
+void tr50_file_segment_done(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	CURL *lib_curl,
+	CURLcode curl_result )
+{
+	struct tr50_file_segment *segment = NULL;
+	iot_uint8_t i;
+
+	curl_multi_remove_handle( data->transfer_multi, lib_curl );
+	for ( i = 0u; i < transfer->segment_count; ++i )
+		if ( transfer->segment[i].lib_curl == lib_curl )
+			segment = &transfer->segment[i];
+
+	/* a range that ended early is retried like any other failure */
+	if ( !segment )
+		curl_result = CURLE_FAILED_INIT;
+	else if ( curl_result == CURLE_OK && segment->offset != segment->end )
+		curl_result = CURLE_PARTIAL_FILE;
+
+	if ( segment && curl_result == CURLE_OK )
+	{
+		/* move on to the next range, reusing the connection */
+		if ( tr50_file_segment_assign( transfer, segment ) == IOT_FALSE )
+		{
+			tr50_file_transfer_handle_release( data, lib_curl );
+			segment->lib_curl = NULL;
+		}
+		else if ( tr50_file_segment_request( data, segment ) !=
+			IOT_STATUS_SUCCESS )
+			curl_result = CURLE_FAILED_INIT;
+	}
+
+	if ( curl_result != CURLE_OK )
+	{
+		tr50_file_segments_stop( data, transfer );
+		if ( transfer->segment_fallback != IOT_FALSE )
+		{
+			/* the server ignored the range: start again as a single
+			 * stream, what was written can't be resumed from */
+			char map_path[ PATH_MAX + 1u ];
+
+			IOT_LOG( data->lib, IOT_LOG_WARNING,
+				"Ranges not supported, downloading %s as a "
+				"single stream", transfer->path );
+			os_snprintf( map_path, PATH_MAX, "%s%s",
+				transfer->file_path, TR50_DOWNLOAD_MAP_EXTENSION );
+			os_file_close( transfer->chunk_map_handle );
+			transfer->chunk_map_handle = NULL;
+			os_file_close( transfer->file_handle );
+			transfer->file_handle = NULL;
+			os_free( transfer->chunk_map );
+			transfer->chunk_map = NULL;
+			os_file_delete( map_path );
+			os_file_delete( transfer->file_path );
+			transfer->segment_count = 0u;
+
+			os_thread_mutex_lock( &data->transfer_mutex );
+			transfer->retry_time = 0u;
+			transfer->state = TR50_FILE_TRANSFER_PENDING;
+			os_thread_mutex_unlock( &data->transfer_mutex );
+		}
+		else
+			tr50_file_transfer_done( data, transfer, curl_result );
+	}
+	else
+	{
+		/* all chunks are received once no range is being fetched */
+		iot_bool_t active = IOT_FALSE;
+		for ( i = 0u; i < transfer->segment_count; ++i )
+			if ( transfer->segment[i].lib_curl )
+				active = IOT_TRUE;
+		if ( active == IOT_FALSE )
+			tr50_file_transfer_finish( data, transfer,
+				IOT_STATUS_SUCCESS );
+	}
+}
+
+iot_status_t tr50_file_segment_request(
+	struct tr50_data *data,
+	const struct tr50_file_segment *segment )
+{
+	iot_status_t result = IOT_STATUS_FAILURE;
+	char range[ 48u ];
+
+	os_snprintf( range, sizeof( range ), "%llu-%llu",
+		(unsigned long long)segment->offset,
+		(unsigned long long)( segment->end - 1u ) );
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+	curl_easy_setopt( segment->lib_curl, CURLOPT_RANGE, range );
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+	tr50_file_transfer_throttle( segment->transfer, segment->lib_curl );
+	if ( curl_multi_add_handle( data->transfer_multi,
+		segment->lib_curl ) == CURLM_OK )
+		result = IOT_STATUS_SUCCESS;
+	return result;
+}
+
+size_t tr50_file_segment_write(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data )
+{
+	struct tr50_file_segment *const segment =
+		(struct tr50_file_segment *)user_data;
+	struct tr50_file_transfer *const transfer = segment->transfer;
+	const size_t len = size * nmemb;
+	long response_code = 0;
+	size_t result = 0u;
+
+	/* a server ignoring the range sends the whole file instead */
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+	curl_easy_getinfo( segment->lib_curl, CURLINFO_RESPONSE_CODE,
+		&response_code );
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+	if ( response_code != 206 )
+		transfer->segment_fallback = IOT_TRUE;
+	else if ( len <= segment->end - segment->offset &&
+		os_file_seek( transfer->file_handle, (long)segment->offset,
+			OS_FILE_SEEK_START ) == 0 )
+	{
+		result = os_file_write( ptr, 1u, len, transfer->file_handle );
+		segment->offset += result;
+		transfer->segment_bytes += result;
+		transfer->bytes += result;
+	}
+
+	/* record each chunk once all of it is in the file */
+	while ( segment->chunk < segment->chunk_end &&
+		( segment->offset == segment->end ||
+		  segment->offset >= ( segment->chunk + 1u ) *
+			TR50_FILE_SEGMENT_CHUNK_SIZE ) )
+	{
+		unsigned char *const map_byte =
+			&transfer->chunk_map[segment->chunk / 8u];
+
+		*map_byte |= (unsigned char)( 1u << ( segment->chunk % 8u ) );
+
+		/* the chunk must be on disk before the map claims it, in
+		 * case power is lost */
+		os_flush( transfer->file_handle );
+		os_file_sync( transfer->file_path );
+		if ( os_file_seek( transfer->chunk_map_handle,
+			(long)( TR50_DOWNLOAD_MAP_HEADER_SIZE + segment->chunk / 8u ),
+			OS_FILE_SEEK_START ) == 0 )
+		{
+			os_file_write( map_byte, 1u, 1u,
+				transfer->chunk_map_handle );
+			os_flush( transfer->chunk_map_handle );
+		}
+		++segment->chunk;
+	}
+	return result;
+}
+
+iot_status_t tr50_file_segments_start(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	iot_uint8_t i;
+
+	/* first attempt: open the file and load the chunks received before */
+	if ( !transfer->chunk_map )
+	{
+		char map_path[ PATH_MAX + 1u ];
+		unsigned char header[ TR50_DOWNLOAD_MAP_HEADER_SIZE ];
+		unsigned char saved[ TR50_DOWNLOAD_MAP_HEADER_SIZE ];
+		iot_bool_t resume = IOT_FALSE;
+		size_t map_len;
+
+		/* the header identifies the file the chunks belong to */
+		os_memzero( header, sizeof( header ) );
+		os_memcpy( header, TR50_DOWNLOAD_MAP_MAGIC, 8u );
+		for ( i = 0u; i < 8u; ++i )
+			header[8u + i] =
+				(unsigned char)( transfer->size >> ( i * 8u ) );
+		for ( i = 0u; i < 4u; ++i )
+		{
+			header[16u + i] =
+				(unsigned char)( transfer->crc32 >> ( i * 8u ) );
+			header[20u + i] = (unsigned char)(
+				TR50_FILE_SEGMENT_CHUNK_SIZE >> ( i * 8u ) );
+		}
+
+		transfer->chunk_count = ( transfer->size +
+			TR50_FILE_SEGMENT_CHUNK_SIZE - 1u ) /
+			TR50_FILE_SEGMENT_CHUNK_SIZE;
+		map_len = (size_t)( ( transfer->chunk_count + 7u ) / 8u );
+		os_snprintf( map_path, PATH_MAX, "%s%s",
+			transfer->file_path, TR50_DOWNLOAD_MAP_EXTENSION );
+
+		result = IOT_STATUS_NO_MEMORY;
+		transfer->chunk_map = (unsigned char *)os_malloc( map_len );
+		if ( transfer->chunk_map )
+		{
+			if ( os_file_exists( transfer->file_path ) &&
+				os_file_exists( map_path ) )
+				transfer->chunk_map_handle =
+					os_file_open( map_path, OS_READ_WRITE );
+			if ( transfer->chunk_map_handle &&
+				os_file_read( saved, 1u, sizeof( saved ),
+					transfer->chunk_map_handle ) == sizeof( saved ) &&
+				os_memcmp( saved, header, sizeof( header ) ) == 0 &&
+				os_file_read( transfer->chunk_map, 1u, map_len,
+					transfer->chunk_map_handle ) == map_len )
+				resume = IOT_TRUE;
+			else
+			{
+				/* nothing to resume from, or the chunks recorded
+				 * are of a different file */
+				if ( transfer->chunk_map_handle )
+					os_file_close( transfer->chunk_map_handle );
+				os_memzero( transfer->chunk_map, map_len );
+				transfer->chunk_map_handle = os_file_open( map_path,
+					OS_READ_WRITE | OS_CREATE );
+				if ( transfer->chunk_map_handle )
+				{
+					os_file_write( header, 1u, sizeof( header ),
+						transfer->chunk_map_handle );
+					os_file_write( transfer->chunk_map, 1u, map_len,
+						transfer->chunk_map_handle );
+					os_flush( transfer->chunk_map_handle );
+				}
+			}
+
+			transfer->file_handle = os_file_open( transfer->file_path,
+				OS_READ_WRITE |
+				( ( resume != IOT_FALSE ) ? 0 : OS_CREATE ) );
+			result = IOT_STATUS_FILE_OPEN_FAILED;
+			if ( transfer->file_handle && transfer->chunk_map_handle )
+			{
+				/* reserve the space for the whole file up front */
+				const unsigned char last = 0u;
+				if ( resume == IOT_FALSE && os_file_seek(
+					transfer->file_handle,
+					(long)( transfer->size - 1u ),
+					OS_FILE_SEEK_START ) == 0 )
+					os_file_write( &last, 1u, 1u,
+						transfer->file_handle );
+				IOT_LOG( data->lib, IOT_LOG_DEBUG,
+					"Downloading %s as %u ranges%s",
+					transfer->path,
+					(unsigned int)transfer->segment_count,
+					( resume != IOT_FALSE ) ? " (resumed)" : "" );
+				result = IOT_STATUS_SUCCESS;
+			}
+			else
+				IOT_LOG( data->lib, IOT_LOG_ERROR,
+					"Failed to open %s", transfer->file_path );
+		}
+	}
+
+	if ( result == IOT_STATUS_SUCCESS )
+	{
+		iot_uint64_t chunk;
+		iot_uint64_t missing = 0u;
+		iot_uint64_t received = 0u;
+
+		for ( chunk = 0u; chunk < transfer->chunk_count; ++chunk )
+		{
+			if ( transfer->chunk_map[chunk / 8u] &
+				( 1u << ( chunk % 8u ) ) )
+			{
+				iot_uint64_t chunk_len = transfer->size -
+					chunk * TR50_FILE_SEGMENT_CHUNK_SIZE;
+				if ( chunk_len > TR50_FILE_SEGMENT_CHUNK_SIZE )
+					chunk_len = TR50_FILE_SEGMENT_CHUNK_SIZE;
+				received += chunk_len;
+			}
+			else
+				++missing;
+		}
+
+		/* split what is missing evenly between the segments */
+		transfer->prev_byte = (long)received;
+		transfer->segment_bytes = 0u;
+		transfer->chunk_span = ( missing + transfer->segment_count - 1u ) /
+			transfer->segment_count;
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+		for ( i = 0u; i < transfer->segment_count &&
+			result == IOT_STATUS_SUCCESS; ++i )
+		{
+			struct tr50_file_segment *const segment =
+				&transfer->segment[i];
+			segment->transfer = transfer;
+			if ( tr50_file_segment_assign( transfer, segment ) !=
+				IOT_FALSE )
+			{
+				result = IOT_STATUS_FAILURE;
+				segment->lib_curl =
+					tr50_file_transfer_handle_get( data );
+				if ( segment->lib_curl )
+				{
+					tr50_file_transfer_options( data, transfer,
+						segment->lib_curl );
+					/* ranges are of the file as stored */
+					curl_easy_setopt( segment->lib_curl,
+						CURLOPT_ACCEPT_ENCODING, NULL );
+					curl_easy_setopt( segment->lib_curl,
+						CURLOPT_WRITEFUNCTION,
+						tr50_file_segment_write );
+					curl_easy_setopt( segment->lib_curl,
+						CURLOPT_WRITEDATA, segment );
+					curl_easy_setopt( segment->lib_curl,
+						CURLOPT_PRIVATE, transfer );
+					curl_easy_setopt( segment->lib_curl,
+						CURLOPT_LOW_SPEED_LIMIT,
+						IOT_TRANSFER_LOW_SPEED_LIMIT );
+					curl_easy_setopt( segment->lib_curl,
+						CURLOPT_LOW_SPEED_TIME,
+						IOT_TRANSFER_LOW_SPEED_TIMEOUT );
+					if ( transfer->retry > 0 )
+					{
+						curl_easy_setopt( segment->lib_curl,
+							CURLOPT_FRESH_CONNECT, 1L );
+						curl_easy_setopt( segment->lib_curl,
+							CURLOPT_DNS_CACHE_TIMEOUT, 0L );
+					}
+					result = tr50_file_segment_request( data,
+						segment );
+				}
+			}
+		}
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+
+		/* every chunk was received in an earlier attempt */
+		if ( result == IOT_STATUS_SUCCESS && missing == 0u )
+			tr50_file_transfer_finish( data, transfer,
+				IOT_STATUS_SUCCESS );
+	}
+	return result;
+}
+
+void tr50_file_segments_stop(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer )
+{
+	iot_uint8_t i;
+	for ( i = 0u; i < TR50_FILE_SEGMENT_MAX; ++i )
+	{
+		struct tr50_file_segment *const segment = &transfer->segment[i];
+		if ( segment->lib_curl )
+		{
+			curl_multi_remove_handle( data->transfer_multi,
+				segment->lib_curl );
+			tr50_file_transfer_handle_release( data,
+				segment->lib_curl );
+			segment->lib_curl = NULL;
+		}
+	}
+}
+
+void tr50_file_transfer_done(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	CURLcode curl_result )
+{
+	iot_status_t result = IOT_STATUS_FAILURE;
+	const iot_timestamp_t now = iot_timestamp_now();
+
+	if ( transfer->lib_curl )
+		curl_multi_remove_handle( data->transfer_multi,
+			transfer->lib_curl );
+	IOT_LOG( data->lib, IOT_LOG_TRACE, "curl result %d", curl_result );
+	if ( curl_result == CURLE_OK )
+		result = IOT_STATUS_SUCCESS;
+	/* need to handle errors 400 * without retrying */
+	else if ( curl_result == CURLE_HTTP_RETURNED_ERROR ||
+	          curl_result == CURLE_SSL_CACERT ||
+	          curl_result == CURLE_ABORTED_BY_CALLBACK )
+		IOT_LOG( data->lib, IOT_LOG_ERROR,
+			"File transfer not recoverable(%d) exiting.\nReason: %s",
+			curl_result, curl_easy_strerror( curl_result ) );
+	else if ( ( transfer->max_retries < 0 ||
+	            transfer->retry < transfer->max_retries ) &&
+	          now < transfer->expiry_time )
+	{
+		/* back off before trying again, doubling the delay each time */
+		iot_millisecond_t delay = TR50_FILE_TRANSFER_RETRY_MS;
+		iot_int64_t i;
+		for ( i = 0; i < transfer->retry &&
+			delay < TR50_FILE_TRANSFER_RETRY_MAX_MS; ++i )
+			delay *= 2u;
+		if ( delay > TR50_FILE_TRANSFER_RETRY_MAX_MS )
+			delay = TR50_FILE_TRANSFER_RETRY_MAX_MS;
+
+		os_thread_mutex_lock( &data->transfer_mutex );
+		++transfer->retry;
+		transfer->retry_time = now + delay;
+		transfer->state = TR50_FILE_TRANSFER_PENDING;
+		os_thread_mutex_unlock( &data->transfer_mutex );
+		result = IOT_STATUS_TRY_AGAIN;
+	}
+	else
+		IOT_LOG( data->lib, IOT_LOG_ERROR,
+			"File transfer failed: %s",
+			curl_easy_strerror( curl_result ) );
+
+	if ( result != IOT_STATUS_TRY_AGAIN )
+		tr50_file_transfer_finish( data, transfer, result );
+}
+
+OS_THREAD_DECL tr50_file_transfer_engine(
+	void* arg )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	struct tr50_data *const data = (struct tr50_data *)arg;
+	if ( data )
+	{
+		struct tr50_file_transfer *transfer;
+		iot_bool_t ended = IOT_FALSE;
+		iot_bool_t running = IOT_TRUE;
+
+		result = IOT_STATUS_SUCCESS;
+		while ( running != IOT_FALSE )
+		{
+			struct tr50_file_transfer *due = NULL;
+			struct tr50_file_transfer **due_end = &due;
+			const iot_timestamp_t now = iot_timestamp_now();
+			const CURLMsg *msg;
+			int msgs_left = 0;
+			int still_running = 0;
+			unsigned int active_count = 0u;
+
+			/* find transfers that are due to start (or be retried),
+			 * oldest first, up to the number allowed at once */
+			os_thread_mutex_lock( &data->transfer_mutex );
+			running = data->transfer_running;
+			for ( transfer = data->file_transfer_queue; transfer;
+				transfer = transfer->next )
+				if ( transfer->state == TR50_FILE_TRANSFER_ACTIVE )
+					++active_count;
+			for ( transfer = data->file_transfer_queue;
+				running != IOT_FALSE && transfer &&
+				active_count < data->transfer_active_max;
+				transfer = transfer->next )
+			{
+				if ( transfer->state == TR50_FILE_TRANSFER_PENDING &&
+					transfer->retry_time <= now )
+				{
+					transfer->state = TR50_FILE_TRANSFER_ACTIVE;
+					transfer->engine_next = NULL;
+					*due_end = transfer;
+					due_end = &transfer->engine_next;
+					++active_count;
+				}
+			}
+			os_thread_mutex_unlock( &data->transfer_mutex );
+
+			/* a transfer failing to start is complete, and can be
+			 * freed as soon as it is */
+			transfer = due;
+			while ( transfer )
+			{
+				struct tr50_file_transfer *const next =
+					transfer->engine_next;
+				tr50_file_transfer_start( data, transfer );
+				transfer = next;
+			}
+			tr50_file_transfer_schedule( data,
+				( due || ended != IOT_FALSE ) );
+
+			/* perform transfers, then handle any that ended */
+			ended = IOT_FALSE;
+			curl_multi_perform( data->transfer_multi, &still_running );
+			while ( ( msg = curl_multi_info_read(
+				data->transfer_multi, &msgs_left ) ) != NULL )
+			{
+				if ( msg->msg == CURLMSG_DONE )
+				{
+					char *priv = NULL;
+					CURL *const lib_curl = msg->easy_handle;
+					const CURLcode curl_result = msg->data.result;
+					ended = IOT_TRUE;
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+					curl_easy_getinfo( lib_curl,
+						CURLINFO_PRIVATE, &priv );
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+					if ( priv && ( (struct tr50_file_transfer *)
+						(void *)priv )->segment_count > 0u )
+						tr50_file_segment_done( data,
+							(struct tr50_file_transfer *)(void *)priv,
+							lib_curl, curl_result );
+					else if ( priv )
+						tr50_file_transfer_done( data,
+							(struct tr50_file_transfer *)(void *)priv,
+							curl_result );
+				}
+			}
+
+			/* wait for activity, a new transfer or the next retry
+			 * (queued transfers can start as soon as one ended) */
+			if ( running != IOT_FALSE && ended == IOT_FALSE )
+			{
+#if LIBCURL_VERSION_NUM >= 0x074400
+				curl_multi_poll( data->transfer_multi, NULL, 0u,
+					TR50_FILE_TRANSFER_WAIT_MS, NULL );
+#else
+				int numfds = 0;
+				curl_multi_wait( data->transfer_multi, NULL, 0u,
+					TR50_FILE_TRANSFER_WAIT_MS, &numfds );
+				if ( numfds == 0 )
+					os_time_sleep( TR50_FILE_TRANSFER_WAIT_MS,
+						IOT_FALSE );
+#endif /* LIBCURL_VERSION_NUM >= 0x074400 */
+			}
+		}
+
+		/* stop any transfers still in progress */
+		for ( transfer = data->file_transfer_queue; transfer;
+			transfer = transfer->next )
+		{
+			if ( transfer->lib_curl || transfer->chunk_map )
+			{
+				if ( transfer->lib_curl )
+					curl_multi_remove_handle( data->transfer_multi,
+						transfer->lib_curl );
+				tr50_file_transfer_finish( data, transfer,
+					IOT_STATUS_FAILURE );
+			}
+		}
+	}
+	return (OS_THREAD_RETURN)result;
+}
+
+void tr50_file_transfer_finish(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	iot_status_t result )
+{
+	tr50_file_segments_stop( data, transfer );
+	if ( transfer->lib_curl )
+		tr50_file_transfer_handle_release( data, transfer->lib_curl );
+	transfer->lib_curl = NULL;
+	if ( transfer->file_handle )
+		os_file_close( transfer->file_handle );
+	transfer->file_handle = NULL;
+	if ( transfer->chunk_map_handle )
+		os_file_close( transfer->chunk_map_handle );
+	transfer->chunk_map_handle = NULL;
+	if ( transfer->archive_stream )
+		iot_archive_stream_close( transfer->archive_stream );
+	transfer->archive_stream = NULL;
+	if ( transfer->request_headers )
+		curl_slist_free_all( transfer->request_headers );
+	transfer->request_headers = NULL;
+
+	/* final checks and cleanup */
+	if ( result == IOT_STATUS_SUCCESS )
+	{
+		if ( transfer->op == IOT_OPERATION_FILE_DOWNLOAD )
+		{
+			iot_uint64_t crc32 = 0u;
+
+			/* checksum was calculated as the file was written, except
+			 * for segmented downloads written out of order */
+			if ( transfer->chunk_map )
+			{
+				iot_checksum_initialize( &transfer->checksum,
+					IOT_CHECKSUM_TYPE_CRC32 );
+				result = iot_checksum_path_update(
+					transfer->file_path, &transfer->checksum, 1u );
+			}
+			if ( result == IOT_STATUS_SUCCESS )
+				result = iot_checksum_finalize(
+					&transfer->checksum, &crc32 );
+			if ( result == IOT_STATUS_SUCCESS &&
+				crc32 != transfer->crc32 )
+			{
+				IOT_LOG( data->lib, IOT_LOG_ERROR,
+					"Checksum for %s does not match. "
+					"Expected: 0x%lX, calculated: 0x%lX",
+					transfer->path, transfer->crc32, crc32);
+				os_file_delete( transfer->file_path );
+				result = IOT_STATUS_FAILURE;
+			}
+
+			/* chunks are only kept while the file can be resumed */
+			if ( transfer->chunk_map && ( result == IOT_STATUS_SUCCESS ||
+				!os_file_exists( transfer->file_path ) ) )
+			{
+				char map_path[ PATH_MAX + 1u ];
+				os_snprintf( map_path, PATH_MAX, "%s%s",
+					transfer->file_path,
+					TR50_DOWNLOAD_MAP_EXTENSION );
+				os_file_delete( map_path );
+			}
+			/* the file can not be renamed on some platforms while it
+			 * is open (i.e. read as it downloads), copy it instead */
+			if ( result == IOT_STATUS_SUCCESS &&
+				os_file_move( transfer->file_path, transfer->path )
+					!= OS_STATUS_SUCCESS )
+			{
+				if ( os_file_copy( transfer->file_path,
+					transfer->path ) == OS_STATUS_SUCCESS )
+				{
+					if ( os_file_delete( transfer->file_path )
+						!= OS_STATUS_SUCCESS )
+						IOT_LOG( data->lib, IOT_LOG_WARNING,
+							"Failed to remove %s",
+							transfer->file_path );
+				}
+				else
+				{
+					IOT_LOG( data->lib, IOT_LOG_ERROR,
+						"Failed to move %s to %s",
+						transfer->file_path,
+						transfer->path );
+					result = IOT_STATUS_FAILURE;
+				}
+			}
+		}
+	}
+	if ( transfer->chunk_map )
+		os_free( transfer->chunk_map );
+	transfer->chunk_map = NULL;
+
+	/* queue the result to be reported by the library */
+	os_thread_mutex_lock( &data->transfer_mutex );
+	transfer->result = result;
+	transfer->state = TR50_FILE_TRANSFER_COMPLETE;
+	os_thread_mutex_unlock( &data->transfer_mutex );
+}
+
+CURL *tr50_file_transfer_handle_get(
+	struct tr50_data *data )
+{
+	CURL *lib_curl = NULL;
+	if ( data->transfer_pool_count > 0u )
+		lib_curl = data->transfer_pool[--data->transfer_pool_count];
+	else
+		lib_curl = curl_easy_init();
+
+	/* options are cleared when the handle is released, so set the share
+	 * each time the handle is used */
+	if ( lib_curl && data->transfer_share )
+	{
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+		curl_easy_setopt( lib_curl, CURLOPT_SHARE,
+			data->transfer_share );
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+	}
+	return lib_curl;
+}
+
+void tr50_file_transfer_handle_release(
+	struct tr50_data *data,
+	CURL *lib_curl )
+{
+	if ( data->transfer_pool_count < TR50_FILE_TRANSFER_POOL_MAX )
+	{
+		/* keeps the handle's connection and session caches */
+		curl_easy_reset( lib_curl );
+		data->transfer_pool[data->transfer_pool_count++] = lib_curl;
+	}
+	else
+		curl_easy_cleanup( lib_curl );
+}
+
+void tr50_file_transfer_options(
+	const struct tr50_data *data,
+	struct tr50_file_transfer *transfer,
+	CURL *lib_curl )
+{
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+	const char *ca_bundle_file = NULL;
+	iot_bool_t validate_cert = IOT_FALSE;
+
+	curl_easy_setopt( lib_curl,
+		CURLOPT_URL, transfer->url );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_VERBOSE, 1L );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_NOSIGNAL, 1L );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_FAILONERROR, 1L);
+	curl_easy_setopt( lib_curl,
+		CURLOPT_ACCEPT_ENCODING, "" );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_NOPROGRESS, 0L );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_PROGRESSFUNCTION,
+		tr50_file_progress_old );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_PROGRESSDATA, transfer );
+#if LIBCURL_VERSION_NUM >= 0x072000
+	curl_easy_setopt( lib_curl,
+		CURLOPT_XFERINFOFUNCTION,
+		tr50_file_progress );
+	curl_easy_setopt( lib_curl,
+		CURLOPT_XFERINFODATA, transfer );
+#endif /* LIBCURL_VERSION_NUM >= 0x072000 */
+	iot_config_get( data->lib,
+		"ca_bundle_file", IOT_FALSE,
+		IOT_TYPE_STRING, &ca_bundle_file );
+	iot_config_get( data->lib,
+		"validate_cloud_cert", IOT_FALSE,
+		IOT_TYPE_BOOL, &validate_cert );
+	if ( !ca_bundle_file )
+		ca_bundle_file = IOT_DEFAULT_CERT_PATH;
+	curl_easy_setopt( lib_curl,
+		CURLOPT_CAINFO, ca_bundle_file );
+
+	/* SSL verification */
+	if ( validate_cert != IOT_FALSE )
+	{
+		curl_easy_setopt( lib_curl,
+			CURLOPT_SSL_VERIFYHOST,
+			TR50_DEFAULT_SSL_VERIFY_HOST );
+		curl_easy_setopt( lib_curl,
+			CURLOPT_SSL_VERIFYPEER,
+			TR50_DEFAULT_SSL_VERIFY_PEER );
+
+		/* In some OSs libcurl cannot access the default CAs
+		 * and it has to be added in the fs */
+
+	}
+	else
+	{
+		curl_easy_setopt(lib_curl, CURLOPT_SSL_VERIFYHOST, 0L);
+		curl_easy_setopt(lib_curl, CURLOPT_SSL_VERIFYPEER, 0L);
+	}
+
+	/* Proxy settings */
+	if ( data->proxy.type != IOT_PROXY_UNKNOWN &&
+	     data->proxy.host && *data->proxy.host != '\0' )
+	{
+		long proxy_type = CURLPROXY_HTTP;
+		if ( data->proxy.type == IOT_PROXY_SOCKS5 )
+			proxy_type = CURLPROXY_SOCKS5_HOSTNAME;
+
+		curl_easy_setopt( lib_curl,
+			CURLOPT_PROXY, data->proxy.host );
+		curl_easy_setopt( lib_curl,
+			CURLOPT_PROXYPORT, data->proxy.port );
+		curl_easy_setopt( lib_curl,
+			CURLOPT_PROXYTYPE, proxy_type );
+
+		if ( data->proxy.username && data->proxy.username[0] != '\0' )
+			curl_easy_setopt( lib_curl,
+				CURLOPT_PROXYUSERNAME,
+				data->proxy.username );
+		if ( data->proxy.password && data->proxy.password[0] != '\0' )
+			curl_easy_setopt( lib_curl,
+				CURLOPT_PROXYPASSWORD,
+				data->proxy.password );
+	}
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+}
+
+void tr50_file_transfer_schedule(
+	struct tr50_data *data,
+	iot_bool_t changed )
+{
+	const iot_timestamp_t now = iot_timestamp_now();
+	const iot_millisecond_t elapsed =
+		(iot_millisecond_t)( now - data->transfer_schedule_time );
+
+	if ( changed != IOT_FALSE ||
+		elapsed >= TR50_FILE_TRANSFER_SCHEDULE_MS )
+	{
+		struct tr50_file_transfer *active = NULL;
+		struct tr50_file_transfer *transfer;
+		const iot_int64_t max_speed = data->transfer_max_speed;
+		iot_int64_t budget = 0;
+		iot_uint64_t moved = 0u;
+		unsigned int weight_total = 0u;
+		iot_uint8_t top = TR50_FILE_PRIORITY_LOW;
+
+		/* transfers in progress (not waiting to be retried) */
+		os_thread_mutex_lock( &data->transfer_mutex );
+		for ( transfer = data->file_transfer_queue; transfer;
+			transfer = transfer->next )
+		{
+			if ( transfer->state == TR50_FILE_TRANSFER_ACTIVE &&
+				( transfer->lib_curl || transfer->chunk_map ) )
+			{
+				moved += transfer->bytes - transfer->bytes_scheduled;
+				if ( transfer->priority > top )
+					top = transfer->priority;
+				transfer->engine_next = active;
+				active = transfer;
+			}
+		}
+		os_thread_mutex_unlock( &data->transfer_mutex );
+
+		/* background transfers wait for more important ones */
+		for ( transfer = active; transfer;
+			transfer = transfer->engine_next )
+		{
+			iot_bool_t pause = IOT_FALSE;
+			if ( transfer->priority == TR50_FILE_PRIORITY_LOW &&
+				top > TR50_FILE_PRIORITY_LOW )
+				pause = IOT_TRUE;
+			if ( pause != transfer->paused )
+				IOT_LOG( data->lib, IOT_LOG_DEBUG, "%s %s",
+					( pause != IOT_FALSE ) ? "Pausing" :
+					"Resuming", transfer->path );
+			transfer->paused = pause;
+			if ( pause == IOT_FALSE )
+				weight_total += 1u << transfer->priority;
+		}
+
+		/* token bucket, refilled at the maximum speed and holding at
+		 * most one period's worth: bytes moved above the maximum are
+		 * taken back over the next second, unused ones given out */
+		if ( max_speed > 0 )
+		{
+			const iot_int64_t burst = max_speed *
+				(iot_int64_t)TR50_FILE_TRANSFER_SCHEDULE_MS /
+				IOT_MILLISECONDS_IN_SECOND;
+			data->transfer_tokens += max_speed * (iot_int64_t)elapsed /
+				IOT_MILLISECONDS_IN_SECOND - (iot_int64_t)moved;
+			if ( data->transfer_tokens > burst )
+				data->transfer_tokens = burst;
+			if ( data->transfer_tokens < -burst )
+				data->transfer_tokens = -burst;
+			budget = max_speed + data->transfer_tokens;
+		}
 
-				msg = iot_json_encode_dump( json );
+		for ( transfer = active; transfer;
+			transfer = transfer->engine_next )
+		{
+			curl_off_t limit = 0;
 
-				/* publish */
-				result = iot_mqtt_publish( data->mqtt, "api",
-					msg, os_strlen( msg ), TR50_MQTT_QOS,
-					IOT_FALSE, NULL );
-				if ( result == IOT_STATUS_SUCCESS )
-				{
-					/* add it to the queue */
-					os_memcpy(
-						&data->file_transfer_queue[ data->file_transfer_count ],
-						&transfer, sizeof( struct tr50_file_transfer ) );
-					data->file_transfer_queue[ data->file_transfer_count ].plugin_data =
-						(void*)data;
-					++data->file_transfer_count;
-				}
-				else
-					IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
-						"Failed send file request" );
+			/* share the budget in proportion to the priorities */
+			if ( max_speed > 0 && transfer->paused == IOT_FALSE )
+			{
+				limit = (curl_off_t)( budget *
+					(iot_int64_t)( 1u << transfer->priority ) /
+					(iot_int64_t)weight_total );
+				if ( limit < TR50_FILE_TRANSFER_SPEED_MIN )
+					limit = TR50_FILE_TRANSFER_SPEED_MIN;
+			}
 
-				iot_json_encode_terminate( json );
+			/* pausing is repeated, in case a request started since */
+			if ( limit != transfer->speed_limit ||
+				transfer->paused != IOT_FALSE ||
+				changed != IOT_FALSE )
+			{
+				iot_uint8_t j;
+				transfer->speed_limit = limit;
+				if ( transfer->lib_curl )
+					tr50_file_transfer_throttle( transfer,
+						transfer->lib_curl );
+				for ( j = 0u; j < transfer->segment_count; ++j )
+					if ( transfer->segment[j].lib_curl )
+						tr50_file_transfer_throttle( transfer,
+							transfer->segment[j].lib_curl );
 			}
-			else
-				IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
-					"Failed to encode json" );
+			transfer->bytes_scheduled = transfer->bytes;
 		}
-		else
-			IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
-				"Maximum file transfer reached" );
+		data->transfer_schedule_time = now;
 	}
-	return result;
 }
 
-#ifdef IOT_THREAD_SUPPORT
-OS_THREAD_DECL tr50_file_transfer(
-	void* arg )
+iot_status_t tr50_file_transfer_start(
+	struct tr50_data *data,
+	struct tr50_file_transfer *transfer )
 {
-	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
-	iot_bool_t remove_from_queue = IOT_FALSE;
-	struct tr50_file_transfer *const transfer =
-		(struct tr50_file_transfer*)arg;
-	if ( transfer )
+	iot_status_t result = IOT_STATUS_SUCCESS;
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+	/* large downloads can be fetched as several ranges at once, unless
+	 * part of the file was already fetched as a single stream (or it is
+	 * read as it downloads); each range is written at an offset given
+	 * to os_file_seek, so the whole file must be addressable by a long
+	 * (2 GiB on 32-bit targets) */
+	if ( transfer->op == IOT_OPERATION_FILE_DOWNLOAD &&
+		!transfer->lib_curl && !transfer->chunk_map &&
+		transfer->segment_fallback == IOT_FALSE &&
+		transfer->sequential == IOT_FALSE &&
+		transfer->size >= TR50_FILE_SEGMENT_MIN_SIZE &&
+		transfer->size - 1u <= (iot_uint64_t)LONG_MAX )
 	{
-		const struct tr50_data *const data =
-			(const struct tr50_data * )transfer->plugin_data;
-		char file_path[ PATH_MAX +1u ];
-		transfer->lib_curl = curl_easy_init();
-		if ( transfer->lib_curl && data )
-		{
-			const char *ca_bundle_file = NULL;
-			CURLcode curl_result = CURLE_FAILED_INIT;
-			os_file_t file_handle;
-			iot_bool_t validate_cert = IOT_FALSE;
-			int retry = 0;
-			iot_bool_t append_mode = IOT_FALSE;
+		char map_path[ PATH_MAX + 1u ];
+		iot_int64_t segments = 0;
+
+		iot_config_get( data->lib, "file_transfer_segments", IOT_FALSE,
+			IOT_TYPE_INT64, &segments );
+		if ( segments > (iot_int64_t)TR50_FILE_SEGMENT_MAX )
+			segments = (iot_int64_t)TR50_FILE_SEGMENT_MAX;
+		os_snprintf( map_path, PATH_MAX, "%s%s",
+			transfer->file_path, TR50_DOWNLOAD_MAP_EXTENSION );
+		if ( segments > 1 && ( !os_file_exists( transfer->file_path ) ||
+			os_file_exists( map_path ) ) )
+			transfer->segment_count = (iot_uint8_t)segments;
+	}
 
-			if ( transfer->op == IOT_OPERATION_FILE_UPLOAD )
-				os_strncpy( file_path, transfer->path, PATH_MAX );
-			else
-				os_snprintf( file_path, PATH_MAX, "%s%s",
-					transfer->path, TR50_DOWNLOAD_EXTENSION );
+	/* first attempt: open the file and set up the curl handle */
+	if ( transfer->segment_count == 0u && !transfer->lib_curl )
+	{
+		iot_bool_t append_mode = IOT_FALSE;
 
-			if ( os_file_exists( file_path ) &&  transfer->op == IOT_OPERATION_FILE_DOWNLOAD)
-				append_mode = IOT_TRUE;
+		/* a file left by a segmented attempt is preallocated & its
+		 * chunks are written out of order, it can't be appended to */
+		if ( transfer->op == IOT_OPERATION_FILE_DOWNLOAD )
+		{
+			char map_path[ PATH_MAX + 1u ];
+			os_snprintf( map_path, PATH_MAX, "%s%s",
+				transfer->file_path, TR50_DOWNLOAD_MAP_EXTENSION );
+			if ( os_file_exists( map_path ) )
+			{
+				IOT_LOG( data->lib, IOT_LOG_WARNING,
+					"Discarding ranges of %s downloaded "
+					"before, downloading it as a single "
+					"stream", transfer->path );
+				os_file_delete( map_path );
+				os_file_delete( transfer->file_path );
+			}
+		}
 
-			file_handle = os_file_open( file_path,
+		result = IOT_STATUS_FAILURE;
+		if ( os_file_exists( transfer->file_path ) &&
+			transfer->op == IOT_OPERATION_FILE_DOWNLOAD )
+			append_mode = IOT_TRUE;
+
+		/* the checksum of a download is calculated as it is written,
+		 * starting from the part downloaded previously */
+		iot_checksum_initialize( &transfer->checksum,
+			IOT_CHECKSUM_TYPE_CRC32 );
+		if ( append_mode != IOT_FALSE )
+			iot_checksum_path_update( transfer->file_path,
+				&transfer->checksum, 1u );
+
+		/* a directory is archived as it is read, when uploading */
+		if ( transfer->archive == IOT_ARCHIVE_NONE )
+			transfer->file_handle = os_file_open( transfer->file_path,
 				(transfer->op == IOT_OPERATION_FILE_UPLOAD)? OS_READ : OS_READ_WRITE |
 				( (append_mode == IOT_TRUE)? OS_APPEND: OS_CREATE) );
+		if ( transfer->file_handle ||
+			transfer->archive != IOT_ARCHIVE_NONE )
+			transfer->lib_curl = tr50_file_transfer_handle_get( data );
 
-			if ( file_handle )
+		if ( transfer->lib_curl )
+		{
+			tr50_file_transfer_options( data, transfer,
+				transfer->lib_curl );
+			if ( transfer->op == IOT_OPERATION_FILE_UPLOAD &&
+				transfer->archive != IOT_ARCHIVE_NONE )
 			{
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
-#endif /* ifdef __clang__ */
-				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_URL, transfer->url );
+				/* the size of the archive is only known once it
+				 * is produced, so it is sent in chunks */
+				transfer->request_headers = curl_slist_append(
+					NULL, "Transfer-Encoding: chunked" );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_VERBOSE, 1L );
+					CURLOPT_POST, 1L );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_NOSIGNAL, 1L );
+					CURLOPT_HTTPHEADER,
+					transfer->request_headers );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_FAILONERROR, 1L);
+					CURLOPT_READDATA, transfer );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_ACCEPT_ENCODING, "" );
+					CURLOPT_READFUNCTION, tr50_file_archive_read );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_NOPROGRESS, 0L );
-				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_PROGRESSFUNCTION,
-					tr50_file_progress_old );
+					CURLOPT_POSTFIELDSIZE, -1L );
+			}
+			else if ( transfer->op == IOT_OPERATION_FILE_UPLOAD )
+			{
+				transfer->size =
+					os_file_size( transfer->path );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_PROGRESSDATA, transfer );
-#if LIBCURL_VERSION_NUM >= 0x072000
+					CURLOPT_POST, 1L );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_XFERINFOFUNCTION,
-					tr50_file_progress );
+					CURLOPT_READDATA, transfer );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_XFERINFODATA, transfer );
-#endif /* LIBCURL_VERSION_NUM >= 0x072000 */
-				iot_config_get( data->lib,
-					"ca_bundle_file", IOT_FALSE,
-					IOT_TYPE_STRING, &ca_bundle_file );
-				iot_config_get( data->lib,
-					"validate_cloud_cert", IOT_FALSE,
-					IOT_TYPE_BOOL, &validate_cert );
-				if ( !ca_bundle_file )
-					ca_bundle_file = IOT_DEFAULT_CERT_PATH;
+					CURLOPT_READFUNCTION, tr50_file_read );
 				curl_easy_setopt( transfer->lib_curl,
-					CURLOPT_CAINFO, ca_bundle_file );
-
-				/* SSL verification */
-				if ( validate_cert != IOT_FALSE )
-				{
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_SSL_VERIFYHOST,
-						TR50_DEFAULT_SSL_VERIFY_HOST );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_SSL_VERIFYPEER,
-						TR50_DEFAULT_SSL_VERIFY_PEER );
-
-					/* In some OSs libcurl cannot access the default CAs
-					 * and it has to be added in the fs */
-
-				}
-				else
-				{
-					curl_easy_setopt(transfer->lib_curl, CURLOPT_SSL_VERIFYHOST, 0L);
-					curl_easy_setopt(transfer->lib_curl, CURLOPT_SSL_VERIFYPEER, 0L);
-				}
-
-				/* Proxy settings */
-				if ( data->proxy.type != IOT_PROXY_UNKNOWN &&
-				     data->proxy.host && *data->proxy.host != '\0' )
-				{
-					long proxy_type = CURLPROXY_HTTP;
-					if ( data->proxy.type == IOT_PROXY_SOCKS5 )
-						proxy_type = CURLPROXY_SOCKS5_HOSTNAME;
-
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_PROXY, data->proxy.host );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_PROXYPORT, data->proxy.port );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_PROXYTYPE, proxy_type );
-
-					if ( data->proxy.username && data->proxy.username[0] != '\0' )
-						curl_easy_setopt( transfer->lib_curl,
-							CURLOPT_PROXYUSERNAME,
-							data->proxy.username );
-					if ( data->proxy.password && data->proxy.password[0] != '\0' )
-						curl_easy_setopt( transfer->lib_curl,
-							CURLOPT_PROXYPASSWORD,
-							data->proxy.password );
-				}
-
-				if ( transfer->op == IOT_OPERATION_FILE_UPLOAD )
-				{
-					transfer->size =
-						os_file_size( transfer->path );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_POST, 1L );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_READDATA, file_handle );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_READFUNCTION, os_file_read );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_POSTFIELDSIZE,
-						transfer->size );
-				}
-				else
-				{
-
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_WRITEFUNCTION, os_file_write );
-					curl_easy_setopt( transfer->lib_curl,
-						CURLOPT_WRITEDATA, file_handle );
-				}
-				IOT_LOG( data->lib, IOT_LOG_DEBUG, "Maximum number of retries: %ld",
-					transfer->max_retries);
-
-				/* max_retries defined in iot_defs.h */
-				for ( retry = 0; (retry <= transfer->max_retries ||
-					transfer->max_retries< 0 ) && curl_result != CURLE_OK; retry++)
-				{
-					IOT_LOG( data->lib, IOT_LOG_TRACE, "retry count=%d", retry);
-					if ( os_file_exists( file_path ) )
-					{
-						long resume_from = 0;
-
-						/* Force a timeout when speed is less than the low speed limit
-						 * for certain period of time so libcurl will stop trying for nothing
-						 * and wait until network gets better */
-						curl_easy_setopt( transfer->lib_curl,
-							CURLOPT_LOW_SPEED_LIMIT, IOT_TRANSFER_LOW_SPEED_LIMIT );     /* bytes/second */
-						curl_easy_setopt( transfer->lib_curl,
-							CURLOPT_LOW_SPEED_TIME, IOT_TRANSFER_LOW_SPEED_TIMEOUT );      /* low speed timeout */
-
-						/* set resume from amount for download */
-						if ( transfer->op == IOT_OPERATION_FILE_DOWNLOAD)
-						{
-							resume_from = (long)os_file_size_handle( file_handle );
-							IOT_LOG( data->lib, IOT_LOG_DEBUG,
-								"File exists %s, resume xfer from %ld bytes",
-								file_path, resume_from);
-							curl_easy_setopt( transfer->lib_curl,
-								CURLOPT_RESUME_FROM, resume_from );
-						}
-						else
-						{
-							curl_easy_setopt( transfer->lib_curl,
-								CURLOPT_APPEND, 1L);
-						}
-						curl_easy_setopt( transfer->lib_curl,
-							CURLOPT_FRESH_CONNECT, 1L);                 /* fresh connect ctx */
-						curl_easy_setopt( transfer->lib_curl,
-								CURLOPT_DNS_CACHE_TIMEOUT, 0L);     /* no dns cache */
-					}
-					curl_result = curl_easy_perform( transfer->lib_curl );
-
-					/* need to handle errors 400 * without retrying */
-					if ( curl_result == CURLE_HTTP_RETURNED_ERROR ||
-					     curl_result == CURLE_SSL_CACERT )
-					{
-						IOT_LOG( data->lib, IOT_LOG_ERROR,
-							"File transfer not recoverable(%d) exiting.\nReason: %s",
-							curl_result, curl_easy_strerror( curl_result ) );
-						break;
-					}
-					else
-						IOT_LOG( data->lib, IOT_LOG_TRACE, "curl result %d", curl_result);
-
-					/* add a delay before immediately trying again */
-					if ( curl_result != CURLE_OK )
-						os_time_sleep(10000, IOT_FALSE);
-				}
-
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif /* ifdef __clang__ */
-
-				if ( curl_result == CURLE_OK )
-					result = IOT_STATUS_SUCCESS;
-				else
-					IOT_LOG( data->lib, IOT_LOG_ERROR,
-						"File transfer failed: %s",
-						curl_easy_strerror( curl_result ) );
-
-				os_file_close( file_handle );
+					CURLOPT_POSTFIELDSIZE,
+					transfer->size );
 			}
 			else
-				IOT_LOG( data->lib, IOT_LOG_ERROR,
-					"Failed to open %s", transfer->path );
+			{
 
-			curl_easy_cleanup( transfer->lib_curl );
+				curl_easy_setopt( transfer->lib_curl,
+					CURLOPT_WRITEFUNCTION, tr50_file_write );
+				curl_easy_setopt( transfer->lib_curl,
+					CURLOPT_WRITEDATA, transfer );
+			}
+			curl_easy_setopt( transfer->lib_curl,
+				CURLOPT_PRIVATE, transfer );
+			IOT_LOG( data->lib, IOT_LOG_DEBUG, "Maximum number of retries: %ld",
+				transfer->max_retries);
+			result = IOT_STATUS_SUCCESS;
 		}
-		else
+		else if ( transfer->file_handle ||
+			transfer->archive != IOT_ARCHIVE_NONE )
 			IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
 				"Failed to initialize libcurl" );
+		else
+			IOT_LOG( data->lib, IOT_LOG_ERROR,
+				"Failed to open %s", transfer->path );
+	}
 
+	if ( result == IOT_STATUS_SUCCESS && transfer->segment_count > 0u )
+		result = tr50_file_segments_start( data, transfer );
+	else if ( result == IOT_STATUS_SUCCESS )
+	{
+		IOT_LOG( data->lib, IOT_LOG_TRACE, "retry count=%ld",
+			(long)transfer->retry );
 
-		/* final checks and cleanup */
-		if ( result == IOT_STATUS_SUCCESS )
+		/* each attempt sends the archive from its beginning */
+		if ( transfer->archive != IOT_ARCHIVE_NONE )
 		{
-			if ( transfer->op == IOT_OPERATION_FILE_DOWNLOAD )
+			if ( transfer->archive_stream )
+				iot_archive_stream_close(
+					transfer->archive_stream );
+			transfer->archive_stream = iot_archive_stream_open(
+				transfer->path, transfer->archive );
+			if ( transfer->archive_stream )
+				iot_archive_stream_progress(
+					transfer->archive_stream, NULL,
+					&transfer->size );
+			else
 			{
-				os_file_t file_handle = os_file_open(
-					file_path, OS_READ );
-				if ( file_handle )
-				{
-					iot_uint64_t crc32 = 0u;
-
-					result = iot_checksum_file_get(
-						data->lib, file_handle,
-						IOT_CHECKSUM_TYPE_CRC32, &crc32 );
-					if ( result == IOT_STATUS_SUCCESS &&
-						crc32 != transfer->crc32 )
-					{
-						IOT_LOG( data->lib, IOT_LOG_ERROR,
-							"Checksum for %s does not match. "
-							"Expected: 0x%lX, calculated: 0x%lX",
-							transfer->path, transfer->crc32, crc32);
-						os_file_delete( file_path );
-						result = IOT_STATUS_FAILURE;
-					}
-					os_file_close( file_handle );
-
-					if ( result == IOT_STATUS_SUCCESS )
-						os_file_move( file_path, transfer->path );
-				}
+				IOT_LOG( data->lib, IOT_LOG_ERROR,
+					"Failed to archive %s", transfer->path );
+				result = IOT_STATUS_FAILURE;
+			}
+		}
+		if ( os_file_exists( transfer->file_path ) )
+		{
+			long resume_from = 0;
+
+			/* Force a timeout when speed is less than the low speed limit
+			 * for certain period of time so libcurl will stop trying for nothing
+			 * and wait until network gets better */
+			curl_easy_setopt( transfer->lib_curl,
+				CURLOPT_LOW_SPEED_LIMIT, IOT_TRANSFER_LOW_SPEED_LIMIT );     /* bytes/second */
+			curl_easy_setopt( transfer->lib_curl,
+				CURLOPT_LOW_SPEED_TIME, IOT_TRANSFER_LOW_SPEED_TIMEOUT );      /* low speed timeout */
+
+			/* set resume from amount for download */
+			if ( transfer->op == IOT_OPERATION_FILE_DOWNLOAD)
+			{
+				resume_from = (long)os_file_size_handle( transfer->file_handle );
+				IOT_LOG( data->lib, IOT_LOG_DEBUG,
+					"File exists %s, resume xfer from %ld bytes",
+					transfer->file_path, resume_from);
+				curl_easy_setopt( transfer->lib_curl,
+					CURLOPT_RESUME_FROM, resume_from );
 			}
 			else
 			{
-				if ( os_strlen( transfer->path ) > 4u  &&
-					os_strncmp(
-						transfer->path +
-						os_strlen( transfer->path ) - 4u,
-						".tar", 4u ) == 0 )
-					os_file_delete( transfer->path );
+				curl_easy_setopt( transfer->lib_curl,
+					CURLOPT_APPEND, 1L);
 			}
-
-			remove_from_queue = IOT_TRUE;
 		}
-		else
-			remove_from_queue = IOT_TRUE;
 
-		if ( transfer->callback )
+		/* after a failure don't trust the connection or the address it
+		 * was made to, the ssl session can still be resumed */
+		if ( transfer->retry > 0 )
 		{
-			iot_file_progress_t transfer_progress;
-			os_memzero( &transfer_progress, sizeof(transfer_progress) );
-			transfer_progress.percentage = (result == IOT_STATUS_SUCCESS)?
-				100.0 : (iot_float32_t)(100.0 * transfer->prev_byte / transfer->size);
-			transfer_progress.status = result;
-			transfer_progress.completed = IOT_TRUE;
-
-			transfer->callback( &transfer_progress, transfer->user_data );
+			curl_easy_setopt( transfer->lib_curl,
+				CURLOPT_FRESH_CONNECT, 1L);                 /* fresh connect ctx */
+			curl_easy_setopt( transfer->lib_curl,
+					CURLOPT_DNS_CACHE_TIMEOUT, 0L);     /* no dns cache */
 		}
-
-		if ( remove_from_queue )
+		if ( result == IOT_STATUS_SUCCESS )
+			tr50_file_transfer_throttle( transfer,
+				transfer->lib_curl );
+		if ( result == IOT_STATUS_SUCCESS &&
+			curl_multi_add_handle( data->transfer_multi,
+			transfer->lib_curl ) != CURLM_OK )
 		{
-			struct tr50_data *const tr50 =
-				(struct tr50_data *)transfer->plugin_data;
+			IOT_LOG( data->lib, IOT_LOG_ERROR,
+				"Failed to start transfer of %s", transfer->path );
+			result = IOT_STATUS_FAILURE;
+		}
+	}
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
 
-			if ( tr50 )
-			{
-				/* remove the transfer from the queue */
-				iot_uint8_t i = (iot_uint8_t)(
-					(unsigned long)((const unsigned char *)(transfer) - (const unsigned char*)&tr50->file_transfer_queue[0]) / (unsigned long)sizeof(struct tr50_file_transfer));
-				os_memmove(
-					&tr50->file_transfer_queue[i],
-					&tr50->file_transfer_queue[i+1u],
-					( tr50->file_transfer_count - i -1u ) *
-					sizeof( iot_file_transfer_t ) );
-				os_memzero(
-					&tr50->file_transfer_queue[ tr50->file_transfer_count - 1u ],
-					sizeof( iot_file_transfer_t ) );
-				--tr50->file_transfer_count;
-				result = IOT_STATUS_SUCCESS;
-			}
-			else
-			{
-				IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
-					"Cannot find plugin data" );
-				result = IOT_STATUS_FAILURE;
-			}
+	if ( result != IOT_STATUS_SUCCESS )
+		tr50_file_transfer_finish( data, transfer, result );
+	return result;
+}
+
+void tr50_file_transfer_throttle(
+	const struct tr50_file_transfer *transfer,
+	CURL *lib_curl )
+{
+	curl_off_t limit = transfer->speed_limit;
+
+	/* the ranges of a segmented download share its speed */
+	if ( limit > 0 && transfer->segment_count > 0u )
+	{
+		limit /= transfer->segment_count;
+		if ( limit < TR50_FILE_TRANSFER_SPEED_MIN )
+			limit = TR50_FILE_TRANSFER_SPEED_MIN;
+	}
+#ifdef __clang__
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
+#endif /* ifdef __clang__ */
+	curl_easy_setopt( lib_curl, CURLOPT_MAX_RECV_SPEED_LARGE, limit );
+	curl_easy_setopt( lib_curl, CURLOPT_MAX_SEND_SPEED_LARGE, limit );
+#ifdef __clang__
+#pragma clang diagnostic pop
+#endif /* ifdef __clang__ */
+	curl_easy_pause( lib_curl, ( transfer->paused != IOT_FALSE ) ?
+		CURLPAUSE_ALL : CURLPAUSE_CONT );
+}
+
+iot_status_t tr50_file_transfer_wakeup(
+	struct tr50_data *data )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	os_thread_mutex_lock( &data->transfer_mutex );
+	if ( data->transfer_running == IOT_FALSE )
+	{
+		size_t stack_size = 0u;
+#if defined( __VXWORKS__ )
+		stack_size = deviceCloudStackSizeGet();
+#endif /* if defined( __VXWORKS__ ) */
+		data->transfer_running = IOT_TRUE;
+		if ( !data->transfer_multi ||
+			os_thread_create( &data->transfer_thread,
+			tr50_file_transfer_engine, data, stack_size ) != 0 )
+		{
+			IOT_LOG( data->lib, IOT_LOG_ERROR, "%s",
+				"Failed to create the file transfer thread" );
+			data->transfer_running = IOT_FALSE;
+			result = IOT_STATUS_FAILURE;
 		}
 	}
-	return (OS_THREAD_RETURN)result;
+#if LIBCURL_VERSION_NUM >= 0x074400
+	else
+		curl_multi_wakeup( data->transfer_multi );
+#endif /* LIBCURL_VERSION_NUM >= 0x074400 */
+	os_thread_mutex_unlock( &data->transfer_mutex );
+	return result;
 }
 
 int tr50_file_progress( void *user_data,
@@ -1891,8 +3654,12 @@ int tr50_file_progress( void *user_data,
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wdisabled-macro-expansion"
 #endif /* ifdef __clang__ */
-			curl_easy_getinfo(
-				transfer->lib_curl, CURLINFO_TOTAL_TIME, &cur_time);
+			if ( transfer->lib_curl )
+				curl_easy_getinfo( transfer->lib_curl,
+					CURLINFO_TOTAL_TIME, &cur_time );
+			else
+				cur_time = (double)iot_timestamp_now() /
+					IOT_MILLISECONDS_IN_SECOND;
 #ifdef __clang__
 #pragma clang diagnostic pop
 #endif /* ifdef __clang__ */
@@ -1900,6 +3667,19 @@ int tr50_file_progress( void *user_data,
 
 			if ( transfer->op == IOT_OPERATION_FILE_UPLOAD )
 			{
+				/* the size of an archive is unknown until it is
+				 * complete, so report how much of the files it
+				 * holds were sent */
+				if ( transfer->archive_stream )
+				{
+					iot_uint64_t done = 0u;
+					iot_uint64_t size = 0u;
+					iot_archive_stream_progress(
+						transfer->archive_stream,
+						&done, &size );
+					up_now = (curl_off_t)done;
+					up_total = (curl_off_t)size;
+				}
 				now = (long)up_now + transfer->prev_byte;
 				total = (long)up_total + transfer->prev_byte;
 				transfer_type = "Upload";
@@ -1907,7 +3687,10 @@ int tr50_file_progress( void *user_data,
 			else
 			{
 				/* For larger files, cloud does not specify total
-				 * size, so use the file size given in the beginning */
+				 * size, so use the file size given in the beginning.
+				 * A segmented download is reported as a whole */
+				if ( transfer->segment_count > 0u )
+					down_now = (curl_off_t)transfer->segment_bytes;
 				now = (long)down_now + transfer->prev_byte;
 				total = (long)transfer->size;
 				transfer_type = "Download";
@@ -1956,48 +3739,137 @@ int tr50_file_progress_old(
 		(curl_off_t)down_total, (curl_off_t)down_now,
 		(curl_off_t)up_total, (curl_off_t)up_now );
 }
+
+size_t tr50_file_read(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data )
+{
+	struct tr50_file_transfer *const transfer =
+		(struct tr50_file_transfer *)user_data;
+	const size_t result = os_file_read( ptr, size, nmemb,
+		transfer->file_handle );
+	transfer->bytes += size * result;
+	return result;
+}
+
+size_t tr50_file_write(
+	char *ptr,
+	size_t size,
+	size_t nmemb,
+	void *user_data )
+{
+	struct tr50_file_transfer *const transfer =
+		(struct tr50_file_transfer *)user_data;
+	const size_t result = os_file_write( ptr, size, nmemb,
+		transfer->file_handle );
+
+	/* only what reached the file is part of the checksum, the rest
+	 * is requested again when the transfer is resumed */
+	iot_checksum_update( &transfer->checksum, ptr, size * result );
+	transfer->bytes += size * result;
+	return result;
+}
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 void tr50_file_queue_check(
 	struct tr50_data *data )
 {
-	if ( data )
+	if ( data && data->file_transfer_count > 0u )
 	{
-		iot_timestamp_t now = iot_timestamp_now();
-		if ( data->file_queue_last_checked == 0u ||
-			now - data->file_queue_last_checked >=
-			TR50_FILE_QUEUE_CHECK_INTERVAL )
-		{
 #ifdef IOT_THREAD_SUPPORT
-			iot_uint8_t i = 0u;
-			for ( i= 0u;
-				i < data->file_transfer_count;
-				i++ )
+		struct tr50_file_transfer *done = NULL;
+		struct tr50_file_transfer **done_end = &done;
+		struct tr50_file_transfer **link = &data->file_transfer_queue;
+
+		/* take completed transfers off the queue */
+		os_thread_mutex_lock( &data->transfer_mutex );
+		while ( *link )
+		{
+			struct tr50_file_transfer *const transfer = *link;
+			if ( transfer->state == TR50_FILE_TRANSFER_COMPLETE )
 			{
-				struct tr50_file_transfer *transfer =
-					&data->file_transfer_queue[i];
-				if ( transfer &&
-					transfer->retry_time != 0u &&
-					transfer->retry_time <= now )
-				{
-					os_thread_t thread;
-					size_t stack_size = 0u;
+				*link = transfer->next;
+				transfer->next = NULL;
+				*done_end = transfer;
+				done_end = &transfer->next;
+				--data->file_transfer_count;
+			}
+			else
+				link = &transfer->next;
+		}
+		os_thread_mutex_unlock( &data->transfer_mutex );
 
-					/* Create a thread to do the file transfer */
-#if defined( __VXWORKS__ )
-					stack_size = deviceCloudStackSizeGet();
-#endif /* if defined( __VXWORKS__ ) */
+		/* report results outside of the lock */
+		while ( done )
+		{
+			struct tr50_file_transfer *const transfer = done;
+			iot_file_progress_t progress;
 
-					if ( os_thread_create( &thread,
-						tr50_file_transfer,
-						transfer, stack_size ) == 0 )
-						transfer->retry_time = 0u;
-				}
-			}
+			os_memzero( &progress, sizeof( iot_file_progress_t ) );
+			progress.percentage = (transfer->result == IOT_STATUS_SUCCESS)?
+				100.0 : (iot_float32_t)(100.0 * transfer->prev_byte / transfer->size);
+			progress.status = transfer->result;
+			progress.completed = IOT_TRUE;
+			if ( transfer->callback )
+				transfer->callback( &progress, transfer->user_data );
+			done = transfer->next;
+			tr50_file_transfer_free( transfer );
+		}
 #endif /* ifdef IOT_THREAD_SUPPORT */
-			data->file_queue_last_checked = now;
+	}
+}
+
+struct tr50_file_transfer *tr50_file_transfer_alloc(
+	const char *name,
+	const char *path,
+	iot_operation_t op )
+{
+	struct tr50_file_transfer *transfer;
+	size_t name_len;
+	size_t path_len;
+	size_t file_path_len = 0u;
+
+	if ( !name )
+		name = "";
+	if ( !path )
+		path = "";
+	name_len = os_strlen( name ) + 1u;
+	path_len = os_strlen( path ) + 1u;
+
+	/* a download is written to a temporary file until it is complete */
+	if ( op == IOT_OPERATION_FILE_DOWNLOAD )
+		file_path_len = path_len + sizeof( TR50_DOWNLOAD_EXTENSION ) - 1u;
+
+	transfer = (struct tr50_file_transfer *)os_malloc(
+		sizeof( struct tr50_file_transfer ) + name_len + path_len +
+		file_path_len );
+	if ( transfer )
+	{
+		os_memzero( transfer, sizeof( struct tr50_file_transfer ) );
+		transfer->name = (char *)( transfer + 1 );
+		os_memcpy( transfer->name, name, name_len );
+		transfer->path = transfer->name + name_len;
+		os_memcpy( transfer->path, path, path_len );
+		transfer->file_path = transfer->path;
+		if ( file_path_len > 0u )
+		{
+			transfer->file_path = transfer->path + path_len;
+			os_snprintf( transfer->file_path, file_path_len, "%s%s",
+				path, TR50_DOWNLOAD_EXTENSION );
 		}
+		transfer->op = op;
 	}
+	return transfer;
+}
+
+void tr50_file_transfer_free(
+	struct tr50_file_transfer *transfer )
+{
+	if ( transfer->url )
+		os_free( transfer->url );
+	os_free( transfer );
 }
 
 iot_status_t tr50_initialize(
@@ -2009,13 +3881,49 @@ iot_status_t tr50_initialize(
 	IOT_LOG( lib, IOT_LOG_TRACE, "tr50: %s", "initialize" );
 	if ( data )
 	{
+		size_t i;
 		os_memzero( data, sizeof( struct tr50_data ) );
 		data->lib = lib;
+		data->file_transfer_backlog = TR50_FILE_TRANSFER_BACKLOG;
 		*plugin_data = data;
+		for ( i = 0u; i < TR50_MSG_PATH_COUNT; ++i )
+		{
+			/* a path that fails to compile is never found */
+			data->msg_paths[i] = iot_json_path_compile(
+				data->msg_path_buf[i], TR50_MSG_PATH_SIZE, 0u,
+				TR50_MSG_PATHS[i] );
+			if ( !data->msg_paths[i] )
+				IOT_LOG( lib, IOT_LOG_ERROR,
+					"tr50: failed to compile message path: %s",
+					TR50_MSG_PATHS[i] );
+		}
 #ifdef IOT_THREAD_SUPPORT
 		os_thread_mutex_create( &data->mail_check_mutex ) ;
+		os_thread_mutex_create( &data->ack_mutex );
+		os_thread_condition_create( &data->ack_signal );
+		os_thread_mutex_create( &data->transfer_mutex );
 #endif /* IOT_THREAD_SUPPORT */
 		curl_global_init( CURL_GLOBAL_ALL );
+#ifdef IOT_THREAD_SUPPORT
+		data->transfer_active_max = TR50_FILE_TRANSFER_MAX;
+		data->transfer_multi = curl_multi_init();
+
+		/* share dns lookups, ssl sessions and connections between
+		 * transfers, these are only used from the transfer thread so
+		 * no locking functions are required */
+		data->transfer_share = curl_share_init();
+		if ( data->transfer_share )
+		{
+			curl_share_setopt( data->transfer_share,
+				CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+			curl_share_setopt( data->transfer_share,
+				CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+#if LIBCURL_VERSION_NUM >= 0x073900
+			curl_share_setopt( data->transfer_share,
+				CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT );
+#endif /* LIBCURL_VERSION_NUM >= 0x073900 */
+		}
+#endif /* IOT_THREAD_SUPPORT */
 		result = iot_mqtt_initialize();
 	}
 	return result;
@@ -2071,7 +3979,17 @@ void tr50_on_message(
 #ifdef IOT_STACK_ONLY
 	json = iot_json_decode_initialize( buf, TR50_IN_BUFFER_SIZE, 0u );
 #else
-	json = iot_json_decode_initialize( NULL, 0u, IOT_JSON_FLAG_DYNAMIC );
+	/* the decoder (and its tokens) is kept between messages, so once it
+	 * has grown to fit the typical message no further allocation is
+	 * needed to parse */
+	json = NULL;
+	if ( data )
+	{
+		if ( !data->msg_decoder )
+			data->msg_decoder = iot_json_decode_initialize(
+				NULL, 0u, IOT_JSON_FLAG_DYNAMIC );
+		json = data->msg_decoder;
+	}
 #endif
 	if ( data && json &&
 		iot_json_decode_parse( json, payload, payload_len, &root,
@@ -2170,27 +4088,42 @@ void tr50_on_message(
 									if ( iot_json_decode_array_at( json,
 										j_messages, i, &j_cmd_item ) == IOT_STATUS_SUCCESS )
 									{
+										/* read all fields in one pass */
+										const iot_json_item_t *j_fields[ TR50_MSG_PATH_COUNT ];
 										const iot_json_item_t *j_id;
-										j_id = iot_json_decode_object_find(
-											json, j_cmd_item, "id" );
+										const iot_status_t path_result =
+											iot_json_path_extract( json, j_cmd_item,
+												data->msg_paths, TR50_MSG_PATH_COUNT,
+												j_fields );
+
+										/* missing fields are reported below */
+										if ( path_result != IOT_STATUS_SUCCESS &&
+											path_result != IOT_STATUS_NOT_FOUND )
+										{
+											IOT_LOG( data->lib, IOT_LOG_ERROR,
+												"tr50: failed to read message fields: %s",
+												iot_error( path_result ) );
+											os_memzero( j_fields,
+												sizeof( j_fields ) );
+										}
+
+										j_id = j_fields[ TR50_MSG_PATH_ID ];
 										if ( !j_id )
 											IOT_LOG( data->lib, IOT_LOG_WARNING,
 												"\"%s\" not found!", "id" );
 
-										j_params = iot_json_decode_object_find(
-											json, j_cmd_item, "params" );
+										j_params = j_fields[ TR50_MSG_PATH_PARAMS ];
 										if ( !j_params )
 											IOT_LOG( data->lib, IOT_LOG_WARNING,
 												"\"%s\" not found!", "params" );
 
 										if ( j_id && j_params )
 										{
-											const iot_json_item_t *j_method;
+											const iot_json_item_t *const j_method =
+												j_fields[ TR50_MSG_PATH_METHOD ];
 											const iot_json_object_iterator_t *iter;
 											iot_action_request_t *req = NULL;
 
-											j_method = iot_json_decode_object_find(
-												json, j_params, "method" );
 											if ( j_method )
 											{
 												char id[ IOT_ID_MAX_LEN + 1u ];
@@ -2236,8 +4169,7 @@ void tr50_on_message(
 											}
 
 											/* for each parameter */
-											j_params = iot_json_decode_object_find(
-												json, j_params, "params" );
+											j_params = j_fields[ TR50_MSG_PATH_ARGS ];
 											iter = iot_json_decode_object_iterator(
 												json, j_params );
 											while ( iter )
@@ -2339,19 +4271,30 @@ void tr50_on_message(
 										== IOT_JSON_TYPE_INTEGER )
 										iot_json_decode_integer( json, j_obj, &fileSize );
 
-									if ( msg_id > 0 && (unsigned int)msg_id >= TR50_FILE_REQUEST_ID_OFFSET &&
-										(unsigned int)msg_id - TR50_FILE_REQUEST_ID_OFFSET < TR50_FILE_TRANSFER_MAX )
+									if ( msg_id > 0 && (unsigned int)msg_id >= TR50_FILE_REQUEST_ID_OFFSET )
 									{
-										transfer = &data->file_transfer_queue[(unsigned int)msg_id - TR50_FILE_REQUEST_ID_OFFSET];
-										if ( transfer->path[0] )
+#ifdef IOT_THREAD_SUPPORT
+										os_thread_mutex_lock( &data->transfer_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+										for ( transfer = data->file_transfer_queue;
+											transfer && transfer->id != (unsigned int)msg_id;
+											transfer = transfer->next );
+										if ( transfer && transfer->state == TR50_FILE_TRANSFER_REQUESTED )
 										{
 											/* determine host name from config file */
 											const char *host = NULL;
+											size_t url_len;
 											iot_config_get( data->lib,
 												"cloud.host", IOT_FALSE,
 												IOT_TYPE_STRING, &host );
-											os_snprintf( transfer->url, PATH_MAX,
-												"https://%s/file/%.*s", host, (int)v_len, v );
+											if ( !host )
+												host = "";
+											url_len = os_strlen( host ) + v_len +
+												sizeof( "https:///file/" );
+											transfer->url = (char *)os_malloc( url_len );
+											if ( transfer->url )
+												os_snprintf( transfer->url, url_len,
+													"https://%s/file/%.*s", host, (int)v_len, v );
 											transfer->crc32 = (iot_uint64_t)crc32;
 											transfer->size = (iot_uint64_t)fileSize;
 											transfer->retry_time = 0u;
@@ -2360,25 +4303,31 @@ void tr50_on_message(
 												TR50_FILE_TRANSFER_EXPIRY_TIME;
 											transfer->max_retries =
 												IOT_TRANSFER_MAX_RETRIES;
+											transfer->state =
+												TR50_FILE_TRANSFER_PENDING;
 											found_transfer = IOT_TRUE;
+											if ( !transfer->url )
+											{
+												transfer->result =
+													IOT_STATUS_NO_MEMORY;
+												transfer->state =
+													TR50_FILE_TRANSFER_COMPLETE;
+												found_transfer = IOT_FALSE;
+											}
 										}
+#ifdef IOT_THREAD_SUPPORT
+										os_thread_mutex_unlock( &data->transfer_mutex );
+#endif /* ifdef IOT_THREAD_SUPPORT */
 									}
 
 									if ( found_transfer )
 									{
 #if defined( IOT_THREAD_SUPPORT )
-										os_thread_t thread;
-										size_t stack_size = 0u;
-
-#if defined( __VXWORKS__ )
-										stack_size = deviceCloudStackSizeGet();
-#endif /* if defined( __VXWORKS__ ) */
-
-										/* Create a thread to do the file transfer */
-										if ( os_thread_create( &thread, tr50_file_transfer, transfer, stack_size ) )
+										/* hand the transfer to the transfer thread */
+										if ( tr50_file_transfer_wakeup( data ) != IOT_STATUS_SUCCESS )
 											IOT_LOG( data->lib, IOT_LOG_ERROR,
-												"Failed to create a thread to transfer "
-												"file for message #%u", (unsigned int)msg_id );
+												"Failed to start transfer "
+												"of file for message #%u", (unsigned int)msg_id );
 #endif /* if defined( IOT_THREAD_SUPPORT ) */
 									}
 								}
@@ -2386,12 +4335,44 @@ void tr50_on_message(
 						}
 					}
 				}
+
+				/* batched messages contain a reply for each command */
+				root_iter = iot_json_decode_object_iterator_next(
+					json, root, root_iter );
+				while ( root_iter )
+				{
+					const iot_json_item_t *j_success = NULL;
+					iot_bool_t is_success = IOT_FALSE;
+
+					iot_json_decode_object_iterator_key(
+						json, root, root_iter,
+						&v, &v_len );
+					os_snprintf( name, IOT_NAME_MAX_LEN, "%.*s", (int)v_len, v );
+					msg_id = os_atoi( name );
+					j_obj = NULL;
+					iot_json_decode_object_iterator_value(
+						json, root, root_iter, &j_obj );
+					if ( j_obj )
+						j_success = iot_json_decode_object_find( json,
+							j_obj, "success" );
+					if ( j_success && msg_id > 0 && msg_id < 256 )
+					{
+						iot_json_decode_bool( json, j_success, &is_success );
+						tr50_transaction_status_set( data, (iot_uint8_t)msg_id,
+							( is_success ? TR50_TRANSACTION_SUCCESS :
+								TR50_TRANSACTION_FAILURE ) );
+					}
+					root_iter = iot_json_decode_object_iterator_next(
+						json, root, root_iter );
+				}
 			}
 		}
 		else
 			IOT_LOG( data->lib, IOT_LOG_TRACE, "tr50: %s",
 				"message received on unknown topic" );
+#ifdef IOT_STACK_ONLY
 		iot_json_decode_terminate( json );
+#endif /* ifdef IOT_STACK_ONLY */
 	}
 	else if ( data )
 		IOT_LOG( data->lib, IOT_LOG_ERROR, "tr50: %s",
@@ -2713,11 +4694,60 @@ iot_status_t tr50_terminate(
 	iot_status_t result = IOT_STATUS_SUCCESS;
 	struct tr50_data *data = plugin_data;
 	IOT_LOG( lib, IOT_LOG_TRACE, "tr50: %s", "terminate" );
-#ifdef IOT_THREAD_SUPPORT
-	os_thread_mutex_destroy( &data->mail_check_mutex );
-#endif /* IOT_THREAD_SUPPORT */
 	if ( data )
 	{
+#ifdef IOT_THREAD_SUPPORT
+		/* stop the acknowledgement timer thread */
+		os_thread_mutex_lock( &data->ack_mutex );
+		if ( data->ack_running != IOT_FALSE )
+		{
+			data->ack_running = IOT_FALSE;
+			os_thread_mutex_unlock( &data->ack_mutex );
+			os_thread_condition_signal( &data->ack_signal,
+				&data->ack_mutex );
+			os_thread_wait( &data->ack_thread );
+			os_thread_destroy( &data->ack_thread );
+		}
+		else
+			os_thread_mutex_unlock( &data->ack_mutex );
+		os_thread_condition_destroy( &data->ack_signal );
+		os_thread_mutex_destroy( &data->mail_check_mutex );
+		os_thread_mutex_destroy( &data->ack_mutex );
+
+		/* stop the file transfer thread */
+		os_thread_mutex_lock( &data->transfer_mutex );
+		if ( data->transfer_running != IOT_FALSE )
+		{
+			data->transfer_running = IOT_FALSE;
+#if LIBCURL_VERSION_NUM >= 0x074400
+			curl_multi_wakeup( data->transfer_multi );
+#endif /* LIBCURL_VERSION_NUM >= 0x074400 */
+			os_thread_mutex_unlock( &data->transfer_mutex );
+			os_thread_wait( &data->transfer_thread );
+			os_thread_destroy( &data->transfer_thread );
+		}
+		else
+			os_thread_mutex_unlock( &data->transfer_mutex );
+		if ( data->transfer_multi )
+			curl_multi_cleanup( data->transfer_multi );
+		while ( data->transfer_pool_count > 0u )
+			curl_easy_cleanup(
+				data->transfer_pool[--data->transfer_pool_count] );
+		if ( data->transfer_share )
+			curl_share_cleanup( data->transfer_share );
+		os_thread_mutex_destroy( &data->transfer_mutex );
+#endif /* IOT_THREAD_SUPPORT */
+		while ( data->file_transfer_queue )
+		{
+			struct tr50_file_transfer *const transfer =
+				data->file_transfer_queue;
+			data->file_transfer_queue = transfer->next;
+			tr50_file_transfer_free( transfer );
+		}
+#ifndef IOT_STACK_ONLY
+		if ( data->msg_decoder )
+			iot_json_decode_terminate( data->msg_decoder );
+#endif /* ifndef IOT_STACK_ONLY */
 		os_free( data );
 		data = NULL;
 	}
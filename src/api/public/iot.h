@@ -622,6 +622,26 @@ IOT_API IOT_SECTION iot_status_t iot_action_option_set_raw(
 	size_t length,
 	const void *ptr );
 
+/**
+ * @brief Sets the maximum number of requests for an action that may run at
+ *        once
+ *
+ * Requests over the limit wait in the queue, while requests for other
+ * actions continue to run.
+ *
+ * @param[in,out]  action              action to set the limit for
+ * @param[in]      max_running         maximum requests running at once
+ *                                     (0 = unlimited)
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed
+ * @retval IOT_STATUS_SUCCESS          limit was successfully set
+ *
+ * @see iot_action_group_set
+ */
+IOT_API IOT_SECTION iot_status_t iot_action_concurrency_set(
+	iot_action_t *action,
+	iot_uint16_t max_running );
+
 /**
  * @brief Deregisters an action from an agent
  *
@@ -662,6 +682,31 @@ IOT_API IOT_SECTION iot_status_t iot_action_free(
 	iot_action_t *action,
 	iot_millisecond_t max_time_out );
 
+/**
+ * @brief Adds an action to a group sharing a concurrency limit
+ *
+ * The limit applies to the requests of all actions in the group combined, in
+ * addition to any limit of the action itself.  The group is created the first
+ * time it is named, naming it again updates its limit.  The group of an action
+ * may be changed while its requests are running, they then count against the
+ * new group.
+ *
+ * @param[in,out]  action              action to add to the group
+ * @param[in]      group               name of the group
+ * @param[in]      max_running         maximum requests in the group running
+ *                                     at once (0 = unlimited)
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed
+ * @retval IOT_STATUS_FULL             maximum number of groups reached
+ * @retval IOT_STATUS_SUCCESS          action was successfully added
+ *
+ * @see iot_action_concurrency_set
+ */
+IOT_API IOT_SECTION iot_status_t iot_action_group_set(
+	iot_action_t *action,
+	const char *group,
+	iot_uint16_t max_running );
+
 /**
  * @brief Adds a parameter to an action
  *
@@ -855,6 +900,24 @@ IOT_API IOT_SECTION iot_action_request_t *iot_action_request_allocate(
 	const char *name,
 	const char *source );
 
+/**
+ * @brief returns whether an action request should stop
+ *
+ * Long running action callbacks should poll this and return as soon as
+ * possible once it returns @c IOT_TRUE.  A request is cancelled once it
+ * exceeds the time limit of its action (its completion has then already been
+ * reported as timed out), or when the library is stopping.
+ *
+ * @param[in]      request             request to check
+ *
+ * @retval IOT_FALSE                   request may continue
+ * @retval IOT_TRUE                    request is cancelled, or is invalid
+ *
+ * @see iot_action_time_limit_set
+ */
+IOT_API IOT_SECTION iot_bool_t iot_action_request_cancelled(
+	const iot_action_request_t *request );
+
 /**
  * @brief Returns the value of a action request option
  *
@@ -1383,6 +1446,15 @@ IOT_API IOT_SECTION iot_status_t iot_event_publish(
  * @param[in]      lib                 library handle
  * @param[out]     txn                 transaction status (optional)
  * @param[in]      options             options for file download (optional)
+ *                                     the "priority" option sets the
+ *                                     importance of the transfer: 0 for a
+ *                                     background transfer (paused while
+ *                                     others are in progress), 1 normal
+ *                                     (default), 2 urgent.  The
+ *                                     "sequential" option writes the file
+ *                                     in order, to file_path with ".part"
+ *                                     appended until it is complete, so
+ *                                     that it can be read as it downloads
  * @param[in]      file_name           cloud's file name to get (optional)
  *                                     if file name is not given, local file
  *                                     name will be used
@@ -1443,6 +1515,11 @@ IOT_API IOT_SECTION iot_status_t iot_file_progress_get(
  * @param[in]      lib                 library handle
  * @param[out]     txn                 transaction status (optional)
  * @param[in]      options             options for file upload (optional)
+ *                                     the "priority" option sets the
+ *                                     importance of the transfer: 0 for a
+ *                                     background transfer (paused while
+ *                                     others are in progress), 1 normal
+ *                                     (default), 2 urgent
  * @param[in]      file_name           cloud's file name to send (optional)
  *                                     if file name is not given, local file
  *                                     name will be used, if it is a directory,
@@ -1453,7 +1530,10 @@ IOT_API IOT_SECTION iot_status_t iot_file_progress_get(
  *                                     be relative to default upload directory.
  *                                     if it is a directory instead of a file,
  *                                     all files within that directory will be
- *                                     bundled together.
+ *                                     bundled together in a tar archive, as
+ *                                     it is uploaded.  The "compression"
+ *                                     option ("gzip" or "zstd") compresses
+ *                                     the archive.
  * @param[in]      func                callback function to give
  *                                     progress update (optional)
  *                                     if none is given, progress will
@@ -21,6 +21,17 @@
 #include <iot.h>
 #include <os.h>
 
+/** @brief Size of a CRC32 digest in bytes */
+#define IOT_CHECKSUM_CRC32_SIZE                  4u
+/** @brief Size of a MD5 digest in bytes */
+#define IOT_CHECKSUM_MD5_SIZE                    16u
+/** @brief Size of a SHA256 digest in bytes */
+#define IOT_CHECKSUM_SHA256_SIZE                 32u
+/** @brief Size of the largest digest in bytes */
+#define IOT_CHECKSUM_SIZE_MAX                    IOT_CHECKSUM_SHA256_SIZE
+/** @brief Size of a digest as a hexadecimal string (excluding terminator) */
+#define IOT_CHECKSUM_HEX_SIZE( size )            ( (size) * 2u )
+
 /** @brief type checksum algorithm supported */
 typedef enum iot_checksum_type
 {
@@ -32,15 +43,98 @@ typedef enum iot_checksum_type
 	IOT_CHECKSUM_TYPE_SHA256
 } iot_checksum_type_t;
 
+/**
+ * @brief context for calculating a checksum incrementally, as data is
+ *        streamed
+ *
+ * Several contexts can be updated together, in a single pass over the
+ * data, using @p iot_checksum_update_multiple or
+ * @p iot_checksum_path_update.
+ *
+ * @see iot_checksum_initialize
+ * @see iot_checksum_update
+ * @see iot_checksum_digest_get
+ */
+typedef struct iot_checksum_context
+{
+	/** @brief checksum algorithm in use */
+	iot_checksum_type_t type;
+	/** @brief running state of the algorithm */
+	union
+	{
+		/** @brief CRC32 value of the data so far */
+		iot_uint32_t crc32;
+		/** @brief state of the block based algorithms (MD5, SHA256) */
+		struct
+		{
+			/** @brief hash value of the blocks so far */
+			iot_uint32_t h[8u];
+			/** @brief total number of bytes added */
+			iot_uint64_t length;
+			/** @brief data waiting for a block to be filled */
+			unsigned char block[64u];
+		} digest;
+	} state;
+} iot_checksum_context_t;
+
+/**
+ * @brief Returns the digest of the data added to a checksum calculation
+ *
+ * The context is not modified, so more data can be added afterwards.
+ * CRC32 digests are returned in big-endian (network) byte order.
+ *
+ * @param[in]      ctx                 checksum context
+ * @param[out]     digest              buffer to hold the digest
+ * @param[in]      len                 size of the buffer
+ * @param[out]     digest_len          size of the digest (optional)
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_FULL             buffer is too small for the digest
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_digest_hex_get
+ */
+iot_status_t iot_checksum_digest_get(
+	const iot_checksum_context_t *ctx,
+	unsigned char *digest,
+	size_t len,
+	size_t *digest_len );
+
+/**
+ * @brief Returns the digest of the data added to a checksum calculation as
+ *        a null-terminated, lower-case hexadecimal string
+ *
+ * @param[in]      ctx                 checksum context
+ * @param[out]     hex                 buffer to hold the string
+ * @param[in]      len                 size of the buffer
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_FULL             buffer is too small for the digest
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_digest_get
+ */
+iot_status_t iot_checksum_digest_hex_get(
+	const iot_checksum_context_t *ctx,
+	char *hex,
+	size_t len );
+
 /**
  * @brief Calculates the checksum of a file
  *
+ * @note only CRC32 fits in the integer returned, use
+ *       @p iot_checksum_file_update and @p iot_checksum_digest_get for the
+ *       other algorithms
+ *
  * @param[in]      lib                 library handle
  * @param[in]      file                handle to an open file
  * @param[in]      type                checksum algorithm to use
  * @param[out]     checksum            checksum output
  *
  * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
  * @retval IOT_STATUS_SUCCESS          on success
  */
 iot_status_t iot_checksum_file_get(
@@ -49,4 +143,128 @@ iot_status_t iot_checksum_file_get(
 	iot_checksum_type_t type,
 	iot_uint64_t *checksum );
 
+/**
+ * @brief Adds the rest of an open file to one or more checksum calculations,
+ *        in a single pass over the file
+ *
+ * The file is read from its current position to its end.
+ *
+ * @param[in]      file                handle to an open file
+ * @param[in,out]  ctx                 checksum contexts to update
+ * @param[in]      count               number of contexts
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_IO_ERROR         failed to read the file
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_path_update
+ */
+iot_status_t iot_checksum_file_update(
+	os_file_t file,
+	iot_checksum_context_t *ctx,
+	size_t count );
+
+/**
+ * @brief Completes an incremental checksum calculation
+ *
+ * @note only CRC32 fits in the integer returned, use
+ *       @p iot_checksum_digest_get for the other algorithms
+ *
+ * @param[in]      ctx                 checksum context
+ * @param[out]     checksum            checksum of all the data added
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_initialize
+ * @see iot_checksum_update
+ */
+iot_status_t iot_checksum_finalize(
+	const iot_checksum_context_t *ctx,
+	iot_uint64_t *checksum );
+
+/**
+ * @brief Starts an incremental checksum calculation
+ *
+ * @param[out]     ctx                 checksum context to initialize
+ * @param[in]      type                checksum algorithm to use
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_finalize
+ * @see iot_checksum_update
+ */
+iot_status_t iot_checksum_initialize(
+	iot_checksum_context_t *ctx,
+	iot_checksum_type_t type );
+
+/**
+ * @brief Adds the contents of a file to one or more checksum calculations,
+ *        in a single pass over the file
+ *
+ * Where the operating system supports it the file is mapped into memory
+ * instead of being copied into a buffer.
+ *
+ * @param[in]      path                path of the file
+ * @param[in,out]  ctx                 checksum contexts to update
+ * @param[in]      count               number of contexts
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_FILE_OPEN_FAILED failed to open the file
+ * @retval IOT_STATUS_IO_ERROR         failed to read the file
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_file_update
+ * @see iot_checksum_update_multiple
+ */
+iot_status_t iot_checksum_path_update(
+	const char *path,
+	iot_checksum_context_t *ctx,
+	size_t count );
+
+/**
+ * @brief Adds data to an incremental checksum calculation
+ *
+ * @param[in,out]  ctx                 checksum context
+ * @param[in]      buf                 data to add
+ * @param[in]      len                 number of bytes in the data
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_finalize
+ * @see iot_checksum_initialize
+ */
+iot_status_t iot_checksum_update(
+	iot_checksum_context_t *ctx,
+	const void *buf,
+	size_t len );
+
+/**
+ * @brief Adds data to several checksum calculations at once (for example
+ *        CRC32 and SHA256), in a single pass over the data
+ *
+ * @param[in,out]  ctx                 checksum contexts to update
+ * @param[in]      count               number of contexts
+ * @param[in]      buf                 data to add
+ * @param[in]      len                 number of bytes in the data
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to function
+ * @retval IOT_STATUS_NOT_SUPPORTED    checksum algorithm not supported
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_checksum_update
+ */
+iot_status_t iot_checksum_update_multiple(
+	iot_checksum_context_t *ctx,
+	size_t count,
+	const void *buf,
+	size_t len );
+
 #endif /* IOT_CHECKSUM_H */
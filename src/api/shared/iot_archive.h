@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief Contains definitions for archiving a directory as it is uploaded
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#ifndef IOT_ARCHIVE_H
+#define IOT_ARCHIVE_H
+
+#include "iot.h" /* for IOT_API, IOT_SECTION definitions */
+#include <os.h>  /* for size_t */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* ifdef __cplusplus */
+
+/**
+ * @brief Largest amount of a file archived at once
+ *
+ * The archive is only produced when it is read, one piece at a time, so at
+ * most this much file data (plus the blocks and compression state of
+ * libarchive) is held in memory by a stream.
+ */
+#define IOT_ARCHIVE_STEP_SIZE                    16384u
+
+/**
+ * @brief Format of an archive produced from a directory
+ */
+typedef enum
+{
+	/** @brief Not an archive, the path is a regular file */
+	IOT_ARCHIVE_NONE = 0,
+	/** @brief Uncompressed tar archive (".tar") */
+	IOT_ARCHIVE_TAR,
+	/** @brief tar archive compressed with gzip (".tar.gz") */
+	IOT_ARCHIVE_TAR_GZIP,
+	/** @brief tar archive compressed with zstd (".tar.zst") */
+	IOT_ARCHIVE_TAR_ZSTD
+} iot_archive_type_t;
+
+/** @brief Archive of a directory, produced as it is read */
+typedef struct iot_archive_stream iot_archive_stream_t;
+
+/**
+ * @brief Returns the file name extension of an archive format
+ *
+ * @param[in]      type                archive format
+ *
+ * @return the extension (including the leading '.'), an empty string for
+ *         @ref IOT_ARCHIVE_NONE
+ */
+IOT_API IOT_SECTION const char *iot_archive_extension(
+	iot_archive_type_t type );
+
+/**
+ * @brief Closes an archive stream, releasing all of its resources
+ *
+ * @param[in]      stream              stream to close
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed
+ * @retval IOT_STATUS_FAILURE          the archive was not completed
+ * @retval IOT_STATUS_SUCCESS          the whole archive was read
+ *
+ * @see iot_archive_stream_open
+ */
+IOT_API IOT_SECTION iot_status_t iot_archive_stream_close(
+	iot_archive_stream_t *stream );
+
+/**
+ * @brief Opens a stream producing an archive of the files in a directory
+ *
+ * Nothing is written to disk: the archive is produced as the stream is
+ * read.
+ *
+ * @param[in]      path                directory to archive
+ * @param[in]      type                archive format to produce
+ *
+ * @return a stream to read the archive from, NULL on failure (or if the
+ *         compression requested is not supported by libarchive)
+ *
+ * @see iot_archive_stream_close
+ * @see iot_archive_stream_read
+ */
+IOT_API IOT_SECTION iot_archive_stream_t *iot_archive_stream_open(
+	const char *path,
+	iot_archive_type_t type );
+
+/**
+ * @brief Returns how much of the directory has been archived
+ *
+ * @note the archive size is not known before it is produced, progress is
+ *       measured in bytes of the files archived
+ *
+ * @param[in]      stream              stream to query
+ * @param[out]     done                bytes of the files archived so far
+ *                                     (optional)
+ * @param[out]     total               bytes of all files in the directory
+ *                                     when it was opened (optional)
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed
+ * @retval IOT_STATUS_FAILURE          the archive could not be produced
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+IOT_API IOT_SECTION iot_status_t iot_archive_stream_progress(
+	const iot_archive_stream_t *stream,
+	iot_uint64_t *done,
+	iot_uint64_t *total );
+
+/**
+ * @brief Reads the next part of an archive
+ *
+ * The parameters follow the convention of fread and of libcurl's read
+ * callback.  Each call produces just enough of the archive to return some
+ * data.
+ *
+ * @param[out]     buf                 destination for the archive data
+ * @param[in]      size                size of each item
+ * @param[in]      nmemb               number of items to read
+ * @param[in]      stream              stream to read from
+ *
+ * @return the number of bytes read, 0 at the end of the archive or on
+ *         failure (iot_archive_stream_progress reports which one)
+ */
+IOT_API IOT_SECTION size_t iot_archive_stream_read(
+	void *buf,
+	size_t size,
+	size_t nmemb,
+	void *stream );
+
+#ifdef __cplusplus
+}
+#endif /* ifdef __cplusplus */
+
+#endif /* ifndef IOT_ARCHIVE_H */
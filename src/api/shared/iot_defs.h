@@ -102,6 +102,8 @@
 #define IOT_TRANSFER_LOW_SPEED_LIMIT   50L
 /** @brief Curl low speed timeout in seconds */
 #define IOT_TRANSFER_LOW_SPEED_TIMEOUT 30L
+/** @brief Extension of a file while it is downloaded */
+#define IOT_TRANSFER_PART_EXTENSION    ".part"
 
 /** @brief Current item ( action or telemetry ) state */
 enum iot_item_state
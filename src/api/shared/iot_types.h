@@ -18,6 +18,7 @@
 #define IOT_TYPES_H
 
 #include "os.h"
+#include "iot_archive.h"
 #include "iot_build.h"
 #include "iot_defs.h"
 #include "iot_plugin.h"
@@ -165,6 +166,23 @@ struct iot_options
 #endif /* IOT_STACK_ONLY */
 };
 
+/** @brief Maximum number of action concurrency groups */
+#define IOT_ACTION_GROUP_MAX                     8u
+
+/**
+ * @brief a group of actions sharing a concurrency limit
+ */
+struct iot_action_group
+{
+	/** @brief group name */
+	char name[ IOT_NAME_MAX_LEN + 1u ];
+	/** @brief maximum requests in the group running at once
+	 *         (0 = unlimited) */
+	iot_uint16_t max_running;
+	/** @brief requests in the group currently running */
+	iot_uint16_t running;
+};
+
 /**
  * @brief action details
  */
@@ -194,6 +212,13 @@ struct iot_action
 	iot_uint8_t parameter_count;
 	/** @brief maximum amount of time to wait before returning failure */
 	iot_millisecond_t time_limit;
+	/** @brief maximum requests of the action running at once
+	 *         (0 = unlimited) */
+	iot_uint16_t max_running;
+	/** @brief requests of the action currently running */
+	iot_uint16_t running;
+	/** @brief group the action shares a concurrency limit with (optional) */
+	struct iot_action_group *group;
 #ifdef IOT_STACK_ONLY
 	/** @brief storage of options on the stack
 	 *
@@ -221,6 +246,27 @@ struct iot_action
 #endif /* IOT_STACK_ONLY */
 };
 
+/**
+ * @defgroup action_deadline_states Time limit states of action requests
+ * @{
+ */
+/** @brief Request has no time limit pending */
+#define IOT_ACTION_DEADLINE_NONE                 0u
+/** @brief Request is in the deadline wheel */
+#define IOT_ACTION_DEADLINE_SCHEDULED            1u
+/** @brief Request exceeded its time limit, time out being reported */
+#define IOT_ACTION_DEADLINE_EXPIRING             2u
+/** @brief Request exceeded its time limit, time out was reported */
+#define IOT_ACTION_DEADLINE_EXPIRED              3u
+/** @brief Request finished while time out was being reported */
+#define IOT_ACTION_DEADLINE_RELEASED             4u
+/** @} */
+
+/** @brief Number of slots in the deadline wheel (must be a power of 2) */
+#define IOT_ACTION_DEADLINE_SLOTS                64u
+/** @brief Time covered by each slot of the deadline wheel in milliseconds */
+#define IOT_ACTION_DEADLINE_TICK                 100u
+
 /**
  * @brief an action request from the cloud
  */
@@ -248,6 +294,15 @@ struct iot_action_request
 	iot_millisecond_t time_limit;
 	/** @brief result of the action */
 	iot_status_t result;
+	/** @brief set when the request should stop (polled by callbacks) */
+	volatile iot_bool_t cancelled;
+	/** @brief monotonic time the request exceeds its time limit
+	 *  (0 = no limit), see @ref iot_timestamp_monotonic */
+	iot_timestamp_t deadline;
+	/** @brief next request in the same deadline wheel slot */
+	struct iot_action_request *deadline_next;
+	/** @brief time limit state, see @ref action_deadline_states */
+	iot_uint8_t deadline_state;
 #ifdef IOT_STACK_ONLY
 	/** @brief error message details */
 	char _error[ IOT_NAME_MAX_LEN + 1u ];
@@ -262,7 +317,30 @@ struct iot_action_request
 	struct iot_action_parameter _parameter[ IOT_PARAMETER_MAX ];
 	/** @brief Request source from the cloud */
 	char _source[ IOT_ID_MAX_LEN + 1u];
-#endif /* IOT_STACK_ONLY */
+#else /* ifdef IOT_STACK_ONLY */
+	/** @brief number of bytes used in the arena */
+	size_t arena_used;
+	/** @brief offset of the most recent allocation in the arena */
+	size_t arena_last;
+	/**
+	 * @brief storage for the name, source, options & parameters of the
+	 *        request (the heap is used once it is full)
+	 *
+	 * @note This must be the last member, it is not cleared when the
+	 *       request is reset
+	 */
+	union
+	{
+		/** @brief aligns the arena for any value type */
+		iot_float64_t _align_float;
+		/** @brief aligns the arena for any value type */
+		iot_uint64_t _align_int;
+		/** @brief aligns the arena for any value type */
+		void *_align_ptr;
+		/** @brief arena storage */
+		char buf[ IOT_ACTION_REQUEST_ARENA_SIZE ];
+	} arena;
+#endif /* else IOT_STACK_ONLY */
 };
 
 /**
@@ -371,6 +449,8 @@ struct iot_telemetry
 /** @brief structure containing informaiton about a file upload or download */
 struct iot_file_transfer
 {
+	/** @brief format of the archive to upload, if the path is a directory */
+	iot_archive_type_t archive;
 	/** @brief progress function callback */
 	iot_file_progress_callback_t *callback;
 	/** @brief cloud's file name */
@@ -417,6 +497,24 @@ struct iot_plugin_enabled
 	iot_plugin_t                *ptr;
 };
 
+#ifdef IOT_ACTION_RUNNER
+/**
+ * @brief persistent process used to launch command actions
+ */
+struct iot_action_runner
+{
+	/** @brief socket used to send requests to the runner */
+	int                         fd;
+	/** @brief process id of the runner (0 if not yet started, -1 if
+	 *         it failed to start) */
+	int                         pid;
+#ifdef IOT_THREAD_SUPPORT
+	/** @brief lock held while the runner is started */
+	os_thread_mutex_t           lock;
+#endif /* ifdef IOT_THREAD_SUPPORT */
+};
+#endif /* ifdef IOT_ACTION_RUNNER */
+
 /**
  * @brief library connection details
  */
@@ -433,6 +531,14 @@ struct iot
 	 *       if the index is >= action_count are available for use.
 	 */
 	struct iot_action           *action_ptr[ IOT_ACTION_MAX ];
+	/** @brief concurrency groups actions can belong to */
+	struct iot_action_group     action_group[ IOT_ACTION_GROUP_MAX ];
+	/** @brief number of concurrency groups */
+	iot_uint8_t                 action_group_count;
+	/** @brief number of action requests currently running */
+	iot_uint16_t                action_running;
+	/** @brief whether an exclusive action request is running */
+	iot_bool_t                  action_exclusive_running;
 
 	/** @brief registered alarms stored on the stack */
 	struct iot_alarm            alarm[ IOT_ALARM_STACK_MAX ];
@@ -504,6 +610,14 @@ struct iot
 	struct iot_action_request   *request_queue_wait[IOT_ACTION_QUEUE_MAX];
 	/** @brief Number of action requests waiting to be processed */
 	iot_uint8_t                 request_queue_wait_count;
+	/** @brief Running requests with a time limit, by deadline tick */
+	struct iot_action_request   *deadline_wheel[IOT_ACTION_DEADLINE_SLOTS];
+	/** @brief Next deadline wheel tick to be checked */
+	iot_timestamp_t             deadline_tick;
+#ifdef IOT_ACTION_RUNNER
+	/** @brief Process for launching command actions */
+	struct iot_action_runner    action_runner;
+#endif /* ifdef IOT_ACTION_RUNNER */
 
 	/* log support */
 	/** @brief Function to call to log a message */
@@ -531,8 +645,11 @@ struct iot
 	os_thread_mutex_t           worker_mutex;
 	/** @brief Signal for waking up waiting threads */
 	os_thread_condition_t       worker_signal;
-	/** @brief Lock for commands which cannot run concurrently */
-	os_thread_rwlock_t          worker_thread_exclusive_lock;
+	/** @brief Thread reporting requests exceeding their time limit */
+	os_thread_t                 deadline_thread;
+	/** @brief Signal for waking up the deadline thread (uses the
+	 *         worker mutex) */
+	os_thread_condition_t       deadline_signal;
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 #ifdef IOT_STACK_ONLY
@@ -759,6 +876,57 @@ IOT_API IOT_SECTION iot_status_t iot_action_option_get(
 IOT_API IOT_SECTION iot_status_t iot_action_process( iot_t *lib,
 	iot_millisecond_t max_time_out );
 
+/**
+ * @brief Reports running requests that have exceeded their time limit
+ *
+ * Requests that have exceeded their time limit are cancelled (see
+ * @ref iot_action_request_cancelled) and their completion is sent with a
+ * status of @c IOT_STATUS_TIMED_OUT, without waiting for the action to return.
+ *
+ * With worker threads, this is called by a thread started with them as each
+ * deadline passes.  Without them (no thread support, or
+ * @c IOT_FLAG_SINGLE_THREAD), actions run in the thread calling
+ * @ref iot_loop_iteration, so nothing is reported while an action runs: the
+ * time limit is only enforced by actions checking
+ * @ref iot_action_request_cancelled, and by the wait for commands.
+ *
+ * @param[in,out]  lib                 library handle
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to function
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see iot_action_deadline_next
+ */
+IOT_SECTION iot_status_t iot_action_deadline_check( iot_t *lib );
+
+/**
+ * @brief Returns the earliest time limit of the running requests
+ *
+ * @note The caller must hold the worker mutex
+ *
+ * @param[in]      lib                 library handle
+ *
+ * @return monotonic time stamp of the earliest deadline, 0 if no running
+ *         request has a time limit
+ *
+ * @see iot_action_deadline_check
+ */
+IOT_SECTION iot_timestamp_t iot_action_deadline_next( const iot_t *lib );
+
+/**
+ * @brief Returns a time stamp from a clock that is not affected by changes to
+ *        the system time
+ *
+ * @note The value is only meaningful when compared to another value returned
+ *       by this function (for measuring time limits)
+ *
+ * @return the current monotonic time in milliseconds (the system time, if the
+ *         operating system has no monotonic clock)
+ *
+ * @see iot_timestamp_now
+ */
+IOT_SECTION iot_timestamp_t iot_timestamp_monotonic( void );
+
 /**
  * @brief Returns the value of a telemetry option
  *
@@ -33,10 +33,7 @@
 #include "os.h"
 #include "api/shared/iot_types.h"      /* for iot_proxy structure */
 
-#ifndef _WRS_KERNEL
-#	include "device_manager_md5.h"
-#	include "device_manager_sha256.h"
-#endif /* ifndef _WRS_KERNEL */
+#include "iot_checksum.h"          /* for digest sizes */
 #include "device_manager_ota.h"
 
 /** @brief Maximum length of a token from the web */
@@ -45,8 +42,7 @@
 #define DEVICE_MANAGER_FILE_HEADER_TOKEN_KEY_LENGTH 16u
 /** @brief Maximum length of checksum */
 #define DEVICE_MANAGER_CHECKSUM_LENGTH \
-	((DEVICE_MANAGER_SHA256_DIGEST_HEX_LENGTH) >= ( DEVICE_MANAGER_MD5_DIGEST_HEX_LENGTH ) \
-	? ( DEVICE_MANAGER_SHA256_DIGEST_HEX_LENGTH ) : ( DEVICE_MANAGER_MD5_DIGEST_HEX_LENGTH ) )
+	IOT_CHECKSUM_HEX_SIZE( IOT_CHECKSUM_SIZE_MAX )
 
 struct device_manager_info;
 
@@ -501,6 +501,11 @@ iot_status_t device_manager_actions_register(
 				DEVICE_MANAGER_FILE_CLOUD_PARAMETER_FILE_PATH,
 				IOT_PARAMETER_IN, IOT_TYPE_STRING, 0u );
 
+			/* limit transfers running at once */
+			iot_action_group_set( action->ptr,
+				DEVICE_MANAGER_FILE_TRANSFER_GROUP,
+				DEVICE_MANAGER_FILE_TRANSFER_MAX_RUNNING );
+
 			result = iot_action_register_callback( action->ptr,
 				&device_manager_file_download, device_manager, NULL, 0u );
 
@@ -537,6 +542,11 @@ iot_status_t device_manager_actions_register(
 				DEVICE_MANAGER_FILE_CLOUD_PARAMETER_FILE_PATH,
 				IOT_PARAMETER_IN, IOT_TYPE_STRING, 0u );
 
+			/* limit transfers running at once */
+			iot_action_group_set( action->ptr,
+				DEVICE_MANAGER_FILE_TRANSFER_GROUP,
+				DEVICE_MANAGER_FILE_TRANSFER_MAX_RUNNING );
+
 			result = iot_action_register_callback( action->ptr,
 				&device_manager_file_upload, device_manager, NULL, 0u );
 			if ( result != IOT_STATUS_SUCCESS )
@@ -47,6 +47,11 @@
 /** @brief Flag to enable remote login related actions */
 #define DEVICE_MANAGER_ENABLE_REMOTE_LOGIN            0x0100
 
+/** @brief Name of the group sharing the file transfer concurrency limit */
+#define DEVICE_MANAGER_FILE_TRANSFER_GROUP            "file_transfer"
+/** @brief Maximum number of file transfer actions running at once */
+#define DEVICE_MANAGER_FILE_TRANSFER_MAX_RUNNING      4u
+
 /**
  * @brief Index of various default device manager functions in the global
  *        structure
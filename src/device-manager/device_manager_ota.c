@@ -30,7 +30,61 @@
 #define DEVICE_MANAGER_OTA_PKG_PARAM   "package"
 /** @brief Name of the parameter for download timeout */
 #define DEVICE_MANAGER_OTA_TIMEOUT     "ota_timeout"
+/** @brief Size of each block read from a package as it downloads */
+#define DEVICE_MANAGER_OTA_STREAM_BLOCK 10240u
+/** @brief Time to wait for more of a package to download (milliseconds) */
+#define DEVICE_MANAGER_OTA_STREAM_WAIT 100u
 
+#if ARCHIVE_VERSION_NUMBER < 4000000
+/** @brief Signed size type used by libarchive callbacks */
+#define DEVICE_MANAGER_OTA_SSIZE_T     __LA_SSIZE_T
+#else
+/** @brief Signed size type used by libarchive callbacks */
+#define DEVICE_MANAGER_OTA_SSIZE_T     la_ssize_t
+#endif
+
+/**
+ * @brief Result of an OTA package download, set by its progress callback
+ */
+struct device_manager_ota_download
+{
+	/** @brief Whether the action stopped waiting for the download, the
+	 *         progress callback then frees it once completed */
+	iot_bool_t abandoned;
+	/** @brief Whether the download has completed */
+	iot_bool_t completed;
+	/** @brief Result of the download, once completed */
+	iot_status_t status;
+#ifdef IOT_THREAD_SUPPORT
+	/** @brief Lock protecting the result (set by another thread) */
+	os_thread_mutex_t lock;
+#endif /* ifdef IOT_THREAD_SUPPORT */
+};
+
+/**
+ * @brief OTA package that is extracted as it downloads
+ *
+ * The package is downloaded in order to its path followed by
+ * @ref IOT_TRANSFER_PART_EXTENSION, and renamed to its path once its
+ * checksum was verified.  The extraction reads it as it grows.
+ */
+struct device_manager_ota_stream
+{
+	/** @brief Last block read from the package */
+	char buf[ DEVICE_MANAGER_OTA_STREAM_BLOCK ];
+	/** @brief Handle of the package being read */
+	os_file_t file;
+	/** @brief Path of the package while it downloads */
+	char part_path[ PATH_MAX + 1u ];
+	/** @brief Path of the package once downloaded */
+	const char *path;
+	/** @brief Download of the package */
+	struct device_manager_ota_download *download;
+	/** @brief Request that started the update */
+	const iot_action_request_t *request;
+	/** @brief Time to stop waiting for the download (0 = none) */
+	iot_timestamp_t deadline;
+};
 
 /**
  * @brief Callback function to handle ota action
@@ -54,12 +108,35 @@ static iot_status_t device_manager_ota( iot_action_request_t *request,
  * @retval ARCHIVE_OK              on success
  */
 int device_manager_ota_copy_data(struct archive *ar, struct archive *aw);
+/**
+ * @brief Returns whether the download of an OTA package has completed
+ *
+ * @param[in,out]  download            download to check
+ * @param[out]     status              result of the download, if completed
+ *
+ * @retval IOT_FALSE                   download is still in progress
+ * @retval IOT_TRUE                    download has completed
+ */
+static iot_bool_t device_manager_ota_download_completed(
+	struct device_manager_ota_download *download,
+	iot_status_t *status );
+/**
+ * @brief Releases the download of an OTA package
+ *
+ * A download that has not completed is left to be freed by its progress
+ * callback.
+ *
+ * @param[in,out]  download            download to release
+ */
+static void device_manager_ota_download_release(
+	struct device_manager_ota_download *download );
 /**
  * @brief Execute ota install
  *
+ * @note the package must already be extracted to @p package_path
+ *
  * @param[in]  device_manager_info  pointer to device manager data structure
  * @param[in]  package_path         pointer to ota package directory
- * @param[in]  file_name            pointer to ota package name
  *
  * @retval IOT_STATUS_BAD_PARAMETER    on failure
  * @retval IOT_STATUS_FAILURE          on failure
@@ -67,7 +144,7 @@ int device_manager_ota_copy_data(struct archive *ar, struct archive *aw);
  */
  iot_status_t device_manager_ota_install_execute(
 	struct device_manager_info *device_manager_info,
-	const char *package_path, const char* file_name );
+	const char *package_path );
 /**
  * @brief  parameter adjustment
  *
@@ -83,27 +160,66 @@ int device_manager_ota_copy_data(struct archive *ar, struct archive *aw);
  * @brief  Extracts an OTA package
  *
  * @param[in,out]  iot_lib             library handle
- * @param[in]      package_path        path to the package
- * @param[in]      file_name           extraction file name
+ * @param[in]      package_path        path to extract the package to
+ * @param[in,out]  stream              package being downloaded
  *
  * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to function
  * @retval IOT_STATUS_FAILURE          system failure
  * @retval IOT_STATUS_SUCCESS          on success
  */
 static iot_status_t device_manager_ota_extract_package(
-	iot_t *iot_lib, const char *package_path, const char *file_name );
+	iot_t *iot_lib, const char *package_path,
+	struct device_manager_ota_stream *stream );
 /**
  * @brief Function to extract ota package
  *
  * @param[in,out]  iot_lib             library handle
- * @param[in]      sw_update_package        ota package file
+ * @param[in,out]  stream              package being downloaded
  *
  * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to function
  * @retval IOT_STATUS_FAILURE          system failure
  * @retval IOT_STATUS_SUCCESS          on success
  */
 iot_status_t device_manager_ota_extract_package_perform(
-	iot_t *iot_lib, const char * sw_update_package );
+	iot_t *iot_lib, struct device_manager_ota_stream *stream );
+/**
+ * @brief Closes a package read as it downloads (libarchive close callback)
+ *
+ * @param[in]      a                   archive being read
+ * @param[in,out]  client_data         package being downloaded
+ *
+ * @retval ARCHIVE_OK                  on success
+ */
+static int device_manager_ota_stream_close( struct archive *a,
+	void *client_data );
+/**
+ * @brief Reads the next block of a package as it downloads (libarchive
+ *        read callback)
+ *
+ * Waits for more of the package to be downloaded, the end of the package
+ * is reached once its download completed.
+ *
+ * @param[in,out]  a                   archive being read
+ * @param[in,out]  client_data         package being downloaded
+ * @param[out]     buff                block read
+ *
+ * @retval >0                          number of bytes read
+ * @retval 0                           end of the package
+ * @retval ARCHIVE_FATAL               the download failed
+ */
+static DEVICE_MANAGER_OTA_SSIZE_T device_manager_ota_stream_read(
+	struct archive *a, void *client_data, const void **buff );
+/**
+ * @brief Waits for more of a package to download
+ *
+ * @param[in]      stream              package being downloaded
+ *
+ * @retval IOT_STATUS_EXECUTION_ERROR  the request was cancelled
+ * @retval IOT_STATUS_SUCCESS          waited, the download may continue
+ * @retval IOT_STATUS_TIMED_OUT        the download took too long
+ */
+static iot_status_t device_manager_ota_stream_wait(
+	const struct device_manager_ota_stream *stream );
 
 iot_status_t device_manager_ota_deregister(
 	struct device_manager_info  *device_manager )
@@ -190,13 +306,31 @@ static void device_manager_ota_progress(
 		const iot_file_progress_t *progress,
 		void *user_data)
 {
-	iot_file_progress_t *ctx = (iot_file_progress_t *)user_data;
+	struct device_manager_ota_download *download =
+		(struct device_manager_ota_download *)user_data;
 	printf("%s status %d completed %d\n", __func__,progress->status, (int) progress->completed);
 	if ( progress->completed == IOT_TRUE)
 	{
-		/* Optional: check the status for these in the calling function */
-		ctx->completed = progress->completed;
-		ctx->status = progress->status;
+		iot_bool_t abandoned;
+		/* read by the action while the package is extracted */
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_lock( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		download->status = progress->status;
+		download->completed = progress->completed;
+		abandoned = download->abandoned;
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_unlock( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+
+		/* the action stopped waiting for it */
+		if ( abandoned != IOT_FALSE )
+		{
+#ifdef IOT_THREAD_SUPPORT
+			os_thread_mutex_destroy( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+			os_free( download );
+		}
 	}
 
 }
@@ -238,6 +372,38 @@ iot_status_t device_manager_ota( iot_action_request_t *request, void *user_data
 			char local_archive_path[ PATH_MAX + 1u ];
 			char sw_update_log[  PATH_MAX + 1u ];
 			char runtime_dir[ PATH_MAX + 1u];
+			iot_int64_t ota_timeout = 0;
+			iot_bool_t download_started = IOT_FALSE;
+			/* shared with the progress callback, which can outlive
+			 * this action if it stops waiting */
+			struct device_manager_ota_download *const download =
+				os_malloc( sizeof(
+					struct device_manager_ota_download ) );
+			/* holds a block of the package, too large for the
+			 * stack of an action worker thread */
+			struct device_manager_ota_stream *const stream =
+				os_malloc( sizeof(
+					struct device_manager_ota_stream ) );
+
+			if ( download )
+			{
+				os_memzero( download, sizeof(
+					struct device_manager_ota_download ) );
+				download->status = IOT_STATUS_FAILURE;
+#ifdef IOT_THREAD_SUPPORT
+				os_thread_mutex_create( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+			}
+			if ( stream )
+				os_memzero( stream, sizeof(
+					struct device_manager_ota_stream ) );
+
+			/* optional limit on the download time (seconds) */
+			if ( iot_action_parameter_get( request,
+				DEVICE_MANAGER_OTA_TIMEOUT, IOT_TRUE,
+				IOT_TYPE_INT64, &ota_timeout ) !=
+				IOT_STATUS_SUCCESS )
+				ota_timeout = 0;
 
 			printf( "Value for parameter: %s = %s\n",
 				DEVICE_MANAGER_OTA_PKG_PARAM,
@@ -248,8 +414,11 @@ iot_status_t device_manager_ota( iot_action_request_t *request, void *user_data
 
 			/* set the software update and package download directories */
 			result = IOT_STATUS_FAILURE;
-			if ( OS_STATUS_SUCCESS == os_make_path( sw_update_dir,
-				PATH_MAX, runtime_dir, "update", NULL ) )
+			if ( !download || !stream )
+				result = IOT_STATUS_NO_MEMORY;
+			else if ( OS_STATUS_SUCCESS == os_make_path(
+				sw_update_dir, PATH_MAX, runtime_dir, "update",
+				NULL ) )
 			{
 				/*
 				 * Create update directory before starting.
@@ -271,14 +440,10 @@ iot_status_t device_manager_ota( iot_action_request_t *request, void *user_data
 			}
 			if ( result == IOT_STATUS_SUCCESS )
 			{
-				iot_file_progress_t ctx;
 				iot_options_t *const options =
 					iot_options_allocate(
 						device_manager_info->iot_lib );
 
-				os_memset(&ctx, 0,sizeof(iot_file_progress_t));
-				ctx.status = IOT_STATUS_FAILURE;
-
 				IOT_LOG( iot_lib, IOT_LOG_DEBUG,
 					"Checking global file store for pkg: %s download to %s\n",
 					file_to_download, sw_update_dir);
@@ -287,6 +452,11 @@ iot_status_t device_manager_ota( iot_action_request_t *request, void *user_data
 				 * parameter to the cb */
 				iot_options_set_bool( options, "global",
 					IOT_TRUE );
+				/* the package is extracted as it downloads: have
+				 * it written in order, ahead of other transfers */
+				iot_options_set_bool( options, "sequential",
+					IOT_TRUE );
+				iot_options_set_integer( options, "priority", 2 );
 
 				/* Setup the local path */
 				os_snprintf(local_archive_path, PATH_MAX,
@@ -303,32 +473,84 @@ iot_status_t device_manager_ota( iot_action_request_t *request, void *user_data
 						options,
 						file_to_download,
 						local_archive_path,
-						&device_manager_ota_progress, &ctx);
+						&device_manager_ota_progress, download);
 				iot_options_free( options );
+				if ( result == IOT_STATUS_SUCCESS )
+					download_started = IOT_TRUE;
 			}
 			if ( result == IOT_STATUS_SUCCESS)
 			{
-				iot_bool_t done = IOT_FALSE;
+				iot_status_t download_status = IOT_STATUS_FAILURE;
+				iot_status_t wait_status = IOT_STATUS_SUCCESS;
 
-				/* need to wait for the file to arrive */
-				do {
-					if ( os_file_exists(local_archive_path))
-						done = IOT_TRUE;
-					else
-						os_time_sleep(1000, IOT_FALSE);
-
-					IOT_LOG( iot_lib, IOT_LOG_DEBUG,
-						"Waiting for file %s\n", local_archive_path);
+				/* extract the package while it downloads */
+				os_snprintf( stream->part_path, PATH_MAX, "%s%s",
+					local_archive_path,
+					IOT_TRANSFER_PART_EXTENSION );
+				stream->path = local_archive_path;
+				stream->download = download;
+				stream->request = request;
+				if ( ota_timeout > 0 )
+					stream->deadline = iot_timestamp_now() +
+						(iot_timestamp_t)ota_timeout *
+						IOT_MILLISECONDS_IN_SECOND;
+				result = device_manager_ota_extract_package(
+					iot_lib, sw_update_dir, stream );
 
-				} while( done != IOT_TRUE );
+				/* the end of the archive can be read before the
+				 * download completes: the package is only
+				 * installed once its checksum was verified */
+				while ( wait_status == IOT_STATUS_SUCCESS &&
+					device_manager_ota_download_completed(
+					download, &download_status ) == IOT_FALSE )
+					wait_status =
+						device_manager_ota_stream_wait(
+						stream );
+				if ( wait_status != IOT_STATUS_SUCCESS )
+				{
+					IOT_LOG( iot_lib, IOT_LOG_ERROR,
+						"Stopped waiting for %s: %s",
+						local_archive_path,
+						iot_error( wait_status ) );
+					download_status = wait_status;
+				}
+				if ( result == IOT_STATUS_SUCCESS &&
+					download_status != IOT_STATUS_SUCCESS )
+				{
+					IOT_LOG( iot_lib, IOT_LOG_ERROR,
+						"Failed to download %s: %s",
+						local_archive_path,
+						iot_error( download_status ) );
+					result = download_status;
+				}
 
-				IOT_LOG( iot_lib, IOT_LOG_DEBUG,
-					"File %s downloaded successfully\n", local_archive_path);
+				if ( result == IOT_STATUS_SUCCESS )
+				{
+					IOT_LOG( iot_lib, IOT_LOG_DEBUG,
+						"File %s downloaded successfully\n",
+						local_archive_path);
 
-				result = device_manager_ota_install_execute(
+					/* the package is extracted, it is no
+					 * longer needed (it keeps its temporary
+					 * name if it could not be renamed while
+					 * it was being read) */
+					os_file_delete( local_archive_path );
+					if ( os_file_exists( stream->part_path ) )
+						os_file_delete( stream->part_path );
+					result = device_manager_ota_install_execute(
 						device_manager_info,
-						sw_update_dir,
-						file_to_download);
+						sw_update_dir );
+				}
+				else
+				{
+					/* files extracted from a package that
+					 * failed to download are not trusted */
+					IOT_LOG( iot_lib, IOT_LOG_ERROR,
+						"Removing update directory: %s",
+						sw_update_dir );
+					os_directory_delete( sw_update_dir,
+						NULL, IOT_TRUE );
+				}
 			}
 			IOT_LOG( iot_lib , IOT_LOG_TRACE,
 				"software update install result: %d", result );
@@ -349,6 +571,17 @@ iot_status_t device_manager_ota( iot_action_request_t *request, void *user_data
 				sw_update_log,        /* path to send */
 				NULL,                 /* callback func */
 				NULL );               /* user data */
+			if ( download && download_started != IOT_FALSE )
+				device_manager_ota_download_release( download );
+			else if ( download )
+			{
+#ifdef IOT_THREAD_SUPPORT
+				os_thread_mutex_destroy( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+				os_free( download );
+			}
+			if ( stream )
+				os_free( stream );
 		}
 	}
 	return result;
@@ -380,82 +613,74 @@ size_t device_manager_software_update_del_characters(
 
 iot_status_t device_manager_ota_install_execute(
 	struct device_manager_info *device_manager_info,
-	const char *package_path, const char* file_name )
+	const char *package_path )
 {
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
-	if ( device_manager_info && package_path && package_path[0] != '\0' &&
-		file_name && file_name[0] != '\0')
+	if ( device_manager_info && package_path && package_path[0] != '\0' )
 	{
 		char update_dup_path[PATH_MAX + 1u] = { 0 };
 		char command_with_params[PATH_MAX + 1u] = { 0 };
 		iot_t *const iot_lib = device_manager_info->iot_lib;
-
-		result = device_manager_ota_extract_package(iot_lib, package_path, file_name);
+		char update_path[PATH_MAX + 1u];
+		char exec_dir[PATH_MAX + 1u];
 
 		IOT_LOG( iot_lib, IOT_LOG_TRACE,
-				"software update package_path: %s, file_name: %s",
-				package_path,
-				file_name);
-		if ( result == IOT_STATUS_SUCCESS )
+				"software update package_path: %s",
+				package_path );
+		result = IOT_STATUS_EXECUTION_ERROR;
+		app_path_executable_directory_get(exec_dir, PATH_MAX);
+		if ( app_path_which( update_path, PATH_MAX, exec_dir, IOT_TARGET_UPDATE) )
 		{
-			char update_path[PATH_MAX + 1u];
-			char exec_dir[PATH_MAX + 1u];
-
-			result = IOT_STATUS_EXECUTION_ERROR;
-			app_path_executable_directory_get(exec_dir, PATH_MAX);
-			if ( app_path_which( update_path, PATH_MAX, exec_dir, IOT_TARGET_UPDATE) )
-			{
-				/**
-				  * IDP system Truested Path Execution (TPE) protection
-				  * restricts the execution of files under certain circumastances
-				  * determined by their path. The copy of iot-update in the
-				  * directory on IDP must have execution permissions. It's hard to
-				  * guarantee the directory have such permission for all IDP security
-				  * combinations. It's safe to use the default execution directory to
-				  * execute the copy of iot-update.
-				  * It is also applicable to other systems execpt for Android dut to it has
-				  * other permission restriction.
-				  */
-				const char *update_dup_dir = NULL;
-				os_status_t osal_status = OS_STATUS_FAILURE;
+			/**
+			  * IDP system Truested Path Execution (TPE) protection
+			  * restricts the execution of files under certain circumastances
+			  * determined by their path. The copy of iot-update in the
+			  * directory on IDP must have execution permissions. It's hard to
+			  * guarantee the directory have such permission for all IDP security
+			  * combinations. It's safe to use the default execution directory to
+			  * execute the copy of iot-update.
+			  * It is also applicable to other systems execpt for Android dut to it has
+			  * other permission restriction.
+			  */
+			const char *update_dup_dir = NULL;
+			os_status_t osal_status = OS_STATUS_FAILURE;
 #ifdef  __ANDROID__
-				char temp_dir[PATH_MAX + 1];
-				update_dup_dir = os_directory_get_temp_dir(
-					temp_dir, PATH_MAX );
+			char temp_dir[PATH_MAX + 1];
+			update_dup_dir = os_directory_get_temp_dir(
+				temp_dir, PATH_MAX );
 #else
-				update_dup_dir = exec_dir;
+			update_dup_dir = exec_dir;
 #endif /* #ifdef __ANDROID__*/
-				if ( OS_STATUS_SUCCESS == os_make_path(
-					update_dup_path,
-					PATH_MAX,
-					update_dup_dir,
-					IOT_TARGET_UPDATE"-copy"IOT_EXE_SUFFIX,
-					NULL ) )
-				{
-					osal_status = os_file_copy(
-						update_path,
-						update_dup_path );
-					os_file_sync( update_dup_path );
-					printf("file copy status %d\n", (int)osal_status);
-				}
+			if ( OS_STATUS_SUCCESS == os_make_path(
+				update_dup_path,
+				PATH_MAX,
+				update_dup_dir,
+				IOT_TARGET_UPDATE"-copy"IOT_EXE_SUFFIX,
+				NULL ) )
+			{
+				osal_status = os_file_copy(
+					update_path,
+					update_dup_path );
+				os_file_sync( update_dup_path );
+				printf("file copy status %d\n", (int)osal_status);
+			}
 
-				if (osal_status == OS_STATUS_SUCCESS )
-				{
-					if ( os_file_exists( update_dup_path ) )
-						os_snprintf( command_with_params,
-							PATH_MAX,
-							"\"%s\" --path \"%s\"",
-							update_dup_path,
-							package_path );
-				}
-				else
-				{
+			if (osal_status == OS_STATUS_SUCCESS )
+			{
+				if ( os_file_exists( update_dup_path ) )
 					os_snprintf( command_with_params,
 						PATH_MAX,
 						"\"%s\" --path \"%s\"",
-						update_path,
+						update_dup_path,
 						package_path );
-				}
+			}
+			else
+			{
+				os_snprintf( command_with_params,
+					PATH_MAX,
+					"\"%s\" --path \"%s\"",
+					update_path,
+					package_path );
 			}
 		}
 
@@ -490,12 +715,13 @@ iot_status_t device_manager_ota_install_execute(
 }
 
 iot_status_t device_manager_ota_extract_package(iot_t *iot_lib,
-	const char *package_path, const char *file_name )
+	const char *package_path, struct device_manager_ota_stream *stream )
 {
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
-printf("%s:%d package_path=%s file_name=%s\n", __func__,__LINE__,package_path, file_name);
-	if ( iot_lib && package_path && file_name )
+	if ( iot_lib && package_path && stream )
 	{
+		IOT_LOG( iot_lib, IOT_LOG_TRACE,
+			"Extracting %s to %s", stream->path, package_path );
 		if ( os_directory_exists ( package_path ) )
 		{
 			char cwd[1024u];
@@ -511,9 +737,8 @@ printf("%s:%d package_path=%s file_name=%s\n", __func__,__LINE__,package_path, f
 			/*
 			 * extract ota package
 			*/
-			if ( os_file_exists ( file_name ) )
-				result = device_manager_ota_extract_package_perform(
-					iot_lib, file_name ) ;
+			result = device_manager_ota_extract_package_perform(
+				iot_lib, stream );
 			if ( cwd [0] != '\0')
 				os_directory_change( cwd );
 		}
@@ -522,10 +747,10 @@ printf("%s:%d package_path=%s file_name=%s\n", __func__,__LINE__,package_path, f
 }
 
 iot_status_t device_manager_ota_extract_package_perform(
-	iot_t *iot_lib, const char * sw_update_package)
+	iot_t *iot_lib, struct device_manager_ota_stream *stream )
 {
 	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
-	if( sw_update_package )
+	if( stream )
 	{
 		struct archive *a;
 		struct archive *ext;
@@ -538,6 +763,11 @@ iot_status_t device_manager_ota_extract_package_perform(
 		flags |= ARCHIVE_EXTRACT_PERM;
 		flags |= ARCHIVE_EXTRACT_ACL;
 		flags |= ARCHIVE_EXTRACT_FFLAGS;
+		/* the package is extracted before its checksum is verified,
+		 * nothing may be written outside of the update directory */
+		flags |= ARCHIVE_EXTRACT_SECURE_NODOTDOT;
+		flags |= ARCHIVE_EXTRACT_SECURE_NOABSOLUTEPATHS;
+		flags |= ARCHIVE_EXTRACT_SECURE_SYMLINKS;
 
 		a = archive_read_new();
 		archive_read_support_format_all(a);
@@ -545,8 +775,9 @@ iot_status_t device_manager_ota_extract_package_perform(
 		ext = archive_write_disk_new();
 		archive_write_disk_set_options(ext, flags);
 		archive_write_disk_set_standard_lookup(ext);
-		if ( archive_read_open_filename(a, sw_update_package, 10240u)
-			== ARCHIVE_OK)
+		if ( archive_read_open( a, stream, NULL,
+			device_manager_ota_stream_read,
+			device_manager_ota_stream_close ) == ARCHIVE_OK )
 		{
 			int r;
 			while ( result == IOT_STATUS_SUCCESS )
@@ -620,8 +851,9 @@ iot_status_t device_manager_ota_extract_package_perform(
 			}
 		}
 		else
-			IOT_LOG( iot_lib, IOT_LOG_ERROR, "%s",
-				"Error: open archive filename");
+			IOT_LOG( iot_lib, IOT_LOG_ERROR,
+				"Error: open archive: %s",
+				archive_error_string(a));
 		archive_read_close(a);
 		archive_read_free(a);
 		archive_write_close(ext);
@@ -669,3 +901,139 @@ int device_manager_ota_copy_data(struct archive *ar, struct archive *aw)
 	}
 	return r;
 }
+
+iot_bool_t device_manager_ota_download_completed(
+	struct device_manager_ota_download *download,
+	iot_status_t *status )
+{
+	iot_bool_t result;
+#ifdef IOT_THREAD_SUPPORT
+	os_thread_mutex_lock( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+	result = download->completed;
+	if ( result != IOT_FALSE && status )
+		*status = download->status;
+#ifdef IOT_THREAD_SUPPORT
+	os_thread_mutex_unlock( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+	return result;
+}
+
+void device_manager_ota_download_release(
+	struct device_manager_ota_download *download )
+{
+	iot_bool_t completed;
+#ifdef IOT_THREAD_SUPPORT
+	os_thread_mutex_lock( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+	completed = download->completed;
+	download->abandoned = IOT_TRUE;
+#ifdef IOT_THREAD_SUPPORT
+	os_thread_mutex_unlock( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+
+	if ( completed != IOT_FALSE )
+	{
+#ifdef IOT_THREAD_SUPPORT
+		os_thread_mutex_destroy( &download->lock );
+#endif /* ifdef IOT_THREAD_SUPPORT */
+		os_free( download );
+	}
+}
+
+int device_manager_ota_stream_close( struct archive *a, void *client_data )
+{
+	struct device_manager_ota_stream *const stream =
+		(struct device_manager_ota_stream *)client_data;
+	(void)a;
+	if ( stream && stream->file )
+	{
+		os_file_close( stream->file );
+		stream->file = NULL;
+	}
+	return ARCHIVE_OK;
+}
+
+DEVICE_MANAGER_OTA_SSIZE_T device_manager_ota_stream_read(
+	struct archive *a, void *client_data, const void **buff )
+{
+	struct device_manager_ota_stream *const stream =
+		(struct device_manager_ota_stream *)client_data;
+	DEVICE_MANAGER_OTA_SSIZE_T result = ARCHIVE_FATAL;
+	iot_bool_t waiting = IOT_TRUE;
+
+	while ( stream && waiting != IOT_FALSE )
+	{
+		/* read before checking for more, no data can be missed */
+		iot_status_t status = IOT_STATUS_FAILURE;
+		const iot_bool_t completed =
+			device_manager_ota_download_completed(
+				stream->download, &status );
+		size_t len = 0u;
+
+		/* the package is renamed once downloaded, if it was before
+		 * being opened; an open handle remains valid */
+		if ( !stream->file )
+		{
+			stream->file = os_file_open( stream->part_path,
+				OS_READ );
+			if ( !stream->file )
+				stream->file = os_file_open( stream->path,
+					OS_READ );
+		}
+
+		/* seeking clears the end of file reached by the last read
+		 * (relative, so the position is not limited to a long) */
+		if ( stream->file && os_file_seek( stream->file,
+			0, OS_FILE_SEEK_CURRENT ) == 0 )
+			len = os_file_read( stream->buf, 1u,
+				sizeof( stream->buf ), stream->file );
+
+		if ( len > 0u )
+		{
+			*buff = stream->buf;
+			result = (DEVICE_MANAGER_OTA_SSIZE_T)len;
+			waiting = IOT_FALSE;
+		}
+		else if ( completed != IOT_FALSE )
+		{
+			result = 0;
+			if ( status != IOT_STATUS_SUCCESS )
+			{
+				archive_set_error( a, ARCHIVE_ERRNO_MISC,
+					"download failed: %s",
+					iot_error( status ) );
+				result = ARCHIVE_FATAL;
+			}
+			waiting = IOT_FALSE;
+		}
+		else
+		{
+			const iot_status_t wait_status =
+				device_manager_ota_stream_wait( stream );
+			if ( wait_status != IOT_STATUS_SUCCESS )
+			{
+				archive_set_error( a, ARCHIVE_ERRNO_MISC,
+					"download stopped: %s",
+					iot_error( wait_status ) );
+				waiting = IOT_FALSE;
+			}
+		}
+	}
+	return result;
+}
+
+iot_status_t device_manager_ota_stream_wait(
+	const struct device_manager_ota_stream *stream )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	if ( stream->request &&
+		iot_action_request_cancelled( stream->request ) != IOT_FALSE )
+		result = IOT_STATUS_EXECUTION_ERROR;
+	else if ( stream->deadline > 0u &&
+		iot_timestamp_now() >= stream->deadline )
+		result = IOT_STATUS_TIMED_OUT;
+	else
+		os_time_sleep( DEVICE_MANAGER_OTA_STREAM_WAIT, IOT_FALSE );
+	return result;
+}
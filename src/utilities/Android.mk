@@ -30,7 +30,9 @@ iotutils_src_files := \
 	app_json_base.c \
 	app_json_decode.c \
 	app_json_encode.c \
+	app_json_path.c \
 	app_json_schema.c \
+	app_json_stream.c \
 
 include $(CLEAR_VARS)
 LOCAL_C_INCLUDES := $(iotutils_c_includes)
@@ -239,7 +239,9 @@ iot_status_t app_json_decode_bool(
  *
  * @note specifying the flag APP_JSON_FLAG_DYNAMIC indicates to use dynamic
  * memory on the heap for allocating the JSON decoder object and JSON tokens.
- * In this case, the parameters @c buf and @c len are ignored.
+ * In this case, the parameters @c buf and @c len are ignored.  A dynamic
+ * decoder also indexes each parsed document, so that finding a key in an
+ * object or stepping to the next item does not visit nested items.
  *
  * @param[in,out]  buf                 memory to use for the base parser
  * @param[in]      len                 amount of memory in the buf parameter
@@ -451,6 +453,9 @@ size_t app_json_decode_object_size(
  * the null-terminating character, always indicated the amount of valid
  * characters using the @c len parameter
  *
+ * @note a decoder may be used to parse more than one document, items returned
+ * from a previous call are no longer valid once the decoder is used again
+ *
  * @param[in]      decoder             JSON decoder object
  * @param[in]      js                  pointer to a string containing JSON text
  * @param[in]      len                 length of the JSON string
@@ -554,11 +559,293 @@ app_json_type_t app_json_decode_type(
 	const app_json_item_t *item );
 
 
+/* PATH SUPPORT */
+/******************/
+/** @brief Maximum number of paths extracted in one call */
+#define APP_JSON_PATH_MAX              32u
+
+/** @brief Represents a compiled JSON path */
+typedef struct app_json_path app_json_path_t;
+
+/**
+ * @brief Signature of the function called for each item matching a path
+ *
+ * @param[in]      user_data           user data passed to app_json_path_match
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      item                item matching the path
+ *
+ * @retval IOT_STATUS_SUCCESS          continue matching
+ * @retval ...                         any other value stops matching and is
+ *                                     returned from app_json_path_match
+ */
+typedef iot_status_t (*app_json_path_callback_t)(
+	void *user_data,
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item );
+
+/**
+ * @brief Compiles a path expression for matching items in a document
+ *
+ * A path is a list of steps from an item to the items within it: a key
+ * selects an object member and is separated from the previous step by a '.',
+ * "[n]" selects an array element.  "*" and "[*]" select every member or
+ * element, and a backslash escapes a '.' or '[' within a key.  For example,
+ * "params.messages[*].id" selects the id of every message.  An empty path
+ * selects the item itself.
+ *
+ * @note specifying the flag APP_JSON_FLAG_DYNAMIC indicates to use dynamic
+ * memory on the heap for the compiled path.  In this case, the parameters
+ * @c buf and @c len are ignored.  Otherwise, @c buf must be large enough to
+ * hold the compiled path.
+ *
+ * @param[in,out]  buf                 memory to use for the compiled path
+ * @param[in]      len                 amount of memory in the buf parameter
+ * @param[in]      flags               flags for the compiled path
+ * @param[in]      expr                path expression
+ *
+ * @return a compiled path, NULL if the expression is invalid or there is not
+ * enough memory
+ *
+ * @see app_json_path_extract
+ * @see app_json_path_match
+ * @see app_json_path_terminate
+ */
+app_json_path_t *app_json_path_compile(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	const char *expr );
+
+/**
+ * @brief Finds the first item matching each of several paths
+ *
+ * All paths are matched together in a single walk of the items below
+ * @p item, which stops once every path has been matched.
+ *
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      item                item to start from
+ * @param[in]      paths               compiled paths to match (entries may be
+ *                                     NULL)
+ * @param[in]      count               number of paths (maximum of
+ *                                     APP_JSON_PATH_MAX)
+ * @param[out]     out                 first item matching each path, NULL if
+ *                                     none matched
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_NOT_FOUND        no item matched one or more paths
+ * @retval IOT_STATUS_SUCCESS          an item matched every path
+ *
+ * @see app_json_path_compile
+ */
+iot_status_t app_json_path_extract(
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item,
+	const app_json_path_t *const *paths,
+	size_t count,
+	const app_json_item_t **out );
+
+/**
+ * @brief Calls a function for every item matching a path
+ *
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      item                item to start from
+ * @param[in]      path                compiled path to match
+ * @param[in]      callback            function to call for each match
+ * @param[in]      user_data           user data to pass to the callback
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_NOT_FOUND        no item matched the path
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         value returned by the callback
+ *
+ * @see app_json_path_compile
+ */
+iot_status_t app_json_path_match(
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item,
+	const app_json_path_t *path,
+	app_json_path_callback_t callback,
+	void *user_data );
+
+/**
+ * @brief Frees the memory used by a compiled path
+ *
+ * @param[in]      path                compiled path
+ *
+ * @see app_json_path_compile
+ */
+void app_json_path_terminate(
+	app_json_path_t *path );
+
+
+/* STREAM SUPPORT */
+/********************/
+/** @brief Represents a streaming (incremental) JSON decoder object */
+typedef struct app_json_stream app_json_stream_t;
+
+/** @brief Events reported while streaming a JSON document */
+typedef enum app_json_stream_event
+{
+	/** @brief a value that is not an array or object */
+	APP_JSON_STREAM_VALUE = 0,
+	/** @brief start of an array or object */
+	APP_JSON_STREAM_START,
+	/** @brief end of an array or object */
+	APP_JSON_STREAM_END
+} app_json_stream_event_t;
+
+/**
+ * @brief Signature of the function called for each event while streaming
+ *
+ * @note The @c key and @c value text are only valid during the call and are
+ * not null-terminated.  String values are unescaped; numbers, booleans and
+ * null are passed as they appear in the document.
+ *
+ * @param[in]      user_data           user data given at initialization
+ * @param[in]      event               event being reported
+ * @param[in]      type                type of the item (array or object for
+ *                                     the start & end events)
+ * @param[in]      depth               number of arrays and objects that
+ *                                     contain the item
+ * @param[in]      key                 key of the item, NULL if the item is not
+ *                                     inside an object (or for end events)
+ * @param[in]      key_len             length of the key
+ * @param[in]      value               text of the value, NULL for the start
+ *                                     & end events
+ * @param[in]      value_len           length of the value text
+ *
+ * @retval IOT_STATUS_SUCCESS          continue parsing
+ * @retval ...                         any other value stops parsing and is
+ *                                     returned from app_json_stream_parse
+ */
+typedef iot_status_t (*app_json_stream_callback_t)(
+	void *user_data,
+	app_json_stream_event_t event,
+	app_json_type_t type,
+	unsigned int depth,
+	const char *key,
+	size_t key_len,
+	const char *value,
+	size_t value_len );
+
+/**
+ * @brief Completes streaming of a JSON document
+ *
+ * Reports any value still pending (a number at the root of the document has
+ * no terminating character) and checks that the document is complete.  The
+ * stream is then ready to parse another document.
+ *
+ * @param[in,out]  stream              JSON streaming decoder object
+ * @param[out]     error               buffer to output error message to
+ *                                     (optional)
+ * @param[in]      error_len           size of the error message buffer
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_PARSE_ERROR      document incomplete or invalid
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see app_json_stream_parse
+ */
+iot_status_t app_json_stream_finish(
+	app_json_stream_t *stream,
+	char *error,
+	size_t error_len );
+
+/**
+ * @brief Initializes a streaming JSON decoder
+ *
+ * A streaming decoder accepts a document in chunks of any size and reports
+ * each item to a callback as it is completed, without holding the document
+ * or a token for each item.  Only a key and a value split across chunks (or
+ * containing escape sequences) are copied, so the memory required is bounded
+ * by the largest key and value rather than the size of the document.
+ *
+ * @note specifying the flag APP_JSON_FLAG_DYNAMIC indicates to use dynamic
+ * memory on the heap for the decoder object and the space for keys & values,
+ * which grows as required.  In this case, the parameters @c buf and @c len
+ * are ignored.  Otherwise, @c buf holds the decoder object and the remaining
+ * space in it limits the size of a key and value held.
+ *
+ * @param[in,out]  buf                 memory to use for the decoder
+ * @param[in]      len                 amount of memory in the buf parameter
+ * @param[in]      flags               flags for indicating parsing support
+ * @param[in]      callback            function to call for each event
+ * @param[in]      user_data           user data to pass to the callback
+ *
+ * @return a valid JSON streaming decoder object, NULL on failure
+ *
+ * @see app_json_stream_parse
+ * @see app_json_stream_terminate
+ */
+app_json_stream_t *app_json_stream_initialize(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	app_json_stream_callback_t callback,
+	void *user_data );
+
+/**
+ * @brief Parses the next chunk of a JSON document
+ *
+ * @param[in,out]  stream              JSON streaming decoder object
+ * @param[in]      js                  chunk of the document
+ * @param[in]      len                 length of the chunk
+ * @param[out]     error               buffer to output error message to
+ *                                     (optional)
+ * @param[in]      error_len           size of the error message buffer
+ *
+ * @note after an error the stream must be finished before it is reused
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    invalid parameter passed to the function
+ * @retval IOT_STATUS_NO_MEMORY        not enough memory to hold a key or value
+ * @retval IOT_STATUS_PARSE_ERROR      invalid JSON encountered
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         value returned from the callback
+ *
+ * @see app_json_stream_finish
+ * @see app_json_stream_initialize
+ */
+iot_status_t app_json_stream_parse(
+	app_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	char *error,
+	size_t error_len );
+
+/**
+ * @brief Frees memory associated with a streaming JSON decoder
+ *
+ * @param[in]      stream              JSON streaming decoder object
+ *
+ * @see app_json_stream_initialize
+ */
+void app_json_stream_terminate(
+	app_json_stream_t *stream );
+
+
 /* ENCODE SUPPORT */
 /********************/
 /** @brief Represents a JSON encoder object */
 typedef struct app_json_encoder app_json_encoder_t;
 
+/**
+ * @brief Signature of the function called to write encoded output
+ *
+ * @param[in]      user_data           user data given when setting the sink
+ * @param[in]      data                encoded text (not null-terminated)
+ * @param[in]      len                 number of characters in @c data
+ *
+ * @retval IOT_STATUS_SUCCESS          output written
+ * @retval ...                         any other value stops encoding and is
+ *                                     returned to the caller
+ *
+ * @see app_json_encode_sink_set
+ */
+typedef iot_status_t (*app_json_encode_sink_t)(
+	void *user_data,
+	const char *data,
+	size_t len );
+
 /**
  * @brief Ends the encoding of a JSON array
  *
@@ -630,11 +917,57 @@ iot_status_t app_json_encode_bool(
  *
  * @param[in]      encoder             JSON encoder object
  *
- * @return string in JSON format
+ * @return string in JSON format, NULL if the encoder writes to a sink
+ *
+ * @see app_json_encode_flush
  */
 const char *app_json_encode_dump(
 	app_json_encoder_t *encoder );
 
+/**
+ * @brief Estimates the space required to encode an item
+ *
+ * The estimate includes the key, the value and any separators, indentation
+ * or spacing the encoder adds.  Estimates for each item in a message can be
+ * added together and passed to app_json_encode_reserve to allocate the output
+ * buffer once, before encoding.
+ *
+ * @param[in]      encoder             JSON encoder object (optional, if not
+ *                                     given a compact output is assumed)
+ * @param[in]      key                 (optional) key for the item
+ * @param[in]      value               (optional) string value for the item
+ * @param[in]      value_len           length of the encoded value, used when
+ *                                     @c value is NULL (i.e. for a number)
+ *
+ * @return the number of characters required to encode the item
+ *
+ * @see app_json_encode_reserve
+ */
+size_t app_json_encode_estimate(
+	const app_json_encoder_t *encoder,
+	const char *key,
+	const char *value,
+	size_t value_len );
+
+/**
+ * @brief Completes the document and writes it to the sink
+ *
+ * Any arrays and objects still open are closed and the remaining output is
+ * written to the sink.  The encoder is then ready to encode another
+ * document.
+ *
+ * @param[in,out]  encoder             JSON encoder object
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to the function
+ * @retval IOT_STATUS_BAD_REQUEST      the encoder does not have a sink
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         value returned by the sink on failure
+ *
+ * @see app_json_encode_sink_set
+ */
+iot_status_t app_json_encode_flush(
+	app_json_encoder_t *encoder );
+
 /**
  * @brief Initializes the JSON encoding system
  *
@@ -767,9 +1100,15 @@ iot_status_t app_json_encode_object_start(
  * the same key as another item in the object will result in undefined
  * behaviour.
  *
+ * @note Except when built with jansson, the shortest text that reads back as
+ * the same value is written (i.e. 0.1 is written as "0.1"), integral values
+ * keep a trailing ".0" and very large or small values use an exponent
+ * (i.e. "1e300").
+ *
  * @retval IOT_STATUS_FULL             the maximum number of items for the
  *                                     buffer has been reached
- * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to the function
+ * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to the function,
+ *                                     or @c value is infinite or NaN
  * @retval IOT_STATUS_BAD_REQUEST      adding item not inside an array or object
  * @retval IOT_STATUS_NO_MEMORY        no more memory available
  * @retval IOS_STATUS_SUCCESS          on success
@@ -781,6 +1120,54 @@ iot_status_t app_json_encode_real(
 	const char *key,
 	iot_float64_t value );
 
+/**
+ * @brief Reserves space in the output buffer for items to be added
+ *
+ * @note for an encoder using dynamic memory the output buffer is grown
+ * geometrically as items are added, reserving space ahead of time allows the
+ * buffer to be allocated once
+ *
+ * @param[in]      encoder             JSON encoder object
+ * @param[in]      len                 number of characters to reserve
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to the function
+ * @retval IOT_STATUS_NO_MEMORY        not enough memory available
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see app_json_encode_estimate
+ */
+iot_status_t app_json_encode_reserve(
+	app_json_encoder_t *encoder,
+	size_t len );
+
+/**
+ * @brief Sets a sink to write the output of an encoder to
+ *
+ * Output is written to the sink whenever the buffer of the encoder is full
+ * (and when the document is flushed), so a document of any size can be
+ * produced using a fixed-size buffer, without holding the whole document in
+ * memory.  The buffer only needs to hold the largest single item.
+ *
+ * @note Once part of an object has been written to the sink, the object can
+ * no longer be cancelled or cleared.  When built with jansson or json-c, the
+ * document is still held in memory and is written to the sink when flushed.
+ *
+ * @param[in,out]  encoder             JSON encoder object
+ * @param[in]      sink                function to write output to (NULL to
+ *                                     hold the output in the encoder)
+ * @param[in]      user_data           user data to pass to the sink
+ *
+ * @retval IOT_STATUS_BAD_PARAMETER    bad parameter passed to the function
+ * @retval IOT_STATUS_BAD_REQUEST      items have already been encoded
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see app_json_encode_flush
+ */
+iot_status_t app_json_encode_sink_set(
+	app_json_encoder_t *encoder,
+	app_json_encode_sink_t sink,
+	void *user_data );
+
 /**
  * @brief Encodes a string
  *
@@ -44,6 +44,18 @@
 		struct json_object *j_root;
 	};
 #else /* defined( IOT_JSON_JSMN ) */
+#ifndef IOT_STACK_ONLY
+	/** @brief lookup index entry for a JSMN token */
+	struct app_json_index
+	{
+		/** @brief index of the token following this token's subtree */
+		unsigned int next;
+		/** @brief offset (+1) of the key hash table for an object, or
+		 *         0 if the object has no hash table */
+		unsigned int hash;
+	};
+#endif /* ifndef IOT_STACK_ONLY */
+
 	/** @brief base structure used for decoding with JSMN */
 	struct app_json_decoder
 	{
@@ -59,6 +71,18 @@
 		unsigned int size;
 		/** @brief pointer to first token */
 		jsmntok_t *tokens;
+#ifndef IOT_STACK_ONLY
+		/** @brief lookup index, one entry per token (dynamic only) */
+		struct app_json_index *index;
+		/** @brief number of tokens covered by the lookup index */
+		unsigned int index_objs;
+		/** @brief number of lookup index entries allocated */
+		unsigned int index_size;
+		/** @brief key hash table slots (key token index + 1) */
+		unsigned int *index_hash;
+		/** @brief number of key hash table slots allocated */
+		unsigned int index_hash_size;
+#endif /* ifndef IOT_STACK_ONLY */
 	};
 #endif
 
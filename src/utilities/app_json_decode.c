@@ -21,6 +21,11 @@
 #if defined( IOT_JSON_JANSSON  ) || defined( IOT_JSON_JSONC )
 #	include <os.h> /* for os_memzero, os_snprintf  */
 #else /* if defined( IOT_JSON_JSMN ) || defined( IOT_JSON_JSONC ) */
+/** @brief Minimum number of members before an object's keys are hashed */
+#define APP_JSON_JSMN_HASH_MIN         8u
+/** @brief Minimum number of tokens allocated by a dynamic JSMN decoder */
+#define APP_JSON_JSMN_TOKENS_MIN       16u
+
 /**
  * @brief helper function for decoding real numbers with JSMN
  *
@@ -51,6 +56,74 @@ static iot_status_t app_jsmn_decode_number(
 	iot_float64_t *value,
 	iot_bool_t *is_integer );
 
+#ifndef IOT_STACK_ONLY
+/**
+ * @brief builds the lookup index for the last document parsed
+ *
+ * The index holds, for every token, the position of the token following its
+ * subtree, allowing members of an object or array to be visited without
+ * walking their children.  Objects with at least @c APP_JSON_JSMN_HASH_MIN
+ * members also get an open-addressing hash table of their keys.
+ *
+ * @note the index is an optimization only, if memory is not available the
+ * decoder falls back to scanning the tokens
+ *
+ * @param[in,out]  decoder             JSON decoder object
+ *
+ * @retval IOT_STATUS_NO_MEMORY        not enough memory to build the index
+ * @retval IOT_STATUS_SUCCESS          on success
+ *
+ * @see app_json_decode_parse
+ */
+static iot_status_t app_jsmn_index_build(
+	app_json_decoder_t *decoder );
+
+/**
+ * @brief returns the number of key hash table slots for an object
+ *
+ * @param[in]      members             number of members in the object
+ *
+ * @return the number of slots, always a power of 2
+ *
+ * @see app_jsmn_index_build
+ */
+static unsigned int app_jsmn_index_hash_size(
+	int members );
+#endif /* ifndef IOT_STACK_ONLY */
+
+/**
+ * @brief calculates the hash of a key (FNV-1a)
+ *
+ * @param[in]      key                 key to hash
+ * @param[in]      key_len             length of the key
+ *
+ * @return the hash of the key
+ *
+ * @see app_jsmn_key_match
+ */
+static unsigned int app_jsmn_key_hash(
+	const char *key,
+	size_t key_len );
+
+/**
+ * @brief determines whether a token is an object key matching a key
+ *
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      tok                 token to check
+ * @param[in]      key                 key to match
+ * @param[in]      key_len             length of the key
+ *
+ * @retval IOT_FALSE                   token is not a key, or does not match
+ * @retval IOT_TRUE                    token is a key matching @c key
+ *
+ * @see app_jsmn_key_hash
+ */
+static iot_bool_t app_jsmn_key_match(
+	const app_json_decoder_t *decoder,
+	const jsmntok_t *tok,
+	const char *key,
+	size_t key_len );
+
 iot_status_t app_jsmn_decode_number(
 	const app_json_decoder_t *decoder,
 	const app_json_item_t *item,
@@ -138,6 +211,148 @@ iot_status_t app_jsmn_decode_number(
 		*is_integer = is_int;
 	return result;
 }
+
+#ifndef IOT_STACK_ONLY
+iot_status_t app_jsmn_index_build(
+	app_json_decoder_t *decoder )
+{
+	iot_status_t result = IOT_STATUS_NO_MEMORY;
+	const jsmntok_t *const tokens = decoder->tokens;
+	const unsigned int objs = decoder->objs;
+
+	decoder->index_objs = 0u;
+	if ( decoder->index_size < objs )
+	{
+		struct app_json_index *const index = app_json_realloc(
+			decoder->index,
+			sizeof( struct app_json_index ) * decoder->size );
+		if ( index )
+		{
+			decoder->index = index;
+			decoder->index_size = decoder->size;
+		}
+	}
+
+	if ( decoder->index && decoder->index_size >= objs )
+	{
+		struct app_json_index *const index = decoder->index;
+		unsigned int hash_size = 0u;
+		unsigned int i = objs;
+
+		/* walk backwards, so each token can jump over the subtrees of
+		 * its children which have already been indexed */
+		while ( i > 0u )
+		{
+			unsigned int n;
+			--i;
+			n = i + 1u;
+			while ( n < objs && tokens[n].start < tokens[i].end )
+				n = index[n].next;
+			index[i].next = n;
+			index[i].hash = 0u;
+			if ( tokens[i].type == JSMN_OBJECT &&
+				tokens[i].size >= (int)APP_JSON_JSMN_HASH_MIN )
+			{
+				index[i].hash = hash_size + 1u;
+				hash_size += app_jsmn_index_hash_size(
+					tokens[i].size );
+			}
+		}
+
+		if ( hash_size > decoder->index_hash_size )
+		{
+			unsigned int *const hash = app_json_realloc(
+				decoder->index_hash,
+				sizeof( unsigned int ) * hash_size );
+			if ( hash )
+			{
+				decoder->index_hash = hash;
+				decoder->index_hash_size = hash_size;
+			}
+		}
+
+		for ( i = 0u; i < objs; ++i )
+		{
+			/* without hash tables, lookups use the skip table */
+			if ( hash_size > decoder->index_hash_size )
+				index[i].hash = 0u;
+			else if ( index[i].hash )
+			{
+				unsigned int *const slots =
+					&decoder->index_hash[index[i].hash - 1u];
+				const unsigned int mask =
+					app_jsmn_index_hash_size( tokens[i].size ) - 1u;
+				unsigned int k;
+
+				for ( k = 0u; k <= mask; ++k )
+					slots[k] = 0u;
+
+				k = i + 1u;
+				while ( k < index[i].next )
+				{
+					const unsigned int v = index[k].next;
+					unsigned int h = app_jsmn_key_hash(
+						&decoder->buf[tokens[k].start],
+						(size_t)(tokens[k].end - tokens[k].start) );
+					h &= mask;
+					while ( slots[h] != 0u )
+						h = (h + 1u) & mask;
+					slots[h] = k + 1u;
+					k = v;
+					if ( v < objs )
+						k = index[v].next;
+				}
+			}
+		}
+		decoder->index_objs = objs;
+		result = IOT_STATUS_SUCCESS;
+	}
+	return result;
+}
+
+unsigned int app_jsmn_index_hash_size(
+	int members )
+{
+	unsigned int result = APP_JSON_JSMN_HASH_MIN * 2u;
+	while ( result < (unsigned int)members * 2u )
+		result <<= 1;
+	return result;
+}
+#endif /* ifndef IOT_STACK_ONLY */
+
+unsigned int app_jsmn_key_hash(
+	const char *key,
+	size_t key_len )
+{
+	unsigned int result = 2166136261u;
+	size_t i;
+	for ( i = 0u; i < key_len; ++i )
+	{
+		result ^= (unsigned char)key[i];
+		result *= 16777619u;
+	}
+	return result;
+}
+
+iot_bool_t app_jsmn_key_match(
+	const app_json_decoder_t *decoder,
+	const jsmntok_t *tok,
+	const char *key,
+	size_t key_len )
+{
+	iot_bool_t result = IOT_FALSE;
+	if ( tok->type == JSMN_STRING && tok->size == 1 &&
+		(size_t)(tok->end - tok->start) == key_len )
+	{
+		const char *const k = &decoder->buf[tok->start];
+		size_t i = 0u;
+		while ( i < key_len && k[i] == key[i] )
+			++i;
+		if ( i == key_len )
+			result = IOT_TRUE;
+	}
+	return result;
+}
 #endif /* if defined( IOT_JSON_JSMN ) || defined( IOT_JSON_JSONC )*/
 
 iot_status_t app_json_decode_array_at(
@@ -184,6 +399,23 @@ iot_status_t app_json_decode_array_at(
 			idx = p_idx;
 			++cur;
 			++idx;
+#ifndef IOT_STACK_ONLY
+			if ( p_idx < decoder->index_objs )
+			{
+				/* jump from element to element */
+				const unsigned int end_idx =
+					decoder->index[p_idx].next;
+				size_t i = 0u;
+				while ( i < index && idx < end_idx )
+				{
+					idx = decoder->index[idx].next;
+					++i;
+				}
+				if ( idx < end_idx )
+					obj = &decoder->tokens[idx];
+			}
+			else
+#endif /* ifndef IOT_STACK_ONLY */
 			while ( obj == NULL && idx < decoder->objs )
 			{
 #ifdef JSMN_PARENT_LINKS
@@ -301,25 +533,40 @@ const app_json_array_iterator_t *app_json_decode_array_iterator_next(
 		/* get index of current item */
 		idx = (unsigned int)(cur - decoder->tokens);
 
-		++cur;
-		++idx;
-#ifdef JSMN_PARENT_LINKS
-		while ( cur->start < obj_end_pos &&
-			cur->parent != parent &&
-			idx < decoder->objs )
+#ifndef IOT_STACK_ONLY
+		if ( idx < decoder->index_objs )
+		{
+			const unsigned int p_idx = (unsigned int)
+				((const jsmntok_t *)item - decoder->tokens);
+			/* jump over the subtree of the current element */
+			idx = decoder->index[idx].next;
+			result = NULL;
+			if ( idx < decoder->index[p_idx].next )
+				result = &decoder->tokens[idx];
+		}
+		else
+#endif /* ifndef IOT_STACK_ONLY */
 		{
 			++cur;
 			++idx;
-		}
+#ifdef JSMN_PARENT_LINKS
+			while ( idx < decoder->objs &&
+				cur->start < obj_end_pos &&
+				cur->parent != parent )
+			{
+				++cur;
+				++idx;
+			}
 #else  /* ifdef JSMN_PARENT_LINKS */
-		/** @todo make this work without JSMN_PARENT_LINKS */
+			/** @todo make this work without JSMN_PARENT_LINKS */
 #endif /* else JSMN_PARENT_LINKS */
 
-		result = cur;
-		/* hit end of list */
-		if ( idx >= decoder->objs ||
-			cur->start >= obj_end_pos )
-			result = NULL;
+			result = cur;
+			/* hit end of list */
+			if ( idx >= decoder->objs ||
+				cur->start >= obj_end_pos )
+				result = NULL;
+		}
 #endif /* defined( IOT_JSON_JSMN ) */
 	}
 	return result;
@@ -450,6 +697,13 @@ app_json_decoder_t *app_json_decode_initialize(
 			decoder->buf = NULL;
 			decoder->len = 0u;
 			decoder->tokens = NULL;
+#ifndef IOT_STACK_ONLY
+			decoder->index = NULL;
+			decoder->index_objs = 0u;
+			decoder->index_size = 0u;
+			decoder->index_hash = NULL;
+			decoder->index_hash_size = 0u;
+#endif /* ifndef IOT_STACK_ONLY */
 			if ( max_objs )
 			{
 				jsmntok_t *tok;
@@ -624,43 +878,95 @@ const app_json_item_t *app_json_decode_object_find_len(
 		else
 			result = json_object_get( object, key );
 #elif defined( IOT_JSON_JSONC )
-		(void)key_len;
+		/* json-c only looks up nul-terminated keys */
+		char key_buf[64u];
+		char *buf = key_buf;
+		json_object *out;
+		struct json_object *j_obj;
+
+		if ( key_len == 0u )
+			buf = (char *)key;
+		else if ( key_len >= sizeof( key_buf ) )
+			buf = app_json_realloc( NULL, key_len + 1u );
+		if ( buf && buf != key )
+		{
+			os_strncpy( buf, key, key_len );
+			buf[key_len] = '\0';
+		}
+
+		os_memcpy( &j_obj, &object, sizeof( struct json_object * ) );
+		if ( buf &&
+			json_object_object_get_ex( j_obj, buf, &out ) == TRUE )
+			result = out;
+		if ( buf && buf != key && buf != key_buf )
+			app_json_free( buf );
 #else /* defined( IOT_JSON_JSMN ) */
 		const jsmntok_t *cur = object;
 		if ( cur && cur->type == JSMN_OBJECT )
 		{
-			unsigned int idx = 0u;
-			unsigned int p_idx = 0u;
-			p_idx = (unsigned int)(cur - decoder->tokens);
-			idx = p_idx;
-			++cur;
-			++idx;
-			while ( result == NULL && idx < decoder->objs )
+			const unsigned int p_idx =
+				(unsigned int)(cur - decoder->tokens);
+			unsigned int idx = p_idx + 1u;
+
+			if ( key_len == 0u )
+				while ( key[key_len] != '\0' )
+					++key_len;
+#ifndef IOT_STACK_ONLY
+			if ( p_idx < decoder->index_objs )
 			{
-				if (
-#ifdef JSMN_PARENT_LINKS
-					cur->parent == (int)p_idx &&
-#endif /* ifdef JSMN_PARENT_LINKS */
-					cur->type == JSMN_STRING &&
-					cur->size == 1 )
+				const struct app_json_index *const index =
+					decoder->index;
+				if ( index[p_idx].hash )
 				{
-					/* compare key */
-					size_t k = 0u;
-					const size_t k_len = (size_t)(cur->end - cur->start);
-
-					while ( (key_len == 0u || k < k_len) &&
-						decoder->buf[(size_t)(cur->start) + k] == key[k] )
+					/* probe the object's key hash table */
+					const unsigned int *const slots =
+						&decoder->index_hash[index[p_idx].hash - 1u];
+					const unsigned int mask =
+						app_jsmn_index_hash_size( cur->size ) - 1u;
+					unsigned int h =
+						app_jsmn_key_hash( key, key_len ) & mask;
+					while ( result == NULL && slots[h] != 0u )
 					{
-						++k;
+						cur = &decoder->tokens[slots[h] - 1u];
+						if ( app_jsmn_key_match( decoder, cur,
+							key, key_len ) )
+							result = cur + 1;
+						h = (h + 1u) & mask;
 					}
-
-					/* match found */
-					if ( (key_len == 0u && key[k] == '\0')
-						|| (key_len > 0u && k == key_len) )
-						result = cur + 1;
 				}
+				else
+				{
+					/* visit only the keys, skipping values */
+					while ( result == NULL &&
+						idx < index[p_idx].next )
+					{
+						const unsigned int v = index[idx].next;
+						cur = &decoder->tokens[idx];
+						if ( app_jsmn_key_match( decoder, cur,
+							key, key_len ) )
+							result = cur + 1;
+						idx = v;
+						if ( v < decoder->index_objs )
+							idx = index[v].next;
+					}
+				}
+			}
+			else
+#endif /* ifndef IOT_STACK_ONLY */
+			{
 				++cur;
-				++idx;
+				while ( result == NULL && idx < decoder->objs )
+				{
+					if (
+#ifdef JSMN_PARENT_LINKS
+						cur->parent == (int)p_idx &&
+#endif /* ifdef JSMN_PARENT_LINKS */
+						app_jsmn_key_match( decoder, cur,
+							key, key_len ) )
+						result = cur + 1;
+					++cur;
+					++idx;
+				}
 			}
 		}
 #endif /* defined( IOT_JSON_JSMN ) */
@@ -785,25 +1091,42 @@ const app_json_object_iterator_t *app_json_decode_object_iterator_next(
 		/* get index of current item */
 		idx = (unsigned int)(cur - decoder->tokens);
 
-		++cur;
-		++idx;
-#ifdef JSMN_PARENT_LINKS
-		while ( cur->start < obj_end_pos &&
-			cur->parent != parent &&
-			idx < decoder->objs )
+#ifndef IOT_STACK_ONLY
+		if ( idx < decoder->index_objs )
+		{
+			const unsigned int p_idx = (unsigned int)
+				((const jsmntok_t *)item - decoder->tokens);
+			/* jump over the value of the current key */
+			idx = decoder->index[idx].next;
+			if ( idx < decoder->index_objs )
+				idx = decoder->index[idx].next;
+			result = NULL;
+			if ( idx < decoder->index[p_idx].next )
+				result = &decoder->tokens[idx];
+		}
+		else
+#endif /* ifndef IOT_STACK_ONLY */
 		{
 			++cur;
 			++idx;
-		}
+#ifdef JSMN_PARENT_LINKS
+			while ( idx < decoder->objs &&
+				cur->start < obj_end_pos &&
+				cur->parent != parent )
+			{
+				++cur;
+				++idx;
+			}
 #else  /* ifdef JSMN_PARENT_LINKS */
-		/** @todo make this work without JSMN_PARENT_LINKS */
+			/** @todo make this work without JSMN_PARENT_LINKS */
 #endif /* else JSMN_PARENT_LINKS */
 
-		result = cur;
-		/* hit end of list */
-		if ( idx >= decoder->objs ||
-			cur->start >= obj_end_pos )
-			result = NULL;
+			result = cur;
+			/* hit end of list */
+			if ( idx >= decoder->objs ||
+				cur->start >= obj_end_pos )
+				result = NULL;
+		}
 #endif /* endif( IOT_JSON_JSMN ) */
 	}
 	return result;
@@ -877,6 +1200,8 @@ iot_status_t app_json_decode_parse(
 	{
 #if defined( IOT_JSON_JANSSON )
 		json_error_t j_error;
+		if ( decoder->j_root )
+			json_decref( decoder->j_root );
 		decoder->j_root = json_loadb( js, len, 0u, &j_error );
 		result = IOT_STATUS_PARSE_ERROR;
 		if ( decoder->j_root )
@@ -893,6 +1218,9 @@ iot_status_t app_json_decode_parse(
 #elif defined( IOT_JSON_JSONC )
 		enum json_tokener_error j_error;
 		struct json_tokener *tok = json_tokener_new();
+		if ( decoder->j_root )
+			json_object_put( decoder->j_root );
+		decoder->j_root = NULL;
 		do
 		{
 			decoder->j_root = json_tokener_parse_ex( tok, js, len );
@@ -910,6 +1238,7 @@ iot_status_t app_json_decode_parse(
 
 			if ( decoder->j_root )
 				json_object_put( decoder->j_root );
+			decoder->j_root = NULL;
 
 			result = IOT_STATUS_PARSE_ERROR;
 		}
@@ -920,75 +1249,47 @@ iot_status_t app_json_decode_parse(
 		const char *error_text = NULL;
 		int i;
 		result = IOT_STATUS_PARSE_ERROR;
+
+		/* jsmn initializes each token as it is allocated, so tokens
+		 * left over from a previous document are never read beyond
+		 * decoder->objs */
+		decoder->objs = 0u;
+#ifndef IOT_STACK_ONLY
+		decoder->index_objs = 0u;
+#endif /* ifndef IOT_STACK_ONLY */
+		jsmn_init( &parser );
 #ifndef IOT_STACK_ONLY
 		if ( decoder->flags & APP_JSON_FLAG_DYNAMIC )
 		{
 			i = JSMN_ERROR_NOMEM;
-			if ( !decoder->tokens )
-			{
-				decoder->size = 1u;
-				decoder->tokens =
-					(jsmntok_t*)app_json_realloc( NULL,
-					sizeof( jsmntok_t ) * decoder->size );
-			}
-			while ( i == JSMN_ERROR_NOMEM && decoder->tokens )
-			{
-				jsmn_init( &parser );
+			if ( decoder->tokens )
 				i = jsmn_parse( &parser, js, len,
 					decoder->tokens, decoder->size );
-				if ( i == JSMN_ERROR_NOMEM )
-				{
-					jsmntok_t *tokens;
-					decoder->size = (decoder->size + 1) * 2u;
-					tokens = app_json_realloc(
-						decoder->tokens,
-						sizeof( jsmntok_t ) * decoder->size );
-					if ( tokens )
-					{
-						size_t j = 0u;
-
-						decoder->tokens = tokens;
 
-						/* initialize tokens */
-						while ( j < decoder->size )
-						{
-							decoder->tokens[j].type = JSMN_UNDEFINED;
-							decoder->tokens[j].start = 0;
-							decoder->tokens[j].end = 0;
-							decoder->tokens[j].size = 0;
-#ifdef JSMN_PARENT_LINKS
-							decoder->tokens[j].parent = 0;
-#endif /* ifdef JSMN_PARENT_LINKS */
-							++j;
-						}
-					}
-					else
-					{
-						app_json_free( decoder->tokens );
-						decoder->size = 0u;
-					}
-				}
+			/* jsmn is resumable: when it runs out of tokens
+			 * the parser state is left at the token that
+			 * failed, so grow the token array and continue
+			 * parsing rather than starting again */
+			while ( i == JSMN_ERROR_NOMEM )
+			{
+				jsmntok_t *tokens;
+				unsigned int size = decoder->size * 2u;
+				if ( size < APP_JSON_JSMN_TOKENS_MIN )
+					size = APP_JSON_JSMN_TOKENS_MIN;
+				tokens = app_json_realloc( decoder->tokens,
+					sizeof( jsmntok_t ) * size );
+				if ( !tokens )
+					break;
+				decoder->tokens = tokens;
+				decoder->size = size;
+				i = jsmn_parse( &parser, js, len,
+					decoder->tokens, decoder->size );
 			}
 		}
 		else
 #endif /* ifndef IOT_STACK_ONLY */
-		{
-			size_t j;
-			jsmn_init( &parser );
-			for ( j = 0u; j < decoder->size; ++j )
-			{
-				decoder->tokens[j].type = JSMN_UNDEFINED;
-				decoder->tokens[j].start = 0;
-				decoder->tokens[j].end = 0;
-				decoder->tokens[j].size = 0;
-#ifdef JSMN_PARENT_LINKS
-				decoder->tokens[j].parent = 0;
-#endif /* ifdef JSMN_PARENT_LINKS */
-			}
-
 			i = jsmn_parse( &parser, js, len,
 				decoder->tokens, decoder->size );
-		}
 
 		if ( i == JSMN_ERROR_NOMEM )
 		{
@@ -1008,6 +1309,10 @@ iot_status_t app_json_decode_parse(
 			decoder->len = len;
 			*root = decoder->tokens;
 			result = IOT_STATUS_SUCCESS;
+#ifndef IOT_STACK_ONLY
+			if ( decoder->flags & APP_JSON_FLAG_DYNAMIC )
+				app_jsmn_index_build( decoder );
+#endif /* ifndef IOT_STACK_ONLY */
 		}
 
 		/* copy error text */
@@ -1147,6 +1452,10 @@ void app_json_decode_terminate(
 #if !defined( IOT_STACK_ONLY )
 		if ( decoder->flags & APP_JSON_FLAG_DYNAMIC && decoder->tokens )
 			app_json_free( decoder->tokens );
+		if ( decoder->index )
+			app_json_free( decoder->index );
+		if ( decoder->index_hash )
+			app_json_free( decoder->index_hash );
 #endif /* if !defined( IOT_STACK_ONLY ) */
 #endif /* defined( IOT_JSON_JSMN ) */
 
@@ -21,6 +21,18 @@
 
 #include <os.h>
 
+#if defined( __AVX2__ )
+#	include <immintrin.h> /* for _mm256_* */
+#endif /* if defined( __AVX2__ ) */
+#if defined( __SSE2__ ) || defined( _M_X64 ) || \
+	( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#	define JSON_SCAN_SSE2
+#	include <emmintrin.h> /* for _mm_* */
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+#	define JSON_SCAN_NEON
+#	include <arm_neon.h> /* for vld1q_u8 */
+#endif
+
 #if defined( IOT_JSON_JANSSON ) || defined( IOT_JSON_JSONC )
 /**
  * @brief Maximum supportable json depth
@@ -40,6 +52,8 @@ struct app_json_encoder
 	unsigned int flags;              /**< @brief output flags */
 	json_t **j_cur;                  /**< @brief current object for each level */
 	char *output;                    /**< @brief saved dumped string */
+	app_json_encode_sink_t sink;     /**< @brief output sink (optional) */
+	void *sink_data;                 /**< @brief user data for the sink */
 };
 
 /**
@@ -54,6 +68,23 @@ static iot_status_t app_json_encode_key(
 	const char *key,
 	json_t *obj );
 
+#if defined( IOT_JSON_JANSSON )
+/**
+ * @brief passes output from jansson to the sink of an encoder
+ *
+ * @param[in]      buffer              output text
+ * @param[in]      size                number of characters in @c buffer
+ * @param[in]      data                JSON encoder object
+ *
+ * @retval -1                          sink failed
+ * @retval 0                           on success
+ */
+static int app_json_encode_sink_jansson(
+	const char *buffer,
+	size_t size,
+	void *data );
+#endif /* if defined( IOT_JSON_JANSSON ) */
+
 #else /* defined( IOT_JSON_JSMN ) */
 /** @brief Maximum output depth */
 typedef unsigned long app_json_encode_struct_t;
@@ -68,6 +99,13 @@ typedef unsigned long app_json_encode_struct_t;
  */
 #define JSON_MAX_DEPTH                 ((sizeof(app_json_encode_struct_t)* 8)/JSON_STRUCT_BITS)
 
+#ifndef IOT_STACK_ONLY
+/**
+ * @brief Initial size of the output buffer for a dynamic encoder
+ */
+#define JSON_BUFFER_MIN                64u
+#endif /* ifndef IOT_STACK_ONLY */
+
 /**
  * @brief internal structure for composing JSON messages (16 bytes)
  */
@@ -78,6 +116,9 @@ struct app_json_encoder
 	unsigned int flags;              /**< @brief output flags */
 	size_t len;                      /**< @brief size of JSON buffer */
 	app_json_encode_struct_t structs;    /**< @brief array of structures */
+	app_json_encode_sink_t sink;     /**< @brief output sink (optional) */
+	void *sink_data;                 /**< @brief user data for the sink */
+	size_t flushed;                  /**< @brief characters sent to sink */
 };
 
 /** @brief JSON tokens for the start of objects & arrays */
@@ -96,16 +137,38 @@ static unsigned int app_json_encode_depth(
 	const app_json_encoder_t *encoder );
 
 /**
- * @brief calculated the number number of printable characters in an integer
+ * @brief writes the contents of the output buffer to the sink
  *
- * @param[in]      i                   integer to calculate number of characters
- * @param[in]      neg                 add characters for negative number
+ * @param[in,out]  encoder             JSON encoder object
+ * @param[in]      keep                number of characters at the end of the
+ *                                     output to keep in the buffer
  *
- * @return number of printable characters in the number
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         value returned by the sink on failure
  */
-static size_t app_json_encode_intlen(
-	uint64_t i,
-	iot_bool_t neg );
+static iot_status_t app_json_encode_drain(
+	app_json_encoder_t *encoder,
+	size_t keep );
+
+/**
+ * @brief ensures there is space in the output buffer for more characters
+ *
+ * @note for a dynamic encoder the buffer is grown geometrically (at least
+ *       doubled), so the number of reallocations while building a document
+ *       is logarithmic in its size
+ * @note for an encoder with a sink, the output is written to the sink
+ *       before the buffer is grown
+ *
+ * @param[in,out]  encoder             JSON encoder object
+ * @param[in]      required            number of characters required after
+ *                                     the current position
+ *
+ * @retval IOT_STATUS_NO_MEMORY        not enough space available
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static iot_status_t app_json_encode_grow(
+	app_json_encoder_t *encoder,
+	size_t required );
 
 /**
  * @brief helper function to start a new object
@@ -123,20 +186,6 @@ static iot_status_t app_json_encode_key(
 	size_t value_len,
 	iot_bool_t *added_parent );
 
-/**
- * @brief helper function to calculate the length of a string for encoding
- *        in JSON
- *
- * @note This function handles adding counts for extra characters required to
- *       black-slash characters in JSON string
- *
- * @param[in]      str                 sring to get length of
- *
- * @return the length of the string in characters (adding for escape characters)
- */
-static size_t app_json_encode_strlen(
-	const char* str );
-
 /**
  * @brief copies the string in src to the destination buffer in JSON format
  *
@@ -176,6 +225,235 @@ static iot_status_t app_json_encode_struct_start(
 	app_json_type_t s );
 #endif /* defined( IOT_JSON_JSMN ) */
 
+/**
+ * @brief returns the number of characters at the start of a string that can
+ *        be copied into JSON output as-is
+ *
+ * @note This function scans multiple characters at a time where supported
+ *       (AVX2, SSE2 or NEON, otherwise 8 characters in a 64-bit word) and
+ *       stops at the first double-quote, back-slash or control character,
+ *       which need to be checked for escaping
+ *
+ * @param[in]      str                 string to scan
+ * @param[in]      len                 number of characters in the string
+ *
+ * @return the number of characters before the first character requiring
+ *         checking (@c len if there are none)
+ */
+static size_t app_json_encode_clean_len(
+	const char *str,
+	size_t len );
+
+/**
+ * @brief helper function to calculate the length of a string for encoding
+ *        in JSON
+ *
+ * @note This function handles adding counts for extra characters required to
+ *       black-slash characters in JSON string
+ *
+ * @param[in]      str                 sring to get length of
+ *
+ * @return the length of the string in characters (adding for escape characters)
+ */
+static size_t app_json_encode_strlen(
+	const char* str );
+
+#if !defined( IOT_JSON_JANSSON )
+/**
+ * @brief Maximum number of characters in a formatted number
+ *
+ * (sign, 17 significant digits, up to 21 integer digits or 5 leading zeros
+ * when no exponent is used, or a decimal point and a 3 digit exponent)
+ */
+#define JSON_NUMBER_MAX_LEN            32u
+
+/** @brief Mask of the exponent bits of an IEEE-754 double */
+#define JSON_DOUBLE_EXPONENT_MASK      0x7FF0000000000000uLL
+/** @brief Mask of the significand bits of an IEEE-754 double */
+#define JSON_DOUBLE_SIGNIFICAND_MASK   0x000FFFFFFFFFFFFFuLL
+/** @brief Implicit leading bit of a normal IEEE-754 double */
+#define JSON_DOUBLE_HIDDEN_BIT         0x0010000000000000uLL
+/** @brief Exponent bias of an IEEE-754 double (including the significand) */
+#define JSON_DOUBLE_EXPONENT_BIAS      1075
+/** @brief Integral values below this are formatted without digit generation */
+#define JSON_DOUBLE_INTEGER_MAX        9007199254740992.0 /* 2^53 */
+
+/**
+ * @brief floating-point number with an explicit binary exponent (f * 2^e)
+ */
+struct app_json_diyfp
+{
+	uint64_t f;                      /**< @brief significand */
+	int e;                           /**< @brief binary exponent */
+};
+
+/** @brief Significands of the cached powers of ten 10^-348 to 10^340 */
+static const uint64_t JSON_CACHED_POWERS_F[] = {
+	0xfa8fd5a0081c0288uLL, 0xbaaee17fa23ebf76uLL, 0x8b16fb203055ac76uLL,
+	0xcf42894a5dce35eauLL, 0x9a6bb0aa55653b2duLL, 0xe61acf033d1a45dfuLL,
+	0xab70fe17c79ac6cauLL, 0xff77b1fcbebcdc4fuLL, 0xbe5691ef416bd60cuLL,
+	0x8dd01fad907ffc3cuLL, 0xd3515c2831559a83uLL, 0x9d71ac8fada6c9b5uLL,
+	0xea9c227723ee8bcbuLL, 0xaecc49914078536duLL, 0x823c12795db6ce57uLL,
+	0xc21094364dfb5637uLL, 0x9096ea6f3848984fuLL, 0xd77485cb25823ac7uLL,
+	0xa086cfcd97bf97f4uLL, 0xef340a98172aace5uLL, 0xb23867fb2a35b28euLL,
+	0x84c8d4dfd2c63f3buLL, 0xc5dd44271ad3cdbauLL, 0x936b9fcebb25c996uLL,
+	0xdbac6c247d62a584uLL, 0xa3ab66580d5fdaf6uLL, 0xf3e2f893dec3f126uLL,
+	0xb5b5ada8aaff80b8uLL, 0x87625f056c7c4a8buLL, 0xc9bcff6034c13053uLL,
+	0x964e858c91ba2655uLL, 0xdff9772470297ebduLL, 0xa6dfbd9fb8e5b88fuLL,
+	0xf8a95fcf88747d94uLL, 0xb94470938fa89bcfuLL, 0x8a08f0f8bf0f156buLL,
+	0xcdb02555653131b6uLL, 0x993fe2c6d07b7facuLL, 0xe45c10c42a2b3b06uLL,
+	0xaa242499697392d3uLL, 0xfd87b5f28300ca0euLL, 0xbce5086492111aebuLL,
+	0x8cbccc096f5088ccuLL, 0xd1b71758e219652cuLL, 0x9c40000000000000uLL,
+	0xe8d4a51000000000uLL, 0xad78ebc5ac620000uLL, 0x813f3978f8940984uLL,
+	0xc097ce7bc90715b3uLL, 0x8f7e32ce7bea5c70uLL, 0xd5d238a4abe98068uLL,
+	0x9f4f2726179a2245uLL, 0xed63a231d4c4fb27uLL, 0xb0de65388cc8ada8uLL,
+	0x83c7088e1aab65dbuLL, 0xc45d1df942711d9auLL, 0x924d692ca61be758uLL,
+	0xda01ee641a708deauLL, 0xa26da3999aef774auLL, 0xf209787bb47d6b85uLL,
+	0xb454e4a179dd1877uLL, 0x865b86925b9bc5c2uLL, 0xc83553c5c8965d3duLL,
+	0x952ab45cfa97a0b3uLL, 0xde469fbd99a05fe3uLL, 0xa59bc234db398c25uLL,
+	0xf6c69a72a3989f5cuLL, 0xb7dcbf5354e9beceuLL, 0x88fcf317f22241e2uLL,
+	0xcc20ce9bd35c78a5uLL, 0x98165af37b2153dfuLL, 0xe2a0b5dc971f303auLL,
+	0xa8d9d1535ce3b396uLL, 0xfb9b7cd9a4a7443cuLL, 0xbb764c4ca7a44410uLL,
+	0x8bab8eefb6409c1auLL, 0xd01fef10a657842cuLL, 0x9b10a4e5e9913129uLL,
+	0xe7109bfba19c0c9duLL, 0xac2820d9623bf429uLL, 0x80444b5e7aa7cf85uLL,
+	0xbf21e44003acdd2duLL, 0x8e679c2f5e44ff8fuLL, 0xd433179d9c8cb841uLL,
+	0x9e19db92b4e31ba9uLL, 0xeb96bf6ebadf77d9uLL, 0xaf87023b9bf0ee6buLL
+};
+
+/** @brief Binary exponents of the cached powers of ten 10^-348 to 10^340 */
+static const short JSON_CACHED_POWERS_E[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066
+};
+
+/** @brief Two character decimal representation of 0 to 99 */
+static const char JSON_DIGIT_PAIRS[] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+/** @brief Powers of ten representable in 64-bits */
+static const uint64_t JSON_POW10[] = {
+	1uLL, 10uLL, 100uLL, 1000uLL, 10000uLL, 100000uLL, 1000000uLL,
+	10000000uLL, 100000000uLL, 1000000000uLL, 10000000000uLL,
+	100000000000uLL, 1000000000000uLL, 10000000000000uLL,
+	100000000000000uLL, 1000000000000000uLL, 10000000000000000uLL,
+	100000000000000000uLL, 1000000000000000000uLL,
+	10000000000000000000uLL };
+
+/**
+ * @brief formats a real number as the shortest text that reads back as the
+ *        same value
+ *
+ * @note Integral values are always written with a trailing ".0" (so they are
+ *       decoded as real numbers), very large or small values are written
+ *       using an exponent (i.e. "1e+300" is written as "1e300")
+ *
+ * @param[out]     buf                 destination buffer, must hold at least
+ *                                     JSON_NUMBER_MAX_LEN characters (not
+ *                                     null-terminated)
+ * @param[in]      value               value to format
+ *
+ * @return the number of characters written, 0 if the value is not finite
+ *         (JSON has no representation for infinity or NaN)
+ */
+static size_t app_json_encode_format_real(
+	char *buf,
+	iot_float64_t value );
+
+/**
+ * @brief formats an unsigned integer, two digits at a time
+ *
+ * @param[out]     buf                 destination buffer, must hold at least
+ *                                     20 characters (not null-terminated)
+ * @param[in]      value               value to format
+ *
+ * @return the number of characters written
+ */
+static size_t app_json_encode_format_uint(
+	char *buf,
+	uint64_t value );
+
+/**
+ * @brief generates the shortest decimal digits for a positive double
+ *        (Grisu2 by Florian Loitsch)
+ *
+ * @param[in]      value               finite value greater than 0 to convert
+ * @param[out]     digits              decimal digits (at most 17, not
+ *                                     null-terminated)
+ * @param[out]     len                 number of digits generated
+ * @param[out]     k                   decimal exponent: value is digits * 10^k
+ */
+static void app_json_encode_grisu2(
+	iot_float64_t value,
+	char *digits,
+	int *len,
+	int *k );
+
+/**
+ * @brief generates the digits of the scaled value within the scaled boundaries
+ *
+ * @param[in]      w                   scaled value
+ * @param[in]      mp                  scaled upper boundary
+ * @param[in]      delta               distance between the scaled boundaries
+ * @param[out]     digits              decimal digits
+ * @param[out]     len                 number of digits generated
+ * @param[in,out]  k                   decimal exponent
+ */
+static void app_json_encode_grisu_digits(
+	struct app_json_diyfp w,
+	struct app_json_diyfp mp,
+	uint64_t delta,
+	char *digits,
+	int *len,
+	int *k );
+
+/**
+ * @brief multiplies two numbers, rounding the result to 64-bits
+ *
+ * @param[in]      a                   first number
+ * @param[in]      b                   second number
+ *
+ * @return the product a * b
+ */
+static struct app_json_diyfp app_json_encode_grisu_multiply(
+	struct app_json_diyfp a,
+	struct app_json_diyfp b );
+
+/**
+ * @brief moves the last generated digit closer to the exact value
+ *
+ * @param[in,out]  digits              decimal digits
+ * @param[in]      len                 number of digits generated
+ * @param[in]      delta               distance between the scaled boundaries
+ * @param[in]      rest                remainder after the last digit
+ * @param[in]      ten_kappa           scaled unit of the last digit
+ * @param[in]      wp_w                distance from the value to the upper
+ *                                     boundary
+ */
+static void app_json_encode_grisu_round(
+	char *digits,
+	int len,
+	uint64_t delta,
+	uint64_t rest,
+	uint64_t ten_kappa,
+	uint64_t wp_w );
+#endif /* if !defined( IOT_JSON_JANSSON ) */
+
 #if defined( IOT_JSON_JANSSON ) || defined( IOT_JSON_JSONC )
 iot_status_t app_json_encode_key(
 	app_json_encoder_t *encoder,
@@ -392,6 +670,107 @@ iot_status_t app_json_encode_bool(
 	return result;
 }
 
+/** @brief whether a character needs to be checked for escaping */
+#define JSON_CHAR_CHECK( c ) \
+	( (unsigned char)(c) < 0x20u || (c) == '\"' || (c) == '\\' )
+
+size_t app_json_encode_clean_len(
+	const char *str,
+	size_t len )
+{
+	size_t i = 0u;
+#if defined( __AVX2__ )
+	{
+		const __m256i quote = _mm256_set1_epi8( '\"' );
+		const __m256i slash = _mm256_set1_epi8( '\\' );
+		const __m256i ctrl = _mm256_set1_epi8( 0x1F );
+		iot_bool_t clean = IOT_TRUE;
+		while ( clean != IOT_FALSE && i + 32u <= len )
+		{
+			const __m256i v = _mm256_loadu_si256(
+				(const __m256i *)&str[i] );
+			/* min( v, 0x1F ) == v when v <= 0x1F */
+			const __m256i m = _mm256_or_si256(
+				_mm256_or_si256( _mm256_cmpeq_epi8( v, quote ),
+					_mm256_cmpeq_epi8( v, slash ) ),
+				_mm256_cmpeq_epi8( _mm256_min_epu8( v, ctrl ), v ) );
+			if ( _mm256_movemask_epi8( m ) == 0 )
+				i += 32u;
+			else
+				clean = IOT_FALSE;
+		}
+	}
+#endif /* if defined( __AVX2__ ) */
+#if defined( JSON_SCAN_SSE2 )
+	{
+		const __m128i quote = _mm_set1_epi8( '\"' );
+		const __m128i slash = _mm_set1_epi8( '\\' );
+		const __m128i ctrl = _mm_set1_epi8( 0x1F );
+		iot_bool_t clean = IOT_TRUE;
+		while ( clean != IOT_FALSE && i + 16u <= len )
+		{
+			const __m128i v = _mm_loadu_si128(
+				(const __m128i *)&str[i] );
+			const __m128i m = _mm_or_si128(
+				_mm_or_si128( _mm_cmpeq_epi8( v, quote ),
+					_mm_cmpeq_epi8( v, slash ) ),
+				_mm_cmpeq_epi8( _mm_min_epu8( v, ctrl ), v ) );
+			if ( _mm_movemask_epi8( m ) == 0 )
+				i += 16u;
+			else
+				clean = IOT_FALSE;
+		}
+	}
+#elif defined( JSON_SCAN_NEON )
+	{
+		const uint8x16_t quote = vdupq_n_u8( '\"' );
+		const uint8x16_t slash = vdupq_n_u8( '\\' );
+		const uint8x16_t ctrl = vdupq_n_u8( 0x20 );
+		iot_bool_t clean = IOT_TRUE;
+		while ( clean != IOT_FALSE && i + 16u <= len )
+		{
+			const uint8x16_t v = vld1q_u8(
+				(const uint8_t *)&str[i] );
+			const uint8x16_t m = vorrq_u8(
+				vorrq_u8( vceqq_u8( v, quote ),
+					vceqq_u8( v, slash ) ),
+				vcltq_u8( v, ctrl ) );
+			if ( vmaxvq_u8( m ) == 0u )
+				i += 16u;
+			else
+				clean = IOT_FALSE;
+		}
+	}
+#else
+	{
+		/* 8 characters at a time: a byte of (x - n) & ~x has its high
+		 * bit set when the byte of x is less than n */
+		const uint64_t ones = 0x0101010101010101uLL;
+		const uint64_t highs = 0x8080808080808080uLL;
+		iot_bool_t clean = IOT_TRUE;
+		while ( clean != IOT_FALSE && i + 8u <= len )
+		{
+			uint64_t v;
+			uint64_t q;
+			uint64_t b;
+			os_memcpy( &v, &str[i], sizeof( uint64_t ) );
+			q = v ^ ( ones * (uint64_t)'\"' );
+			b = v ^ ( ones * (uint64_t)'\\' );
+			if ( ( ( ( v - ones * 0x20u ) & ~v ) |
+			       ( ( q - ones ) & ~q ) |
+			       ( ( b - ones ) & ~b ) ) & highs )
+				clean = IOT_FALSE;
+			else
+				i += 8u;
+		}
+	}
+#endif
+	/* locate the character (or finish the tail) one at a time */
+	while ( i < len && !JSON_CHAR_CHECK( str[i] ) )
+		++i;
+	return i;
+}
+
 #if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
 unsigned int app_json_encode_depth( const app_json_encoder_t *encoder )
 {
@@ -404,6 +783,75 @@ unsigned int app_json_encode_depth( const app_json_encoder_t *encoder )
 	}
 	return i;
 }
+
+iot_status_t app_json_encode_drain(
+	app_json_encoder_t *encoder,
+	size_t keep )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	if ( encoder->sink && encoder->cur )
+	{
+		const size_t used = (size_t)(encoder->cur - encoder->buf);
+		if ( used > keep )
+		{
+			const size_t len = used - keep;
+			result = encoder->sink( encoder->sink_data,
+				encoder->buf, len );
+			if ( result == IOT_STATUS_SUCCESS )
+			{
+				os_memmove( encoder->buf, encoder->buf + len,
+					keep );
+				encoder->cur = encoder->buf + keep;
+				encoder->flushed += len;
+			}
+		}
+	}
+	return result;
+}
+
+iot_status_t app_json_encode_grow(
+	app_json_encoder_t *encoder,
+	size_t required )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	size_t used = 0u;
+	if ( encoder->cur )
+		used = (size_t)(encoder->cur - encoder->buf);
+	if ( encoder->len - used < required && encoder->sink && used > 1u )
+	{
+		/* the last character is kept, as it determines whether a
+		 * separator is needed before the next item */
+		result = app_json_encode_drain( encoder, 1u );
+		used = (size_t)(encoder->cur - encoder->buf);
+	}
+	if ( result == IOT_STATUS_SUCCESS && encoder->len - used < required )
+	{
+		result = IOT_STATUS_NO_MEMORY;
+#ifndef IOT_STACK_ONLY
+		if ( encoder->flags & APP_JSON_FLAG_DYNAMIC )
+		{
+			void *new_buf;
+			size_t new_len = encoder->len * 2u;
+			if ( new_len < JSON_BUFFER_MIN )
+				new_len = JSON_BUFFER_MIN;
+			if ( new_len < used + required )
+				new_len = used + required;
+
+			/* +1 for null-terminator */
+			new_buf = app_json_realloc( encoder->buf, new_len + 1u );
+			if ( new_buf )
+			{
+				if ( encoder->cur )
+					encoder->cur = (char*)new_buf + used;
+				encoder->buf = new_buf;
+				encoder->len = new_len;
+				result = IOT_STATUS_SUCCESS;
+			}
+		}
+#endif /* ifndef IOT_STACK_ONLY */
+	}
+	return result;
+}
 #endif /* !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC ) */
 
 const char *app_json_encode_dump(
@@ -434,7 +882,7 @@ const char *app_json_encode_dump(
 		encoder->output = NULL;
 	}
 
-	if ( encoder && encoder->j_cur )
+	if ( encoder && encoder->j_cur && !encoder->sink )
 		result = encoder->output = json_dumps( encoder->j_cur[0u], flags );
 #elif defined( IOT_JSON_JSONC )
 	if ( encoder )
@@ -452,7 +900,7 @@ const char *app_json_encode_dump(
 		if ( encoder->flags >> APP_JSON_INDENT_OFFSET )
 			flags |= JSON_C_TO_STRING_PRETTY;
 
-		if ( encoder->j_cur && encoder->j_cur[0u] )
+		if ( encoder->j_cur && encoder->j_cur[0u] && !encoder->sink )
 		{
 			const char *const output =
 				json_object_to_json_string_ext(
@@ -469,14 +917,27 @@ const char *app_json_encode_dump(
 		}
 	}
 #else /* defined( IOT_JSON_JSMN ) */
-	if ( encoder && encoder->buf && *encoder->buf != '\0' )
+	/* with a sink, output is written using app_json_encode_flush */
+	if ( encoder && encoder->buf && *encoder->buf != '\0' &&
+		!encoder->sink )
 	{
 		/* complete any open objects in the output string */
 		char *p_cur = encoder->cur;
+		unsigned int indent = (encoder->flags >> APP_JSON_INDENT_OFFSET);
+		unsigned int depth = app_json_encode_depth( encoder );
+#ifndef IOT_STACK_ONLY
+		/* a dynamic buffer is only grown to fit the items added, so
+		 * make room for closing any structures still open */
+		if ( p_cur && encoder->flags & APP_JSON_FLAG_DYNAMIC )
+		{
+			p_cur = NULL;
+			if ( app_json_encode_grow( encoder,
+				depth * ( indent * depth + 2u ) ) == IOT_STATUS_SUCCESS )
+				p_cur = encoder->cur;
+		}
+#endif /* ifndef IOT_STACK_ONLY */
 		if ( p_cur )
 		{
-			unsigned int indent = (encoder->flags >> APP_JSON_INDENT_OFFSET);
-			unsigned int depth = app_json_encode_depth( encoder );
 			app_json_encode_struct_t s = encoder->structs;
 
 			while ( s )
@@ -519,6 +980,419 @@ const char *app_json_encode_dump(
 	return result;
 }
 
+size_t app_json_encode_estimate(
+	const app_json_encoder_t *encoder,
+	const char *key,
+	const char *value,
+	size_t value_len )
+{
+	size_t result = value_len;
+	if ( value )
+		result = app_json_encode_strlen( value ) + 2u; /* '"' around */
+	if ( key )
+		result += app_json_encode_strlen( key ) + 3u; /* '"' & ':' */
+	++result; /* ',' */
+	if ( encoder )
+	{
+		const unsigned int indent =
+			(encoder->flags >> APP_JSON_INDENT_OFFSET);
+		if ( encoder->flags & APP_JSON_FLAG_EXPAND )
+			result += 2u; /* ' ' after ',' & ':' */
+		if ( indent )
+		{
+#if defined( IOT_JSON_JANSSON ) || defined( IOT_JSON_JSONC )
+			const unsigned int depth = encoder->depth;
+#else /* defined( IOT_JSON_JSMN ) */
+			const unsigned int depth =
+				app_json_encode_depth( encoder );
+#endif /* defined( IOT_JSON_JSMN ) */
+			result += indent * ( depth + 1u ) + 1u; /* +1 for '\n' */
+		}
+	}
+	return result;
+}
+
+iot_status_t app_json_encode_flush(
+	app_json_encoder_t *encoder )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( encoder && !encoder->sink )
+		result = IOT_STATUS_BAD_REQUEST;
+	else if ( encoder )
+	{
+#if defined( IOT_JSON_JANSSON )
+		result = IOT_STATUS_SUCCESS;
+		if ( encoder->j_cur && encoder->j_cur[0u] )
+		{
+			size_t flags = JSON_PRESERVE_ORDER;
+			if ( !( encoder->flags & APP_JSON_FLAG_EXPAND ) )
+				flags |= JSON_COMPACT;
+			if ( encoder->flags >> APP_JSON_INDENT_OFFSET )
+				flags |= JSON_INDENT(
+					encoder->flags >> APP_JSON_INDENT_OFFSET );
+			if ( json_dump_callback( encoder->j_cur[0u],
+				app_json_encode_sink_jansson, encoder,
+				flags ) != 0 )
+				result = IOT_STATUS_FAILURE;
+			if ( result == IOT_STATUS_SUCCESS )
+			{
+				json_decref( encoder->j_cur[0u] );
+				encoder->j_cur[0u] = NULL;
+				encoder->depth = 0u;
+			}
+		}
+#elif defined( IOT_JSON_JSONC )
+		result = IOT_STATUS_SUCCESS;
+		if ( encoder->j_cur && encoder->j_cur[0u] )
+		{
+			int flags = JSON_C_TO_STRING_PLAIN;
+			const char *output;
+			if ( encoder->flags & APP_JSON_FLAG_EXPAND )
+				flags |= JSON_C_TO_STRING_SPACED;
+			if ( encoder->flags >> APP_JSON_INDENT_OFFSET )
+				flags |= JSON_C_TO_STRING_PRETTY;
+
+			/* the string is owned by the object, so it is passed
+			 * to the sink without copying */
+			output = json_object_to_json_string_ext(
+				encoder->j_cur[0u], flags );
+			result = IOT_STATUS_NO_MEMORY;
+			if ( output )
+				result = encoder->sink( encoder->sink_data,
+					output, os_strlen( output ) );
+			if ( result == IOT_STATUS_SUCCESS )
+			{
+				json_object_put( encoder->j_cur[0u] );
+				encoder->j_cur[0u] = NULL;
+				encoder->depth = 0u;
+			}
+		}
+#else /* defined( IOT_JSON_JSMN ) */
+		/* complete any open objects, then write what remains */
+		result = IOT_STATUS_SUCCESS;
+		while ( result == IOT_STATUS_SUCCESS && encoder->structs )
+			result = app_json_encode_struct_end( encoder,
+				(app_json_type_t)encoder->structs );
+		if ( result == IOT_STATUS_SUCCESS )
+			result = app_json_encode_drain( encoder, 0u );
+		if ( result == IOT_STATUS_SUCCESS )
+		{
+			/* ready for the next document */
+			encoder->cur = NULL;
+			encoder->flushed = 0u;
+			if ( encoder->buf )
+				*encoder->buf = '\0';
+		}
+#endif /* defined( IOT_JSON_JSMN ) */
+	}
+	return result;
+}
+
+#if !defined( IOT_JSON_JANSSON )
+size_t app_json_encode_format_real(
+	char *buf,
+	iot_float64_t value )
+{
+	size_t len = 0u;
+	union
+	{
+		iot_float64_t d;
+		uint64_t u;
+	} bits;
+
+	bits.d = value;
+	if ( ( bits.u & JSON_DOUBLE_EXPONENT_MASK ) != JSON_DOUBLE_EXPONENT_MASK )
+	{
+		if ( bits.u >> 63 )
+		{
+			buf[len++] = '-';
+			value = -value;
+		}
+
+		if ( value < JSON_DOUBLE_INTEGER_MAX &&
+			value == (iot_float64_t)(uint64_t)value )
+		{
+			/* integral values (including 0) are exact as integers */
+			len += app_json_encode_format_uint( &buf[len],
+				(uint64_t)value );
+			buf[len++] = '.';
+			buf[len++] = '0';
+		}
+		else
+		{
+			char *const p = &buf[len];
+			int digits_len;
+			int i;
+			int k;
+			int kk;
+
+			app_json_encode_grisu2( value, p, &digits_len, &k );
+			kk = digits_len + k; /* 10^(kk-1) <= value < 10^kk */
+			if ( k >= 0 && kk <= 21 )
+			{
+				/* 1234e7 -> 12340000000.0 */
+				for ( i = digits_len; i < kk; ++i )
+					p[i] = '0';
+				p[kk] = '.';
+				p[kk + 1] = '0';
+				len += (size_t)kk + 2u;
+			}
+			else if ( kk > 0 && kk <= 21 )
+			{
+				/* 1234e-2 -> 12.34 */
+				os_memmove( &p[kk + 1], &p[kk],
+					(size_t)( digits_len - kk ) );
+				p[kk] = '.';
+				len += (size_t)digits_len + 1u;
+			}
+			else if ( kk > -6 && kk <= 0 )
+			{
+				/* 1234e-6 -> 0.001234 */
+				const int offset = 2 - kk;
+				os_memmove( &p[offset], p, (size_t)digits_len );
+				p[0] = '0';
+				p[1] = '.';
+				for ( i = 2; i < offset; ++i )
+					p[i] = '0';
+				len += (size_t)( digits_len + offset );
+			}
+			else
+			{
+				/* 1234e30 -> 1.234e33 */
+				int exponent = kk - 1;
+				if ( digits_len > 1 )
+				{
+					os_memmove( &p[2], &p[1],
+						(size_t)( digits_len - 1 ) );
+					p[1] = '.';
+					++digits_len;
+				}
+				p[digits_len++] = 'e';
+				if ( exponent < 0 )
+				{
+					p[digits_len++] = '-';
+					exponent = -exponent;
+				}
+				len += (size_t)digits_len +
+					app_json_encode_format_uint(
+						&p[digits_len],
+						(uint64_t)exponent );
+			}
+		}
+	}
+	return len;
+}
+
+size_t app_json_encode_format_uint(
+	char *buf,
+	uint64_t value )
+{
+	char digits[20u];
+	size_t pos = sizeof( digits );
+	size_t len;
+
+	while ( value >= 100u )
+	{
+		const size_t i = (size_t)( value % 100u ) * 2u;
+		value /= 100u;
+		digits[--pos] = JSON_DIGIT_PAIRS[i + 1u];
+		digits[--pos] = JSON_DIGIT_PAIRS[i];
+	}
+	if ( value >= 10u )
+	{
+		const size_t i = (size_t)value * 2u;
+		digits[--pos] = JSON_DIGIT_PAIRS[i + 1u];
+		digits[--pos] = JSON_DIGIT_PAIRS[i];
+	}
+	else
+		digits[--pos] = (char)( '0' + value );
+
+	len = sizeof( digits ) - pos;
+	os_memcpy( buf, &digits[pos], len );
+	return len;
+}
+
+void app_json_encode_grisu2(
+	iot_float64_t value,
+	char *digits,
+	int *len,
+	int *k )
+{
+	struct app_json_diyfp c_mk;
+	struct app_json_diyfp v;
+	struct app_json_diyfp w;
+	struct app_json_diyfp w_m;
+	struct app_json_diyfp w_p;
+	double dk;
+	size_t idx;
+	int biased_e;
+	union
+	{
+		iot_float64_t d;
+		uint64_t u;
+	} bits;
+
+	bits.d = value;
+	biased_e = (int)( ( bits.u & JSON_DOUBLE_EXPONENT_MASK ) >> 52 );
+	v.f = bits.u & JSON_DOUBLE_SIGNIFICAND_MASK;
+	if ( biased_e != 0 )
+	{
+		v.f += JSON_DOUBLE_HIDDEN_BIT;
+		v.e = biased_e - JSON_DOUBLE_EXPONENT_BIAS;
+	}
+	else
+		v.e = 1 - JSON_DOUBLE_EXPONENT_BIAS; /* subnormal */
+
+	/* upper boundary: half way to the next double, normalized */
+	w_p.f = ( v.f << 1 ) + 1u;
+	w_p.e = v.e - 1;
+	while ( !( w_p.f & ( JSON_DOUBLE_HIDDEN_BIT << 1 ) ) )
+	{
+		w_p.f <<= 1;
+		--w_p.e;
+	}
+	w_p.f <<= 10;
+	w_p.e -= 10;
+
+	/* lower boundary: closer when the value is a power of 2 */
+	if ( v.f == JSON_DOUBLE_HIDDEN_BIT )
+	{
+		w_m.f = ( v.f << 2 ) - 1u;
+		w_m.e = v.e - 2;
+	}
+	else
+	{
+		w_m.f = ( v.f << 1 ) - 1u;
+		w_m.e = v.e - 1;
+	}
+	w_m.f <<= w_m.e - w_p.e;
+	w_m.e = w_p.e;
+
+	w = v;
+	while ( !( w.f & 0x8000000000000000uLL ) )
+	{
+		w.f <<= 1;
+		--w.e;
+	}
+
+	/* cached power of ten bringing the binary exponent into [-60, -32] */
+	dk = ( -61 - w_p.e ) * 0.30102999566398114 + 347.0;
+	*k = (int)dk;
+	if ( dk - *k > 0.0 )
+		++(*k);
+	idx = (size_t)( ( *k >> 3 ) + 1 );
+	*k = 348 - (int)( idx * 8u );
+	c_mk.f = JSON_CACHED_POWERS_F[idx];
+	c_mk.e = JSON_CACHED_POWERS_E[idx];
+
+	w = app_json_encode_grisu_multiply( w, c_mk );
+	w_p = app_json_encode_grisu_multiply( w_p, c_mk );
+	w_m = app_json_encode_grisu_multiply( w_m, c_mk );
+	++w_m.f;
+	--w_p.f;
+	app_json_encode_grisu_digits( w, w_p, w_p.f - w_m.f, digits, len, k );
+}
+
+void app_json_encode_grisu_digits(
+	struct app_json_diyfp w,
+	struct app_json_diyfp mp,
+	uint64_t delta,
+	char *digits,
+	int *len,
+	int *k )
+{
+	const unsigned int shift = (unsigned int)-mp.e;
+	const uint64_t one = 1uLL << shift;
+	const uint64_t wp_w = mp.f - w.f;
+	uint32_t p1 = (uint32_t)( mp.f >> shift );
+	uint64_t p2 = mp.f & ( one - 1u );
+	int kappa = 1;
+	iot_bool_t done = IOT_FALSE;
+
+	while ( kappa < 10 && p1 >= JSON_POW10[kappa] )
+		++kappa;
+
+	*len = 0;
+	/* integral part */
+	while ( kappa > 0 && done == IOT_FALSE )
+	{
+		const uint32_t d = (uint32_t)( p1 / JSON_POW10[kappa - 1] );
+		uint64_t rest;
+		p1 %= (uint32_t)JSON_POW10[kappa - 1];
+		if ( d || *len )
+			digits[(*len)++] = (char)( '0' + d );
+		--kappa;
+		rest = ( (uint64_t)p1 << shift ) + p2;
+		if ( rest <= delta )
+		{
+			*k += kappa;
+			app_json_encode_grisu_round( digits, *len, delta, rest,
+				JSON_POW10[kappa] << shift, wp_w );
+			done = IOT_TRUE;
+		}
+	}
+
+	/* fractional part */
+	while ( done == IOT_FALSE )
+	{
+		char d;
+		p2 *= 10u;
+		delta *= 10u;
+		d = (char)( p2 >> shift );
+		if ( d || *len )
+			digits[(*len)++] = (char)( '0' + d );
+		p2 &= one - 1u;
+		--kappa;
+		if ( p2 < delta )
+		{
+			*k += kappa;
+			app_json_encode_grisu_round( digits, *len, delta, p2,
+				one, -kappa < 20 ? wp_w * JSON_POW10[-kappa] : 0u );
+			done = IOT_TRUE;
+		}
+	}
+}
+
+struct app_json_diyfp app_json_encode_grisu_multiply(
+	struct app_json_diyfp a,
+	struct app_json_diyfp b )
+{
+	const uint64_t mask = 0xFFFFFFFFuLL;
+	const uint64_t a_hi = a.f >> 32;
+	const uint64_t a_lo = a.f & mask;
+	const uint64_t b_hi = b.f >> 32;
+	const uint64_t b_lo = b.f & mask;
+	const uint64_t hi_hi = a_hi * b_hi;
+	const uint64_t lo_hi = a_lo * b_hi;
+	const uint64_t hi_lo = a_hi * b_lo;
+	const uint64_t lo_lo = a_lo * b_lo;
+	uint64_t mid = ( lo_lo >> 32 ) + ( hi_lo & mask ) + ( lo_hi & mask );
+	struct app_json_diyfp result;
+
+	mid += 1uLL << 31; /* round */
+	result.f = hi_hi + ( hi_lo >> 32 ) + ( lo_hi >> 32 ) + ( mid >> 32 );
+	result.e = a.e + b.e + 64;
+	return result;
+}
+
+void app_json_encode_grisu_round(
+	char *digits,
+	int len,
+	uint64_t delta,
+	uint64_t rest,
+	uint64_t ten_kappa,
+	uint64_t wp_w )
+{
+	while ( rest < wp_w && delta - rest >= ten_kappa &&
+		( rest + ten_kappa < wp_w ||
+		  wp_w - rest > rest + ten_kappa - wp_w ) )
+	{
+		--digits[len - 1];
+		rest += ten_kappa;
+	}
+}
+#endif /* if !defined( IOT_JSON_JANSSON ) */
+
 app_json_encoder_t *app_json_encode_initialize(
 	void *buf,
 	size_t len,
@@ -578,6 +1452,9 @@ app_json_encoder_t *app_json_encode_initialize(
 #endif /* ifndef IOT_STACK_ONLY */
 #if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
 			encoder->structs = 0u;
+			encoder->sink = NULL;
+			encoder->sink_data = NULL;
+			encoder->flushed = 0u;
 #endif /* if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC ) */
 			encoder->flags = flags;
 #ifndef IOT_STACK_ONLY
@@ -604,37 +1481,24 @@ iot_status_t app_json_encode_integer(
 	else
 	{
 		iot_bool_t added_parent = IOT_FALSE;
-		uint64_t pos_value;
-		size_t value_len;
+		char num[JSON_NUMBER_MAX_LEN];
+		uint64_t pos_value = (uint64_t)value;
+		size_t value_len = 0u;
 		if ( value < 0 )
-			pos_value = (uint64_t)(value * -1);
-		else
-			pos_value = (uint64_t)value;
+		{
+			num[value_len++] = '-';
+			/* negate as unsigned, so the minimum value is handled */
+			pos_value = 0u - pos_value;
+		}
+		value_len += app_json_encode_format_uint( &num[value_len],
+			pos_value );
 
-		value_len = app_json_encode_intlen( pos_value, value < 0 );
 		result = app_json_encode_key( encoder, key, value_len,
 			&added_parent );
 		if ( result == IOT_STATUS_SUCCESS )
 		{
-			char *dest = &encoder->cur[value_len - 1u];
-			if ( value <= 0 )
-			{
-				if ( value < 0 )
-				{
-					*encoder->cur = '-';
-					value *= -1;
-				}
-				else
-					*encoder->cur = '0';
-				++encoder->cur;
-			}
-			while ( pos_value > 0 )
-			{
-				*dest = (pos_value % 10 + '0');
-				pos_value /= 10;
-				--dest;
-				++encoder->cur;
-			}
+			os_memcpy( encoder->cur, num, value_len );
+			encoder->cur += value_len;
 
 			if ( added_parent )
 				result = app_json_encode_struct_end( encoder,
@@ -646,19 +1510,6 @@ iot_status_t app_json_encode_integer(
 }
 
 #if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
-size_t app_json_encode_intlen( uint64_t i, iot_bool_t neg )
-{
-	size_t len = 0u;
-	if ( neg || i == 0 )
-		++len;
-	while ( i > 0 )
-	{
-		i /= 10;
-		++len;
-	}
-	return len;
-}
-
 iot_status_t app_json_encode_key(
 	app_json_encoder_t *encoder,
 	const char *key,
@@ -695,7 +1546,6 @@ iot_status_t app_json_encode_key(
 
 		if ( result == IOT_STATUS_SUCCESS )
 		{
-			size_t space = encoder->len - (size_t)(encoder->cur - encoder->buf);
 			iot_bool_t add_comma = 0;
 			unsigned int indent = (encoder->flags >> APP_JSON_INDENT_OFFSET);
 			const unsigned int depth = app_json_encode_depth( encoder );
@@ -728,31 +1578,12 @@ iot_status_t app_json_encode_key(
 			if ( indent )
 				extra_space += ( indent * 2u * depth ) + 1u; /* +1 for '\n' */
 
-#ifndef IOT_STACK_ONLY
-			if ( encoder->flags & APP_JSON_FLAG_DYNAMIC )
-			{
-				const size_t new_space =
-					encoder->len + key_len + value_len + extra_space;
-				void *const new_buf = app_json_realloc(
-					encoder->buf, new_space + 1u );
-				if ( new_buf )
-				{
-					encoder->cur = (char*)new_buf +
-						(encoder->cur - encoder->buf);
-					encoder->buf = new_buf;
-					encoder->len = new_space;
-					space = new_space;
-				}
-			}
-			else
-#endif /* ifndef IOT_STACK_ONLY */
+			result = app_json_encode_grow( encoder,
+				key_len + value_len + extra_space );
+			if ( result == IOT_STATUS_SUCCESS )
 			{
 				if ( !encoder->cur )
 					encoder->cur = encoder->buf;
-			}
-
-			if ( key_len + value_len + extra_space <= space )
-			{
 				if ( add_comma )
 				{
 					*encoder->cur = ',';
@@ -793,10 +1624,7 @@ iot_status_t app_json_encode_key(
 						++encoder->cur;
 					}
 				}
-				result = IOT_STATUS_SUCCESS;
 			}
-			else
-				result = IOT_STATUS_NO_MEMORY;
 		}
 	}
 	return result;
@@ -929,13 +1757,20 @@ iot_status_t app_json_encode_object_cancel(
 			}
 			else
 				new_pos = save_pos + 1;
-			encoder->cur = new_pos;
-			encoder->structs >>= 3;
 
-			/* removed the root element */
-			if ( encoder->structs == 0 )
-				*encoder->buf = '\0';
-			result = IOT_STATUS_SUCCESS;
+			/* the start of the object (or its key) has been written
+			 * to the sink, so it can no longer be removed */
+			if ( encoder->flushed == 0u ||
+				( save_pos > encoder->buf && new_pos > encoder->buf ) )
+			{
+				encoder->cur = new_pos;
+				encoder->structs >>= 3;
+
+				/* removed the root element */
+				if ( encoder->structs == 0 )
+					*encoder->buf = '\0';
+				result = IOT_STATUS_SUCCESS;
+			}
 		}
 #endif /* defined( IOT_JSON_JSMN ) */
 	}
@@ -1001,9 +1836,14 @@ iot_status_t app_json_encode_object_clear(
 					++depth_count;
 				--new_pos;
 			}
-			++new_pos;
-			encoder->cur = new_pos;
-			result = IOT_STATUS_SUCCESS;
+			/* the start of the object has been written to the sink */
+			if ( encoder->flushed == 0u ||
+				*new_pos == JSON_CHARS_START[2] )
+			{
+				++new_pos;
+				encoder->cur = new_pos;
+				result = IOT_STATUS_SUCCESS;
+			}
 		}
 #endif /* defined( IOT_JSON_JSMN ) */
 	}
@@ -1055,12 +1895,6 @@ iot_status_t app_json_encode_object_start(
 	return result;
 }
 
-/**
- * @def JSON_ENCODE_MAX_DECIMALS
- * @brief number of decimals to display for real data
- */
-#define JSON_ENCODE_MAX_DECIMALS 6
-
 iot_status_t app_json_encode_real(
 	app_json_encoder_t *encoder,
 	const char *key,
@@ -1070,69 +1904,106 @@ iot_status_t app_json_encode_real(
 #if defined( IOT_JSON_JANSSON )
 	result = app_json_encode_key( encoder, key, json_real( value ) );
 #elif defined( IOT_JSON_JSONC )
+#if JSON_C_MAJOR_VERSION < 0 || \
+	(JSON_C_MAJOR_VERSION == 0 && JSON_C_MINOR_VERSION < 13) || \
+	(JSON_C_MAJOR_VERSION == 0 && JSON_C_MINOR_VERSION == 13) && (JSON_C_MICRO_VERSION < 1)
 	result = app_json_encode_key( encoder, key, json_object_new_double( value ) );
+#else /* if json-c < 0.13.1 */
+	struct json_object *v = NULL;
+	char num[JSON_NUMBER_MAX_LEN + 1u];
+	const size_t value_len = app_json_encode_format_real( num, value );
+	if ( value_len > 0u )
+	{
+		num[value_len] = '\0';
+		v = json_object_new_double_s( value, num );
+	}
+	result = app_json_encode_key( encoder, key, v );
+#endif /* else if json-c < 0.13.1 */
 #else /* defined( IOT_JSON_JSMN ) */
 	/* can't add boolean as root element */
 	if ( !key && ( encoder && encoder->structs == 0u ) )
 		result = IOT_STATUS_BAD_REQUEST;
 	else
 	{
-		iot_bool_t added_parent = 0;
-
-		uint64_t i = (uint64_t)value;
-		double frac = value - i;
-		size_t int_len;
-		size_t value_len;
+		char num[JSON_NUMBER_MAX_LEN];
+		const size_t value_len = app_json_encode_format_real( num, value );
 
-		/* handle negative numbers */
-		if ( value < 0.0 )
+		/* no JSON representation for infinity or NaN */
+		result = IOT_STATUS_BAD_PARAMETER;
+		if ( value_len > 0u )
 		{
-			i = (uint64_t)(value * -1.0);
-			frac = (value * -1.0) - i;
-		}
-
-		int_len = app_json_encode_intlen( i, value < 0.0 );
-		value_len = int_len + JSON_ENCODE_MAX_DECIMALS + 1u;
-		result = app_json_encode_key( encoder, key, value_len, &added_parent );
-		if ( result == IOT_STATUS_SUCCESS )
-		{
-			char *dest = &encoder->cur[int_len - 1u];
-			if ( value < 0.0 )
+			iot_bool_t added_parent = IOT_FALSE;
+			result = app_json_encode_key( encoder, key, value_len,
+				&added_parent );
+			if ( result == IOT_STATUS_SUCCESS )
 			{
-				*encoder->cur = '-';
-				++encoder->cur;
+				os_memcpy( encoder->cur, num, value_len );
+				encoder->cur += value_len;
+				if ( added_parent )
+					result = app_json_encode_struct_end(
+						encoder,
+						APP_JSON_TYPE_OBJECT << 1u );
 			}
+		}
+	}
+#endif /* defined( IOT_JSON_JSMN ) */
+	return result;
+}
 
-			if ( i == 0 )
-			{
-				*encoder->cur = '0';
-				++encoder->cur;
-			}
+iot_status_t app_json_encode_reserve(
+	app_json_encoder_t *encoder,
+	size_t len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( encoder )
+	{
+#if defined( IOT_JSON_JANSSON ) || defined( IOT_JSON_JSONC )
+		/* items are held in a tree until dumped, nothing to reserve */
+		(void)len;
+		result = IOT_STATUS_SUCCESS;
+#else /* defined( IOT_JSON_JSMN ) */
+		result = app_json_encode_grow( encoder, len );
+#endif /* defined( IOT_JSON_JSMN ) */
+	}
+	return result;
+}
 
-			while ( i > 0u )
-			{
-				*dest = (i % 10 + '0');
-				i /= 10;
-				--dest;
-				++encoder->cur;
-			}
+#if defined( IOT_JSON_JANSSON )
+int app_json_encode_sink_jansson(
+	const char *buffer,
+	size_t size,
+	void *data )
+{
+	int result = -1;
+	app_json_encoder_t *const encoder = (app_json_encoder_t *)data;
+	if ( encoder && encoder->sink( encoder->sink_data, buffer, size ) ==
+		IOT_STATUS_SUCCESS )
+		result = 0;
+	return result;
+}
+#endif /* if defined( IOT_JSON_JANSSON ) */
 
-			*encoder->cur++ = '.';
-			i = 0u;
-			do {
-				int j;
-				frac *= 10.0;
-				j = (int)(frac);
-				*encoder->cur++ = '0' + (char)j;
-				frac -= j;
-				++i;
-			} while ( frac > 0.0 && i < JSON_ENCODE_MAX_DECIMALS );
-			if ( added_parent )
-				result = app_json_encode_struct_end( encoder,
-					APP_JSON_TYPE_OBJECT << 1u );
+iot_status_t app_json_encode_sink_set(
+	app_json_encoder_t *encoder,
+	app_json_encode_sink_t sink,
+	void *user_data )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( encoder )
+	{
+		result = IOT_STATUS_BAD_REQUEST;
+#if defined( IOT_JSON_JANSSON ) || defined( IOT_JSON_JSONC )
+		if ( encoder->depth == 0u )
+#else /* defined( IOT_JSON_JSMN ) */
+		if ( !encoder->cur || encoder->cur == encoder->buf )
+#endif /* defined( IOT_JSON_JSMN ) */
+		{
+			/* only changed between documents */
+			encoder->sink = sink;
+			encoder->sink_data = user_data;
+			result = IOT_STATUS_SUCCESS;
 		}
 	}
-#endif /* defined( IOT_JSON_JSMN ) */
 	return result;
 }
 
@@ -1179,79 +2050,86 @@ iot_status_t app_json_encode_string(
 	return result;
 }
 
-#if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
 size_t app_json_encode_strlen(
 	const char* str )
 {
-	size_t result = 0u;
-	while ( *str != '\0' )
+	const size_t len = os_strlen( str );
+	size_t result = len;
+	size_t i = app_json_encode_clean_len( str, len );
+	while ( i < len )
 	{
-		/* add additional character for null-terminator */
-		if ( *str == '\"' || *str == '\\' || *str == '\b' ||
-		     *str == '\f' || *str == '\n' || *str == '\r' ||
-		     *str == '\t' )
+		/* add additional character for the back-slash */
+		if ( str[i] == '\"' || str[i] == '\\' || str[i] == '\b' ||
+		     str[i] == '\f' || str[i] == '\n' || str[i] == '\r' ||
+		     str[i] == '\t' )
 			++result;
-		++result;
-		++str;
+		++i;
+		i += app_json_encode_clean_len( &str[i], len - i );
 	}
 	return result;
 }
 
+#if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
+
 char *app_json_encode_strncpy(
 	char *dest,
 	const char *src,
 	size_t num )
 {
-	iot_bool_t skip_char = IOT_FALSE;
+	const char *const src_end = src + os_strlen( src );
 	char *out = dest;
 	size_t i = 0u;
-	while ( i < num && *src != '\0' )
+	while ( i < num && src < src_end )
 	{
-		if ( *src == '\"' || *src == '\\' || *src == '\b' ||
-		     *src == '\f' || *src == '\n' || *src == '\r' ||
-		     *src == '\t' )
-		{
-			if ( i + 1u < num )
-			{
-				*out = '\\';
-				++out;
-				++i;
-			}
-			else
-				skip_char = IOT_TRUE;
-		}
-
-		if ( skip_char == IOT_FALSE )
+		/* bulk copy characters not requiring an escape */
+		size_t run = app_json_encode_clean_len( src,
+			(size_t)( src_end - src ) );
+		if ( run > num - i )
+			run = num - i;
+		os_memcpy( out, src, run );
+		out += run;
+		src += run;
+		i += run;
+
+		if ( i < num && src < src_end )
 		{
-			switch ( *src )
+			char c = *src;
+			switch ( c )
 			{
 			case '\b':
-				*out = 'b';
+				c = 'b';
 				break;
 			case '\f':
-				*out = 'f';
+				c = 'f';
 				break;
 			case '\n':
-				*out = 'n';
+				c = 'n';
 				break;
 			case '\r':
-				*out = 'r';
+				c = 'r';
 				break;
 			case '\t':
-				*out = 't';
+				c = 't';
 				break;
-			default:
-				*out = *src;
 			}
+
+			if ( c != *src || c == '\"' || c == '\\' )
+			{
+				/* escape doesn't fit, stop before it */
+				if ( i + 1u >= num )
+					break;
+				*out++ = '\\';
+				++i;
+			}
+			*out++ = c;
 			++src;
-			++out;
 			++i;
 		}
 	}
 
 	/* pad remaining with zero's */
 	for ( ; i < num; ++i )
-		*out = '\0';
+		*out++ = '\0';
 	return dest;
 }
 
@@ -1280,28 +2158,10 @@ iot_status_t app_json_encode_struct_end(
 					/* +2 for '\n' + ']' or '}' character */
 					if ( (indent * depth) + 2u > space )
 					{
-#ifndef IOT_STACK_ONLY
-						if ( encoder->flags & APP_JSON_FLAG_DYNAMIC )
-						{
-							const size_t new_space =
-								(depth * indent) + 2u;
-							void *const new_buf = app_json_realloc(
-								encoder->buf,
-								encoder->len + new_space );
-							if ( new_buf )
-							{
-								encoder->cur = (char*)new_buf +
-									(encoder->cur - encoder->buf);
-								encoder->buf = new_buf;
-								encoder->len += new_space;
-								space += new_space;
-							}
-							else
-								result = IOT_STATUS_NO_MEMORY;
-						}
-						else
-#endif /* ifndef IOT_STACK_ONLY */
-							result = IOT_STATUS_NO_MEMORY;
+						result = app_json_encode_grow( encoder,
+							(indent * depth) + 2u );
+						space = encoder->len - (size_t)
+							(encoder->cur - encoder->buf);
 					}
 
 					if ( result == IOT_STATUS_SUCCESS )
@@ -0,0 +1,505 @@
+/**
+ * @file
+ * @brief source file for compiled JSON path queries
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "app_json.h"
+
+#include "app_json_base.h"
+
+#include <os.h>
+
+/** @brief type of a path segment */
+enum app_json_path_segment_type
+{
+	JSON_PATH_SEGMENT_KEY = 0,       /**< @brief object member by key */
+	JSON_PATH_SEGMENT_INDEX,         /**< @brief array element by index */
+	JSON_PATH_SEGMENT_ANY_KEY,       /**< @brief every object member */
+	JSON_PATH_SEGMENT_ANY_INDEX      /**< @brief every array element */
+};
+
+/**
+ * @brief single step of a compiled path
+ */
+struct app_json_path_segment
+{
+	enum app_json_path_segment_type type; /**< @brief type of segment */
+	const char *key;                 /**< @brief key to match */
+	size_t key_len;                  /**< @brief length of key */
+	size_t index;                    /**< @brief array index to match */
+};
+
+/**
+ * @brief internal structure for a compiled JSON path
+ */
+struct app_json_path
+{
+	unsigned int flags;              /**< @brief path flags */
+	size_t count;                    /**< @brief number of segments */
+	struct app_json_path_segment *segments; /**< @brief path segments */
+};
+
+/**
+ * @brief state shared while walking a document
+ */
+struct app_json_path_walk
+{
+	const app_json_path_t *const *paths; /**< @brief paths to match */
+	app_json_path_callback_t callback;   /**< @brief match callback */
+	void *user_data;                     /**< @brief user data for callback */
+	const app_json_item_t **out;         /**< @brief first match of each */
+	uint32_t wanted;                 /**< @brief paths still to be matched */
+	uint32_t found;                  /**< @brief paths matched */
+};
+
+/**
+ * @brief Parses a path expression
+ *
+ * @param[in]      expr                path expression to parse
+ * @param[out]     segments            segments to fill (optional)
+ * @param[out]     keys                space to copy keys into (optional)
+ * @param[out]     count               number of segments in the path
+ * @param[out]     keys_len            number of characters of keys
+ *
+ * @retval IOT_STATUS_PARSE_ERROR      invalid path expression
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static iot_status_t app_json_path_parse(
+	const char *expr,
+	struct app_json_path_segment *segments,
+	char *keys,
+	size_t *count,
+	size_t *keys_len );
+
+/**
+ * @brief Reports the paths matching an item, then walks the items within it
+ *
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      item                item reached
+ * @param[in]      depth               number of segments matched to reach
+ *                                     the item
+ * @param[in]      active              paths whose first @p depth segments
+ *                                     matched (one bit per path)
+ * @param[in,out]  walk                state of the walk
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         value returned by the callback
+ */
+static iot_status_t app_json_path_walk(
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item,
+	size_t depth,
+	uint32_t active,
+	struct app_json_path_walk *walk );
+
+/**
+ * @brief Returns the paths matching an object member or array element
+ *
+ * @param[in]      walk                state of the walk
+ * @param[in]      depth               segment to compare
+ * @param[in]      active              paths to compare (one bit per path)
+ * @param[in]      key                 key of the member, NULL for an element
+ * @param[in]      key_len             length of the key
+ * @param[in]      index               index of the element
+ *
+ * @return the paths matching (one bit per path)
+ */
+static uint32_t app_json_path_walk_child(
+	const struct app_json_path_walk *walk,
+	size_t depth,
+	uint32_t active,
+	const char *key,
+	size_t key_len,
+	size_t index );
+
+app_json_path_t *app_json_path_compile(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	const char *expr )
+{
+	struct app_json_path *path = NULL;
+	size_t count = 0u;
+	size_t keys_len = 0u;
+
+	if ( expr && app_json_path_parse( expr, NULL, NULL, &count,
+		&keys_len ) == IOT_STATUS_SUCCESS )
+	{
+		const size_t required = sizeof( struct app_json_path ) +
+			( sizeof( struct app_json_path_segment ) * count ) +
+			keys_len + 1u;
+#if !defined( IOT_STACK_ONLY )
+		if ( !buf )
+			flags |= APP_JSON_FLAG_DYNAMIC;
+		if ( flags & APP_JSON_FLAG_DYNAMIC )
+			buf = app_json_realloc( NULL, required );
+		else
+#endif /* if !defined( IOT_STACK_ONLY ) */
+		if ( len < required )
+			buf = NULL;
+
+		if ( buf )
+		{
+			char *keys;
+			path = (struct app_json_path *)buf;
+			path->flags = flags;
+			path->count = count;
+			path->segments = (struct app_json_path_segment *)
+				( path + 1 );
+			keys = (char *)( path->segments + count );
+			app_json_path_parse( expr, path->segments, keys,
+				&count, &keys_len );
+		}
+	}
+	return path;
+}
+
+iot_status_t app_json_path_extract(
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item,
+	const app_json_path_t *const *paths,
+	size_t count,
+	const app_json_item_t **out )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( decoder && paths && out && count > 0u &&
+		count <= APP_JSON_PATH_MAX )
+	{
+		struct app_json_path_walk walk;
+		size_t i;
+
+		os_memzero( &walk, sizeof( struct app_json_path_walk ) );
+		walk.paths = paths;
+		walk.out = out;
+		for ( i = 0u; i < count; ++i )
+		{
+			out[i] = NULL;
+			if ( paths[i] )
+				walk.wanted |= (uint32_t)1u << i;
+		}
+
+		result = IOT_STATUS_SUCCESS;
+		if ( item && walk.wanted )
+			result = app_json_path_walk( decoder, item, 0u,
+				walk.wanted, &walk );
+		if ( result == IOT_STATUS_SUCCESS && walk.wanted )
+			result = IOT_STATUS_NOT_FOUND;
+	}
+	return result;
+}
+
+iot_status_t app_json_path_match(
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item,
+	const app_json_path_t *path,
+	app_json_path_callback_t callback,
+	void *user_data )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( decoder && path && callback )
+	{
+		struct app_json_path_walk walk;
+		os_memzero( &walk, sizeof( struct app_json_path_walk ) );
+		walk.paths = &path;
+		walk.callback = callback;
+		walk.user_data = user_data;
+		walk.wanted = 1u;
+
+		result = IOT_STATUS_SUCCESS;
+		if ( item )
+			result = app_json_path_walk( decoder, item, 0u, 1u,
+				&walk );
+		if ( result == IOT_STATUS_SUCCESS && !walk.found )
+			result = IOT_STATUS_NOT_FOUND;
+	}
+	return result;
+}
+
+iot_status_t app_json_path_parse(
+	const char *expr,
+	struct app_json_path_segment *segments,
+	char *keys,
+	size_t *count,
+	size_t *keys_len )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	const char *p = expr;
+
+	*count = 0u;
+	*keys_len = 0u;
+	while ( *p != '\0' && result == IOT_STATUS_SUCCESS )
+	{
+		struct app_json_path_segment segment;
+		os_memzero( &segment, sizeof( struct app_json_path_segment ) );
+
+		if ( *p == '[' )
+		{
+			/* array element: "[n]" or "[*]" */
+			++p;
+			if ( *p == '*' )
+			{
+				segment.type = JSON_PATH_SEGMENT_ANY_INDEX;
+				++p;
+			}
+			else if ( *p >= '0' && *p <= '9' )
+			{
+				segment.type = JSON_PATH_SEGMENT_INDEX;
+				while ( *p >= '0' && *p <= '9' )
+				{
+					segment.index = ( segment.index * 10u ) +
+						(size_t)( *p - '0' );
+					++p;
+				}
+			}
+			else
+				result = IOT_STATUS_PARSE_ERROR;
+
+			if ( result == IOT_STATUS_SUCCESS && *p == ']' )
+				++p;
+			else
+				result = IOT_STATUS_PARSE_ERROR;
+		}
+		else
+		{
+			/* object member: key up to the next '.' or '[', "\" escapes
+			 * the following character */
+			if ( *count > 0u )
+			{
+				if ( *p == '.' )
+					++p;
+				else
+					result = IOT_STATUS_PARSE_ERROR;
+			}
+
+			segment.type = JSON_PATH_SEGMENT_KEY;
+			if ( keys )
+				segment.key = &keys[*keys_len];
+			if ( p[0] == '*' && ( p[1] == '\0' || p[1] == '.' ||
+				p[1] == '[' ) )
+			{
+				segment.type = JSON_PATH_SEGMENT_ANY_KEY;
+				++p;
+			}
+			while ( result == IOT_STATUS_SUCCESS &&
+				segment.type == JSON_PATH_SEGMENT_KEY &&
+				*p != '\0' && *p != '.' && *p != '[' )
+			{
+				if ( *p == '\\' && p[1] != '\0' )
+					++p;
+				if ( keys )
+					keys[*keys_len] = *p;
+				++(*keys_len);
+				++segment.key_len;
+				++p;
+			}
+
+			if ( segment.type == JSON_PATH_SEGMENT_KEY &&
+				segment.key_len == 0u )
+				result = IOT_STATUS_PARSE_ERROR;
+		}
+
+		if ( result == IOT_STATUS_SUCCESS )
+		{
+			if ( segments )
+				segments[*count] = segment;
+			++(*count);
+		}
+	}
+
+	if ( keys )
+		keys[*keys_len] = '\0';
+	return result;
+}
+
+void app_json_path_terminate(
+	app_json_path_t *path )
+{
+#ifndef IOT_STACK_ONLY
+	if ( path && ( path->flags & APP_JSON_FLAG_DYNAMIC ) )
+		app_json_free( path );
+#else /* ifndef IOT_STACK_ONLY */
+	(void)path;
+#endif /* else IOT_STACK_ONLY */
+}
+
+iot_status_t app_json_path_walk(
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item,
+	size_t depth,
+	uint32_t active,
+	struct app_json_path_walk *walk )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	uint32_t remaining = 0u;
+	size_t i;
+
+	/* report paths ending at this item, keep those that go deeper */
+	for ( i = 0u; i < APP_JSON_PATH_MAX && result == IOT_STATUS_SUCCESS &&
+		( active >> i ); ++i )
+	{
+		const uint32_t bit = (uint32_t)1u << i;
+		if ( ( active & bit ) && ( walk->wanted & bit ) )
+		{
+			if ( walk->paths[i]->count == depth )
+			{
+				walk->found |= bit;
+				if ( walk->out )
+				{
+					walk->out[i] = item;
+					walk->wanted &= ~bit;
+				}
+				else
+					result = walk->callback( walk->user_data,
+						decoder, item );
+			}
+			else
+				remaining |= bit;
+		}
+	}
+
+	if ( result == IOT_STATUS_SUCCESS && remaining )
+	{
+		const app_json_type_t type =
+			app_json_decode_type( decoder, item );
+		const struct app_json_path_segment *single = NULL;
+
+		/* a single path looking for one member or element can use a
+		 * direct look up instead of visiting every item */
+		if ( ( remaining & ( remaining - 1u ) ) == 0u )
+		{
+			i = 0u;
+			while ( ( remaining >> i ) != 1u )
+				++i;
+			single = &walk->paths[i]->segments[depth];
+			if ( single->type != JSON_PATH_SEGMENT_KEY &&
+				single->type != JSON_PATH_SEGMENT_INDEX )
+				single = NULL;
+		}
+
+		if ( type == APP_JSON_TYPE_OBJECT && single &&
+			single->type == JSON_PATH_SEGMENT_KEY )
+		{
+			const app_json_item_t *const child =
+				app_json_decode_object_find_len( decoder, item,
+					single->key, single->key_len );
+			if ( child )
+				result = app_json_path_walk( decoder, child,
+					depth + 1u, remaining, walk );
+		}
+		else if ( type == APP_JSON_TYPE_ARRAY && single &&
+			single->type == JSON_PATH_SEGMENT_INDEX )
+		{
+			const app_json_item_t *child = NULL;
+			if ( app_json_decode_array_at( decoder, item,
+				single->index, &child ) == IOT_STATUS_SUCCESS )
+				result = app_json_path_walk( decoder, child,
+					depth + 1u, remaining, walk );
+		}
+		else if ( type == APP_JSON_TYPE_OBJECT )
+		{
+			const app_json_object_iterator_t *iter =
+				app_json_decode_object_iterator( decoder, item );
+			while ( iter && result == IOT_STATUS_SUCCESS &&
+				( remaining & walk->wanted ) )
+			{
+				const char *key = NULL;
+				size_t key_len = 0u;
+				const app_json_item_t *child = NULL;
+				uint32_t matched = 0u;
+
+				if ( app_json_decode_object_iterator_key( decoder,
+					item, iter, &key, &key_len ) ==
+					IOT_STATUS_SUCCESS )
+					matched = app_json_path_walk_child( walk,
+						depth, remaining, key, key_len, 0u );
+				if ( matched &&
+					app_json_decode_object_iterator_value(
+						decoder, item, iter, &child ) ==
+					IOT_STATUS_SUCCESS )
+					result = app_json_path_walk( decoder, child,
+						depth + 1u, matched, walk );
+				iter = app_json_decode_object_iterator_next(
+					decoder, item, iter );
+			}
+		}
+		else if ( type == APP_JSON_TYPE_ARRAY )
+		{
+			const app_json_array_iterator_t *iter =
+				app_json_decode_array_iterator( decoder, item );
+			size_t index = 0u;
+			while ( iter && result == IOT_STATUS_SUCCESS &&
+				( remaining & walk->wanted ) )
+			{
+				const app_json_item_t *child = NULL;
+				const uint32_t matched = app_json_path_walk_child(
+					walk, depth, remaining, NULL, 0u, index );
+				if ( matched &&
+					app_json_decode_array_iterator_value(
+						decoder, item, iter, &child ) ==
+					IOT_STATUS_SUCCESS )
+					result = app_json_path_walk( decoder, child,
+						depth + 1u, matched, walk );
+				iter = app_json_decode_array_iterator_next(
+					decoder, item, iter );
+				++index;
+			}
+		}
+	}
+	return result;
+}
+
+uint32_t app_json_path_walk_child(
+	const struct app_json_path_walk *walk,
+	size_t depth,
+	uint32_t active,
+	const char *key,
+	size_t key_len,
+	size_t index )
+{
+	uint32_t result = 0u;
+	size_t i;
+	for ( i = 0u; i < APP_JSON_PATH_MAX && ( active >> i ); ++i )
+	{
+		const uint32_t bit = (uint32_t)1u << i;
+		if ( active & walk->wanted & bit )
+		{
+			const struct app_json_path_segment *const segment =
+				&walk->paths[i]->segments[depth];
+			switch ( segment->type )
+			{
+			case JSON_PATH_SEGMENT_KEY:
+				if ( key && key_len == segment->key_len &&
+					os_strncmp( key, segment->key,
+						key_len ) == 0 )
+					result |= bit;
+				break;
+			case JSON_PATH_SEGMENT_INDEX:
+				if ( !key && index == segment->index )
+					result |= bit;
+				break;
+			case JSON_PATH_SEGMENT_ANY_KEY:
+				if ( key )
+					result |= bit;
+				break;
+			case JSON_PATH_SEGMENT_ANY_INDEX:
+			default:
+				if ( !key )
+					result |= bit;
+				break;
+			}
+		}
+	}
+	return result;
+}
@@ -23,17 +23,21 @@
 #include <math.h>
 
 /** @brief value for the field is required (applies to all types) */
-#define APP_JSON_SCHEMA_FLAG_REQUIRED          0x1  /* 0001 */
-#if 0
-/** @brief whether 'maximum' value is exclusive (only applicable to numbers) */
-#define APP_JSON_SCHEMA_FLAG_MAXIMUM_EXCLUSIVE 0x4  /* 0100 (number) */
-/** @brief whether 'minimum' value is exclusive (only applicable to numbers) */
-#define APP_JSON_SCHEMA_FLAG_MINIMUM_EXCLUSIVE 0x8  /* 1000 (number) */
-#endif
+#define APP_JSON_SCHEMA_FLAG_REQUIRED          0x001
 /** @brief whether all items must be unique (only applicable to arrays) */
-#define APP_JSON_SCHEMA_FLAG_UNIQUE            0x4  /* 0100 (array) */
+#define APP_JSON_SCHEMA_FLAG_UNIQUE            0x004 /* (array) */
 /** @brief additional items are accepted (only applicable to arrays & objects) */
-#define APP_JSON_SCHEMA_FLAG_ADDITIONAL        0x8 /*  1000 (array) */
+#define APP_JSON_SCHEMA_FLAG_ADDITIONAL        0x008 /* (array) */
+/** @brief whether 'maximum' value is exclusive (only applicable to numbers) */
+#define APP_JSON_SCHEMA_FLAG_MAXIMUM_EXCLUSIVE 0x010 /* (number) */
+/** @brief whether 'minimum' value is exclusive (only applicable to numbers) */
+#define APP_JSON_SCHEMA_FLAG_MINIMUM_EXCLUSIVE 0x020 /* (number) */
+/** @brief a maximum value or length was compiled for the item */
+#define APP_JSON_SCHEMA_FLAG_MAXIMUM           0x040 /* (number, string) */
+/** @brief a minimum value or length was compiled for the item */
+#define APP_JSON_SCHEMA_FLAG_MINIMUM           0x080 /* (number, string) */
+/** @brief a 'multipleOf' value was compiled for the item */
+#define APP_JSON_SCHEMA_FLAG_MULTIPLE_OF       0x100 /* (number) */
 
 /** @brief String prepending acceptable options */
 #define APP_JSON_SCHEMA_ACCEPTABLE_PRE         "(acceptable values are: "
@@ -86,8 +90,8 @@ static const char *APP_JSON_SCHEMA_KEYWORDS[] ={
 	"description",
 	"dependencies",
 	"enum",
-	"exclusiveMinimum",
 	"exclusiveMaximum",
+	"exclusiveMinimum",
 	"format",
 	"integer",
 	"items",
@@ -112,13 +116,29 @@ static const char *APP_JSON_SCHEMA_KEYWORDS[] ={
 };
 
 
+/**
+ * @brief value of a numeric keyword compiled from the schema
+ */
+union app_json_schema_value
+{
+	/** @brief value for "integer" items and string lengths */
+	iot_int64_t integer;
+	/** @brief value for "number" items */
+	double real;
+};
+
 /**
  * @brief represents an item in the schema that defines something
+ *
+ * Keywords used during validation are compiled into the item when the schema
+ * is parsed, so validating a value does not need to search the schema JSON.
  */
 struct app_json_schema_item
 {
 	/** @brief flags for the item */
-	uint8_t       flags;
+	uint16_t          flags;
+	/** @brief type of value the item defines */
+	app_json_type_t   type;
 	/** @brief key item */
 	const app_json_item_t   *item;
 	/** @brief name */
@@ -131,6 +151,16 @@ struct app_json_schema_item
 	unsigned int      parent;
 	/** @brief pointer to json dependencies (can be either array or object) */
 	const app_json_item_t   *dependencies;
+	/** @brief pointer to json 'enum' array (strings only) */
+	const app_json_item_t   *enum_values;
+	/** @brief message reported if a keyword used in validation is invalid */
+	const char        *invalid_msg;
+	/** @brief 'maximum' value (numbers) or 'maxLength' (strings) */
+	union app_json_schema_value maximum;
+	/** @brief 'minimum' value (numbers) or 'minLength' (strings) */
+	union app_json_schema_value minimum;
+	/** @brief 'multipleOf' value (numbers) */
+	union app_json_schema_value multiple_of;
 };
 
 /**
@@ -178,6 +208,33 @@ static iot_status_t app_json_schema_allocate_item(
 	const app_json_item_t *j_dependencies,
 	const char **error_msg );
 
+/**
+ * @brief compiles the keywords used for validating values of an item
+ *
+ * @param[in]      schema              base schema object
+ * @param[in,out]  base                item to compile keywords for
+ */
+static void app_json_schema_compile_item(
+	const app_json_schema_t *schema,
+	struct app_json_schema_item *base );
+
+/**
+ * @brief compiles the value of a numeric keyword
+ *
+ * @param[in]      schema              base schema object
+ * @param[in]      j_item              JSON value of the keyword
+ * @param[in]      type                type of the item containing the keyword
+ * @param[out]     out                 compiled value
+ *
+ * @retval IOT_STATUS_BAD_REQUEST      keyword value is of the wrong type
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static iot_status_t app_json_schema_compile_value(
+	const app_json_schema_t *schema,
+	const app_json_item_t *j_item,
+	app_json_type_t type,
+	union app_json_schema_value *out );
+
 static iot_status_t app_json_schema_parse_schema_json(
 	app_json_schema_t *schema,
 	const app_json_item_t *root,
@@ -265,7 +322,13 @@ iot_status_t app_json_schema_allocate_item(
 		base->name = name;
 		base->name_len = name_len;
 		base->parent = parent_idx;
+		base->type = item_type;
 		base->dependencies = NULL;
+		base->enum_values = NULL;
+		base->invalid_msg = NULL;
+		base->maximum.integer = 0;
+		base->minimum.integer = 0;
+		base->multiple_of.integer = 0;
 		*count = *count + 1;
 
 		/* flags */
@@ -320,15 +383,16 @@ iot_status_t app_json_schema_allocate_item(
 				u_item ) != APP_JSON_TYPE_BOOL )
 			{
 				*error_msg = "'exclusiveMaximum' is not of correct type";
+				base->invalid_msg = "invalid 'exclusiveMaximum' value";
 				result = IOT_STATUS_BAD_REQUEST;
 			}
 			else if ( u_item )
 			{
-				int unique = IOT_FALSE;
+				int exclusive = IOT_FALSE;
 				app_json_decode_bool( schema->decoder, u_item,
-					&unique );
-				if ( unique != IOT_FALSE )
-					base->flags |= APP_JSON_SCHEMA_FLAG_UNIQUE;
+					&exclusive );
+				if ( exclusive != IOT_FALSE )
+					base->flags |= APP_JSON_SCHEMA_FLAG_MAXIMUM_EXCLUSIVE;
 			}
 
 			/* exclusiveMinimum */
@@ -338,17 +402,19 @@ iot_status_t app_json_schema_allocate_item(
 				u_item ) != APP_JSON_TYPE_BOOL )
 			{
 				*error_msg = "'exclusiveMinimum' is not of correct type";
+				base->invalid_msg = "invalid 'exclusiveMinimum' value";
 				result = IOT_STATUS_BAD_REQUEST;
 			}
 			else if ( u_item )
 			{
-				int unique = IOT_FALSE;
+				int exclusive = IOT_FALSE;
 				app_json_decode_bool( schema->decoder, u_item,
-					&unique );
-				if ( unique != IOT_FALSE )
-					base->flags |= APP_JSON_SCHEMA_FLAG_ADDITIONAL;
+					&exclusive );
+				if ( exclusive != IOT_FALSE )
+					base->flags |= APP_JSON_SCHEMA_FLAG_MINIMUM_EXCLUSIVE;
 			}
 		}
+		app_json_schema_compile_item( schema, base );
 
 		if ( item_type == APP_JSON_TYPE_ARRAY )
 		{
@@ -837,6 +903,96 @@ int app_json_schema_bool(
 	return result;
 }
 
+void app_json_schema_compile_item(
+	const app_json_schema_t *schema,
+	struct app_json_schema_item *base )
+{
+	const app_json_item_t *j_item;
+	enum app_json_schema_keyword_id max_field_id =
+		APP_JSON_SCHEMA_KEYWORD_MAXIMUM;
+	enum app_json_schema_keyword_id min_field_id =
+		APP_JSON_SCHEMA_KEYWORD_MINIMUM;
+
+	if ( base->type == APP_JSON_TYPE_STRING )
+	{
+		/* enum */
+		j_item = app_json_decode_object_find(
+			schema->decoder, base->item,
+			APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_ENUM] );
+		if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
+			APP_JSON_TYPE_ARRAY )
+			base->enum_values = j_item;
+		else if ( j_item )
+			base->invalid_msg = "invalid 'enum' array";
+
+		max_field_id = APP_JSON_SCHEMA_KEYWORD_MAXIMUM_LENGTH;
+		min_field_id = APP_JSON_SCHEMA_KEYWORD_MINIMUM_LENGTH;
+	}
+
+	if ( base->type == APP_JSON_TYPE_INTEGER ||
+		base->type == APP_JSON_TYPE_REAL ||
+		base->type == APP_JSON_TYPE_STRING )
+	{
+		/* maximum or maxLength */
+		j_item = app_json_decode_object_find(
+			schema->decoder, base->item,
+			APP_JSON_SCHEMA_KEYWORDS[max_field_id] );
+		if ( j_item && app_json_schema_compile_value( schema, j_item,
+			base->type, &base->maximum ) == IOT_STATUS_SUCCESS )
+			base->flags |= APP_JSON_SCHEMA_FLAG_MAXIMUM;
+		else if ( j_item && base->type == APP_JSON_TYPE_STRING )
+			base->invalid_msg = "invalid 'maximumItem' value";
+		else if ( j_item )
+			base->invalid_msg = "invalid 'maximum' value";
+
+		/* minimum or minLength */
+		j_item = app_json_decode_object_find(
+			schema->decoder, base->item,
+			APP_JSON_SCHEMA_KEYWORDS[min_field_id] );
+		if ( j_item && app_json_schema_compile_value( schema, j_item,
+			base->type, &base->minimum ) == IOT_STATUS_SUCCESS )
+			base->flags |= APP_JSON_SCHEMA_FLAG_MINIMUM;
+		else if ( j_item && base->type == APP_JSON_TYPE_STRING )
+			base->invalid_msg = "invalid 'minimumItem' value";
+		else if ( j_item )
+			base->invalid_msg = "invalid 'minimum' value";
+	}
+
+	if ( base->type == APP_JSON_TYPE_INTEGER ||
+		base->type == APP_JSON_TYPE_REAL )
+	{
+		/* multipleOf */
+		j_item = app_json_decode_object_find(
+			schema->decoder, base->item,
+			APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_MULTIPLE_OF] );
+		if ( j_item && app_json_schema_compile_value( schema, j_item,
+			base->type, &base->multiple_of ) == IOT_STATUS_SUCCESS )
+			base->flags |= APP_JSON_SCHEMA_FLAG_MULTIPLE_OF;
+		else if ( j_item )
+			base->invalid_msg = "invalid 'multipleOf' value";
+	}
+}
+
+iot_status_t app_json_schema_compile_value(
+	const app_json_schema_t *schema,
+	const app_json_item_t *j_item,
+	app_json_type_t type,
+	union app_json_schema_value *out )
+{
+	iot_status_t result = IOT_STATUS_BAD_REQUEST;
+	const app_json_type_t j_type =
+		app_json_decode_type( schema->decoder, j_item );
+	if ( type == APP_JSON_TYPE_REAL && j_type == APP_JSON_TYPE_REAL )
+		result = app_json_decode_number( schema->decoder, j_item,
+			&out->real );
+	else if ( type != APP_JSON_TYPE_REAL && j_type == APP_JSON_TYPE_INTEGER )
+		result = app_json_decode_integer( schema->decoder, j_item,
+			&out->integer );
+	if ( result != IOT_STATUS_SUCCESS )
+		result = IOT_STATUS_BAD_REQUEST;
+	return result;
+}
+
 int app_json_schema_dependencies_achieved(
 	const app_json_schema_t *schema,
 	const app_json_schema_item_t *item,
@@ -1005,134 +1161,62 @@ int app_json_schema_integer(
 		else
 		{
 			iot_int64_t int_value = 0L;
+			size_t j = 0u;
 
 			/* convert value to integer */
-			while ( result == IOT_TRUE && value_len > 0u )
+			if ( value[0] == '+' || value[0] == '-' )
+				j = 1u;
+			if ( j >= value_len )
+				result = IOT_FALSE;
+			for ( ; j < value_len && result == IOT_TRUE; ++j )
 			{
-				if ( value[value_len - 1u] >= '0' &&
-					value[value_len - 1u] <= '9' )
-					int_value = int_value * 10 +
-						(value[value_len - 1u] - '0');
-				else if ( value_len > 1u ||
-					( value[value_len - 1u] != '+' &&
-					  value[value_len - 1u] != '-' ) )
-				{
-					if ( error_msg )
-						*error_msg = "invalid number";
+				if ( value[j] >= '0' && value[j] <= '9' )
+					int_value = int_value * 10 + (value[j] - '0');
+				else
 					result = IOT_FALSE;
-				}
-				--value_len;
 			}
+			if ( result == IOT_FALSE && error_msg )
+				*error_msg = "invalid number";
 			if ( value[0] == '-' )
-				int_value *= int_value;
+				int_value *= -1;
 
-			if ( result == IOT_TRUE )
+			if ( result == IOT_TRUE && i->invalid_msg )
 			{
-				int exclusive_maximum = IOT_FALSE;
-				int exclusive_minimum = IOT_FALSE;
-				const app_json_item_t *j_item;
-				/* exclusiveMaximum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_EXCLUSIVE_MAXIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_BOOL )
-				{
-					app_json_decode_bool( schema->decoder, j_item,
-						&exclusive_maximum );
-				}
-				else if ( j_item )
-				{
-					if ( error_msg )
-						*error_msg =  "invalid 'exclusiveMaximum' value";
-					result = IOT_FALSE;
-				}
-
-				/* exclusiveMininmum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_EXCLUSIVE_MINIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_BOOL )
-				{
-					app_json_decode_bool( schema->decoder, j_item,
-						&exclusive_minimum );
-				}
-				else if ( j_item )
-				{
-					if ( error_msg )
-						*error_msg =  "invalid 'exclusiveMinimum' value";
-					result = IOT_FALSE;
-				}
-
-				/* maxmimum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MAXIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_INTEGER )
-				{
-					iot_int64_t maximum = 0L;
-					app_json_decode_integer( schema->decoder, j_item, &maximum );
-					if ( (int_value > maximum) ||
-					     (exclusive_maximum != IOT_FALSE && int_value == maximum) )
-					{
-						if ( error_msg )
-							*error_msg =  "value is greater than maximum";
-						result = IOT_FALSE;
-					}
-				}
-				else if ( j_item )
+				if ( error_msg )
+					*error_msg = i->invalid_msg;
+				result = IOT_FALSE;
+			}
+			else if ( result == IOT_TRUE )
+			{
+				/* maximum */
+				if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MAXIMUM ) &&
+				     ( int_value > i->maximum.integer ||
+				       ( ( i->flags & APP_JSON_SCHEMA_FLAG_MAXIMUM_EXCLUSIVE ) &&
+				         int_value == i->maximum.integer ) ) )
 				{
 					if ( error_msg )
-						*error_msg =  "invalid 'maximum' value";
+						*error_msg =  "value is greater than maximum";
 					result = IOT_FALSE;
 				}
 
 				/* minimum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MINIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_INTEGER )
-				{
-					iot_int64_t minimum = 0L;
-					app_json_decode_integer( schema->decoder, j_item, &minimum );
-					if ( (int_value < minimum) ||
-					     (exclusive_minimum != IOT_FALSE && int_value == minimum) )
-					{
-						if ( error_msg )
-							*error_msg =  "value is less than minimum";
-						result = IOT_FALSE;
-					}
-				}
-				else if ( j_item )
+				if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MINIMUM ) &&
+				     ( int_value < i->minimum.integer ||
+				       ( ( i->flags & APP_JSON_SCHEMA_FLAG_MINIMUM_EXCLUSIVE ) &&
+				         int_value == i->minimum.integer ) ) )
 				{
 					if ( error_msg )
-						*error_msg =  "invalid 'minimum' value";
+						*error_msg =  "value is less than minimum";
 					result = IOT_FALSE;
 				}
 
 				/* multipleOf */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MULTIPLE_OF] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_INTEGER )
-				{
-					iot_int64_t multiple_of = 0L;
-					app_json_decode_integer( schema->decoder, j_item, &multiple_of );
-					if ( int_value % multiple_of != 0L )
-					{
-						if ( error_msg )
-							*error_msg =  "value is not a valid multiple";
-						result = IOT_FALSE;
-					}
-				}
-				else if ( j_item )
+				if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MULTIPLE_OF ) &&
+				     i->multiple_of.integer != 0 &&
+				     int_value % i->multiple_of.integer != 0 )
 				{
 					if ( error_msg )
-						*error_msg =  "invalid 'multipleOf' value";
+						*error_msg =  "value is not a valid multiple";
 					result = IOT_FALSE;
 				}
 			}
@@ -1183,38 +1267,23 @@ app_json_schema_object_iterator_t *
 	app_json_schema_object_iterator_t *result = NULL;
 	struct app_json_schema_item *i =
 		(struct app_json_schema_item *)item;
-	if ( schema && i &&
-		app_json_decode_type( schema->decoder, i->item ) == APP_JSON_TYPE_OBJECT )
+	/* ensure that it is a "type": "object" */
+	if ( schema && i && i->type == APP_JSON_TYPE_OBJECT )
 	{
-		const app_json_item_t *j_obj;
-		const char *value = NULL;
-		size_t value_len = 0u;
-
-		j_obj = app_json_decode_object_find( schema->decoder, i->item, "type" );
-		app_json_decode_string( schema->decoder, j_obj, &value, &value_len );
-
-		/* ensure that it is a "type": "object" */
-		if ( value && os_strncmp( value, "object", value_len ) == 0 )
-		{
-			size_t children;
 #ifndef IOT_STACK_ONLY
-			unsigned int p_idx = (unsigned int)(i - schema->root);
+		unsigned int p_idx = (unsigned int)(i - schema->root);
 #else
-			unsigned int p_idx =
-				((unsigned int)((char*)item - (char*)schema) -
-					sizeof( struct app_json_schema ))
-					/ sizeof( struct app_json_schema_item );
+		unsigned int p_idx =
+			((unsigned int)((char*)item - (char*)schema) -
+				sizeof( struct app_json_schema ))
+				/ sizeof( struct app_json_schema_item );
 #endif /* ifndef IOT_STACK_ONLY */
-			j_obj = app_json_decode_object_find( schema->decoder, i->item,
-				"properties" );
-			children = app_json_decode_object_size( schema->decoder, j_obj );
-
-			if ( children > 0u )
-			{
-				while ( i->parent != p_idx )
-					++i;
-				result = (app_json_schema_object_iterator_t *)(i);
-			}
+		/* children are compiled directly after their parent */
+		if ( i->last_child > p_idx + 1u )
+		{
+			while ( i->parent != p_idx )
+				++i;
+			result = (app_json_schema_object_iterator_t *)(i);
 		}
 	}
 	return result;
@@ -1256,40 +1325,29 @@ app_json_schema_object_iterator_t *
 		(struct app_json_schema_item *)item;
 	struct app_json_schema_item *it =
 		(struct app_json_schema_item *)iter;
-	if ( schema && i && it &&
-		app_json_decode_type( schema->decoder, i->item ) == APP_JSON_TYPE_OBJECT )
+	/* ensure that it is a "type": "object" */
+	if ( schema && i && it && i->type == APP_JSON_TYPE_OBJECT )
 	{
-		const app_json_item_t *j_obj;
-		const char *value = NULL;
-		size_t value_len = 0u;
-
-		j_obj = app_json_decode_object_find( schema->decoder, i->item, "type" );
-		app_json_decode_string( schema->decoder, j_obj, &value, &value_len );
-
-		/* ensure that it is a "type": "object" */
-		if ( value && os_strncmp( value, "object", value_len ) == 0 )
-		{
-			const unsigned int p_idx = it->parent;
-			const unsigned int last_child = i->last_child;
+		const unsigned int p_idx = it->parent;
+		const unsigned int last_child = i->last_child;
 #ifndef IOT_STACK_ONLY
-			unsigned int c_idx = (unsigned int)(it - schema->root);
+		unsigned int c_idx = (unsigned int)(it - schema->root);
 #else
-			unsigned int c_idx =
-				((unsigned int)((char*)iter - (char*)schema) -
-					sizeof( struct app_json_schema ))
-					/ sizeof( struct app_json_schema_item );
+		unsigned int c_idx =
+			((unsigned int)((char*)iter - (char*)schema) -
+				sizeof( struct app_json_schema ))
+				/ sizeof( struct app_json_schema_item );
 #endif /* ifndef IOT_STACK_ONLY */
 
-			if ( c_idx < last_child )
-			{
-				do {
-					++it;
-					++c_idx;
-				} while ( c_idx < last_child && it->parent != p_idx );
+		if ( c_idx < last_child )
+		{
+			do {
+				++it;
+				++c_idx;
+			} while ( c_idx < last_child && it->parent != p_idx );
 
-				if ( c_idx < last_child )
-					result = (app_json_schema_object_iterator_t *)(it);
-			}
+			if ( c_idx < last_child )
+				result = (app_json_schema_object_iterator_t *)(it);
 		}
 	}
 	return result;
@@ -1354,9 +1412,6 @@ int app_json_schema_real(
 		}
 		else
 		{
-			int exclusive_maximum = IOT_FALSE;
-			int exclusive_minimum = IOT_FALSE;
-			const app_json_item_t *j_item;
 			double real_value = 0.0;
 
 			/* parse value from string */
@@ -1426,110 +1481,43 @@ int app_json_schema_real(
 			else if ( is_neg )
 				real_value *= -1.0;
 
-			if ( result != IOT_FALSE )
+			if ( result != IOT_FALSE && i->invalid_msg )
 			{
-				/* exclusiveMaximum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_EXCLUSIVE_MAXIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_BOOL )
-				{
-					app_json_decode_bool( schema->decoder, j_item,
-						&exclusive_maximum );
-				}
-				else if ( j_item )
-				{
-					if ( error_msg )
-						*error_msg =  "invalid 'exclusiveMaximum' value";
-					result = IOT_FALSE;
-				}
-
-				/* exclusiveMininmum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_EXCLUSIVE_MINIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_BOOL )
-				{
-					app_json_decode_bool( schema->decoder, j_item,
-						&exclusive_minimum );
-				}
-				else if ( j_item )
-				{
-					if ( error_msg )
-						*error_msg =  "invalid 'exclusiveMinimum' value";
-					result = IOT_FALSE;
-				}
-
-				/* maxmimum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MAXIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_REAL )
-				{
-					double maximum = 0;
-					app_json_decode_number( schema->decoder, j_item, &maximum );
-					if ( (exclusive_maximum == IOT_FALSE && real_value > maximum) ||
-					     (exclusive_maximum != IOT_FALSE && real_value >= maximum) )
-					{
-						if ( error_msg )
-							*error_msg =  "value is greater than maximum";
-						result = IOT_FALSE;
-					}
-				}
-				else if ( j_item )
+				if ( error_msg )
+					*error_msg = i->invalid_msg;
+				result = IOT_FALSE;
+			}
+			else if ( result != IOT_FALSE )
+			{
+				/* maximum */
+				if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MAXIMUM ) &&
+				     ( real_value > i->maximum.real ||
+				       ( ( i->flags & APP_JSON_SCHEMA_FLAG_MAXIMUM_EXCLUSIVE ) &&
+				         real_value >= i->maximum.real ) ) )
 				{
 					if ( error_msg )
-						*error_msg =  "invalid 'maximum' value";
+						*error_msg =  "value is greater than maximum";
 					result = IOT_FALSE;
 				}
 
 				/* minimum */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MINIMUM] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_REAL )
-				{
-					double minimum = 0;
-					app_json_decode_number( schema->decoder, j_item, &minimum );
-					if ( (exclusive_minimum == IOT_FALSE && real_value < minimum) ||
-					     (exclusive_minimum != IOT_FALSE && real_value <= minimum) )
-					{
-						if ( error_msg )
-							*error_msg =  "value is less than minimum";
-						result = IOT_FALSE;
-					}
-				}
-				else if ( j_item )
+				if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MINIMUM ) &&
+				     ( real_value < i->minimum.real ||
+				       ( ( i->flags & APP_JSON_SCHEMA_FLAG_MINIMUM_EXCLUSIVE ) &&
+				         real_value <= i->minimum.real ) ) )
 				{
 					if ( error_msg )
-						*error_msg =  "invalid 'minimum' value";
+						*error_msg =  "value is less than minimum";
 					result = IOT_FALSE;
 				}
 
 				/* multipleOf */
-				j_item = app_json_decode_object_find(
-					schema->decoder, i->item,
-					APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MULTIPLE_OF] );
-				if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-					APP_JSON_TYPE_REAL )
-				{
-					double multiple_of = 0.0;
-					app_json_decode_number( schema->decoder, j_item, &multiple_of );
-					if( fabs( remainder(real_value, multiple_of)) > (1E-9 * multiple_of))
-					{
-						if ( error_msg )
-							*error_msg =  "value is not a valid multiple";
-						result = IOT_FALSE;
-					}
-				}
-				else if ( j_item )
+				if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MULTIPLE_OF ) &&
+				     fabs( remainder( real_value, i->multiple_of.real ) ) >
+				     ( 1E-9 * i->multiple_of.real ) )
 				{
 					if ( error_msg )
-						*error_msg =  "invalid 'multipleOf' value";
+						*error_msg =  "value is not a valid multiple";
 					result = IOT_FALSE;
 				}
 			}
@@ -1568,8 +1556,7 @@ int app_json_schema_string(
 	if ( schema && i && value &&
 		app_json_schema_type( schema, item ) == APP_JSON_TYPE_STRING )
 	{
-		const app_json_item_t *j_item;
-		iot_int64_t length;
+		const app_json_item_t *const j_item = i->enum_values;
 
 		result = IOT_TRUE;
 
@@ -1583,14 +1570,16 @@ int app_json_schema_string(
 				result = IOT_FALSE;
 			}
 		}
+		else if ( i->invalid_msg )
+		{
+			if ( error_msg )
+				*error_msg = i->invalid_msg;
+			result = IOT_FALSE;
+		}
 		else
 		{
 			/* enum */
-			j_item = app_json_decode_object_find(
-				schema->decoder, i->item,
-				APP_JSON_SCHEMA_KEYWORDS[APP_JSON_SCHEMA_KEYWORD_ENUM] );
-			if ( j_item && app_json_decode_type( schema->decoder, j_item ) ==
-				APP_JSON_TYPE_ARRAY )
+			if ( j_item )
 			{
 				const app_json_array_iterator_t *it =
 					app_json_decode_array_iterator( schema->decoder, j_item );
@@ -1690,54 +1679,24 @@ int app_json_schema_string(
 #endif /* ifndef IOT_STACK_ONLY */
 				}
 			}
-			else if ( j_item )
-			{
-				if ( error_msg )
-					*error_msg =  "invalid 'enum' array";
-				result = IOT_FALSE;
-			}
 
 			/* maxLength */
-			length = 0L;
-			j_item = app_json_decode_object_find(
-				schema->decoder, i->item,
-				APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MAXIMUM_LENGTH] );
-			if ( j_item && app_json_decode_integer(
-				schema->decoder, j_item, &length ) == IOT_STATUS_SUCCESS )
-			{
-				if ( length < 0 || value_len > (size_t)length )
-				{
-					if ( error_msg )
-						*error_msg =  "string is too long";
-					result = IOT_FALSE;
-				}
-			}
-			else if ( j_item )
+			if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MAXIMUM ) &&
+			     ( i->maximum.integer < 0 ||
+			       value_len > (size_t)i->maximum.integer ) )
 			{
 				if ( error_msg )
-					*error_msg =  "invalid 'maximumItem' value";
+					*error_msg =  "string is too long";
 				result = IOT_FALSE;
 			}
 
 			/* minLength */
-			length = 0L;
-			j_item = app_json_decode_object_find(
-				schema->decoder, i->item,
-				APP_JSON_SCHEMA_KEYWORDS[ APP_JSON_SCHEMA_KEYWORD_MINIMUM_LENGTH] );
-			if ( j_item && app_json_decode_integer(
-				schema->decoder, j_item, &length ) == IOT_STATUS_SUCCESS )
-			{
-				if ( length < 0L || value_len < (size_t)length )
-				{
-					if ( error_msg )
-						*error_msg =  "string is too short";
-					result = IOT_FALSE;
-				}
-			}
-			else if ( j_item )
+			if ( ( i->flags & APP_JSON_SCHEMA_FLAG_MINIMUM ) &&
+			     ( i->minimum.integer < 0 ||
+			       value_len < (size_t)i->minimum.integer ) )
 			{
 				if ( error_msg )
-					*error_msg =  "invalid 'minimumItem' value";
+					*error_msg =  "string is too short";
 				result = IOT_FALSE;
 			}
 
@@ -1788,31 +1747,8 @@ app_json_type_t app_json_schema_type(
 	app_json_type_t result = APP_JSON_TYPE_NULL;
 	const struct app_json_schema_item *i =
 		(const struct app_json_schema_item *)item;
-	if ( i )
-	{
-		const char *value = NULL;
-		size_t value_len = 0u;
-		const app_json_item_t *j_type =
-			app_json_decode_object_find( schema->decoder,
-				i->item, "type" );
-
-		if ( app_json_decode_string( schema->decoder, j_type, &value, &value_len )
-			== IOT_STATUS_SUCCESS && value )
-		{
-			if ( os_strncmp( value, "array", value_len ) == 0 )
-				result = APP_JSON_TYPE_ARRAY;
-			else if ( os_strncmp( value, "object", value_len ) == 0 )
-				result = APP_JSON_TYPE_OBJECT;
-			else if ( os_strncmp( value, "boolean", value_len ) == 0 )
-				result = APP_JSON_TYPE_BOOL;
-			else if ( os_strncmp( value, "integer", value_len ) == 0 )
-				result = APP_JSON_TYPE_INTEGER;
-			else if ( os_strncmp( value, "number", value_len ) == 0 )
-				result = APP_JSON_TYPE_REAL;
-			else if ( os_strncmp( value, "string", value_len ) == 0 )
-				result = APP_JSON_TYPE_STRING;
-		}
-	}
+	if ( schema && i )
+		result = i->type;
 	return result;
 }
 
@@ -0,0 +1,844 @@
+/**
+ * @file
+ * @brief source file for streaming (incremental) JSON decoding
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "app_json.h"
+
+#include "app_json_base.h"
+
+#include <os.h>
+
+/**
+ * @brief Maximum depth of arrays & objects (one bit each in
+ *        app_json_stream::containers)
+ */
+#define JSON_STREAM_MAX_DEPTH          64u
+/**
+ * @brief Minimum size of the scratch buffer holding a key and a value split
+ *        across chunks
+ */
+#define JSON_STREAM_SCRATCH_MIN        16u
+
+/** @brief expected input, between tokens */
+enum app_json_stream_state
+{
+	JSON_STREAM_STATE_VALUE = 0,     /**< @brief value */
+	JSON_STREAM_STATE_VALUE_OR_END,  /**< @brief value or ']' */
+	JSON_STREAM_STATE_KEY,           /**< @brief key */
+	JSON_STREAM_STATE_KEY_OR_END,    /**< @brief key or '}' */
+	JSON_STREAM_STATE_COLON,         /**< @brief ':' */
+	JSON_STREAM_STATE_NEXT,          /**< @brief ',' or end of structure */
+	JSON_STREAM_STATE_DONE,          /**< @brief root value completed */
+	JSON_STREAM_STATE_ERROR          /**< @brief error encountered */
+};
+
+/** @brief token being collected */
+enum app_json_stream_token
+{
+	JSON_STREAM_TOKEN_NONE = 0,      /**< @brief no token */
+	JSON_STREAM_TOKEN_KEY,           /**< @brief string that is a key */
+	JSON_STREAM_TOKEN_STRING,        /**< @brief string value */
+	JSON_STREAM_TOKEN_NUMBER,        /**< @brief number */
+	JSON_STREAM_TOKEN_LITERAL        /**< @brief true, false or null */
+};
+
+/**
+ * @brief internal structure for streaming JSON decoding
+ */
+struct app_json_stream
+{
+	app_json_stream_callback_t callback; /**< @brief event callback */
+	void *user_data;                 /**< @brief user data for callback */
+	unsigned int flags;              /**< @brief decoder flags */
+	enum app_json_stream_state state;    /**< @brief expected input */
+	enum app_json_stream_token token;    /**< @brief token collecting */
+	unsigned int depth;              /**< @brief current depth */
+	uint64_t containers;             /**< @brief bit set for each object */
+	unsigned int escape;             /**< @brief escape sequence position */
+	uint32_t unicode;                /**< @brief escaped code point */
+	uint32_t surrogate;              /**< @brief pending high surrogate */
+	iot_bool_t has_key;              /**< @brief key held in scratch */
+	size_t key_len;                  /**< @brief length of key in scratch */
+	size_t offset;                   /**< @brief characters consumed */
+	char *scratch;                   /**< @brief key & partial value */
+	size_t scratch_len;              /**< @brief characters in scratch */
+	size_t scratch_size;             /**< @brief size of scratch */
+};
+
+/**
+ * @brief appends characters to the scratch buffer
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      s                   characters to append
+ * @param[in]      len                 number of characters to append
+ *
+ * @retval IOT_STATUS_NO_MEMORY        scratch buffer is full
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static iot_status_t app_json_stream_append(
+	app_json_stream_t *stream,
+	const char *s,
+	size_t len );
+
+/**
+ * @brief appends a code point to the scratch buffer as UTF-8
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      cp                  code point to append
+ *
+ * @retval IOT_STATUS_NO_MEMORY        scratch buffer is full
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static iot_status_t app_json_stream_append_utf8(
+	app_json_stream_t *stream,
+	uint32_t cp );
+
+/**
+ * @brief reports an event, then releases the key held
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      event               event to report
+ * @param[in]      type                type of item
+ * @param[in]      value               value text (optional)
+ * @param[in]      value_len           length of value text
+ *
+ * @return the result from the callback
+ */
+static iot_status_t app_json_stream_emit(
+	app_json_stream_t *stream,
+	app_json_stream_event_t event,
+	app_json_type_t type,
+	const char *value,
+	size_t value_len );
+
+/**
+ * @brief records an error, the stream must be finished before reuse
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      result              error to return
+ * @param[in]      text                error description
+ * @param[out]     error               error message buffer (optional)
+ * @param[in]      error_len           size of the error message buffer
+ *
+ * @return @c result
+ */
+static iot_status_t app_json_stream_error(
+	app_json_stream_t *stream,
+	iot_status_t result,
+	const char *text,
+	char *error,
+	size_t error_len );
+
+/**
+ * @brief reports a completed literal or number
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      value               token text
+ * @param[in]      value_len           length of the token text
+ * @param[out]     error_text          description on parse error
+ *
+ * @retval IOT_STATUS_PARSE_ERROR      invalid token
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         result from the callback
+ */
+static iot_status_t app_json_stream_primitive(
+	app_json_stream_t *stream,
+	const char *value,
+	size_t value_len,
+	const char **error_text );
+
+/**
+ * @brief consumes characters of a string being collected
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      js                  input chunk
+ * @param[in]      len                 length of the input chunk
+ * @param[in,out]  pos                 position in the input chunk
+ * @param[out]     error_text          description on parse error
+ *
+ * @retval IOT_STATUS_NO_MEMORY        scratch buffer is full
+ * @retval IOT_STATUS_PARSE_ERROR      invalid string
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         result from the callback
+ */
+static iot_status_t app_json_stream_string(
+	app_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	size_t *pos,
+	const char **error_text );
+
+/**
+ * @brief moves to the next state after a value has been completed
+ *
+ * @param[in,out]  stream              streaming decoder
+ */
+static void app_json_stream_value_done(
+	app_json_stream_t *stream );
+
+iot_status_t app_json_stream_append(
+	app_json_stream_t *stream,
+	const char *s,
+	size_t len )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	if ( stream->scratch_len + len > stream->scratch_size )
+	{
+		result = IOT_STATUS_NO_MEMORY;
+#ifndef IOT_STACK_ONLY
+		if ( stream->flags & APP_JSON_FLAG_DYNAMIC )
+		{
+			size_t size = stream->scratch_size * 2u;
+			char *scratch;
+			if ( size < JSON_STREAM_SCRATCH_MIN )
+				size = JSON_STREAM_SCRATCH_MIN;
+			if ( size < stream->scratch_len + len )
+				size = stream->scratch_len + len;
+			scratch = app_json_realloc( stream->scratch, size );
+			if ( scratch )
+			{
+				stream->scratch = scratch;
+				stream->scratch_size = size;
+				result = IOT_STATUS_SUCCESS;
+			}
+		}
+#endif /* ifndef IOT_STACK_ONLY */
+	}
+	if ( result == IOT_STATUS_SUCCESS && len > 0u )
+	{
+		os_memcpy( &stream->scratch[stream->scratch_len], s, len );
+		stream->scratch_len += len;
+	}
+	return result;
+}
+
+iot_status_t app_json_stream_append_utf8(
+	app_json_stream_t *stream,
+	uint32_t cp )
+{
+	char out[4u];
+	size_t len;
+	if ( cp < 0x80u )
+	{
+		out[0] = (char)cp;
+		len = 1u;
+	}
+	else if ( cp < 0x800u )
+	{
+		out[0] = (char)( 0xC0u | ( cp >> 6 ) );
+		out[1] = (char)( 0x80u | ( cp & 0x3Fu ) );
+		len = 2u;
+	}
+	else if ( cp < 0x10000u )
+	{
+		out[0] = (char)( 0xE0u | ( cp >> 12 ) );
+		out[1] = (char)( 0x80u | ( ( cp >> 6 ) & 0x3Fu ) );
+		out[2] = (char)( 0x80u | ( cp & 0x3Fu ) );
+		len = 3u;
+	}
+	else
+	{
+		out[0] = (char)( 0xF0u | ( cp >> 18 ) );
+		out[1] = (char)( 0x80u | ( ( cp >> 12 ) & 0x3Fu ) );
+		out[2] = (char)( 0x80u | ( ( cp >> 6 ) & 0x3Fu ) );
+		out[3] = (char)( 0x80u | ( cp & 0x3Fu ) );
+		len = 4u;
+	}
+	return app_json_stream_append( stream, out, len );
+}
+
+iot_status_t app_json_stream_emit(
+	app_json_stream_t *stream,
+	app_json_stream_event_t event,
+	app_json_type_t type,
+	const char *value,
+	size_t value_len )
+{
+	iot_status_t result;
+	const char *key = NULL;
+	if ( stream->has_key != IOT_FALSE )
+		key = stream->scratch;
+	result = stream->callback( stream->user_data, event, type,
+		stream->depth, key, stream->key_len, value, value_len );
+	stream->has_key = IOT_FALSE;
+	stream->key_len = 0u;
+	stream->scratch_len = 0u;
+	return result;
+}
+
+iot_status_t app_json_stream_error(
+	app_json_stream_t *stream,
+	iot_status_t result,
+	const char *text,
+	char *error,
+	size_t error_len )
+{
+	stream->state = JSON_STREAM_STATE_ERROR;
+	if ( error && error_len > 0u )
+	{
+		if ( text )
+			os_snprintf( error, error_len, "%s (offset: %lu)",
+				text, (unsigned long)stream->offset );
+		else
+			*error = '\0';
+	}
+	return result;
+}
+
+app_json_stream_t *app_json_stream_initialize(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	app_json_stream_callback_t callback,
+	void *user_data )
+{
+	struct app_json_stream *stream = NULL;
+	if ( callback )
+	{
+		size_t scratch_size = 0u;
+#if !defined( IOT_STACK_ONLY )
+		if ( !buf )
+			flags |= APP_JSON_FLAG_DYNAMIC;
+		if ( flags & APP_JSON_FLAG_DYNAMIC )
+		{
+			len = sizeof( struct app_json_stream );
+			buf = app_json_realloc( NULL, len );
+		}
+		else
+#endif /* if !defined( IOT_STACK_ONLY ) */
+		if ( len >= sizeof( struct app_json_stream ) +
+			JSON_STREAM_SCRATCH_MIN )
+			scratch_size = len - sizeof( struct app_json_stream );
+		else
+			buf = NULL;
+
+		if ( buf )
+		{
+			stream = (struct app_json_stream *)buf;
+			os_memzero( stream, sizeof( struct app_json_stream ) );
+			stream->callback = callback;
+			stream->user_data = user_data;
+			stream->flags = flags;
+			if ( scratch_size > 0u )
+			{
+				stream->scratch = (char *)buf +
+					sizeof( struct app_json_stream );
+				stream->scratch_size = scratch_size;
+			}
+		}
+	}
+	return stream;
+}
+
+iot_status_t app_json_stream_finish(
+	app_json_stream_t *stream,
+	char *error,
+	size_t error_len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( stream )
+	{
+		const char *error_text = NULL;
+		result = IOT_STATUS_PARSE_ERROR;
+		if ( stream->state != JSON_STREAM_STATE_ERROR )
+		{
+			/* a number or literal at the root has no terminator */
+			if ( stream->token == JSON_STREAM_TOKEN_NUMBER ||
+			     stream->token == JSON_STREAM_TOKEN_LITERAL )
+			{
+				result = app_json_stream_primitive( stream,
+					&stream->scratch[stream->key_len],
+					stream->scratch_len - stream->key_len,
+					&error_text );
+				if ( result == IOT_STATUS_SUCCESS )
+					app_json_stream_value_done( stream );
+			}
+
+			if ( stream->state == JSON_STREAM_STATE_DONE )
+				result = IOT_STATUS_SUCCESS;
+			else if ( !error_text )
+				error_text = "incomplete json string";
+		}
+
+		if ( result != IOT_STATUS_SUCCESS )
+			app_json_stream_error( stream, result, error_text,
+				error, error_len );
+		else if ( error && error_len > 0u )
+			*error = '\0';
+
+		/* ready for the next document */
+		stream->state = JSON_STREAM_STATE_VALUE;
+		stream->token = JSON_STREAM_TOKEN_NONE;
+		stream->depth = 0u;
+		stream->containers = 0u;
+		stream->escape = 0u;
+		stream->surrogate = 0u;
+		stream->has_key = IOT_FALSE;
+		stream->key_len = 0u;
+		stream->offset = 0u;
+		stream->scratch_len = 0u;
+	}
+	return result;
+}
+
+iot_status_t app_json_stream_parse(
+	app_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	char *error,
+	size_t error_len )
+{
+	iot_status_t result = IOT_STATUS_BAD_PARAMETER;
+	if ( stream && ( js || len == 0u ) )
+	{
+		const char *error_text = NULL;
+		size_t i = 0u;
+
+		result = IOT_STATUS_PARSE_ERROR;
+		if ( stream->state != JSON_STREAM_STATE_ERROR )
+			result = IOT_STATUS_SUCCESS;
+		while ( result == IOT_STATUS_SUCCESS && i < len )
+		{
+			if ( stream->token == JSON_STREAM_TOKEN_KEY ||
+			     stream->token == JSON_STREAM_TOKEN_STRING )
+			{
+				const size_t start = i;
+				result = app_json_stream_string( stream, js,
+					len, &i, &error_text );
+				stream->offset += i - start;
+			}
+			else if ( stream->token == JSON_STREAM_TOKEN_NUMBER ||
+				  stream->token == JSON_STREAM_TOKEN_LITERAL )
+			{
+				/* collect the token, passing it directly
+				 * from the input if it isn't split */
+				const size_t start = i;
+				const iot_bool_t partial =
+					stream->scratch_len > stream->key_len;
+				while ( i < len && (
+					( stream->token == JSON_STREAM_TOKEN_NUMBER &&
+					  ( ( js[i] >= '0' && js[i] <= '9' ) ||
+					    js[i] == '-' || js[i] == '+' ||
+					    js[i] == '.' || js[i] == 'e' ||
+					    js[i] == 'E' ) ) ||
+					( stream->token == JSON_STREAM_TOKEN_LITERAL &&
+					  js[i] >= 'a' && js[i] <= 'z' ) ) )
+					++i;
+				stream->offset += i - start;
+				if ( i < len && partial == IOT_FALSE )
+					result = app_json_stream_primitive(
+						stream, &js[start], i - start,
+						&error_text );
+				else
+				{
+					result = app_json_stream_append( stream,
+						&js[start], i - start );
+					if ( result == IOT_STATUS_SUCCESS &&
+					     i < len )
+						result = app_json_stream_primitive(
+							stream,
+							&stream->scratch[stream->key_len],
+							stream->scratch_len -
+								stream->key_len,
+							&error_text );
+				}
+				if ( result == IOT_STATUS_SUCCESS && i < len )
+					app_json_stream_value_done( stream );
+			}
+			else
+			{
+				const char c = js[i];
+				const iot_bool_t in_object = ( stream->depth > 0u &&
+					( stream->containers >>
+					  ( stream->depth - 1u ) ) & 1u );
+				if ( c == ' ' || c == '\t' || c == '\n' || c == '\r' )
+					; /* skip white space */
+				else if ( stream->state == JSON_STREAM_STATE_VALUE ||
+					  stream->state == JSON_STREAM_STATE_VALUE_OR_END )
+				{
+					if ( c == '{' || c == '[' )
+					{
+						if ( stream->depth >= JSON_STREAM_MAX_DEPTH )
+						{
+							error_text = "maximum depth exceeded";
+							result = IOT_STATUS_PARSE_ERROR;
+						}
+						else if ( c == '{' )
+						{
+							result = app_json_stream_emit(
+								stream,
+								APP_JSON_STREAM_START,
+								APP_JSON_TYPE_OBJECT,
+								NULL, 0u );
+							stream->containers |=
+								( (uint64_t)1u << stream->depth );
+							++stream->depth;
+							stream->state = JSON_STREAM_STATE_KEY_OR_END;
+						}
+						else
+						{
+							result = app_json_stream_emit(
+								stream,
+								APP_JSON_STREAM_START,
+								APP_JSON_TYPE_ARRAY,
+								NULL, 0u );
+							stream->containers &=
+								~( (uint64_t)1u << stream->depth );
+							++stream->depth;
+							stream->state = JSON_STREAM_STATE_VALUE_OR_END;
+						}
+					}
+					else if ( c == '"' )
+						stream->token = JSON_STREAM_TOKEN_STRING;
+					else if ( c == '-' || ( c >= '0' && c <= '9' ) )
+					{
+						stream->token = JSON_STREAM_TOKEN_NUMBER;
+						--i; /* collect from this character */
+						--stream->offset;
+					}
+					else if ( c >= 'a' && c <= 'z' )
+					{
+						stream->token = JSON_STREAM_TOKEN_LITERAL;
+						--i; /* collect from this character */
+						--stream->offset;
+					}
+					else if ( c == ']' &&
+						stream->state == JSON_STREAM_STATE_VALUE_OR_END )
+					{
+						--stream->depth;
+						result = app_json_stream_emit( stream,
+							APP_JSON_STREAM_END,
+							APP_JSON_TYPE_ARRAY, NULL, 0u );
+						app_json_stream_value_done( stream );
+					}
+					else
+					{
+						error_text = "invalid character";
+						result = IOT_STATUS_PARSE_ERROR;
+					}
+				}
+				else if ( ( stream->state == JSON_STREAM_STATE_KEY ||
+					    stream->state == JSON_STREAM_STATE_KEY_OR_END ) &&
+					  c == '"' )
+					stream->token = JSON_STREAM_TOKEN_KEY;
+				else if ( stream->state == JSON_STREAM_STATE_COLON &&
+					  c == ':' )
+					stream->state = JSON_STREAM_STATE_VALUE;
+				else if ( stream->state == JSON_STREAM_STATE_NEXT &&
+					  c == ',' )
+				{
+					if ( in_object != IOT_FALSE )
+						stream->state = JSON_STREAM_STATE_KEY;
+					else
+						stream->state = JSON_STREAM_STATE_VALUE;
+				}
+				else if ( ( c == '}' && in_object != IOT_FALSE &&
+					    ( stream->state == JSON_STREAM_STATE_NEXT ||
+					      stream->state == JSON_STREAM_STATE_KEY_OR_END ) ) ||
+					  ( c == ']' && in_object == IOT_FALSE &&
+					    stream->state == JSON_STREAM_STATE_NEXT ) )
+				{
+					--stream->depth;
+					result = app_json_stream_emit( stream,
+						APP_JSON_STREAM_END,
+						c == '}' ? APP_JSON_TYPE_OBJECT :
+							APP_JSON_TYPE_ARRAY,
+						NULL, 0u );
+					app_json_stream_value_done( stream );
+				}
+				else
+				{
+					error_text = "invalid character";
+					result = IOT_STATUS_PARSE_ERROR;
+				}
+				++i;
+				++stream->offset;
+			}
+		}
+
+		if ( result != IOT_STATUS_SUCCESS )
+		{
+			if ( result == IOT_STATUS_NO_MEMORY )
+				error_text = "out of memory";
+			result = app_json_stream_error( stream, result,
+				error_text, error, error_len );
+		}
+		else if ( error && error_len > 0u )
+			*error = '\0';
+	}
+	return result;
+}
+
+iot_status_t app_json_stream_primitive(
+	app_json_stream_t *stream,
+	const char *value,
+	size_t value_len,
+	const char **error_text )
+{
+	iot_status_t result = IOT_STATUS_PARSE_ERROR;
+	app_json_type_t type = APP_JSON_TYPE_NULL;
+	if ( stream->token == JSON_STREAM_TOKEN_LITERAL )
+	{
+		*error_text = "invalid literal";
+		if ( value_len == 4u && os_strncmp( value, "null", 4u ) == 0 )
+			result = IOT_STATUS_SUCCESS;
+		else if ( ( value_len == 4u &&
+			    os_strncmp( value, "true", 4u ) == 0 ) ||
+			  ( value_len == 5u &&
+			    os_strncmp( value, "false", 5u ) == 0 ) )
+		{
+			type = APP_JSON_TYPE_BOOL;
+			result = IOT_STATUS_SUCCESS;
+		}
+	}
+	else
+	{
+		/* -? ( 0 | [1-9][0-9]* ) ( . [0-9]+ )? ( [eE] [+-]? [0-9]+ )? */
+		size_t i = 0u;
+		size_t digits;
+		*error_text = "invalid number";
+		type = APP_JSON_TYPE_INTEGER;
+		if ( i < value_len && value[i] == '-' )
+			++i;
+		digits = i;
+		if ( i < value_len && value[i] == '0' )
+			++i;
+		else
+			while ( i < value_len &&
+				value[i] >= '0' && value[i] <= '9' )
+				++i;
+		if ( i > digits && i < value_len && value[i] == '.' )
+		{
+			type = APP_JSON_TYPE_REAL;
+			digits = ++i;
+			while ( i < value_len &&
+				value[i] >= '0' && value[i] <= '9' )
+				++i;
+		}
+		if ( i > digits && i < value_len &&
+		     ( value[i] == 'e' || value[i] == 'E' ) )
+		{
+			type = APP_JSON_TYPE_REAL;
+			++i;
+			if ( i < value_len &&
+			     ( value[i] == '+' || value[i] == '-' ) )
+				++i;
+			digits = i;
+			while ( i < value_len &&
+				value[i] >= '0' && value[i] <= '9' )
+				++i;
+		}
+		if ( i > digits && i == value_len )
+			result = IOT_STATUS_SUCCESS;
+	}
+
+	if ( result == IOT_STATUS_SUCCESS )
+	{
+		stream->token = JSON_STREAM_TOKEN_NONE;
+		result = app_json_stream_emit( stream, APP_JSON_STREAM_VALUE,
+			type, value, value_len );
+	}
+	return result;
+}
+
+iot_status_t app_json_stream_string(
+	app_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	size_t *pos,
+	const char **error_text )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	size_t i = *pos;
+	while ( result == IOT_STATUS_SUCCESS && i < len &&
+		stream->token != JSON_STREAM_TOKEN_NONE )
+	{
+		const char c = js[i];
+		if ( stream->escape == 0u && stream->surrogate == 0u )
+		{
+			/* copy the run of characters not needing any
+			 * processing, passing a value directly from the
+			 * input if it isn't split or escaped */
+			const size_t start = i;
+			while ( i < len && js[i] != '"' && js[i] != '\\' &&
+				(unsigned char)js[i] >= 0x20u )
+				++i;
+			if ( i < len && js[i] == '"' &&
+			     stream->token == JSON_STREAM_TOKEN_STRING &&
+			     stream->scratch_len == stream->key_len )
+			{
+				stream->token = JSON_STREAM_TOKEN_NONE;
+				result = app_json_stream_emit( stream,
+					APP_JSON_STREAM_VALUE,
+					APP_JSON_TYPE_STRING,
+					&js[start], i - start );
+				app_json_stream_value_done( stream );
+				++i;
+			}
+			else
+			{
+				result = app_json_stream_append( stream,
+					&js[start], i - start );
+				if ( result == IOT_STATUS_SUCCESS && i < len )
+				{
+					if ( js[i] == '\\' )
+						stream->escape = 1u;
+					else if ( js[i] != '"' )
+					{
+						*error_text = "invalid character";
+						result = IOT_STATUS_PARSE_ERROR;
+					}
+					else if ( stream->token ==
+						JSON_STREAM_TOKEN_KEY )
+					{
+						stream->token = JSON_STREAM_TOKEN_NONE;
+						stream->has_key = IOT_TRUE;
+						stream->key_len = stream->scratch_len;
+						stream->state = JSON_STREAM_STATE_COLON;
+					}
+					else
+					{
+						stream->token = JSON_STREAM_TOKEN_NONE;
+						result = app_json_stream_emit(
+							stream,
+							APP_JSON_STREAM_VALUE,
+							APP_JSON_TYPE_STRING,
+							&stream->scratch[stream->key_len],
+							stream->scratch_len -
+								stream->key_len );
+						app_json_stream_value_done(
+							stream );
+					}
+					++i;
+				}
+			}
+		}
+		else if ( stream->escape == 0u )
+		{
+			/* a high surrogate must be followed by a low one */
+			if ( c == '\\' )
+				stream->escape = 1u;
+			else
+			{
+				*error_text = "invalid unicode";
+				result = IOT_STATUS_PARSE_ERROR;
+			}
+			++i;
+		}
+		else if ( stream->escape == 1u )
+		{
+			const char *const from = "\"\\/bfnrt";
+			const char *const to = "\"\\/\b\f\n\r\t";
+			const char *const f = os_strchr( from, c );
+			stream->escape = 0u;
+			if ( c == 'u' )
+			{
+				stream->escape = 2u;
+				stream->unicode = 0u;
+			}
+			else if ( stream->surrogate != 0u )
+			{
+				*error_text = "invalid unicode";
+				result = IOT_STATUS_PARSE_ERROR;
+			}
+			else if ( c != '\0' && f )
+				result = app_json_stream_append( stream,
+					&to[f - from], 1u );
+			else
+			{
+				*error_text = "invalid escape";
+				result = IOT_STATUS_PARSE_ERROR;
+			}
+			++i;
+		}
+		else
+		{
+			/* \uXXXX */
+			uint32_t hex = 16u;
+			if ( c >= '0' && c <= '9' )
+				hex = (uint32_t)( c - '0' );
+			else if ( c >= 'a' && c <= 'f' )
+				hex = (uint32_t)( c - 'a' + 10 );
+			else if ( c >= 'A' && c <= 'F' )
+				hex = (uint32_t)( c - 'A' + 10 );
+
+			if ( hex < 16u )
+			{
+				stream->unicode = ( stream->unicode << 4 ) | hex;
+				++stream->escape;
+			}
+			else
+			{
+				*error_text = "invalid escape";
+				result = IOT_STATUS_PARSE_ERROR;
+			}
+
+			if ( result == IOT_STATUS_SUCCESS &&
+			     stream->escape == 6u )
+			{
+				const uint32_t cp = stream->unicode;
+				stream->escape = 0u;
+				if ( cp >= 0xD800u && cp <= 0xDBFFu &&
+				     stream->surrogate == 0u )
+					stream->surrogate = cp;
+				else if ( cp >= 0xDC00u && cp <= 0xDFFFu &&
+				          stream->surrogate != 0u )
+				{
+					result = app_json_stream_append_utf8(
+						stream, 0x10000u +
+						( ( stream->surrogate - 0xD800u ) << 10 ) +
+						( cp - 0xDC00u ) );
+					stream->surrogate = 0u;
+				}
+				else if ( ( cp >= 0xD800u && cp <= 0xDFFFu ) ||
+				          stream->surrogate != 0u )
+				{
+					*error_text = "invalid unicode";
+					result = IOT_STATUS_PARSE_ERROR;
+				}
+				else
+					result = app_json_stream_append_utf8(
+						stream, cp );
+			}
+			++i;
+		}
+	}
+	*pos = i;
+	return result;
+}
+
+void app_json_stream_terminate(
+	app_json_stream_t *stream )
+{
+#ifndef IOT_STACK_ONLY
+	if ( stream && ( stream->flags & APP_JSON_FLAG_DYNAMIC ) )
+	{
+		app_json_free( stream->scratch );
+		app_json_free( stream );
+	}
+#else /* ifndef IOT_STACK_ONLY */
+	(void)stream;
+#endif /* else IOT_STACK_ONLY */
+}
+
+void app_json_stream_value_done(
+	app_json_stream_t *stream )
+{
+	if ( stream->depth > 0u )
+		stream->state = JSON_STREAM_STATE_NEXT;
+	else
+		stream->state = JSON_STREAM_STATE_DONE;
+}
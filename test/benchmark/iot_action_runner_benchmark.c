@@ -0,0 +1,110 @@
+/**
+ * @file
+ * @brief Compares the time to launch commands using the action runner process
+ *        against launching them with os_system_run
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "iot_action_runner.h"
+
+#include <os.h>
+#include <stdlib.h> /* for atoi */
+#include <time.h>   /* for clock_gettime */
+
+/** @brief Default number of times to run each command */
+#define BENCHMARK_ITERATIONS_DEFAULT             1000
+/** @brief Command run by the benchmark */
+#define BENCHMARK_COMMAND                        "/bin/true"
+/** @brief Size of the output buffers */
+#define BENCHMARK_OUTPUT_SIZE                    1024u
+
+/**
+ * @brief Returns the current monotonic time in milliseconds
+ *
+ * @return the current time in milliseconds
+ */
+static double benchmark_time( void );
+
+double benchmark_time( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+int main( int argc, char *argv[] )
+{
+	char out[ BENCHMARK_OUTPUT_SIZE ];
+	char err[ BENCHMARK_OUTPUT_SIZE ];
+	const char *const cmd_argv[] = { BENCHMARK_COMMAND, NULL };
+	struct iot_action_runner runner;
+	int iterations = BENCHMARK_ITERATIONS_DEFAULT;
+	int result = EXIT_FAILURE;
+
+	if ( argc > 1 )
+		iterations = atoi( argv[1] );
+
+	iot_action_runner_initialize( &runner );
+	if ( iterations > 0 &&
+		iot_action_runner_start( &runner ) == IOT_STATUS_SUCCESS )
+	{
+		double start;
+		double runner_time;
+		double system_time;
+		int i;
+		int return_code = 0;
+
+		result = EXIT_SUCCESS;
+		start = benchmark_time();
+		for ( i = 0; i < iterations && result == EXIT_SUCCESS; ++i )
+			if ( iot_action_runner_run( &runner, cmd_argv, 0u, NULL,
+				out, BENCHMARK_OUTPUT_SIZE, err,
+				BENCHMARK_OUTPUT_SIZE, &return_code )
+				!= IOT_STATUS_SUCCESS || return_code != 0 )
+				result = EXIT_FAILURE;
+		runner_time = benchmark_time() - start;
+
+		start = benchmark_time();
+		for ( i = 0; i < iterations && result == EXIT_SUCCESS; ++i )
+		{
+			os_system_run_args_t args = OS_SYSTEM_RUN_ARGS_INIT;
+			args.cmd = BENCHMARK_COMMAND;
+			args.block = OS_TRUE;
+			args.opts.block.std_out.buf = out;
+			args.opts.block.std_out.len = BENCHMARK_OUTPUT_SIZE;
+			args.opts.block.std_err.buf = err;
+			args.opts.block.std_err.len = BENCHMARK_OUTPUT_SIZE;
+			if ( os_system_run( &args ) != OS_STATUS_SUCCESS ||
+				args.return_code != 0 )
+				result = EXIT_FAILURE;
+		}
+		system_time = benchmark_time() - start;
+
+		if ( result == EXIT_SUCCESS )
+		{
+			os_printf( "command:       %s\n", BENCHMARK_COMMAND );
+			os_printf( "iterations:    %d\n", iterations );
+			os_printf( "action runner: %.3f ms/command\n",
+				runner_time / (double)iterations );
+			os_printf( "os_system_run: %.3f ms/command\n",
+				system_time / (double)iterations );
+		}
+		else
+			os_fprintf( OS_STDERR, "%s\n", "failed to run command" );
+	}
+	else
+		os_fprintf( OS_STDERR, "%s\n", "failed to start runner" );
+	iot_action_runner_terminate( &runner );
+	return result;
+}
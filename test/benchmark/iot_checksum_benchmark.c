@@ -0,0 +1,192 @@
+/**
+ * @file
+ * @brief Measures the throughput of the checksum implementations
+ *
+ * Each implementation hashes the same buffer repeatedly and the result is
+ * reported in GB/s.  The CRC-32 implementation used by the library is the
+ * one named "hardware" when the processor supports it, otherwise
+ * "slicing-by-8".  The digests are measured through the public API, both
+ * alone and all together in a single pass.
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "checksum/iot_checksum_crc32.h"
+#include "checksum/iot_checksum_sha256.h"
+#include "iot_checksum.h"
+
+#include <os.h>
+#include <stdlib.h> /* for atoi, malloc, free */
+#include <time.h>   /* for clock_gettime */
+
+/** @brief Default size of the buffer hashed in kilobytes */
+#define BENCHMARK_SIZE_KB_DEFAULT                1024
+/** @brief Total amount of data hashed by each implementation (bytes) */
+#define BENCHMARK_TOTAL_BYTES                    ( 1024.0 * 1024.0 * 1024.0 )
+
+/**
+ * @brief CRC-32 implementation measured by the benchmark
+ */
+struct benchmark_case
+{
+	const char *name;                /**< @brief name of the implementation */
+	iot_uint32_t (*fn)( iot_uint32_t, const void *, size_t );
+	                                 /**< @brief function to measure */
+};
+
+/**
+ * @brief Measures the digests through the public API
+ *
+ * @param[in]      buf                 data to hash
+ * @param[in]      size                size of the data
+ *
+ * @return EXIT_SUCCESS on success, EXIT_FAILURE otherwise
+ */
+static int benchmark_digests( const unsigned char *buf, size_t size );
+
+/**
+ * @brief Returns the current monotonic time in seconds
+ *
+ * @return the current time in seconds
+ */
+static double benchmark_time( void );
+
+int benchmark_digests( const unsigned char *buf, size_t size )
+{
+	const iot_checksum_type_t types[] = { IOT_CHECKSUM_TYPE_CRC32,
+		IOT_CHECKSUM_TYPE_MD5, IOT_CHECKSUM_TYPE_SHA256 };
+	const char *const names[] = { "crc32", "md5", "sha256",
+		"all (one pass)" };
+	const size_t type_count = sizeof( types ) / sizeof( types[0] );
+	const int runs = (int)( BENCHMARK_TOTAL_BYTES / 4.0 / (double)size ) + 1;
+	int result = EXIT_SUCCESS;
+	size_t i;
+
+	/* each algorithm alone, then all of them in one pass */
+	for ( i = 0u; i <= type_count && result == EXIT_SUCCESS; ++i )
+	{
+		iot_checksum_context_t ctx[ sizeof( types ) / sizeof( types[0] ) ];
+		const size_t first = ( i < type_count ) ? i : 0u;
+		const size_t count = ( i < type_count ) ? 1u : type_count;
+		double start;
+		double elapsed;
+		size_t k;
+		int j;
+
+		start = benchmark_time();
+		for ( j = 0; j < runs && result == EXIT_SUCCESS; ++j )
+		{
+			for ( k = 0u; k < count; ++k )
+				iot_checksum_initialize( &ctx[k], types[first + k] );
+			if ( iot_checksum_update_multiple( ctx, count, buf,
+				size ) != IOT_STATUS_SUCCESS )
+				result = EXIT_FAILURE;
+		}
+		elapsed = benchmark_time() - start;
+
+		if ( result == EXIT_SUCCESS )
+			os_printf( "%-16s %12.2f\n", names[i],
+				(double)size * (double)runs /
+				elapsed / 1000000000.0 );
+		else
+			os_fprintf( OS_STDERR, "%s: failed to hash\n", names[i] );
+	}
+	return result;
+}
+
+double benchmark_time( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+}
+
+int main( int argc, char *argv[] )
+{
+	const struct benchmark_case cases[] = {
+		{ "reference", iot_checksum_crc32_reference },
+		{ "slicing-by-8", iot_checksum_crc32_slice8 },
+		{ "hardware", iot_checksum_crc32_hardware },
+		{ NULL, NULL }
+	};
+	const char *hardware = iot_checksum_crc32_hardware_name();
+	const char *sha256_hardware = iot_checksum_sha256_hardware_name();
+	unsigned char *buf = NULL;
+	size_t size;
+	int size_kb = BENCHMARK_SIZE_KB_DEFAULT;
+	int result = EXIT_FAILURE;
+
+	if ( argc > 1 )
+		size_kb = atoi( argv[1] );
+
+	size = (size_t)size_kb * 1024u;
+	if ( size_kb > 0 )
+		buf = (unsigned char *)malloc( size );
+	if ( buf )
+	{
+		const struct benchmark_case *c;
+		iot_uint32_t expected;
+		size_t i;
+
+		for ( i = 0u; i < size; ++i )
+			buf[i] = (unsigned char)( i * 31u + ( i >> 8 ) );
+		expected = iot_checksum_crc32_reference( 0u, buf, size );
+
+		os_printf( "buffer size:  %d kB\n", size_kb );
+		os_printf( "hardware:     %s\n", hardware ? hardware : "none" );
+		os_printf( "sha256:       %s\n",
+			sha256_hardware ? sha256_hardware : "none" );
+		os_printf( "%-16s %12s\n", "implementation", "GB/s" );
+
+		result = EXIT_SUCCESS;
+		for ( c = cases; c->name && result == EXIT_SUCCESS; ++c )
+		{
+			const int iterations =
+				(int)( BENCHMARK_TOTAL_BYTES / (double)size ) + 1;
+			iot_uint32_t crc = 0u;
+			double start;
+			double elapsed;
+			int j;
+
+			/* the reference is far slower, hash less data with it */
+			const int runs = ( c == cases ) ?
+				iterations / 8 + 1 : iterations;
+
+			start = benchmark_time();
+			for ( j = 0; j < runs; ++j )
+				crc = c->fn( 0u, buf, size );
+			elapsed = benchmark_time() - start;
+
+			if ( crc == expected )
+				os_printf( "%-16s %12.2f\n", c->name,
+					(double)size * (double)runs /
+					elapsed / 1000000000.0 );
+			else
+			{
+				os_fprintf( OS_STDERR, "%s: incorrect checksum\n",
+					c->name );
+				result = EXIT_FAILURE;
+			}
+		}
+
+		if ( result == EXIT_SUCCESS )
+		{
+			os_printf( "%-16s %12s\n", "digest", "GB/s" );
+			result = benchmark_digests( buf, size );
+		}
+		free( buf );
+	}
+	else
+		os_fprintf( OS_STDERR, "%s\n", "failed to allocate buffer" );
+	return result;
+}
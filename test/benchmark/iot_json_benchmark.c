@@ -0,0 +1,601 @@
+/**
+ * @file
+ * @brief Measures the cost of encoding and decoding representative messages
+ *        through the iot_json API with the JSON library the build uses
+ *
+ * Build the benchmark once for each value of IOT_JSON_LIBRARY to compare the
+ * backends.  For each payload it reports the time per operation, the number
+ * of allocations and bytes allocated per operation (through the iot_json
+ * allocation functions) and the largest amount of memory in use at one time.
+ * The peak resident set size of the process is reported at the end.
+ *
+ * @note json-c does not support replacing its allocation functions, so its
+ *       internal allocations are only visible in the peak resident set size
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "iot_json.h"
+
+#include <os.h>
+#include <stdlib.h>       /* for atoi */
+#include <sys/resource.h> /* for getrusage */
+#include <time.h>         /* for clock_gettime */
+
+/** @brief Default number of times to run each operation */
+#define BENCHMARK_ITERATIONS_DEFAULT             10000
+/** @brief Number of messages in the mailbox.check reply */
+#define BENCHMARK_MAILBOX_MESSAGES               8u
+/** @brief Maximum depth walked when decoding */
+#define BENCHMARK_WALK_DEPTH_MAX                 16u
+
+#if defined( IOT_JSON_JANSSON )
+/** @brief Name of the JSON library being measured */
+#define BENCHMARK_JSON_LIBRARY                   "jansson"
+#elif defined( IOT_JSON_JSONC )
+/** @brief Name of the JSON library being measured */
+#define BENCHMARK_JSON_LIBRARY                   "json-c"
+#else /* defined( IOT_JSON_JSMN ) */
+/** @brief Name of the JSON library being measured */
+#define BENCHMARK_JSON_LIBRARY                   "jsmn"
+#endif /* defined( IOT_JSON_JSMN ) */
+
+/**
+ * @brief Header stored in front of each allocation to track its size
+ */
+union benchmark_alloc_header
+{
+	size_t size;                     /**< @brief size of the allocation */
+	double align_double;             /**< @brief ensures alignment */
+	void *align_ptr;                 /**< @brief ensures alignment */
+};
+
+/**
+ * @brief Operation measured by the benchmark
+ */
+struct benchmark_case
+{
+	const char *name;                /**< @brief name of the operation */
+	iot_status_t (*fn)( void );      /**< @brief function to measure */
+};
+
+/** @brief Number of allocations made */
+static unsigned long benchmark_alloc_count = 0u;
+/** @brief Total number of bytes allocated */
+static unsigned long long benchmark_alloc_bytes = 0u;
+/** @brief Number of bytes currently allocated */
+static size_t benchmark_alloc_current = 0u;
+/** @brief Largest number of bytes allocated at one time */
+static size_t benchmark_alloc_peak = 0u;
+
+/** @brief Reply received from the cloud to a mailbox.check request */
+static char benchmark_mailbox_reply[ 4096u ];
+/** @brief Length of the mailbox.check reply */
+static size_t benchmark_mailbox_reply_len = 0u;
+/** @brief Message published for a property */
+static char benchmark_property_publish[ 512u ];
+/** @brief Length of the property message */
+static size_t benchmark_property_publish_len = 0u;
+
+/** @brief Connection configuration file (iot-connect.cfg) */
+static const char *const BENCHMARK_CONNECT_CFG =
+	"{\n"
+	"\t\"cloud\": {\n"
+	"\t\t\"host\": \"api.devicecloud.example.com\",\n"
+	"\t\t\"port\": 8883,\n"
+	"\t\t\"token\": \"abcdefghijklmnop\"\n"
+	"\t},\n"
+	"\t\"validate_cloud_cert\": true,\n"
+	"\t\"ca_bundle_file\": \"/etc/ssl/certs/ca-certificates.crt\",\n"
+	"\t\"proxy\": {\n"
+	"\t\t\"type\": \"socks5\",\n"
+	"\t\t\"host\": \"proxy.example.com\",\n"
+	"\t\t\"port\": 1080,\n"
+	"\t\t\"username\": \"device\",\n"
+	"\t\t\"password\": \"secret\"\n"
+	"\t}\n"
+	"}\n";
+
+/**
+ * @brief Frees memory allocated by @p benchmark_realloc
+ *
+ * @param[in]      ptr                 memory to free
+ */
+static void benchmark_free( void *ptr );
+
+/**
+ * @brief Reallocates memory, recording the allocation
+ *
+ * @param[in]      ptr                 memory to reallocate (optional)
+ * @param[in]      size                new size of the memory
+ *
+ * @return pointer to the memory allocated
+ */
+static void *benchmark_realloc( void *ptr, size_t size );
+
+/**
+ * @brief Encodes the iot-connect.cfg configuration
+ *
+ * @param[out]     out                 buffer to hold the document (optional)
+ * @param[in]      out_len             size of the output buffer
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_build_connect_cfg( char *out, size_t out_len );
+
+/**
+ * @brief Encodes a reply to a mailbox.check request
+ *
+ * @param[out]     out                 buffer to hold the document (optional)
+ * @param[in]      out_len             size of the output buffer
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_build_mailbox_reply( char *out, size_t out_len );
+
+/**
+ * @brief Encodes a property.publish message, as the tr50 plug-in does
+ *
+ * @param[out]     out                 buffer to hold the document (optional)
+ * @param[in]      out_len             size of the output buffer
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_build_property_publish( char *out,
+	size_t out_len );
+
+/**
+ * @brief Decodes a document, retrieving the value of every item in it
+ *
+ * @param[in]      js                  document to decode
+ * @param[in]      len                 length of the document
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_decode( const char *js, size_t len );
+
+/**
+ * @brief Benchmark operation decoding iot-connect.cfg
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_decode_connect_cfg( void );
+
+/**
+ * @brief Benchmark operation decoding a mailbox.check reply
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_decode_mailbox_reply( void );
+
+/**
+ * @brief Benchmark operation decoding a property.publish message
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_decode_property_publish( void );
+
+/**
+ * @brief Benchmark operation encoding iot-connect.cfg
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_encode_connect_cfg( void );
+
+/**
+ * @brief Benchmark operation encoding a mailbox.check reply
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_encode_mailbox_reply( void );
+
+/**
+ * @brief Benchmark operation encoding a property.publish message
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_encode_property_publish( void );
+
+/**
+ * @brief Returns the current monotonic time in nanoseconds
+ *
+ * @return the current time in nanoseconds
+ */
+static double benchmark_time( void );
+
+/**
+ * @brief Retrieves the value of an item and, for arrays and objects, the
+ *        values of all items within it
+ *
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      item                item to walk
+ * @param[in]      depth               current depth of the item
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ * @retval ...                         on failure
+ */
+static iot_status_t benchmark_walk( const iot_json_decoder_t *decoder,
+	const iot_json_item_t *item, unsigned int depth );
+
+iot_status_t benchmark_build_connect_cfg( char *out, size_t out_len )
+{
+	iot_status_t result = IOT_STATUS_NO_MEMORY;
+	iot_json_encoder_t *const json = iot_json_encode_initialize( NULL, 0u,
+		IOT_JSON_FLAG_DYNAMIC | IOT_JSON_FLAG_INDENT(1) );
+	if ( json )
+	{
+		const char *msg;
+		iot_json_encode_object_start( json, "cloud" );
+		iot_json_encode_string( json, "host",
+			"api.devicecloud.example.com" );
+		iot_json_encode_integer( json, "port", 8883 );
+		iot_json_encode_string( json, "token", "abcdefghijklmnop" );
+		iot_json_encode_object_end( json );
+		iot_json_encode_bool( json, "validate_cloud_cert", IOT_TRUE );
+		iot_json_encode_string( json, "ca_bundle_file",
+			"/etc/ssl/certs/ca-certificates.crt" );
+		iot_json_encode_object_start( json, "proxy" );
+		iot_json_encode_string( json, "type", "socks5" );
+		iot_json_encode_string( json, "host", "proxy.example.com" );
+		iot_json_encode_integer( json, "port", 1080 );
+		iot_json_encode_string( json, "username", "device" );
+		iot_json_encode_string( json, "password", "secret" );
+		result = iot_json_encode_object_end( json );
+
+		msg = iot_json_encode_dump( json );
+		if ( !msg )
+			result = IOT_STATUS_FAILURE;
+		else if ( out && out_len > 0u )
+			os_strncpy( out, msg, out_len );
+		iot_json_encode_terminate( json );
+	}
+	return result;
+}
+
+iot_status_t benchmark_build_mailbox_reply( char *out, size_t out_len )
+{
+	iot_status_t result = IOT_STATUS_NO_MEMORY;
+	iot_json_encoder_t *const json =
+		iot_json_encode_initialize( NULL, 0u, IOT_JSON_FLAG_DYNAMIC );
+	if ( json )
+	{
+		unsigned int i;
+		const char *msg;
+
+		iot_json_encode_object_start( json, "check" );
+		iot_json_encode_bool( json, "success", IOT_TRUE );
+		iot_json_encode_object_start( json, "params" );
+		iot_json_encode_array_start( json, "messages" );
+		for ( i = 0u; i < BENCHMARK_MAILBOX_MESSAGES; ++i )
+		{
+			iot_json_encode_object_start( json, NULL );
+			iot_json_encode_string( json, "id",
+				"5a7b3c9d1e2f4a6b8c0d1e2f" );
+			iot_json_encode_string( json, "thingKey",
+				"0a1b2c3d-4e5f-6a7b-8c9d-0e1f2a3b4c5d-device" );
+			iot_json_encode_string( json, "command", "method.exec" );
+			iot_json_encode_object_start( json, "params" );
+			iot_json_encode_string( json, "method", "set_thresholds" );
+			iot_json_encode_object_start( json, "params" );
+			iot_json_encode_real( json, "low", 12.5 );
+			iot_json_encode_real( json, "high", 87.25 );
+			iot_json_encode_integer( json, "interval", 30 );
+			iot_json_encode_bool( json, "enabled", IOT_TRUE );
+			iot_json_encode_string( json, "units", "celsius" );
+			iot_json_encode_object_end( json );
+			iot_json_encode_object_end( json );
+			iot_json_encode_object_end( json );
+		}
+		iot_json_encode_array_end( json );
+		iot_json_encode_object_end( json );
+		result = iot_json_encode_object_end( json );
+
+		msg = iot_json_encode_dump( json );
+		if ( !msg )
+			result = IOT_STATUS_FAILURE;
+		else if ( out && out_len > 0u )
+			os_strncpy( out, msg, out_len );
+		iot_json_encode_terminate( json );
+	}
+	return result;
+}
+
+iot_status_t benchmark_build_property_publish( char *out, size_t out_len )
+{
+	iot_status_t result = IOT_STATUS_NO_MEMORY;
+	iot_json_encoder_t *const json =
+		iot_json_encode_initialize( NULL, 0u, IOT_JSON_FLAG_DYNAMIC );
+	if ( json )
+	{
+		const char *msg;
+		iot_json_encode_object_start( json, "12" );
+		iot_json_encode_string( json, "command", "property.publish" );
+		iot_json_encode_object_start( json, "params" );
+		iot_json_encode_string( json, "thingKey",
+			"0a1b2c3d-4e5f-6a7b-8c9d-0e1f2a3b4c5d-device" );
+		iot_json_encode_string( json, "key", "temperature" );
+		iot_json_encode_real( json, "value", 21.375 );
+		iot_json_encode_string( json, "ts",
+			"2018-06-01T12:34:56.789Z" );
+		iot_json_encode_object_end( json );
+		result = iot_json_encode_object_end( json );
+
+		msg = iot_json_encode_dump( json );
+		if ( !msg )
+			result = IOT_STATUS_FAILURE;
+		else if ( out && out_len > 0u )
+			os_strncpy( out, msg, out_len );
+		iot_json_encode_terminate( json );
+	}
+	return result;
+}
+
+iot_status_t benchmark_decode( const char *js, size_t len )
+{
+	iot_status_t result = IOT_STATUS_NO_MEMORY;
+	iot_json_decoder_t *const json =
+		iot_json_decode_initialize( NULL, 0u, IOT_JSON_FLAG_DYNAMIC );
+	if ( json )
+	{
+		const iot_json_item_t *root = NULL;
+		result = iot_json_decode_parse( json, js, len, &root, NULL, 0u );
+		if ( result == IOT_STATUS_SUCCESS )
+			result = benchmark_walk( json, root, 0u );
+		iot_json_decode_terminate( json );
+	}
+	return result;
+}
+
+iot_status_t benchmark_decode_connect_cfg( void )
+{
+	return benchmark_decode( BENCHMARK_CONNECT_CFG,
+		os_strlen( BENCHMARK_CONNECT_CFG ) );
+}
+
+iot_status_t benchmark_decode_mailbox_reply( void )
+{
+	return benchmark_decode( benchmark_mailbox_reply,
+		benchmark_mailbox_reply_len );
+}
+
+iot_status_t benchmark_decode_property_publish( void )
+{
+	return benchmark_decode( benchmark_property_publish,
+		benchmark_property_publish_len );
+}
+
+iot_status_t benchmark_encode_connect_cfg( void )
+{
+	return benchmark_build_connect_cfg( NULL, 0u );
+}
+
+iot_status_t benchmark_encode_mailbox_reply( void )
+{
+	return benchmark_build_mailbox_reply( NULL, 0u );
+}
+
+iot_status_t benchmark_encode_property_publish( void )
+{
+	return benchmark_build_property_publish( NULL, 0u );
+}
+
+void benchmark_free( void *ptr )
+{
+	if ( ptr )
+	{
+		union benchmark_alloc_header *const header =
+			(union benchmark_alloc_header *)ptr - 1;
+		benchmark_alloc_current -= header->size;
+		os_free( header );
+	}
+}
+
+void *benchmark_realloc( void *ptr, size_t size )
+{
+	union benchmark_alloc_header *header = NULL;
+	size_t old_size = 0u;
+	void *result = NULL;
+
+	if ( ptr )
+	{
+		header = (union benchmark_alloc_header *)ptr - 1;
+		old_size = header->size;
+	}
+
+	header = (union benchmark_alloc_header *)os_realloc( header,
+		sizeof( union benchmark_alloc_header ) + size );
+	if ( header )
+	{
+		header->size = size;
+		benchmark_alloc_current = benchmark_alloc_current - old_size + size;
+		if ( benchmark_alloc_current > benchmark_alloc_peak )
+			benchmark_alloc_peak = benchmark_alloc_current;
+		benchmark_alloc_bytes += size;
+		++benchmark_alloc_count;
+		result = header + 1;
+	}
+	return result;
+}
+
+double benchmark_time( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec * 1000000000.0 + (double)ts.tv_nsec;
+}
+
+iot_status_t benchmark_walk( const iot_json_decoder_t *decoder,
+	const iot_json_item_t *item, unsigned int depth )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	const char *str;
+	size_t str_len;
+	iot_bool_t bool_value;
+	iot_int64_t int_value;
+	iot_float64_t real_value;
+
+	if ( depth >= BENCHMARK_WALK_DEPTH_MAX )
+		result = IOT_STATUS_FULL;
+	else switch ( iot_json_decode_type( decoder, item ) )
+	{
+	case IOT_JSON_TYPE_ARRAY:
+	{
+		const iot_json_array_iterator_t *iter =
+			iot_json_decode_array_iterator( decoder, item );
+		while ( iter && result == IOT_STATUS_SUCCESS )
+		{
+			const iot_json_item_t *value = NULL;
+			result = iot_json_decode_array_iterator_value(
+				decoder, item, iter, &value );
+			if ( result == IOT_STATUS_SUCCESS )
+				result = benchmark_walk( decoder, value,
+					depth + 1u );
+			iter = iot_json_decode_array_iterator_next(
+				decoder, item, iter );
+		}
+		break;
+	}
+	case IOT_JSON_TYPE_OBJECT:
+	{
+		const iot_json_object_iterator_t *iter =
+			iot_json_decode_object_iterator( decoder, item );
+		while ( iter && result == IOT_STATUS_SUCCESS )
+		{
+			const iot_json_item_t *value = NULL;
+			result = iot_json_decode_object_iterator_key(
+				decoder, item, iter, &str, &str_len );
+			if ( result == IOT_STATUS_SUCCESS )
+				result = iot_json_decode_object_iterator_value(
+					decoder, item, iter, &value );
+			if ( result == IOT_STATUS_SUCCESS )
+				result = benchmark_walk( decoder, value,
+					depth + 1u );
+			iter = iot_json_decode_object_iterator_next(
+				decoder, item, iter );
+		}
+		break;
+	}
+	case IOT_JSON_TYPE_BOOL:
+		result = iot_json_decode_bool( decoder, item, &bool_value );
+		break;
+	case IOT_JSON_TYPE_INTEGER:
+		result = iot_json_decode_integer( decoder, item, &int_value );
+		break;
+	case IOT_JSON_TYPE_REAL:
+		result = iot_json_decode_real( decoder, item, &real_value );
+		break;
+	case IOT_JSON_TYPE_STRING:
+		result = iot_json_decode_string( decoder, item,
+			&str, &str_len );
+		break;
+	case IOT_JSON_TYPE_NULL:
+	default:
+		break;
+	}
+	return result;
+}
+
+int main( int argc, char *argv[] )
+{
+	const struct benchmark_case cases[] = {
+		{ "encode property.publish", benchmark_encode_property_publish },
+		{ "decode property.publish", benchmark_decode_property_publish },
+		{ "encode mailbox.check reply", benchmark_encode_mailbox_reply },
+		{ "decode mailbox.check reply", benchmark_decode_mailbox_reply },
+		{ "encode iot-connect.cfg", benchmark_encode_connect_cfg },
+		{ "decode iot-connect.cfg", benchmark_decode_connect_cfg },
+		{ NULL, NULL }
+	};
+	iot_json_realloc_t realloc_fn = benchmark_realloc;
+	iot_json_free_t free_fn = benchmark_free;
+	int iterations = BENCHMARK_ITERATIONS_DEFAULT;
+	int result = EXIT_FAILURE;
+
+	if ( argc > 1 )
+		iterations = atoi( argv[1] );
+
+	iot_json_allocation_set( &realloc_fn, &free_fn );
+
+	/* generate the documents to decode */
+	if ( iterations > 0 &&
+		benchmark_build_property_publish( benchmark_property_publish,
+			sizeof( benchmark_property_publish ) ) == IOT_STATUS_SUCCESS &&
+		benchmark_build_mailbox_reply( benchmark_mailbox_reply,
+			sizeof( benchmark_mailbox_reply ) ) == IOT_STATUS_SUCCESS )
+	{
+		const struct benchmark_case *c;
+		struct rusage usage;
+
+		benchmark_property_publish[
+			sizeof( benchmark_property_publish ) - 1u ] = '\0';
+		benchmark_property_publish_len =
+			os_strlen( benchmark_property_publish );
+		benchmark_mailbox_reply[
+			sizeof( benchmark_mailbox_reply ) - 1u ] = '\0';
+		benchmark_mailbox_reply_len =
+			os_strlen( benchmark_mailbox_reply );
+
+		os_printf( "json library: %s\n", BENCHMARK_JSON_LIBRARY );
+		os_printf( "iterations:   %d\n", iterations );
+		os_printf( "%-28s %12s %12s %12s %12s\n", "operation", "ns/op",
+			"allocs/op", "bytes/op", "peak bytes" );
+
+		result = EXIT_SUCCESS;
+		for ( c = cases; c->name && result == EXIT_SUCCESS; ++c )
+		{
+			double start;
+			double elapsed;
+			int i;
+
+			benchmark_alloc_count = 0u;
+			benchmark_alloc_bytes = 0u;
+			benchmark_alloc_peak = benchmark_alloc_current;
+			start = benchmark_time();
+			for ( i = 0; i < iterations && result == EXIT_SUCCESS; ++i )
+				if ( c->fn() != IOT_STATUS_SUCCESS )
+					result = EXIT_FAILURE;
+			elapsed = benchmark_time() - start;
+
+			if ( result == EXIT_SUCCESS )
+				os_printf( "%-28s %12.1f %12.1f %12.1f %12lu\n",
+					c->name, elapsed / (double)iterations,
+					(double)benchmark_alloc_count /
+						(double)iterations,
+					(double)benchmark_alloc_bytes /
+						(double)iterations,
+					(unsigned long)benchmark_alloc_peak );
+			else
+				os_fprintf( OS_STDERR, "failed to %s\n",
+					c->name );
+		}
+
+		if ( result == EXIT_SUCCESS &&
+			getrusage( RUSAGE_SELF, &usage ) == 0 )
+			os_printf( "peak rss:     %ld kB\n", usage.ru_maxrss );
+	}
+	else
+		os_fprintf( OS_STDERR, "%s\n", "failed to generate documents" );
+
+	iot_json_allocation_set( NULL, NULL );
+	return result;
+}
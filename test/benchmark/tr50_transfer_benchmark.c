@@ -0,0 +1,504 @@
+/**
+ * @file
+ * @brief Compares running file transfers with a thread and curl easy handle
+ *        per transfer against a single thread driving a curl multi handle
+ *
+ * A local HTTP server stands in for the cloud file store: it is started on
+ * the loopback interface and serves a fixed size body to every request.  Run
+ * the benchmark once for each mode, as the peak resident set size reported
+ * covers the whole process:
+ *    tr50_transfer_benchmark threads [transfers] [kB per transfer]
+ *    tr50_transfer_benchmark multi [transfers] [kB per transfer]
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "iot.h"
+#include "shared/iot_defs.h"
+
+#include <curl/curl.h>
+#include <os.h>
+#include <arpa/inet.h>    /* for htonl, htons */
+#include <netinet/in.h>   /* for struct sockaddr_in */
+#include <poll.h>         /* for poll */
+#include <stdlib.h>       /* for atoi */
+#include <sys/resource.h> /* for getrusage */
+#include <sys/socket.h>   /* for socket, bind, listen, accept */
+#include <time.h>         /* for clock_gettime */
+#include <unistd.h>       /* for close, read, write */
+
+/** @brief Default number of concurrent transfers */
+#define BENCHMARK_TRANSFERS_DEFAULT              10
+/** @brief Default size of each transfer in kilobytes */
+#define BENCHMARK_SIZE_KB_DEFAULT                1024
+/** @brief Maximum number of concurrent transfers */
+#define BENCHMARK_TRANSFERS_MAX                  64
+/** @brief Size of the buffer the server sends the body from */
+#define BENCHMARK_CHUNK_SIZE                     16384u
+/** @brief Time the curl multi handle waits for activity (ms) */
+#define BENCHMARK_WAIT_MS                        1000
+
+/**
+ * @brief Connection accepted by the local server
+ */
+struct benchmark_connection
+{
+	int fd;                          /**< @brief socket, -1 if unused */
+	iot_bool_t header_sent;          /**< @brief response header sent */
+	size_t remaining;                /**< @brief body bytes left to send */
+};
+
+/**
+ * @brief Local HTTP server standing in for the cloud file store
+ */
+struct benchmark_server
+{
+	int fd;                          /**< @brief listening socket */
+	unsigned short port;             /**< @brief port listening on */
+	size_t body_size;                /**< @brief size of each response body */
+	int expected;                    /**< @brief requests to serve */
+	os_thread_t thread;              /**< @brief server thread */
+};
+
+/**
+ * @brief Transfer made by a client
+ */
+struct benchmark_transfer
+{
+	const char *url;                 /**< @brief url to download */
+	size_t received;                 /**< @brief bytes received */
+	CURLcode result;                 /**< @brief result of the transfer */
+};
+
+/**
+ * @brief Serves a body to each connection until all requests are served
+ *
+ * @param[in]      arg                 server to run
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static OS_THREAD_DECL benchmark_server_run( void *arg );
+
+/**
+ * @brief Starts the local server
+ *
+ * @param[out]     server              server to start
+ * @param[in]      body_size           size of each response body
+ * @param[in]      expected            number of requests to serve
+ *
+ * @retval IOT_STATUS_SUCCESS          server started
+ * @retval IOT_STATUS_FAILURE          failed to start the server
+ */
+static iot_status_t benchmark_server_start( struct benchmark_server *server,
+	size_t body_size, int expected );
+
+/**
+ * @brief Returns the current monotonic time in milliseconds
+ *
+ * @return the current time in milliseconds
+ */
+static double benchmark_time( void );
+
+/**
+ * @brief Transfers with a thread and curl easy handle each
+ *
+ * @param[in,out]  transfers           transfers to make
+ * @param[in]      count               number of transfers
+ *
+ * @retval IOT_STATUS_SUCCESS          all transfers ran
+ * @retval IOT_STATUS_FAILURE          failed to start a transfer
+ */
+static iot_status_t benchmark_transfer_threads(
+	struct benchmark_transfer *transfers, int count );
+
+/**
+ * @brief Thread running a single transfer with curl_easy_perform
+ *
+ * @param[in,out]  arg                 transfer to make
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static OS_THREAD_DECL benchmark_transfer_thread( void *arg );
+
+/**
+ * @brief Transfers on the calling thread with one curl multi handle
+ *
+ * @param[in,out]  transfers           transfers to make
+ * @param[in]      count               number of transfers
+ *
+ * @retval IOT_STATUS_SUCCESS          all transfers ran
+ * @retval IOT_STATUS_FAILURE          failed to start a transfer
+ */
+static iot_status_t benchmark_transfer_multi(
+	struct benchmark_transfer *transfers, int count );
+
+/**
+ * @brief Counts the bytes received for a transfer
+ *
+ * @param[in]      ptr                 data received
+ * @param[in]      size                size of each item
+ * @param[in]      nmemb               number of items
+ * @param[in,out]  user_data           transfer receiving the data
+ *
+ * @return the number of bytes handled
+ */
+static size_t benchmark_write( char *ptr, size_t size, size_t nmemb,
+	void *user_data );
+
+OS_THREAD_DECL benchmark_server_run( void *arg )
+{
+	struct benchmark_server *const server = (struct benchmark_server *)arg;
+	struct benchmark_connection conn[ BENCHMARK_TRANSFERS_MAX ];
+	struct pollfd fds[ BENCHMARK_TRANSFERS_MAX + 1 ];
+	char chunk[ BENCHMARK_CHUNK_SIZE ];
+	int served = 0;
+	int i;
+
+	os_memset( chunk, 'x', sizeof( chunk ) );
+	for ( i = 0; i < BENCHMARK_TRANSFERS_MAX; ++i )
+		conn[i].fd = -1;
+
+	while ( served < server->expected )
+	{
+		nfds_t nfds = 0u;
+		fds[nfds].fd = server->fd;
+		fds[nfds].events = POLLIN;
+		++nfds;
+		for ( i = 0; i < BENCHMARK_TRANSFERS_MAX; ++i )
+		{
+			fds[nfds].fd = conn[i].fd;
+			fds[nfds].events =
+				conn[i].header_sent ? POLLOUT : POLLIN;
+			++nfds;
+		}
+
+		if ( poll( fds, nfds, BENCHMARK_WAIT_MS ) > 0 )
+		{
+			if ( fds[0].revents & POLLIN )
+			{
+				const int fd = accept( server->fd, NULL, NULL );
+				for ( i = 0; i < BENCHMARK_TRANSFERS_MAX &&
+					conn[i].fd >= 0; ++i ) {}
+				if ( fd >= 0 && i < BENCHMARK_TRANSFERS_MAX )
+				{
+					conn[i].fd = fd;
+					conn[i].header_sent = IOT_FALSE;
+					conn[i].remaining = server->body_size;
+				}
+				else if ( fd >= 0 )
+					close( fd );
+			}
+
+			for ( i = 0; i < BENCHMARK_TRANSFERS_MAX; ++i )
+			{
+				struct benchmark_connection *const c = &conn[i];
+				const short revents = fds[i + 1].revents;
+				if ( c->fd >= 0 && !c->header_sent &&
+					( revents & ( POLLIN | POLLHUP ) ) )
+				{
+					/* requests are small, one read is enough */
+					char req[ 1024u ];
+					char header[ 128u ];
+					if ( read( c->fd, req, sizeof( req ) ) > 0 )
+					{
+						const int len = os_snprintf( header,
+							sizeof( header ),
+							"HTTP/1.1 200 OK\r\n"
+							"Content-Length: %lu\r\n"
+							"Connection: close\r\n\r\n",
+							(unsigned long)c->remaining );
+						if ( write( c->fd, header,
+							(size_t)len ) == len )
+							c->header_sent = IOT_TRUE;
+					}
+					if ( !c->header_sent )
+					{
+						close( c->fd );
+						c->fd = -1;
+					}
+				}
+				else if ( c->fd >= 0 && ( revents & POLLOUT ) )
+				{
+					size_t len = c->remaining;
+					ssize_t sent;
+					if ( len > sizeof( chunk ) )
+						len = sizeof( chunk );
+					sent = write( c->fd, chunk, len );
+					if ( sent > 0 )
+						c->remaining -= (size_t)sent;
+					if ( sent <= 0 || c->remaining == 0u )
+					{
+						close( c->fd );
+						c->fd = -1;
+						++served;
+					}
+				}
+			}
+		}
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+iot_status_t benchmark_server_start( struct benchmark_server *server,
+	size_t body_size, int expected )
+{
+	iot_status_t result = IOT_STATUS_FAILURE;
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof( addr );
+
+	os_memzero( server, sizeof( struct benchmark_server ) );
+	os_memzero( &addr, sizeof( addr ) );
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+	addr.sin_port = 0u;
+	server->body_size = body_size;
+	server->expected = expected;
+	server->fd = socket( AF_INET, SOCK_STREAM, 0 );
+	if ( server->fd >= 0 &&
+		bind( server->fd, (struct sockaddr *)&addr, sizeof( addr ) ) == 0 &&
+		listen( server->fd, BENCHMARK_TRANSFERS_MAX ) == 0 &&
+		getsockname( server->fd, (struct sockaddr *)&addr,
+			&addr_len ) == 0 &&
+		os_thread_create( &server->thread, benchmark_server_run,
+			server, 0u ) == 0 )
+	{
+		server->port = ntohs( addr.sin_port );
+		result = IOT_STATUS_SUCCESS;
+	}
+	else if ( server->fd >= 0 )
+		close( server->fd );
+	return result;
+}
+
+double benchmark_time( void )
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+iot_status_t benchmark_transfer_threads(
+	struct benchmark_transfer *transfers, int count )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	os_thread_t threads[ BENCHMARK_TRANSFERS_MAX ];
+	int started = 0;
+
+	while ( started < count && result == IOT_STATUS_SUCCESS )
+	{
+		if ( os_thread_create( &threads[started],
+			benchmark_transfer_thread, &transfers[started], 0u ) == 0 )
+			++started;
+		else
+			result = IOT_STATUS_FAILURE;
+	}
+	while ( started > 0 )
+	{
+		--started;
+		os_thread_wait( &threads[started] );
+		os_thread_destroy( &threads[started] );
+	}
+	return result;
+}
+
+OS_THREAD_DECL benchmark_transfer_thread( void *arg )
+{
+	struct benchmark_transfer *const transfer =
+		(struct benchmark_transfer *)arg;
+	CURL *const curl = curl_easy_init();
+
+	transfer->result = CURLE_FAILED_INIT;
+	if ( curl )
+	{
+		curl_easy_setopt( curl, CURLOPT_URL, transfer->url );
+		curl_easy_setopt( curl, CURLOPT_NOSIGNAL, 1L );
+		curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, benchmark_write );
+		curl_easy_setopt( curl, CURLOPT_WRITEDATA, transfer );
+		transfer->result = curl_easy_perform( curl );
+		curl_easy_cleanup( curl );
+	}
+	return (OS_THREAD_RETURN)0;
+}
+
+iot_status_t benchmark_transfer_multi(
+	struct benchmark_transfer *transfers, int count )
+{
+	iot_status_t result = IOT_STATUS_FAILURE;
+	CURLM *const multi = curl_multi_init();
+	if ( multi )
+	{
+		CURL *handles[ BENCHMARK_TRANSFERS_MAX ];
+		int still_running = 0;
+		int i;
+
+		result = IOT_STATUS_SUCCESS;
+		for ( i = 0; i < count; ++i )
+		{
+			handles[i] = curl_easy_init();
+			transfers[i].result = CURLE_FAILED_INIT;
+			if ( handles[i] )
+			{
+				curl_easy_setopt( handles[i], CURLOPT_URL,
+					transfers[i].url );
+				curl_easy_setopt( handles[i], CURLOPT_NOSIGNAL, 1L );
+				curl_easy_setopt( handles[i], CURLOPT_WRITEFUNCTION,
+					benchmark_write );
+				curl_easy_setopt( handles[i], CURLOPT_WRITEDATA,
+					&transfers[i] );
+				curl_easy_setopt( handles[i], CURLOPT_PRIVATE,
+					&transfers[i] );
+				curl_multi_add_handle( multi, handles[i] );
+			}
+			else
+				result = IOT_STATUS_FAILURE;
+		}
+
+		do
+		{
+			const CURLMsg *msg;
+			int msgs_left = 0;
+
+			curl_multi_perform( multi, &still_running );
+			while ( ( msg = curl_multi_info_read( multi,
+				&msgs_left ) ) != NULL )
+			{
+				if ( msg->msg == CURLMSG_DONE )
+				{
+					char *priv = NULL;
+					curl_easy_getinfo( msg->easy_handle,
+						CURLINFO_PRIVATE, &priv );
+					if ( priv )
+						((struct benchmark_transfer *)
+							(void *)priv)->result =
+							msg->data.result;
+				}
+			}
+			if ( still_running > 0 )
+#if LIBCURL_VERSION_NUM >= 0x074400
+				curl_multi_poll( multi, NULL, 0u,
+					BENCHMARK_WAIT_MS, NULL );
+#else
+				curl_multi_wait( multi, NULL, 0u,
+					BENCHMARK_WAIT_MS, NULL );
+#endif /* LIBCURL_VERSION_NUM >= 0x074400 */
+		} while ( still_running > 0 );
+
+		for ( i = 0; i < count; ++i )
+		{
+			if ( handles[i] )
+			{
+				curl_multi_remove_handle( multi, handles[i] );
+				curl_easy_cleanup( handles[i] );
+			}
+		}
+		curl_multi_cleanup( multi );
+	}
+	return result;
+}
+
+size_t benchmark_write( char *UNUSED(ptr), size_t size, size_t nmemb,
+	void *user_data )
+{
+	struct benchmark_transfer *const transfer =
+		(struct benchmark_transfer *)user_data;
+	transfer->received += size * nmemb;
+	return size * nmemb;
+}
+
+int main( int argc, char *argv[] )
+{
+	struct benchmark_transfer transfers[ BENCHMARK_TRANSFERS_MAX ];
+	struct benchmark_server server;
+	char url[ 64u ];
+	const char *mode = "multi";
+	int count = BENCHMARK_TRANSFERS_DEFAULT;
+	int size_kb = BENCHMARK_SIZE_KB_DEFAULT;
+	int result = EXIT_FAILURE;
+
+	if ( argc > 1 )
+		mode = argv[1];
+	if ( argc > 2 )
+		count = atoi( argv[2] );
+	if ( argc > 3 )
+		size_kb = atoi( argv[3] );
+
+	if ( ( os_strcmp( mode, "multi" ) == 0 ||
+		os_strcmp( mode, "threads" ) == 0 ) &&
+		count > 0 && count <= BENCHMARK_TRANSFERS_MAX && size_kb > 0 &&
+		curl_global_init( CURL_GLOBAL_ALL ) == CURLE_OK )
+	{
+		const size_t body_size = (size_t)size_kb * 1024u;
+		if ( benchmark_server_start( &server, body_size,
+			count ) == IOT_STATUS_SUCCESS )
+		{
+			iot_status_t status;
+			struct rusage usage;
+			double start;
+			double elapsed;
+			size_t received = 0u;
+			int i;
+
+			os_snprintf( url, sizeof( url ), "http://127.0.0.1:%u/file",
+				(unsigned int)server.port );
+			os_memzero( transfers, sizeof( transfers ) );
+			for ( i = 0; i < count; ++i )
+				transfers[i].url = url;
+
+			start = benchmark_time();
+			if ( os_strcmp( mode, "threads" ) == 0 )
+				status = benchmark_transfer_threads( transfers, count );
+			else
+				status = benchmark_transfer_multi( transfers, count );
+			elapsed = benchmark_time() - start;
+
+			os_thread_wait( &server.thread );
+			os_thread_destroy( &server.thread );
+			close( server.fd );
+
+			if ( status == IOT_STATUS_SUCCESS )
+				result = EXIT_SUCCESS;
+			for ( i = 0; i < count; ++i )
+			{
+				received += transfers[i].received;
+				if ( transfers[i].result != CURLE_OK ||
+					transfers[i].received != body_size )
+					result = EXIT_FAILURE;
+			}
+
+			if ( result == EXIT_SUCCESS )
+			{
+				os_printf( "mode:         %s\n", mode );
+				os_printf( "transfers:    %d x %d kB\n",
+					count, size_kb );
+				os_printf( "elapsed:      %.3f ms\n", elapsed );
+				os_printf( "throughput:   %.1f MB/s\n",
+					(double)received / 1048576.0 /
+					( elapsed / 1000.0 ) );
+				if ( getrusage( RUSAGE_SELF, &usage ) == 0 )
+					os_printf( "peak rss:     %ld kB\n",
+						usage.ru_maxrss );
+			}
+			else
+				os_fprintf( OS_STDERR, "%s\n",
+					"failed to complete transfers" );
+		}
+		else
+			os_fprintf( OS_STDERR, "%s\n", "failed to start server" );
+		curl_global_cleanup();
+	}
+	else
+		os_fprintf( OS_STDERR, "usage: %s [multi|threads] "
+			"[transfers (1-%d)] [kB per transfer]\n", argv[0],
+			BENCHMARK_TRANSFERS_MAX );
+	return result;
+}
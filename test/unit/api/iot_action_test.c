@@ -243,6 +243,102 @@ static void test_iot_action_allocate_no_memory( void **state )
 	assert_null( result );
 }
 
+static void test_iot_action_concurrency_set_null_action( void **state )
+{
+	iot_status_t result;
+
+	result = iot_action_concurrency_set( NULL, 1u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_iot_action_concurrency_set_valid( void **state )
+{
+	iot_action_t action;
+	iot_status_t result;
+
+	memset( &action, 0, sizeof( iot_action_t ) );
+	result = iot_action_concurrency_set( &action, 4u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( action.max_running, 4u );
+}
+
+static void test_iot_action_deadline_check_expired( void **state )
+{
+	iot_t lib;
+	iot_status_t result;
+	char name[ IOT_NAME_MAX_LEN + 1u ];
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	strncpy( name, "action name", IOT_NAME_MAX_LEN );
+	lib.request_queue[0].lib = &lib;
+	lib.request_queue[0].name = name;
+	lib.request_queue[0].time_limit = 500u;
+	lib.request_queue[0].deadline = 1000u;
+	lib.request_queue[0].deadline_state = IOT_ACTION_DEADLINE_SCHEDULED;
+	lib.deadline_wheel[ ( 1000u / IOT_ACTION_DEADLINE_TICK ) &
+		( IOT_ACTION_DEADLINE_SLOTS - 1u ) ] = &lib.request_queue[0];
+	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
+	result = iot_action_deadline_check( &lib );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( lib.request_queue[0].cancelled, IOT_TRUE );
+	assert_int_equal( lib.request_queue[0].deadline_state,
+		IOT_ACTION_DEADLINE_EXPIRED );
+	assert_null( lib.deadline_wheel[ ( 1000u / IOT_ACTION_DEADLINE_TICK ) &
+		( IOT_ACTION_DEADLINE_SLOTS - 1u ) ] );
+}
+
+static void test_iot_action_deadline_check_not_expired( void **state )
+{
+	iot_t lib;
+	iot_status_t result;
+	const iot_timestamp_t deadline = iot_timestamp_monotonic() + 500u;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	lib.request_queue[0].lib = &lib;
+	lib.request_queue[0].deadline = deadline;
+	lib.request_queue[0].deadline_state = IOT_ACTION_DEADLINE_SCHEDULED;
+	lib.deadline_wheel[ ( deadline / IOT_ACTION_DEADLINE_TICK ) &
+		( IOT_ACTION_DEADLINE_SLOTS - 1u ) ] = &lib.request_queue[0];
+	result = iot_action_deadline_check( &lib );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( lib.request_queue[0].cancelled, IOT_FALSE );
+	assert_int_equal( lib.request_queue[0].deadline_state,
+		IOT_ACTION_DEADLINE_SCHEDULED );
+	assert_ptr_equal( lib.deadline_wheel[ ( deadline / IOT_ACTION_DEADLINE_TICK ) &
+		( IOT_ACTION_DEADLINE_SLOTS - 1u ) ], &lib.request_queue[0] );
+}
+
+static void test_iot_action_deadline_check_null_lib( void **state )
+{
+	iot_status_t result;
+	result = iot_action_deadline_check( NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_iot_action_deadline_next_empty( void **state )
+{
+	iot_t lib;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	assert_int_equal( iot_action_deadline_next( &lib ), 0u );
+	assert_int_equal( iot_action_deadline_next( NULL ), 0u );
+}
+
+static void test_iot_action_deadline_next_earliest( void **state )
+{
+	iot_t lib;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	lib.request_queue[0].deadline = 3000u;
+	lib.request_queue[1].deadline = 2000u;
+	lib.request_queue[0].deadline_next = &lib.request_queue[1];
+	lib.request_queue[2].deadline = 2500u;
+	lib.deadline_wheel[0] = &lib.request_queue[0];
+	lib.deadline_wheel[IOT_ACTION_DEADLINE_SLOTS - 1u] =
+		&lib.request_queue[2];
+	assert_int_equal( iot_action_deadline_next( &lib ), 2000u );
+}
+
 static void test_iot_action_deregister_deregistered( void **state )
 {
 	size_t i;
@@ -718,6 +814,83 @@ static void test_iot_action_free_transmit_fail( void **state )
 #endif
 }
 
+static void test_iot_action_group_set_full( void **state )
+{
+	size_t i;
+	iot_t lib;
+	iot_action_t action;
+	iot_status_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &action, 0, sizeof( iot_action_t ) );
+	action.lib = &lib;
+	for ( i = 0u; i < IOT_ACTION_GROUP_MAX; ++i )
+		snprintf( lib.action_group[i].name, IOT_NAME_MAX_LEN,
+			"group%u", (unsigned int)i );
+	lib.action_group_count = IOT_ACTION_GROUP_MAX;
+	result = iot_action_group_set( &action, "another", 1u );
+	assert_int_equal( result, IOT_STATUS_FULL );
+	assert_null( action.group );
+}
+
+static void test_iot_action_group_set_null_group( void **state )
+{
+	iot_t lib;
+	iot_action_t action;
+	iot_status_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &action, 0, sizeof( iot_action_t ) );
+	action.lib = &lib;
+	result = iot_action_group_set( &action, NULL, 1u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	assert_int_equal( lib.action_group_count, 0u );
+}
+
+static void test_iot_action_group_set_shared( void **state )
+{
+	iot_t lib;
+	iot_action_t action[2];
+	iot_status_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( action, 0, sizeof( action ) );
+	action[0].lib = &lib;
+	action[1].lib = &lib;
+	result = iot_action_group_set( &action[0], "updates", 1u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_action_group_set( &action[1], "updates", 2u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( lib.action_group_count, 1u );
+	assert_ptr_equal( action[0].group, &lib.action_group[0] );
+	assert_ptr_equal( action[1].group, &lib.action_group[0] );
+	assert_string_equal( lib.action_group[0].name, "updates" );
+	assert_int_equal( lib.action_group[0].max_running, 2u );
+}
+
+static void test_iot_action_group_set_running( void **state )
+{
+	iot_t lib;
+	iot_action_t action;
+	iot_status_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &action, 0, sizeof( iot_action_t ) );
+	action.lib = &lib;
+	result = iot_action_group_set( &action, "first", 2u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	action.running = 2u;
+	lib.action_group[0].running = 3u;
+
+	/* running requests move with the action to the new group */
+	result = iot_action_group_set( &action, "second", 4u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_ptr_equal( action.group, &lib.action_group[1] );
+	assert_int_equal( lib.action_group[0].running, 1u );
+	assert_int_equal( lib.action_group[1].running, 2u );
+	assert_int_equal( lib.action_group[1].max_running, 4u );
+}
+
 static void test_iot_action_option_get_not_there( void **state )
 {
 	iot_action_t action;
@@ -1682,18 +1855,10 @@ static void test_iot_action_parameter_set_long_name( void **state )
 	test_generate_random_string( param_name, IOT_NAME_MAX_LEN + 2u );
 #ifdef IOT_STACK_ONLY
 	request.parameter = request._parameter;
-#else
-	will_return( __wrap_os_realloc, 1u );
-	will_return( __wrap_os_malloc, 1u );
-#endif /* ifndef IOT_STACK_ONLY */
+#endif /* ifdef IOT_STACK_ONLY */
 	result = iot_action_parameter_set( &request, param_name, IOT_TYPE_UINT16, 13u );
 	assert_int_equal( result, IOT_STATUS_SUCCESS );
 	assert_int_equal( request.parameter_count, 1u );
-
-#ifndef IOT_STACK_ONLY
-	os_free( request.parameter[0].name );
-	os_free( request.parameter );
-#endif /* ifndef IOT_STACK_ONLY */
 }
 
 static void test_iot_action_parameter_set_invalid_name( void **state )
@@ -1790,7 +1955,6 @@ static void test_iot_action_parameter_set_new_parameter( void **state )
 	}
 
 	will_return( __wrap_os_realloc, 1 );
-	will_return( __wrap_os_malloc, 1 );
 #endif
 	strncpy( request.parameter[0].name, "param1", IOT_NAME_MAX_LEN );
 	strncpy( request.parameter[1].name, "param2", IOT_NAME_MAX_LEN );
@@ -1803,7 +1967,8 @@ static void test_iot_action_parameter_set_new_parameter( void **state )
 
 	/* clean up */
 #ifndef IOT_STACK_ONLY
-	for ( i = 0u; i < request.parameter_count; ++i )
+	/* new parameter name is held in the request */
+	for ( i = 0u; i < request.parameter_count - 1u; ++i )
 		os_free( request.parameter[i].name );
 	os_free( request.parameter );
 #endif
@@ -1818,8 +1983,9 @@ static void test_iot_action_parameter_set_no_memory( void **state )
 	memset( &request, 0, sizeof( iot_action_request_t ) );
 	test_generate_random_string( param_name, IOT_NAME_MAX_LEN + 2u );
 #ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1u );
-	will_return( __wrap_os_malloc, 0u );
+	request.arena_used = IOT_ACTION_REQUEST_ARENA_SIZE;
+	will_return( __wrap_os_malloc, 1u ); /* parameter array */
+	will_return( __wrap_os_malloc, 0u ); /* parameter name */
 #endif /* ifndef IOT_STACK_ONLY */
 	result = iot_action_parameter_set( &request, param_name, IOT_TYPE_UINT16, 13u );
 
@@ -1829,6 +1995,10 @@ static void test_iot_action_parameter_set_no_memory( void **state )
 	assert_int_equal( result, IOT_STATUS_NO_MEMORY );
 #endif /* ifdef IOT_STACK_ONLY */
 	assert_int_equal( request.parameter_count, 0u );
+
+#ifndef IOT_STACK_ONLY
+	os_free( request.parameter );
+#endif /* ifndef IOT_STACK_ONLY */
 }
 
 static void test_iot_action_parameter_set_null_name( void **state )
@@ -2058,9 +2228,7 @@ static void test_iot_action_parameter_set_raw_new_parameter( void **state )
 	}
 
 #ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 );
-	will_return( __wrap_os_malloc, 1 );
-	will_return( __wrap_os_realloc, 1 );
+	will_return( __wrap_os_realloc, 1 ); /* parameter array */
 #endif
 	result = iot_action_parameter_set_raw( &request, "param", 10u,
 		(const void *)data );
@@ -2078,7 +2246,8 @@ static void test_iot_action_parameter_set_raw_new_parameter( void **state )
 
 	/* clean up */
 #ifndef IOT_STACK_ONLY
-	for ( i = 0u; i < request.parameter_count; ++i )
+	/* new parameter name is held in the request */
+	for ( i = 0u; i < 2u; ++i )
 	{
 		os_free( request.parameter[i].name );
 		if ( request.parameter[i].data.heap_storage )
@@ -2194,9 +2363,6 @@ static void test_iot_action_parameter_set_raw_type_null( void **state )
 	request.parameter[1].data.has_value = IOT_FALSE;
 	request.parameter[1].data.type = IOT_TYPE_NULL;
 
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 );
-#endif
 	result = iot_action_parameter_set_raw( &request, "param2", 10u, (const void *)data );
 	assert_int_equal( request.parameter_count, 2u );
 #ifdef IOT_STACK_ONLY
@@ -2288,9 +2454,6 @@ static void test_iot_action_parameter_set_raw_valid( void **state )
 	request.parameter[1].data.has_value = IOT_FALSE;
 	request.parameter[1].data.type = IOT_TYPE_RAW;
 
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 );
-#endif
 	result = iot_action_parameter_set_raw( &request, "param2", 10u, (const void *)data );
 	assert_int_equal( request.parameter_count, 2u );
 #ifdef IOT_STACK_ONLY
@@ -2592,15 +2755,10 @@ static void test_iot_action_process_command_parameter_bool( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -2712,15 +2870,10 @@ static void test_iot_action_process_command_parameter_float( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -2846,15 +2999,10 @@ static void test_iot_action_process_command_parameter_int( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -2976,15 +3124,10 @@ static void test_iot_action_process_command_parameter_location( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -3091,15 +3234,10 @@ static void test_iot_action_process_command_parameter_null( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -3225,15 +3363,10 @@ static void test_iot_action_process_command_parameter_raw( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -3360,15 +3493,10 @@ static void test_iot_action_process_command_parameter_string( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 1000u );
@@ -3503,15 +3631,10 @@ static void test_iot_action_process_command_parameter_string_max_len( void **sta
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 1000u );
@@ -3640,15 +3763,10 @@ static void test_iot_action_process_command_parameter_uint( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -3719,15 +3837,10 @@ static void test_iot_action_process_command_script_return_fail( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -3856,15 +3969,10 @@ static void test_iot_action_process_command_valid( void **state )
 #ifndef IOT_STACK_ONLY
 	/* add parameter: retval */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
 	/* add parameter: stdout */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 	/* add parameter: stderr */
 	will_return( __wrap_os_realloc, 1 ); /* increase parameter array */
-	will_return( __wrap_os_malloc, 1 ); /* space to hold name */
-	will_return( __wrap_os_realloc, 1 ); /* copy string value */
 #endif
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
 	result = iot_action_process( &lib, 0u );
@@ -3934,6 +4042,62 @@ static void test_iot_action_process_exclusive( void **state )
 #endif
 }
 
+static void test_iot_action_process_exclusive_waits( void **state )
+{
+	size_t i;
+	iot_t lib;
+	iot_status_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	for ( i = 0u; i < IOT_ACTION_STACK_MAX; ++i )
+	{
+#ifdef IOT_STACK_ONLY
+		lib.action[i].name = lib.action[i]._name;
+#else
+		will_return( __wrap_os_malloc, 1 );
+		lib.action[i].name = os_malloc( IOT_NAME_MAX_LEN + 1u );
+#endif
+		lib.action_ptr[i] = &lib.action[i];
+	}
+	lib.action_count = 2u;
+	strncpy( lib.action_ptr[0]->name, "exclusive", IOT_NAME_MAX_LEN );
+	lib.action_ptr[0]->lib = &lib;
+	lib.action_ptr[0]->callback = &test_callback_func;
+	lib.action_ptr[0]->flags = IOT_ACTION_EXCLUSIVE_APP;
+	strncpy( lib.action_ptr[1]->name, "other", IOT_NAME_MAX_LEN );
+	lib.action_ptr[1]->lib = &lib;
+	lib.action_ptr[1]->callback = &test_callback_func;
+	lib.action_running = 1u; /* another request is running */
+	for ( i = 0u; i < 2u; ++i )
+	{
+		lib.request_queue[i].lib = &lib;
+#ifdef IOT_STACK_ONLY
+		lib.request_queue[i].name = lib.request_queue[i]._name;
+#else
+		will_return( __wrap_os_malloc, 1 );
+		lib.request_queue[i].name = os_malloc( IOT_NAME_MAX_LEN + 1u );
+#endif
+		lib.request_queue_wait[i] = &lib.request_queue[i];
+	}
+	strncpy( lib.request_queue[0].name, "exclusive", IOT_NAME_MAX_LEN );
+	strncpy( lib.request_queue[1].name, "other", IOT_NAME_MAX_LEN );
+	lib.request_queue_wait_count = 2u;
+
+	/* request after the exclusive one must not start before it */
+	result = iot_action_process( &lib, 0u );
+	assert_int_equal( result, IOT_STATUS_NOT_FOUND );
+	assert_int_equal( lib.request_queue_wait_count, 2u );
+	assert_int_equal( lib.action_running, 1u );
+
+	/* clean up */
+#ifndef IOT_STACK_ONLY
+	for ( i = 0u; i < 2u; ++i )
+		os_free( lib.request_queue[i].name );
+	for ( i = 0u; i < IOT_ACTION_STACK_MAX; ++i )
+		os_free( lib.action[i].name );
+#endif
+}
+
 static void test_iot_action_process_lib_to_quit( void **state )
 {
 	size_t i;
@@ -3985,6 +4149,70 @@ static void test_iot_action_process_lib_to_quit( void **state )
 #endif
 }
 
+static void test_iot_action_process_limit_reached( void **state )
+{
+	size_t i;
+	iot_t lib;
+	iot_status_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	for ( i = 0u; i < IOT_ACTION_STACK_MAX; ++i )
+	{
+#ifdef IOT_STACK_ONLY
+		lib.action[i].name = lib.action[i]._name;
+#else
+		will_return( __wrap_os_malloc, 1 );
+		lib.action[i].name = os_malloc( IOT_NAME_MAX_LEN + 1u );
+#endif
+		lib.action_ptr[i] = &lib.action[i];
+	}
+	lib.action_count = 2u;
+	strncpy( lib.action_ptr[0]->name, "busy", IOT_NAME_MAX_LEN );
+	lib.action_ptr[0]->lib = &lib;
+	lib.action_ptr[0]->callback = &test_callback_func;
+	lib.action_ptr[0]->max_running = 1u;
+	lib.action_ptr[0]->running = 1u;
+	strncpy( lib.action_ptr[1]->name, "other", IOT_NAME_MAX_LEN );
+	lib.action_ptr[1]->lib = &lib;
+	lib.action_ptr[1]->callback = &test_callback_func;
+	lib.action_running = 1u;
+	for ( i = 0u; i < 2u; ++i )
+	{
+		lib.request_queue[i].lib = &lib;
+#ifdef IOT_STACK_ONLY
+		lib.request_queue[i].name = lib.request_queue[i]._name;
+#else
+		will_return( __wrap_os_malloc, 1 );
+		lib.request_queue[i].name = os_malloc( IOT_NAME_MAX_LEN + 1u );
+#endif
+		lib.request_queue_wait[i] = &lib.request_queue[i];
+	}
+	for ( i = 2u; i < IOT_ACTION_QUEUE_MAX; ++i )
+		lib.request_queue_free[i] = &lib.request_queue[i];
+	strncpy( lib.request_queue[0].name, "busy", IOT_NAME_MAX_LEN );
+	strncpy( lib.request_queue[1].name, "other", IOT_NAME_MAX_LEN );
+	lib.request_queue_wait_count = 2u;
+	lib.request_queue_free_count = 2u;
+
+	/* request for the other action runs while "busy" is at its limit */
+	will_return( test_callback_func, IOT_STATUS_SUCCESS );
+	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
+	result = iot_action_process( &lib, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( lib.request_queue_wait_count, 1u );
+	assert_ptr_equal( lib.request_queue_wait[0], &lib.request_queue[0] );
+	assert_int_equal( lib.action_ptr[0]->running, 1u );
+	assert_int_equal( lib.action_ptr[1]->running, 0u );
+	assert_int_equal( lib.action_running, 1u );
+
+	/* clean up */
+#ifndef IOT_STACK_ONLY
+	os_free( lib.request_queue[0].name );
+	for ( i = 0u; i < IOT_ACTION_STACK_MAX; ++i )
+		os_free( lib.action[i].name );
+#endif
+}
+
 static void test_iot_action_process_no_handler( void **state )
 {
 	size_t i;
@@ -5065,16 +5293,9 @@ static void test_iot_action_request_allocate_long_name_and_source( void **state
 	iot_lib.request_queue_free[0u] = &req;
 	test_generate_random_string( action_name, IOT_NAME_MAX_LEN + 2u );
 	test_generate_random_string( source_name, IOT_ID_MAX_LEN + 2u);
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_malloc, 1 ); /* for names */
-#endif
 	result = iot_action_request_allocate( &iot_lib, action_name, source_name );
 	assert_non_null( result );
 	assert_ptr_equal( result, &req );
-
-#ifndef IOT_STACK_ONLY
-	os_free( result->name );
-#endif
 }
 
 static void test_iot_action_request_allocate_no_free_slots( void **state )
@@ -5089,24 +5310,20 @@ static void test_iot_action_request_allocate_no_free_slots( void **state )
 	assert_null( result );
 }
 
-static void test_iot_action_request_allocate_no_memory( void **state )
+static void test_iot_action_request_allocate_no_heap( void **state )
 {
 	struct iot iot_lib;
 	struct iot_action_request *result;
 	struct iot_action_request req;
 	memset( &iot_lib, 0, sizeof( struct iot ) );
 	iot_lib.request_queue_free[0u] = &req;
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_malloc, 0 ); /* for names */
-#endif
+	/* names are held in the request, so no heap memory is used */
 	result = iot_action_request_allocate( &iot_lib, "my_action", "fake_source" );
 
-#ifdef IOT_STACK_ONLY
 	assert_non_null( result );
 	assert_ptr_equal( result, &req );
-#else
-	assert_null( result );
-#endif
+	assert_string_equal( result->name, "my_action" );
+	assert_string_equal( result->source, "fake_source" );
 }
 
 static void test_iot_action_request_allocate_valid( void **state )
@@ -5116,19 +5333,79 @@ static void test_iot_action_request_allocate_valid( void **state )
 	struct iot_action_request req;
 	memset( &iot_lib, 0, sizeof( struct iot ) );
 	iot_lib.request_queue_free[0u] = &req;
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_malloc, 1 ); /* for names */
-#endif
 	result = iot_action_request_allocate( &iot_lib, "my_action", NULL );
 
 	assert_non_null( result );
 	assert_ptr_equal( result, &req );
 #ifndef IOT_STACK_ONLY
 	assert_null( result->source );
-	os_free( result->name );
+	assert_ptr_equal( result->name, req.arena.buf );
 #endif
 }
 
+static void test_iot_action_request_cancelled_deadline( void **state )
+{
+	iot_t lib;
+	struct iot_action_request req;
+	iot_bool_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &req, 0, sizeof( struct iot_action_request ) );
+	req.lib = &lib;
+	req.deadline = iot_timestamp_monotonic();
+	result = iot_action_request_cancelled( &req );
+	assert_int_equal( result, IOT_TRUE );
+}
+
+static void test_iot_action_request_cancelled_false( void **state )
+{
+	iot_t lib;
+	struct iot_action_request req;
+	iot_bool_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &req, 0, sizeof( struct iot_action_request ) );
+	req.lib = &lib;
+	req.deadline = iot_timestamp_monotonic() + 500u;
+	result = iot_action_request_cancelled( &req );
+	assert_int_equal( result, IOT_FALSE );
+}
+
+static void test_iot_action_request_cancelled_null_request( void **state )
+{
+	iot_bool_t result;
+	result = iot_action_request_cancelled( NULL );
+	assert_int_equal( result, IOT_TRUE );
+}
+
+static void test_iot_action_request_cancelled_quit( void **state )
+{
+	iot_t lib;
+	struct iot_action_request req;
+	iot_bool_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &req, 0, sizeof( struct iot_action_request ) );
+	req.lib = &lib;
+	lib.to_quit = IOT_TRUE;
+	result = iot_action_request_cancelled( &req );
+	assert_int_equal( result, IOT_TRUE );
+}
+
+static void test_iot_action_request_cancelled_set( void **state )
+{
+	iot_t lib;
+	struct iot_action_request req;
+	iot_bool_t result;
+
+	memset( &lib, 0, sizeof( iot_t ) );
+	memset( &req, 0, sizeof( struct iot_action_request ) );
+	req.lib = &lib;
+	req.cancelled = IOT_TRUE;
+	result = iot_action_request_cancelled( &req );
+	assert_int_equal( result, IOT_TRUE );
+}
+
 static void test_iot_action_request_option_get_not_found( void **state )
 {
 	struct iot_action_request req;
@@ -5266,7 +5543,8 @@ static void test_iot_action_request_option_set_no_memory_array( void **state )
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 #ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 0 );  /* for option array */
+	req.arena_used = IOT_ACTION_REQUEST_ARENA_SIZE;
+	will_return( __wrap_os_malloc, 0 );  /* for option array */
 #endif
 	result = iot_action_request_option_set( &req, "blah",
 		IOT_TYPE_BOOL, IOT_TRUE );
@@ -5286,7 +5564,8 @@ static void test_iot_action_request_option_set_no_memory_name( void **state )
 #ifdef IOT_STACK_ONLY
 	req.option = req._option;
 #else
-	will_return( __wrap_os_realloc, 1 );  /* for option array */
+	req.arena_used = IOT_ACTION_REQUEST_ARENA_SIZE;
+	will_return( __wrap_os_malloc, 1 );  /* for option array */
 	will_return( __wrap_os_malloc, 0 );  /* for option name */
 #endif
 	result = iot_action_request_option_set( &req, "blah",
@@ -5316,9 +5595,6 @@ static void test_iot_action_request_option_set_valid( void **state )
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 #ifdef IOT_STACK_ONLY
 	req.option = req._option;
-#else
-	will_return( __wrap_os_realloc, 1 );  /* for option array */
-	will_return( __wrap_os_malloc, 1 );  /* for option name */
 #endif
 
 	result = iot_action_request_option_set( &req, "blah",
@@ -5330,12 +5606,6 @@ static void test_iot_action_request_option_set_valid( void **state )
 	assert_int_equal( req.option[0u].data.has_value, IOT_TRUE );
 	assert_int_equal( req.option[0u].data.type, IOT_TYPE_BOOL );
 	assert_int_equal( req.option[0u].data.value.boolean, IOT_TRUE  );
-
-	/* clean up */
-#ifndef IOT_STACK_ONLY
-	os_free( req.option[0u].name );
-	os_free( req.option );
-#endif
 }
 
 static void test_iot_action_request_option_set_valid_long_name( void **state )
@@ -5347,9 +5617,6 @@ static void test_iot_action_request_option_set_valid_long_name( void **state )
 	test_generate_random_string( option_name, IOT_NAME_MAX_LEN + 2u );
 #ifdef IOT_STACK_ONLY
 	req.option = req._option;
-#else
-	will_return( __wrap_os_realloc, 1 );  /* for option array */
-	will_return( __wrap_os_malloc, 1 );  /* for option name */
 #endif
 	result = iot_action_request_option_set( &req, option_name,
 		IOT_TYPE_BOOL, IOT_TRUE );
@@ -5361,12 +5628,6 @@ static void test_iot_action_request_option_set_valid_long_name( void **state )
 	assert_int_equal( req.option[0u].data.has_value, IOT_TRUE );
 	assert_int_equal( req.option[0u].data.type, IOT_TYPE_BOOL );
 	assert_int_equal( req.option[0u].data.value.boolean, IOT_TRUE  );
-
-	/* clean up */
-#ifndef IOT_STACK_ONLY
-	os_free( req.option[0u].name );
-	os_free( req.option );
-#endif
 }
 
 static void test_iot_action_request_option_set_overwrite( void **state )
@@ -5376,9 +5637,6 @@ static void test_iot_action_request_option_set_overwrite( void **state )
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 #ifdef IOT_STACK_ONLY
 	req.option = req._option;
-#else
-	will_return( __wrap_os_realloc, 1 ); /* for option array */
-	will_return( __wrap_os_malloc, 1 );  /* for option name */
 #endif
 	result = iot_action_request_option_set( &req, "blah",
 		IOT_TYPE_BOOL, IOT_TRUE );
@@ -5400,12 +5658,6 @@ static void test_iot_action_request_option_set_overwrite( void **state )
 	assert_int_equal( req.option[0u].data.has_value, IOT_TRUE );
 	assert_int_equal( req.option[0u].data.type, IOT_TYPE_BOOL );
 	assert_int_equal( req.option[0u].data.value.boolean, IOT_FALSE  );
-
-	/* clean up */
-#ifndef IOT_STACK_ONLY
-	os_free( req.option[0u].name );
-	os_free( req.option );
-#endif
 }
 
 static void test_iot_action_request_option_set_raw_bad_req( void **state )
@@ -5430,11 +5682,19 @@ static void test_iot_action_request_option_set_raw_no_memory_data( void **state
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 #ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 0 ); /* for raw data */
+	req.arena_used = IOT_ACTION_REQUEST_ARENA_SIZE;
+	will_return( __wrap_os_malloc, 1 ); /* for option array */
+	will_return( __wrap_os_malloc, 1 ); /* for option name */
+	will_return( __wrap_os_malloc, 0 ); /* for raw data */
 #endif
 	result = iot_action_request_option_set_raw( &req, "blah", 5u, "test" );
 	assert_int_equal( result, IOT_STATUS_NO_MEMORY );
 	assert_int_equal( req.option_count, 0u );
+
+	/* clean up */
+#ifndef IOT_STACK_ONLY
+	os_free( req.option );
+#endif
 }
 
 static void test_iot_action_request_option_set_raw_no_memory_array( void **state )
@@ -5443,8 +5703,8 @@ static void test_iot_action_request_option_set_raw_no_memory_array( void **state
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 #ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 ); /* for raw data */
-	will_return( __wrap_os_realloc, 0 );  /* for option array */
+	req.arena_used = IOT_ACTION_REQUEST_ARENA_SIZE;
+	will_return( __wrap_os_malloc, 0 );  /* for option array */
 #endif
 	result = iot_action_request_option_set_raw( &req, "blah", 5u, "test" );
 	assert_int_equal( result, IOT_STATUS_NO_MEMORY );
@@ -5457,8 +5717,8 @@ static void test_iot_action_request_option_set_raw_no_memory_name( void **state
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 #ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 ); /* for raw data */
-	will_return( __wrap_os_realloc, 1 );  /* for option array */
+	req.arena_used = IOT_ACTION_REQUEST_ARENA_SIZE;
+	will_return( __wrap_os_malloc, 1 );  /* for option array */
 	will_return( __wrap_os_malloc, 0 );  /* for option name */
 #endif
 	result = iot_action_request_option_set_raw( &req, "blah", 5u, "test" );
@@ -5476,11 +5736,6 @@ static void test_iot_action_request_option_set_raw_valid( void **state )
 	iot_status_t result;
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 ); /* for raw data */
-	will_return( __wrap_os_realloc, 1 );  /* for option array */
-	will_return( __wrap_os_malloc, 1 );  /* for option name */
-#endif
 
 	result = iot_action_request_option_set_raw( &req, "blah", 5u, "test" );
 
@@ -5496,15 +5751,7 @@ static void test_iot_action_request_option_set_raw_valid( void **state )
 	assert_int_equal( req.option[0u].data.value.raw.length, 5u );
 	assert_string_equal( req.option[0u].data.value.raw.ptr,
 		(const char*)"test" );
-	assert_ptr_equal( req.option[0u].data.value.raw.ptr,
-		req.option[0u].data.heap_storage );
-#endif
-
-	/* clean up */
-#ifndef IOT_STACK_ONLY
-	os_free( req.option[0u].data.heap_storage );
-	os_free( req.option[0u].name );
-	os_free( req.option );
+	assert_null( req.option[0u].data.heap_storage );
 #endif
 }
 
@@ -5515,11 +5762,6 @@ static void test_iot_action_request_option_set_raw_valid_long_name( void **state
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
 	test_generate_random_string( option_name, IOT_NAME_MAX_LEN + 2u );
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 ); /* for raw data */
-	will_return( __wrap_os_realloc, 1 );  /* for option array */
-	will_return( __wrap_os_malloc, 1 );  /* for option name */
-#endif
 	result = iot_action_request_option_set_raw( &req, option_name, 5u, "test" );
 
 #ifdef IOT_STACK_ONLY
@@ -5535,13 +5777,6 @@ static void test_iot_action_request_option_set_raw_valid_long_name( void **state
 	assert_int_equal( req.option[0u].data.value.raw.length, 5u );
 	assert_string_equal( req.option[0u].data.value.raw.ptr, (const char*)"test" );
 #endif
-
-	/* clean up */
-#ifndef IOT_STACK_ONLY
-	os_free( req.option[0u].data.heap_storage );
-	os_free( req.option[0u].name );
-	os_free( req.option );
-#endif
 }
 
 static void test_iot_action_request_option_set_raw_overwrite( void **state )
@@ -5549,11 +5784,6 @@ static void test_iot_action_request_option_set_raw_overwrite( void **state )
 	iot_status_t result;
 	struct iot_action_request req;
 	memset( &req, 0, sizeof( struct iot_action_request ) );
-#ifndef IOT_STACK_ONLY
-	will_return( __wrap_os_realloc, 1 ); /* for option array */
-	will_return( __wrap_os_malloc, 1 );  /* for option name */
-	will_return( __wrap_os_realloc, 1 );  /* for raw data */
-#endif
 	result = iot_action_request_option_set_raw( &req, "blah", 5u, "test" );
 
 #ifdef IOT_STACK_ONLY
@@ -5567,8 +5797,6 @@ static void test_iot_action_request_option_set_raw_overwrite( void **state )
 	assert_int_equal( req.option[0u].data.type, IOT_TYPE_RAW );
 	assert_int_equal( req.option[0u].data.value.raw.length, 5u );
 	assert_string_equal( req.option[0u].data.value.raw.ptr, (const char*)"test" );
-
-	will_return( __wrap_os_realloc, 1 );  /* for raw data */
 #endif
 	result = iot_action_request_option_set_raw( &req, "blah", 5u, "FAKE" );
 
@@ -5584,13 +5812,6 @@ static void test_iot_action_request_option_set_raw_overwrite( void **state )
 	assert_int_equal( req.option[0u].data.value.raw.length, 5u );
 	assert_string_equal( req.option[0u].data.value.raw.ptr, (const char*)"FAKE" );
 #endif
-
-	/* clean up */
-#ifndef IOT_STACK_ONLY
-	os_free( req.option[0u].data.heap_storage );
-	os_free( req.option[0u].name );
-	os_free( req.option );
-#endif
 }
 
 static void test_iot_action_request_copy_raw( void **state )
@@ -6598,6 +6819,57 @@ static void test_iot_action_request_parameter_set_no_memory_name( void **state )
 #endif
 }
 
+static void test_iot_action_request_parameter_set_reuse( void **state )
+{
+	struct iot_action_request req;
+	iot_status_t result;
+	const char *value = NULL;
+#ifndef IOT_STACK_ONLY
+	const char *storage;
+	size_t arena_used;
+#endif /* ifndef IOT_STACK_ONLY */
+
+	memset( &req, 0, sizeof( struct iot_action_request ) );
+#ifdef IOT_STACK_ONLY
+	req.parameter = req._parameter;
+#endif /* ifdef IOT_STACK_ONLY */
+	result = iot_action_request_parameter_set( &req,
+		"param_name", IOT_TYPE_STRING, "first value" );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+#ifndef IOT_STACK_ONLY
+	storage = req.parameter[0].data.value.string;
+	arena_used = req.arena_used;
+#endif /* ifndef IOT_STACK_ONLY */
+
+	/* shorter value reuses the storage of the old one */
+	result = iot_action_request_parameter_set( &req,
+		"param_name", IOT_TYPE_STRING, "second" );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_action_parameter_get( &req,
+		"param_name", IOT_FALSE, IOT_TYPE_STRING, &value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( value, "second" );
+#ifndef IOT_STACK_ONLY
+	assert_ptr_equal( req.parameter[0].data.value.string, storage );
+	assert_int_equal( req.arena_used, arena_used );
+#endif /* ifndef IOT_STACK_ONLY */
+
+	/* longer value grows the most recent allocation in place */
+	result = iot_action_request_parameter_set( &req,
+		"param_name", IOT_TYPE_STRING,
+		"a third value, longer than the first" );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_action_parameter_get( &req,
+		"param_name", IOT_FALSE, IOT_TYPE_STRING, &value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( value, "a third value, longer than the first" );
+	assert_int_equal( req.parameter_count, 1u );
+#ifndef IOT_STACK_ONLY
+	assert_ptr_equal( req.parameter[0].data.value.string, storage );
+	assert_null( req.parameter[0].data.heap_storage );
+#endif /* ifndef IOT_STACK_ONLY */
+}
+
 static void test_iot_action_request_source_bad_req( void **state )
 {
 	const char *result;
@@ -6740,6 +7012,13 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_iot_action_allocate_stack_full ),
 		cmocka_unit_test( test_iot_action_allocate_null_lib ),
 		cmocka_unit_test( test_iot_action_allocate_no_memory ),
+		cmocka_unit_test( test_iot_action_concurrency_set_null_action ),
+		cmocka_unit_test( test_iot_action_concurrency_set_valid ),
+		cmocka_unit_test( test_iot_action_deadline_check_expired ),
+		cmocka_unit_test( test_iot_action_deadline_check_not_expired ),
+		cmocka_unit_test( test_iot_action_deadline_check_null_lib ),
+		cmocka_unit_test( test_iot_action_deadline_next_earliest ),
+		cmocka_unit_test( test_iot_action_deadline_next_empty ),
 		cmocka_unit_test( test_iot_action_deregister_deregistered ),
 		cmocka_unit_test( test_iot_action_deregister_null_action ),
 		cmocka_unit_test( test_iot_action_deregister_null_lib ),
@@ -6753,6 +7032,10 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_iot_action_free_null_handle ),
 		cmocka_unit_test( test_iot_action_free_parameters ),
 		cmocka_unit_test( test_iot_action_free_transmit_fail ),
+		cmocka_unit_test( test_iot_action_group_set_full ),
+		cmocka_unit_test( test_iot_action_group_set_null_group ),
+		cmocka_unit_test( test_iot_action_group_set_running ),
+		cmocka_unit_test( test_iot_action_group_set_shared ),
 		cmocka_unit_test( test_iot_action_option_get_not_there ),
 		cmocka_unit_test( test_iot_action_option_get_null_action ),
 		cmocka_unit_test( test_iot_action_option_get_null_name ),
@@ -6818,7 +7101,9 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_iot_action_process_command_system_run_fail ),
 		cmocka_unit_test( test_iot_action_process_command_valid ),
 		cmocka_unit_test( test_iot_action_process_exclusive ),
+		cmocka_unit_test( test_iot_action_process_exclusive_waits ),
 		cmocka_unit_test( test_iot_action_process_lib_to_quit ),
+		cmocka_unit_test( test_iot_action_process_limit_reached ),
 		cmocka_unit_test( test_iot_action_process_no_handler ),
 		cmocka_unit_test( test_iot_action_process_null_lib ),
 		cmocka_unit_test( test_iot_action_process_options ),
@@ -6844,8 +7129,13 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_iot_action_request_allocate_bad_name ),
 		cmocka_unit_test( test_iot_action_request_allocate_long_name_and_source ),
 		cmocka_unit_test( test_iot_action_request_allocate_no_free_slots ),
-		cmocka_unit_test( test_iot_action_request_allocate_no_memory ),
+		cmocka_unit_test( test_iot_action_request_allocate_no_heap ),
 		cmocka_unit_test( test_iot_action_request_allocate_valid ),
+		cmocka_unit_test( test_iot_action_request_cancelled_deadline ),
+		cmocka_unit_test( test_iot_action_request_cancelled_false ),
+		cmocka_unit_test( test_iot_action_request_cancelled_null_request ),
+		cmocka_unit_test( test_iot_action_request_cancelled_quit ),
+		cmocka_unit_test( test_iot_action_request_cancelled_set ),
 		cmocka_unit_test( test_iot_action_request_option_get_not_found ),
 		cmocka_unit_test( test_iot_action_request_option_get_null_name ),
 		cmocka_unit_test( test_iot_action_request_option_get_null_req ),
@@ -6903,6 +7193,7 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_iot_action_request_parameter_set_bad_type ),
 		cmocka_unit_test( test_iot_action_request_parameter_set_no_memory_array ),
 		cmocka_unit_test( test_iot_action_request_parameter_set_no_memory_name ),
+		cmocka_unit_test( test_iot_action_request_parameter_set_reuse ),
 		cmocka_unit_test( test_iot_action_request_source_bad_req ),
 		cmocka_unit_test( test_iot_action_request_source_no_source_set ),
 		cmocka_unit_test( test_iot_action_request_source_valid_source ),
@@ -1262,16 +1262,12 @@ static void test_iot_connect_configuration_fail_to_parse( void **state )
 	/* iot-connect.cfg */
 	will_return( __wrap_os_file_exists, OS_TRUE );
 	will_return( __wrap_os_file_open, 1u );
-#ifdef IOT_STACK_ONLY
-	will_return( __wrap_os_file_read, 1u );
-#else
-	will_return_count( __wrap_os_realloc, 1u, 3u );
+	will_return( __wrap_iot_json_stream_initialize, 0x1 );
 	will_return_count( __wrap_os_file_read, 1u, 2u );
-#endif
 	will_return( __wrap_os_file_read, 0u );
 	will_return( __wrap_os_file_eof, OS_TRUE );
 	/* fail to parse configuration file */
-	will_return( __wrap_iot_json_decode_initialize, 0 );
+	will_return( __wrap_iot_json_stream_finish, IOT_STATUS_PARSE_ERROR );
 
 	result = iot_connect( &lib, 0u );
 	assert_int_equal( result, IOT_STATUS_PARSE_ERROR );
@@ -1308,12 +1304,8 @@ static void test_iot_connect_configuration_fail_to_read( void **state )
 	/* app_id.cfg */
 	will_return( __wrap_os_file_exists, OS_TRUE );
 	will_return( __wrap_os_file_open, 1u );
-#ifdef IOT_STACK_ONLY
-	will_return( __wrap_os_file_read, 1u );
-#else
-	will_return_count( __wrap_os_realloc, 1u, 3u );
+	will_return( __wrap_iot_json_stream_initialize, 0x1 );
 	will_return_count( __wrap_os_file_read, 1u, 2u );
-#endif
 	will_return( __wrap_os_file_read, 0u );
 	will_return( __wrap_os_file_eof, OS_FALSE );
 
@@ -1354,15 +1346,9 @@ static void test_iot_connect_configuration_no_memory( void **state )
 	lib.options_config = &opts;
 
 	/* iot-connect.cfg */
-#ifdef IOT_STACK_ONLY
 	will_return( __wrap_os_file_exists, OS_TRUE );
 	will_return( __wrap_os_file_open, 1u );
-	will_return_count( __wrap_os_file_read, 1u, 2u );
-#else
-	will_return( __wrap_os_file_exists, OS_TRUE );
-	will_return( __wrap_os_file_open, 1u );
-	will_return( __wrap_os_realloc, 0u );
-#endif
+	will_return( __wrap_iot_json_stream_initialize, NULL );
 
 	result = iot_connect( &lib, 100u );
 	assert_int_equal( result, IOT_STATUS_NO_MEMORY );
@@ -1399,6 +1385,8 @@ static void test_iot_connect_configuration_not_found( void **state )
 	will_return_always( __wrap_iot_action_process, IOT_STATUS_FAILURE );
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		will_return( __wrap_os_thread_create, OS_STATUS_SUCCESS );
+	/* deadline thread */
+	will_return( __wrap_os_thread_create, OS_STATUS_SUCCESS );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 	result = iot_connect( &lib, 100u );
@@ -1443,19 +1431,13 @@ static void test_iot_connect_plugin_connect_fail( void **state )
 	/* app_id.cfg */
 	will_return( __wrap_os_file_exists, OS_TRUE );
 	will_return( __wrap_os_file_open, 1u );
-#ifdef IOT_STACK_ONLY
-	will_return( __wrap_os_file_read, 1u );
-#else
-	will_return_count( __wrap_os_realloc, 1u, 3u );
+	will_return( __wrap_iot_json_stream_initialize, 0x1 );
 	will_return_count( __wrap_os_file_read, 1u, 2u );
-#endif
 	will_return( __wrap_os_file_read, 0u );
 	will_return( __wrap_os_file_eof, IOT_TRUE );
 	/* parse file */
-	will_return( __wrap_iot_json_decode_initialize, 0x1 );
-	will_return( __wrap_iot_json_decode_object_iterator_key, NULL );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_NULL );
-	will_return( __wrap_iot_json_decode_object_iterator_next, NULL );
+	will_return( __wrap_iot_json_stream_finish, IOT_STATUS_SUCCESS );
+	will_return( __wrap_iot_json_stream_finish, NULL );
 
 	/* client connect */
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_FAILURE );
@@ -1517,6 +1499,7 @@ static void test_iot_connect_threads_main_loop_fail( void **state )
 {
 	struct iot lib;
 	iot_status_t result;
+	iot_int64_t int_value = 0;
 
 	memset( &lib, 0, sizeof( struct iot ) );
 	lib.cfg_file_path = test_malloc( 50u );
@@ -1528,20 +1511,16 @@ static void test_iot_connect_threads_main_loop_fail( void **state )
 	/* app_id.cfg */
 	will_return( __wrap_os_file_exists, OS_TRUE );
 	will_return( __wrap_os_file_open, 1u );
-#ifdef IOT_STACK_ONLY
-	will_return( __wrap_os_file_read, 1u );
-#else
-	will_return_count( __wrap_os_realloc, 1u, 3u );
+	will_return( __wrap_iot_json_stream_initialize, 0x1 );
 	will_return_count( __wrap_os_file_read, 1u, 2u );
-#endif
 	will_return( __wrap_os_file_read, 0u );
 	will_return( __wrap_os_file_eof, OS_TRUE );
 
 	/* read configuration file */
-	will_return( __wrap_iot_json_decode_initialize, 0x1 );
-	will_return( __wrap_iot_json_decode_object_iterator_key, "log_level" );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_STRING );
-	will_return( __wrap_iot_json_decode_string, "INFO" );
+	will_return( __wrap_iot_json_stream_finish, IOT_STATUS_SUCCESS );
+	will_return( __wrap_iot_json_stream_finish, "log_level" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_STRING );
+	will_return( __wrap_iot_json_stream_finish, "INFO" );
 	will_return( __wrap_os_malloc, 1u ); /* allocate global options array */
 #ifndef IOT_STACK_ONLY
 	will_return( __wrap_os_realloc, 1u ); /* resize pointer to option arrays */
@@ -1551,34 +1530,40 @@ static void test_iot_connect_threads_main_loop_fail( void **state )
 	will_return( __wrap_os_malloc, 1u ); /* allocate data storage */
 	will_return( __wrap_os_malloc, 1u ); /* allocate data storage */
 #endif /* ifndef IOT_STACK_ONLY */
-	will_return( __wrap_iot_json_decode_object_iterator_next, 1u );
-	will_return( __wrap_iot_json_decode_object_iterator_key, "int_value" );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_INTEGER );
+	will_return( __wrap_iot_json_stream_finish, "int_value" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_INTEGER );
+	will_return( __wrap_iot_json_stream_finish, "1" );
+#ifndef IOT_STACK_ONLY
+	will_return( __wrap_os_realloc, 1u ); /* add to global options array */
+	will_return( __wrap_os_malloc, 1u ); /* allocate key for option */
+#endif /* ifndef IOT_STACK_ONLY */
+	will_return( __wrap_iot_json_stream_finish, "bool_value" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_BOOL );
+	will_return( __wrap_iot_json_stream_finish, "true" );
 #ifndef IOT_STACK_ONLY
 	will_return( __wrap_os_realloc, 1u ); /* add to global options array */
 	will_return( __wrap_os_malloc, 1u ); /* allocate key for option */
 #endif /* ifndef IOT_STACK_ONLY */
-	will_return( __wrap_iot_json_decode_object_iterator_next, 1u );
-	will_return( __wrap_iot_json_decode_object_iterator_key, "bool_value" );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_BOOL );
+	will_return( __wrap_iot_json_stream_finish, "real_value" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_REAL );
+	will_return( __wrap_iot_json_stream_finish, "1.2345" );
 #ifndef IOT_STACK_ONLY
 	will_return( __wrap_os_realloc, 1u ); /* add to global options array */
 	will_return( __wrap_os_malloc, 1u ); /* allocate key for option */
 #endif /* ifndef IOT_STACK_ONLY */
-	will_return( __wrap_iot_json_decode_object_iterator_next, 1u );
-	will_return( __wrap_iot_json_decode_object_iterator_key, "real_value" );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_REAL );
+	will_return( __wrap_iot_json_stream_finish, "object" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_OBJECT );
+	will_return( __wrap_iot_json_stream_finish, "item1" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_INTEGER );
+	will_return( __wrap_iot_json_stream_finish, "9876543210" );
 #ifndef IOT_STACK_ONLY
 	will_return( __wrap_os_realloc, 1u ); /* add to global options array */
 	will_return( __wrap_os_malloc, 1u ); /* allocate key for option */
 #endif /* ifndef IOT_STACK_ONLY */
-	will_return( __wrap_iot_json_decode_object_iterator_next, 1u );
-	will_return( __wrap_iot_json_decode_object_iterator_key, "object" );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_OBJECT );
-	will_return( __wrap_iot_json_decode_object_iterator_key, "item1" );
-	will_return( __wrap_iot_json_decode_type, IOT_JSON_TYPE_ARRAY );
-	will_return( __wrap_iot_json_decode_object_iterator_next, NULL );
-	will_return( __wrap_iot_json_decode_object_iterator_next, NULL );
+	will_return( __wrap_iot_json_stream_finish, "array" );
+	will_return( __wrap_iot_json_stream_finish, IOT_JSON_TYPE_ARRAY );
+	will_return( __wrap_iot_json_stream_finish, NULL ); /* end of "object" */
+	will_return( __wrap_iot_json_stream_finish, NULL );
 
 	/* client connect */
 	will_return( __wrap_iot_plugin_perform, IOT_STATUS_SUCCESS );
@@ -1595,6 +1580,12 @@ static void test_iot_connect_threads_main_loop_fail( void **state )
 	assert_int_equal( result, IOT_STATUS_SUCCESS );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
+	/* nested keys are joined with '.' & kept as 64-bit values */
+	result = iot_config_get( &lib, "object.item1", IOT_FALSE,
+		IOT_TYPE_INT64, &int_value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_true( int_value == 9876543210LL );
+
 	/* clean up */
 #ifndef IOT_STACK_ONLY
 	if ( lib.options )
@@ -1650,6 +1641,8 @@ static void test_iot_connect_threads_success( void **state )
 	will_return_always( __wrap_iot_action_process, IOT_STATUS_FAILURE );
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		will_return( __wrap_os_thread_create, OS_STATUS_SUCCESS );
+	/* deadline thread */
+	will_return( __wrap_os_thread_create, OS_STATUS_SUCCESS );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 	result = iot_connect( &lib, 100u );
@@ -2225,6 +2218,7 @@ static void test_iot_loop_start_threads_success( void **state )
 	will_return( __wrap_os_thread_create, IOT_STATUS_SUCCESS );
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		will_return( __wrap_os_thread_create, IOT_STATUS_SUCCESS );
+	will_return( __wrap_os_thread_create, IOT_STATUS_SUCCESS );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 	result = iot_loop_start( &lib );
@@ -2235,6 +2229,7 @@ static void test_iot_loop_start_threads_success( void **state )
 	assert_true( lib.main_thread != 0 );
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		assert_true( lib.worker_thread[i] != 0 );
+	assert_true( lib.deadline_thread != 0 );
 #else
 	assert_int_equal( result, IOT_STATUS_NOT_SUPPORTED );
 #endif /* ifdef IOT_THREAD_SUPPORT */
@@ -2254,6 +2249,7 @@ static void test_iot_loop_start_threads_twice( void **state )
 	will_return( __wrap_os_thread_create, IOT_STATUS_SUCCESS );
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		will_return( __wrap_os_thread_create, IOT_STATUS_SUCCESS );
+	will_return( __wrap_os_thread_create, IOT_STATUS_SUCCESS );
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 	result = iot_loop_start( &lib );
@@ -2307,6 +2303,7 @@ static void test_iot_loop_stop_threads_force( void **state )
 	lib.main_thread = (os_thread_t)1234;
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		lib.worker_thread[i] = (os_thread_t)(i + 1u);
+	lib.deadline_thread = (os_thread_t)4321;
 #endif /* ifdef IOT_THREAD_SUPPORT */
 	result = iot_loop_stop( &lib, IOT_TRUE );
 
@@ -2331,6 +2328,7 @@ static void test_iot_loop_stop_threads_no_force( void **state )
 	lib.main_thread = (os_thread_t)1234;
 	for ( i = 0u; i < IOT_WORKER_THREADS; ++i )
 		lib.worker_thread[i] = (os_thread_t)(i + 1u);
+	lib.deadline_thread = (os_thread_t)4321;
 #endif /* ifdef IOT_THREAD_SUPPORT */
 
 	result = iot_loop_stop( &lib, IOT_FALSE );
@@ -2508,6 +2506,15 @@ static void test_iot_terminate_telemetry( void **state )
 #endif
 }
 
+/* iot_timestamp_monotonic */
+static void test_iot_timestamp_monotonic_valid( void **state )
+{
+	const iot_timestamp_t first = iot_timestamp_monotonic();
+	const iot_timestamp_t second = iot_timestamp_monotonic();
+	assert_true( first > 0u );
+	assert_true( second >= first );
+}
+
 /* iot_timestamp_now */
 static void test_iot_timestamp_now_valid( void **state )
 {
@@ -2671,6 +2678,7 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_iot_terminate_null_lib ),
 		cmocka_unit_test( test_iot_terminate_option ),
 		cmocka_unit_test( test_iot_terminate_telemetry ),
+		cmocka_unit_test( test_iot_timestamp_monotonic_valid ),
 		cmocka_unit_test( test_iot_timestamp_now_valid ),
 		cmocka_unit_test( test_iot_transaction_status_bad ),
 		cmocka_unit_test( test_iot_transaction_status_good ),
@@ -0,0 +1,413 @@
+/**
+ * @file
+ * @brief unit testing for checksum routines
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "test_support.h"
+
+#include "api/public/iot.h"
+#include "api/public/iot_checksum.h"
+#include "api/checksum/iot_checksum_crc32.h"
+#include "api/checksum/iot_checksum_sha256.h"
+
+#include <string.h>
+
+/** @brief data used to calculate checksums (standard check value input) */
+static const char *const TEST_CHECKSUM_DATA = "123456789";
+/** @brief CRC32 check value of the test data */
+#define TEST_CHECKSUM_CRC32               0xCBF43926u
+/** @brief MD5 digest of the test data */
+#define TEST_CHECKSUM_MD5                 "25f9e794323b453885f5181f1b624d0b"
+/** @brief SHA256 digest of the test data */
+#define TEST_CHECKSUM_SHA256 \
+	"15e2b0d3c33891ebb0f1ef609ec419420c20e320ce94c65fbc8c3312448eb225"
+/** @brief size of the buffer used to compare the CRC32 implementations */
+#define TEST_CHECKSUM_BUFFER_SIZE         4160u
+/** @brief largest offset into the buffer compared */
+#define TEST_CHECKSUM_OFFSET_MAX          16u
+
+/**
+ * @brief fills a buffer with repeatable pseudo-random data
+ *
+ * @param[out]     buf                 buffer to fill
+ * @param[in]      len                 size of the buffer
+ */
+static void test_checksum_fill( unsigned char *buf, size_t len )
+{
+	iot_uint32_t seed = 0x12345678u;
+	size_t i;
+	for ( i = 0u; i < len; ++i )
+	{
+		seed = seed * 1103515245u + 12345u;
+		buf[i] = (unsigned char)( seed >> 16 );
+	}
+}
+
+/* iot_checksum_crc32_* */
+static void test_iot_checksum_crc32_hardware_matches_reference( void **state )
+{
+	unsigned char buf[ TEST_CHECKSUM_BUFFER_SIZE ];
+	size_t len, offset;
+
+	test_checksum_fill( buf, sizeof( buf ) );
+	for ( offset = 0u; offset < TEST_CHECKSUM_OFFSET_MAX; ++offset )
+	{
+		for ( len = 0u; len + offset <= sizeof( buf ); len += 1u + len / 8u )
+		{
+			const iot_uint32_t expected = iot_checksum_crc32_reference(
+				0xA5A5A5A5u, &buf[offset], len );
+			assert_int_equal( iot_checksum_crc32_hardware(
+				0xA5A5A5A5u, &buf[offset], len ), expected );
+		}
+	}
+}
+
+static void test_iot_checksum_crc32_slice8_matches_reference( void **state )
+{
+	unsigned char buf[ TEST_CHECKSUM_BUFFER_SIZE ];
+	size_t len, offset;
+
+	test_checksum_fill( buf, sizeof( buf ) );
+	for ( offset = 0u; offset < TEST_CHECKSUM_OFFSET_MAX; ++offset )
+	{
+		for ( len = 0u; len + offset <= sizeof( buf ); len += 1u + len / 8u )
+		{
+			const iot_uint32_t expected = iot_checksum_crc32_reference(
+				0xA5A5A5A5u, &buf[offset], len );
+			assert_int_equal( iot_checksum_crc32_slice8(
+				0xA5A5A5A5u, &buf[offset], len ), expected );
+		}
+	}
+}
+
+static void test_iot_checksum_crc32_update_check_value( void **state )
+{
+	assert_int_equal( iot_checksum_crc32_reference( 0u,
+		TEST_CHECKSUM_DATA, strlen( TEST_CHECKSUM_DATA ) ),
+		TEST_CHECKSUM_CRC32 );
+	assert_int_equal( iot_checksum_crc32_update( 0u,
+		TEST_CHECKSUM_DATA, strlen( TEST_CHECKSUM_DATA ) ),
+		TEST_CHECKSUM_CRC32 );
+}
+
+/* iot_checksum_sha256_* */
+static void test_iot_checksum_sha256_blocks_matches_portable( void **state )
+{
+	unsigned char buf[ TEST_CHECKSUM_BUFFER_SIZE ];
+	iot_uint32_t expected[8u];
+	iot_uint32_t h[8u];
+	size_t blocks;
+
+	test_checksum_fill( buf, sizeof( buf ) );
+	for ( blocks = 0u; blocks <= sizeof( buf ) / 64u; ++blocks )
+	{
+		iot_checksum_sha256_initialize( expected );
+		iot_checksum_sha256_blocks_portable( expected, buf, blocks );
+		iot_checksum_sha256_initialize( h );
+		iot_checksum_sha256_blocks( h, buf, blocks );
+		assert_memory_equal( h, expected, sizeof( h ) );
+	}
+}
+
+/* iot_checksum_digest_get */
+static void test_iot_checksum_digest_get_crc32( void **state )
+{
+	iot_checksum_context_t ctx;
+	unsigned char digest[ IOT_CHECKSUM_SIZE_MAX ];
+	size_t digest_len = 0u;
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update( &ctx, TEST_CHECKSUM_DATA,
+		strlen( TEST_CHECKSUM_DATA ) );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_digest_get( &ctx, digest, sizeof( digest ),
+		&digest_len );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( digest_len, IOT_CHECKSUM_CRC32_SIZE );
+	assert_memory_equal( digest, "\xCB\xF4\x39\x26", 4u );
+}
+
+static void test_iot_checksum_digest_get_too_small( void **state )
+{
+	iot_checksum_context_t ctx;
+	unsigned char digest[ IOT_CHECKSUM_SHA256_SIZE - 1u ];
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_SHA256 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_digest_get( &ctx, digest, sizeof( digest ),
+		NULL );
+	assert_int_equal( result, IOT_STATUS_FULL );
+}
+
+/* iot_checksum_digest_hex_get */
+static void test_iot_checksum_digest_hex_get_md5( void **state )
+{
+	iot_checksum_context_t ctx;
+	char hex[ IOT_CHECKSUM_HEX_SIZE( IOT_CHECKSUM_MD5_SIZE ) + 1u ];
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_MD5 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update( &ctx, TEST_CHECKSUM_DATA,
+		strlen( TEST_CHECKSUM_DATA ) );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_digest_hex_get( &ctx, hex, sizeof( hex ) );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( hex, TEST_CHECKSUM_MD5 );
+}
+
+static void test_iot_checksum_digest_hex_get_sha256( void **state )
+{
+	iot_checksum_context_t ctx;
+	char hex[ IOT_CHECKSUM_HEX_SIZE( IOT_CHECKSUM_SHA256_SIZE ) + 1u ];
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_SHA256 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update( &ctx, TEST_CHECKSUM_DATA,
+		strlen( TEST_CHECKSUM_DATA ) );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_digest_hex_get( &ctx, hex, sizeof( hex ) );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( hex, TEST_CHECKSUM_SHA256 );
+}
+
+static void test_iot_checksum_digest_hex_get_too_small( void **state )
+{
+	iot_checksum_context_t ctx;
+	char hex[ IOT_CHECKSUM_HEX_SIZE( IOT_CHECKSUM_MD5_SIZE ) ];
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_MD5 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_digest_hex_get( &ctx, hex, sizeof( hex ) );
+	assert_int_equal( result, IOT_STATUS_FULL );
+}
+
+/* iot_checksum_file_get */
+static void test_iot_checksum_file_get_digest_not_supported( void **state )
+{
+	int file_handle;
+	iot_uint64_t checksum = 0u;
+	iot_status_t result;
+
+	/* the file is not read for an unsupported algorithm */
+	result = iot_checksum_file_get( NULL, (os_file_t)&file_handle,
+		IOT_CHECKSUM_TYPE_SHA256, &checksum );
+	assert_int_equal( result, IOT_STATUS_NOT_SUPPORTED );
+}
+
+/* iot_checksum_file_update */
+static void test_iot_checksum_file_update_null_file( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_status_t result;
+
+	iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_MD5 );
+	result = iot_checksum_file_update( NULL, &ctx, 1u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+/* iot_checksum_finalize */
+static void test_iot_checksum_finalize_null_checksum( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_finalize( &ctx, NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_iot_checksum_finalize_null_ctx( void **state )
+{
+	iot_uint64_t checksum = 0u;
+	iot_status_t result;
+
+	result = iot_checksum_finalize( NULL, &checksum );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+/* iot_checksum_initialize */
+static void test_iot_checksum_initialize_null_ctx( void **state )
+{
+	iot_status_t result;
+
+	result = iot_checksum_initialize( NULL, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_iot_checksum_initialize_unsupported( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, (iot_checksum_type_t)99 );
+	assert_int_equal( result, IOT_STATUS_NOT_SUPPORTED );
+}
+
+/* iot_checksum_update */
+static void test_iot_checksum_update_crc32( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_uint64_t checksum = 0u;
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update( &ctx, TEST_CHECKSUM_DATA,
+		strlen( TEST_CHECKSUM_DATA ) );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_finalize( &ctx, &checksum );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( checksum, TEST_CHECKSUM_CRC32 );
+}
+
+static void test_iot_checksum_update_crc32_chunks( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_uint64_t checksum = 0u;
+	iot_status_t result;
+	size_t i;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	for ( i = 0u; i < strlen( TEST_CHECKSUM_DATA ); i += 2u )
+	{
+		size_t len = strlen( TEST_CHECKSUM_DATA ) - i;
+		if ( len > 2u )
+			len = 2u;
+		result = iot_checksum_update( &ctx,
+			&TEST_CHECKSUM_DATA[i], len );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+	}
+	result = iot_checksum_finalize( &ctx, &checksum );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( checksum, TEST_CHECKSUM_CRC32 );
+}
+
+static void test_iot_checksum_update_multiple( void **state )
+{
+	unsigned char buf[ TEST_CHECKSUM_BUFFER_SIZE ];
+	iot_checksum_context_t ctx[3u];
+	iot_checksum_context_t single;
+	unsigned char digest[ IOT_CHECKSUM_SIZE_MAX ];
+	unsigned char expected[ IOT_CHECKSUM_SIZE_MAX ];
+	const iot_checksum_type_t types[3u] = { IOT_CHECKSUM_TYPE_CRC32,
+		IOT_CHECKSUM_TYPE_MD5, IOT_CHECKSUM_TYPE_SHA256 };
+	size_t digest_len, expected_len;
+	size_t i;
+	iot_status_t result;
+
+	test_checksum_fill( buf, sizeof( buf ) );
+	for ( i = 0u; i < 3u; ++i )
+	{
+		result = iot_checksum_initialize( &ctx[i], types[i] );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+	}
+	/* an odd sized piece first, so blocks are split across calls */
+	result = iot_checksum_update_multiple( ctx, 3u, buf, 7u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update_multiple( ctx, 3u, &buf[7],
+		sizeof( buf ) - 7u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	for ( i = 0u; i < 3u; ++i )
+	{
+		result = iot_checksum_initialize( &single, types[i] );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		result = iot_checksum_update( &single, buf, sizeof( buf ) );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		result = iot_checksum_digest_get( &single, expected,
+			sizeof( expected ), &expected_len );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		result = iot_checksum_digest_get( &ctx[i], digest,
+			sizeof( digest ), &digest_len );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		assert_int_equal( digest_len, expected_len );
+		assert_memory_equal( digest, expected, digest_len );
+	}
+}
+
+static void test_iot_checksum_update_no_data( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_uint64_t checksum = 1u;
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update( &ctx, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_finalize( &ctx, &checksum );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( checksum, 0u );
+}
+
+static void test_iot_checksum_update_null_buf( void **state )
+{
+	iot_checksum_context_t ctx;
+	iot_status_t result;
+
+	result = iot_checksum_initialize( &ctx, IOT_CHECKSUM_TYPE_CRC32 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = iot_checksum_update( &ctx, NULL, 4u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_iot_checksum_update_null_ctx( void **state )
+{
+	iot_status_t result;
+
+	result = iot_checksum_update( NULL, TEST_CHECKSUM_DATA,
+		strlen( TEST_CHECKSUM_DATA ) );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_iot_checksum_crc32_hardware_matches_reference ),
+		cmocka_unit_test( test_iot_checksum_crc32_slice8_matches_reference ),
+		cmocka_unit_test( test_iot_checksum_crc32_update_check_value ),
+		cmocka_unit_test( test_iot_checksum_sha256_blocks_matches_portable ),
+		cmocka_unit_test( test_iot_checksum_digest_get_crc32 ),
+		cmocka_unit_test( test_iot_checksum_digest_get_too_small ),
+		cmocka_unit_test( test_iot_checksum_digest_hex_get_md5 ),
+		cmocka_unit_test( test_iot_checksum_digest_hex_get_sha256 ),
+		cmocka_unit_test( test_iot_checksum_digest_hex_get_too_small ),
+		cmocka_unit_test( test_iot_checksum_file_get_digest_not_supported ),
+		cmocka_unit_test( test_iot_checksum_file_update_null_file ),
+		cmocka_unit_test( test_iot_checksum_finalize_null_checksum ),
+		cmocka_unit_test( test_iot_checksum_finalize_null_ctx ),
+		cmocka_unit_test( test_iot_checksum_initialize_null_ctx ),
+		cmocka_unit_test( test_iot_checksum_initialize_unsupported ),
+		cmocka_unit_test( test_iot_checksum_update_crc32 ),
+		cmocka_unit_test( test_iot_checksum_update_crc32_chunks ),
+		cmocka_unit_test( test_iot_checksum_update_multiple ),
+		cmocka_unit_test( test_iot_checksum_update_no_data ),
+		cmocka_unit_test( test_iot_checksum_update_null_buf ),
+		cmocka_unit_test( test_iot_checksum_update_null_ctx )
+	};
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
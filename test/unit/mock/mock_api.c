@@ -29,6 +29,8 @@
 /* mock definitions */
 iot_status_t __wrap_iot_action_process( iot_t *lib_handle, iot_millisecond_t max_time_out );
 iot_status_t __wrap_iot_action_check( iot_t *lib_handle, iot_millisecond_t max_time_out );
+iot_status_t __wrap_iot_action_deadline_check( iot_t *lib_handle );
+iot_timestamp_t __wrap_iot_action_deadline_next( const iot_t *lib_handle );
 iot_status_t __wrap_iot_action_free( iot_action_t *action, iot_millisecond_t max_time_out );
 iot_status_t __wrap_iot_alarm_deregister( iot_telemetry_t *alarm );
 size_t __wrap_iot_base64_encode( uint8_t *out, size_t out_len, const uint8_t *in, size_t in_len );
@@ -57,6 +59,8 @@ void __wrap_iot_plugin_initialize( iot_plugin_t *p );
 void __wrap_iot_plugin_terminate( iot_plugin_t *p );
 iot_status_t __wrap_iot_telemetry_free( iot_telemetry_t *telemetry,
 	iot_millisecond_t max_time_out );
+iot_timestamp_t __wrap_iot_timestamp_monotonic( void );
+iot_timestamp_t __wrap_iot_timestamp_now( void );
 
 /* mock iot_json functions */
 iot_status_t __wrap_iot_json_decode_bool(
@@ -114,6 +118,41 @@ void __wrap_iot_json_decode_terminate(
 iot_json_type_t __wrap_iot_json_decode_type(
 	const iot_json_decoder_t *json,
 	const iot_json_item_t *item );
+iot_status_t __wrap_iot_json_stream_finish(
+	iot_json_stream_t *stream,
+	char *error,
+	size_t error_len );
+iot_json_stream_t *__wrap_iot_json_stream_initialize(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	iot_json_stream_callback_t callback,
+	void *user_data );
+iot_status_t __wrap_iot_json_stream_parse(
+	iot_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	char *error,
+	size_t error_len );
+void __wrap_iot_json_stream_terminate(
+	iot_json_stream_t *stream );
+
+/**
+ * @brief Replays queued items (key, type & value) to the json stream callback
+ *
+ * Items are replayed until a NULL key is queued, the items of an object are
+ * queued after it and also end with a NULL key.
+ *
+ * @param[in]      depth               depth of the items
+ *
+ * @retval IOT_STATUS_SUCCESS          on success
+ */
+static iot_status_t mock_json_stream_replay( unsigned int depth );
+
+/** @brief Callback registered with the mocked json stream */
+static iot_json_stream_callback_t mock_json_stream_callback = NULL;
+/** @brief User data registered with the mocked json stream */
+static void *mock_json_stream_user_data = NULL;
 
 /* mock functions */
 iot_status_t __wrap_iot_action_process( iot_t *lib_handle, iot_millisecond_t max_time_out )
@@ -126,6 +165,16 @@ iot_status_t __wrap_iot_action_check( iot_t *lib_handle, iot_millisecond_t max_t
 	return mock_type( iot_status_t );
 }
 
+iot_status_t __wrap_iot_action_deadline_check( iot_t *lib_handle )
+{
+	return IOT_STATUS_SUCCESS;
+}
+
+iot_timestamp_t __wrap_iot_action_deadline_next( const iot_t *lib_handle )
+{
+	return 0u;
+}
+
 iot_status_t __wrap_iot_action_free( iot_action_t *action, iot_millisecond_t max_time_out )
 {
 	return mock_type( iot_status_t );
@@ -219,6 +268,17 @@ iot_status_t __wrap_iot_telemetry_free( iot_telemetry_t *telemetry,
 	return mock_type( iot_status_t );
 }
 
+iot_timestamp_t __wrap_iot_timestamp_monotonic( void )
+{
+	return 1234567u;
+}
+
+iot_timestamp_t __wrap_iot_timestamp_now( void )
+{
+	/* same as the time returned by os_time */
+	return 1234567u;
+}
+
 iot_status_t __wrap_iot_json_decode_bool(
 	const iot_json_decoder_t *json,
 	const iot_json_item_t *item,
@@ -345,3 +405,93 @@ iot_json_type_t __wrap_iot_json_decode_type(
 	return mock_type( iot_json_type_t );
 }
 
+iot_status_t __wrap_iot_json_stream_finish(
+	iot_json_stream_t *stream,
+	char *error,
+	size_t error_len )
+{
+	/* replays the queued items (key, type & value) in a root object */
+	iot_status_t result = mock_type( iot_status_t );
+	if ( result == IOT_STATUS_SUCCESS && mock_json_stream_callback )
+	{
+		void *const user_data = mock_json_stream_user_data;
+
+		result = mock_json_stream_callback( user_data,
+			IOT_JSON_STREAM_START, IOT_JSON_TYPE_OBJECT, 0u,
+			NULL, 0u, NULL, 0u );
+		if ( result == IOT_STATUS_SUCCESS )
+			result = mock_json_stream_replay( 1u );
+		if ( result == IOT_STATUS_SUCCESS )
+			result = mock_json_stream_callback( user_data,
+				IOT_JSON_STREAM_END, IOT_JSON_TYPE_OBJECT, 0u,
+				NULL, 0u, NULL, 0u );
+	}
+	if ( error && error_len > 0u )
+		*error = '\0';
+	return result;
+}
+
+iot_status_t mock_json_stream_replay( unsigned int depth )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	void *const user_data = mock_json_stream_user_data;
+	const char *key;
+
+	while ( result == IOT_STATUS_SUCCESS &&
+		( key = mock_type( const char * ) ) != NULL )
+	{
+		const iot_json_type_t type = mock_type( iot_json_type_t );
+		if ( type == IOT_JSON_TYPE_ARRAY ||
+		     type == IOT_JSON_TYPE_OBJECT )
+		{
+			result = mock_json_stream_callback( user_data,
+				IOT_JSON_STREAM_START, type, depth,
+				key, strlen( key ), NULL, 0u );
+			if ( result == IOT_STATUS_SUCCESS &&
+			     type == IOT_JSON_TYPE_OBJECT )
+				result = mock_json_stream_replay( depth + 1u );
+			if ( result == IOT_STATUS_SUCCESS )
+				result = mock_json_stream_callback( user_data,
+					IOT_JSON_STREAM_END, type, depth,
+					NULL, 0u, NULL, 0u );
+		}
+		else
+		{
+			const char *value = mock_type( const char * );
+			result = mock_json_stream_callback( user_data,
+				IOT_JSON_STREAM_VALUE, type, depth,
+				key, strlen( key ), value, strlen( value ) );
+		}
+	}
+	return result;
+}
+
+iot_json_stream_t *__wrap_iot_json_stream_initialize(
+	void *buf,
+	size_t len,
+	unsigned int flags,
+	iot_json_stream_callback_t callback,
+	void *user_data )
+{
+	mock_json_stream_callback = callback;
+	mock_json_stream_user_data = user_data;
+	return mock_type( iot_json_stream_t * );
+}
+
+iot_status_t __wrap_iot_json_stream_parse(
+	iot_json_stream_t *stream,
+	const char *js,
+	size_t len,
+	char *error,
+	size_t error_len )
+{
+	return IOT_STATUS_SUCCESS;
+}
+
+void __wrap_iot_json_stream_terminate(
+	iot_json_stream_t *stream )
+{
+	mock_json_stream_callback = NULL;
+	mock_json_stream_user_data = NULL;
+}
+
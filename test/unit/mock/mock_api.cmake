@@ -17,6 +17,8 @@ set( MOCK_API_LIBS "mock_api" )
 set( MOCK_API_FUNC
 	"iot_action_process"
 	"iot_action_check"
+	"iot_action_deadline_check"
+	"iot_action_deadline_next"
 	"iot_action_free"
 	"iot_alarm_deregister"
 	"iot_base64_encode"
@@ -33,6 +35,8 @@ set( MOCK_API_FUNC
 	"iot_plugin_initialize"
 	"iot_plugin_terminate"
 	"iot_telemetry_free"
+	"iot_timestamp_monotonic"
+	"iot_timestamp_now"
 
 	"iot_json_decode_array_at"
 	"iot_json_decode_array_iterator"
@@ -54,5 +58,9 @@ set( MOCK_API_FUNC
 	"iot_json_decode_string"
 	"iot_json_decode_terminate"
 	"iot_json_decode_type"
+	"iot_json_stream_finish"
+	"iot_json_stream_initialize"
+	"iot_json_stream_parse"
+	"iot_json_stream_terminate"
 )
 
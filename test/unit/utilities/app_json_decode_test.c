@@ -763,6 +763,66 @@ static void test_app_json_decode_object_find_invalid( void **state )
 	app_json_decode_terminate( decoder );
 }
 
+static void test_app_json_decode_object_find_dynamic( void **state )
+{
+	char json[512u];
+	app_json_decoder_t *decoder;
+#ifndef IOT_STACK_ONLY
+	iot_status_t result;
+	const app_json_item_t *root = NULL;
+	const app_json_item_t *item;
+	const app_json_item_t *nested;
+	iot_int64_t value = 0;
+	size_t i, len;
+	will_return_always( __wrap_os_realloc, 1 );
+#endif
+
+	snprintf( json, 512u, "{\"nested\":{\"item1\":[1,{\"item2\":2}]}" );
+#ifdef IOT_STACK_ONLY
+	decoder = app_json_decode_initialize( NULL, 0u, 0u );
+	assert_null( decoder );
+#else
+	/* enough members for the object's keys to be hashed */
+	len = strlen( json );
+	for ( i = 0u; i < 16u; ++i )
+		len += (size_t)snprintf( &json[len], 512u - len,
+			",\"item%u\":%u", (unsigned int)i, (unsigned int)i );
+	snprintf( &json[len], 512u - len, ",\"item\":99}" );
+
+	decoder = app_json_decode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, json, strlen(json), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_non_null( root );
+
+	/* keys must match exactly, not by prefix */
+	item = app_json_decode_object_find( decoder, root, "item" );
+	assert_non_null( item );
+	result = app_json_decode_integer( decoder, item, &value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( value, 99 );
+	assert_null( app_json_decode_object_find( decoder, root, "ite" ) );
+
+	item = app_json_decode_object_find( decoder, root, "item15" );
+	assert_non_null( item );
+	result = app_json_decode_integer( decoder, item, &value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( value, 15 );
+
+	/* keys of nested objects are not members of the root */
+	assert_null( app_json_decode_object_find( decoder, root, "item2" ) );
+	nested = app_json_decode_object_find( decoder, root, "nested" );
+	assert_non_null( nested );
+	item = app_json_decode_object_find( decoder, nested, "item1" );
+	assert_non_null( item );
+	assert_int_equal( app_json_decode_type( decoder, item ),
+		APP_JSON_TYPE_ARRAY );
+	assert_null( app_json_decode_object_find( decoder, nested, "item2" ) );
+
+	app_json_decode_terminate( decoder );
+#endif
+}
+
 static void test_app_json_decode_object_find_valid( void **state )
 {
 	char buf[512u];
@@ -1468,6 +1528,94 @@ static void test_app_json_decode_parse_dynamic( void **state )
 #endif
 }
 
+static void test_app_json_decode_parse_dynamic_grow( void **state )
+{
+	char json[1024u];
+	app_json_decoder_t *decoder;
+#ifndef IOT_STACK_ONLY
+	iot_status_t result;
+	const app_json_item_t *root = NULL;
+	const app_json_item_t *item;
+	iot_int64_t value = 0;
+	size_t i, len;
+	will_return_always( __wrap_os_realloc, 1 );
+#endif
+
+	/* enough tokens to require the token array to grow several times */
+	snprintf( json, 1024u, "{" );
+#ifdef IOT_STACK_ONLY
+	decoder = app_json_decode_initialize( NULL, 0u, 0u );
+	assert_null( decoder );
+#else
+	len = strlen( json );
+	for ( i = 0u; i < 64u; ++i )
+		len += (size_t)snprintf( &json[len], 1024u - len,
+			"%s\"item%u\":%u", ( i ? "," : "" ),
+			(unsigned int)i, (unsigned int)i );
+	snprintf( &json[len], 1024u - len, "}" );
+
+	decoder = app_json_decode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, json, strlen(json), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_non_null( root );
+	assert_int_equal( app_json_decode_object_size( decoder, root ), 64u );
+
+	item = app_json_decode_object_find( decoder, root, "item63" );
+	assert_non_null( item );
+	result = app_json_decode_integer( decoder, item, &value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( value, 63 );
+
+	app_json_decode_terminate( decoder );
+#endif
+}
+
+static void test_app_json_decode_parse_dynamic_reuse( void **state )
+{
+	char json[256u];
+	app_json_decoder_t *decoder;
+#ifndef IOT_STACK_ONLY
+	iot_status_t result;
+	const app_json_item_t *root = NULL;
+	const app_json_object_iterator_t *iter;
+	size_t count = 0u;
+	will_return_always( __wrap_os_realloc, 1 );
+#endif
+
+	snprintf( json, 256u,
+		"{\"item1\":\"value1\",\"item2\":[1,2,3],\"item3\":{\"a\":1}}" );
+#ifdef IOT_STACK_ONLY
+	decoder = app_json_decode_initialize( NULL, 0u, 0u );
+	assert_null( decoder );
+#else
+	decoder = app_json_decode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, json, strlen(json), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_non_null( root );
+	assert_int_equal( app_json_decode_object_size( decoder, root ), 3u );
+
+	/* smaller document: tokens from the first parse must not be visited */
+	snprintf( json, 256u, "{\"item1\":\"value1\"}" );
+	result = app_json_decode_parse( decoder, json, strlen(json), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_non_null( root );
+	assert_int_equal( app_json_decode_object_size( decoder, root ), 1u );
+	assert_null( app_json_decode_object_find( decoder, root, "item2" ) );
+
+	iter = app_json_decode_object_iterator( decoder, root );
+	while ( iter )
+	{
+		++count;
+		iter = app_json_decode_object_iterator_next( decoder, root, iter );
+	}
+	assert_int_equal( count, 1u );
+
+	app_json_decode_terminate( decoder );
+#endif
+}
+
 static void test_app_json_decode_parse_invalid_character( void **state )
 {
 	char buf[1024u];
@@ -1867,6 +2015,7 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_app_json_decode_number_null_json ),
 		cmocka_unit_test( test_app_json_decode_number_valid ),
 		cmocka_unit_test( test_app_json_decode_object_find_invalid ),
+		cmocka_unit_test( test_app_json_decode_object_find_dynamic ),
 		cmocka_unit_test( test_app_json_decode_object_find_valid ),
 		cmocka_unit_test( test_app_json_decode_object_find_null_item ),
 		cmocka_unit_test( test_app_json_decode_object_find_null_json ),
@@ -1896,6 +2045,8 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_app_json_decode_object_size_single ),
 		cmocka_unit_test( test_app_json_decode_object_size_multiple ),
 		cmocka_unit_test( test_app_json_decode_parse_dynamic ),
+		cmocka_unit_test( test_app_json_decode_parse_dynamic_grow ),
+		cmocka_unit_test( test_app_json_decode_parse_dynamic_reuse ),
 		cmocka_unit_test( test_app_json_decode_parse_invalid_character ),
 		cmocka_unit_test( test_app_json_decode_parse_invalid_partial ),
 		cmocka_unit_test( test_app_json_decode_parse_null_json ),
@@ -24,10 +24,77 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <time.h> /* for clock */
+
 #if defined( IOT_JSON_JSONC )
 #	include <json-c/json_c_version.h>
 #endif /* if defined( IOT_JSON_JSONC ) */
 
+#if !defined( IOT_STACK_ONLY )
+/** @brief number of calls to the JSON memory reallocation function */
+static unsigned int test_json_realloc_count = 0u;
+
+/**
+ * @brief JSON memory free function used in tests
+ *
+ * @param[in]      ptr                 memory to free
+ */
+static void test_json_free( void *ptr )
+{
+	test_free( ptr );
+}
+
+/**
+ * @brief JSON memory reallocation function counting the number of calls
+ *
+ * @param[in]      ptr                 memory to reallocate (optional)
+ * @param[in]      size                new size of the memory
+ *
+ * @return pointer to the memory allocated
+ */
+static void *test_json_realloc( void *ptr, size_t size )
+{
+	++test_json_realloc_count;
+	return test_realloc( ptr, size );
+}
+
+/** @brief JSON memory free function pointer, for app_json_allocation_set */
+static app_json_free_t test_json_free_fn = test_json_free;
+/** @brief JSON memory reallocation function pointer, for
+ *         app_json_allocation_set */
+static app_json_realloc_t test_json_realloc_fn = test_json_realloc;
+#endif /* if !defined( IOT_STACK_ONLY ) */
+
+/** @brief characters received by the test sink function */
+static char test_sink_output[ 1024u ];
+/** @brief number of characters received by the test sink function */
+static size_t test_sink_output_len = 0u;
+
+/**
+ * @brief JSON encoder sink function appending the output to a test buffer
+ *
+ * @param[in]      user_data           status to return
+ * @param[in]      data                characters to write
+ * @param[in]      len                 number of characters to write
+ *
+ * @return the status pointed to by @p user_data, or IOT_STATUS_SUCCESS
+ */
+static iot_status_t test_sink( void *user_data, const char *data, size_t len )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	if ( user_data )
+		result = *(iot_status_t *)user_data;
+	else if ( test_sink_output_len + len < sizeof( test_sink_output ) )
+	{
+		memcpy( &test_sink_output[test_sink_output_len], data, len );
+		test_sink_output_len += len;
+		test_sink_output[test_sink_output_len] = '\0';
+	}
+	else
+		result = IOT_STATUS_NO_MEMORY;
+	return result;
+}
+
 static void test_app_json_encode_array_end_at_root( void **state )
 {
 	app_json_encoder_t *e;
@@ -479,6 +546,119 @@ static void test_app_json_encode_bool_outside_object( void **state )
 	app_json_encode_terminate( e );
 }
 
+static void test_app_json_encode_estimate_compact( void **state )
+{
+	size_t result;
+
+	/* "key":"va\"l", */
+	result = app_json_encode_estimate( NULL, "key", "va\"l", 0u );
+	assert_int_equal( result, 14u );
+
+	/* "n":123, */
+	result = app_json_encode_estimate( NULL, "n", NULL, 3u );
+	assert_int_equal( result, 8u );
+
+	/* "value", */
+	result = app_json_encode_estimate( NULL, NULL, "value", 0u );
+	assert_int_equal( result, 8u );
+}
+
+static void test_app_json_encode_estimate_expand( void **state )
+{
+	app_json_encoder_t *e;
+	size_t result;
+
+#if defined( IOT_STACK_ONLY )
+	char buffer[ 128u ];
+	e = app_json_encode_initialize( buffer, sizeof( buffer ),
+		APP_JSON_FLAG_EXPAND );
+#else /* if defined( IOT_STACK_ONLY ) */
+	will_return_always( __wrap_os_realloc, 1 );
+	e = app_json_encode_initialize( NULL, 0u,
+		APP_JSON_FLAG_DYNAMIC | APP_JSON_FLAG_EXPAND );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+	/* "key": "value", */
+	result = app_json_encode_estimate( e, "key", "value", 0u );
+	assert_int_equal( result, 16u );
+
+	app_json_encode_terminate( e );
+}
+
+static void test_app_json_encode_growth_allocations( void **state )
+{
+#if !defined( IOT_STACK_ONLY )
+	app_json_encoder_t *e;
+	const char *json_str;
+	iot_status_t result;
+	unsigned int i;
+	clock_t start;
+	double elapsed;
+	const unsigned int item_count = 10000u;
+
+	app_json_allocation_set( &test_json_realloc_fn, &test_json_free_fn );
+	test_json_realloc_count = 0u;
+#if defined( IOT_JSON_JSONC )
+	will_return( __wrap_os_malloc, 1 );
+#endif /* if defined( IOT_JSON_JSONC ) */
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+	assert_non_null( e );
+
+	start = clock();
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	for ( i = 0u; i < item_count; ++i )
+	{
+		result = app_json_encode_integer( e, NULL, 12345 );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+	}
+	result = app_json_encode_array_end( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	json_str = app_json_encode_dump( e );
+	elapsed = (double)( clock() - start ) / CLOCKS_PER_SEC;
+
+	assert_non_null( json_str );
+	/* "[" + "12345" * count + "," * (count - 1) + "]" */
+	assert_int_equal( strlen( json_str ), item_count * 6u + 1u );
+	assert_int_equal( json_str[0], '[' );
+	assert_int_equal( json_str[item_count * 6u], ']' );
+#if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
+	/* output grows geometrically, one allocation per item would be
+	 * over 10000 allocations */
+	assert_in_range( test_json_realloc_count, 1u, 16u );
+#endif /* if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC ) */
+	print_message( "[ BENCH    ] %u items, %u allocations, %.0f items/s\n",
+		item_count, test_json_realloc_count,
+		elapsed > 0.0 ? (double)item_count / elapsed : 0.0 );
+
+	app_json_encode_terminate( e );
+	app_json_allocation_set( NULL, NULL );
+#endif /* if !defined( IOT_STACK_ONLY ) */
+}
+
+static void test_app_json_encode_flush_no_sink( void **state )
+{
+	app_json_encoder_t *e;
+	iot_status_t result;
+	char buffer[ 256u ];
+
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+	assert_non_null( e );
+	result = app_json_encode_integer( e, "a", 1 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_flush( e );
+	assert_int_equal( result, IOT_STATUS_BAD_REQUEST );
+	app_json_encode_terminate( e );
+}
+
+static void test_app_json_encode_flush_null_item( void **state )
+{
+	iot_status_t result;
+	result = app_json_encode_flush( NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
 static void test_app_json_encode_initialize_null( void **state )
 {
 	app_json_encoder_t *result;
@@ -1106,6 +1286,45 @@ static void test_app_json_encode_integer_inside_object_blank_key( void **state )
 	app_json_encode_terminate( e );
 }
 
+static void test_app_json_encode_integer_limits( void **state )
+{
+	app_json_encoder_t *e;
+	const char *json_str;
+	iot_status_t result;
+
+#if defined( IOT_STACK_ONLY )
+	char buffer[ 128u ];
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+#else /* if defined( IOT_STACK_ONLY ) */
+#if defined( IOT_JSON_JSONC )
+	will_return( __wrap_os_malloc, 1 );
+#endif /* if defined( IOT_JSON_JSONC ) */
+	will_return_always( __wrap_os_realloc, 1 );
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_integer( e, NULL, INT64_MIN );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_integer( e, NULL, INT64_MAX );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_integer( e, NULL, 0 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_integer( e, NULL, -7 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_array_end( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	json_str = app_json_encode_dump( e );
+	assert_non_null( json_str );
+	assert_string_equal( json_str,
+		"[-9223372036854775808,9223372036854775807,0,-7]" );
+
+	app_json_encode_terminate( e );
+}
+
 static void test_app_json_encode_integer_null_item( void **state )
 {
 	iot_status_t result;
@@ -1977,6 +2196,36 @@ static void test_app_json_encode_real_inside_object_blank_key( void **state )
 	app_json_encode_terminate( e );
 }
 
+static void test_app_json_encode_real_non_finite( void **state )
+{
+#if !defined( IOT_JSON_JSONC )
+	app_json_encoder_t *e;
+	iot_status_t result;
+
+#if defined( IOT_STACK_ONLY )
+	char buffer[ 128u ];
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+#else /* if defined( IOT_STACK_ONLY ) */
+	will_return_always( __wrap_os_realloc, 1 );
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	/* JSON has no representation for infinity or NaN */
+	result = app_json_encode_real( e, NULL, HUGE_VAL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_encode_real( e, NULL, -HUGE_VAL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_encode_real( e, NULL, HUGE_VAL - HUGE_VAL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+
+	app_json_encode_terminate( e );
+#endif /* if !defined( IOT_JSON_JSONC ) */
+}
+
 static void test_app_json_encode_real_null_item( void **state )
 {
 	iot_status_t result;
@@ -2021,6 +2270,299 @@ static void test_app_json_encode_real_outside_object( void **state )
 	app_json_encode_terminate( e );
 }
 
+static void test_app_json_encode_real_round_trip( void **state )
+{
+	app_json_encoder_t *e;
+	const char *json_str;
+	const char *pos;
+	iot_status_t result;
+	unsigned int i;
+	uint64_t seed = 88172645463325252uLL;
+	clock_t start;
+	double elapsed;
+	const double edge[] = { 0.0, -0.0, 0.1, 0.3, 1e300, 5e-324,
+		DBL_MAX, DBL_MIN, 18446744073709551616.0, 9007199254740993.0,
+		1e21, 1e-7, -2131213.25, 2.2250738585072009e-308 };
+	const unsigned int edge_count = sizeof( edge ) / sizeof( double );
+	double values[ 1000u ];
+	const unsigned int value_count = sizeof( values ) / sizeof( double );
+	static char buffer[ 32768u ];
+
+	/* edge cases followed by random (finite) bit patterns */
+	for ( i = 0u; i < value_count; ++i )
+	{
+		if ( i < edge_count )
+			values[i] = edge[i];
+		else
+		{
+			do {
+				/* xorshift64 */
+				seed ^= seed << 13;
+				seed ^= seed >> 7;
+				seed ^= seed << 17;
+				memcpy( &values[i], &seed, sizeof( double ) );
+			} while ( values[i] - values[i] != 0.0 );
+		}
+	}
+
+#if defined( IOT_STACK_ONLY )
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+#else /* if defined( IOT_STACK_ONLY ) */
+	(void)buffer;
+#if defined( IOT_JSON_JSONC )
+	will_return( __wrap_os_malloc, 1 );
+#endif /* if defined( IOT_JSON_JSONC ) */
+	will_return_always( __wrap_os_realloc, 1 );
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+	start = clock();
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	for ( i = 0u; i < value_count; ++i )
+	{
+		result = app_json_encode_real( e, NULL, values[i] );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+	}
+	result = app_json_encode_array_end( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	json_str = app_json_encode_dump( e );
+	elapsed = (double)( clock() - start ) / CLOCKS_PER_SEC;
+	assert_non_null( json_str );
+
+	/* each value must read back exactly */
+	pos = json_str + 1;
+	for ( i = 0u; i < value_count; ++i )
+	{
+		char *end = NULL;
+		const double v = strtod( pos, &end );
+		assert_true( end != pos );
+		assert_memory_equal( &v, &values[i], sizeof( double ) );
+		pos = end;
+		while ( *pos == ',' || *pos == ' ' )
+			++pos;
+	}
+	assert_int_equal( *pos, ']' );
+	print_message( "[ BENCH    ] %u reals, %.0f reals/s\n", value_count,
+		elapsed > 0.0 ? (double)value_count / elapsed : 0.0 );
+
+	app_json_encode_terminate( e );
+}
+
+static void test_app_json_encode_real_shortest( void **state )
+{
+#if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
+	app_json_encoder_t *e;
+	const char *json_str;
+	iot_status_t result;
+	unsigned int i;
+	const double values[] = { 0.1, -0.0, 1e300, 5e-324, DBL_MAX,
+		18446744073709551616.0, 1e21, 1e20, 1e-7, 0.000001, 123456.789 };
+
+#if defined( IOT_STACK_ONLY )
+	char buffer[ 512u ];
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+#else /* if defined( IOT_STACK_ONLY ) */
+	will_return_always( __wrap_os_realloc, 1 );
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	for ( i = 0u; i < sizeof( values ) / sizeof( double ); ++i )
+	{
+		result = app_json_encode_real( e, NULL, values[i] );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+	}
+	result = app_json_encode_array_end( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	json_str = app_json_encode_dump( e );
+	assert_non_null( json_str );
+	assert_string_equal( json_str, "[0.1,-0.0,1e300,5e-324,"
+		"1.7976931348623157e308,18446744073709552000.0,1e21,"
+		"100000000000000000000.0,1e-7,0.000001,123456.789]" );
+
+	app_json_encode_terminate( e );
+#endif /* if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC ) */
+}
+
+static void test_app_json_encode_reserve_null_item( void **state )
+{
+	iot_status_t result;
+	result = app_json_encode_reserve( NULL, 64u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_app_json_encode_reserve_valid( void **state )
+{
+	app_json_encoder_t *e;
+	const char *json_str;
+	iot_status_t result;
+	unsigned int i;
+#if !defined( IOT_STACK_ONLY )
+	unsigned int count;
+#endif /* if !defined( IOT_STACK_ONLY ) */
+
+#if defined( IOT_STACK_ONLY )
+	char buffer[ 256u ];
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+#else /* if defined( IOT_STACK_ONLY ) */
+	app_json_allocation_set( &test_json_realloc_fn, &test_json_free_fn );
+	test_json_realloc_count = 0u;
+#if defined( IOT_JSON_JSONC )
+	will_return( __wrap_os_malloc, 1 );
+#endif /* if defined( IOT_JSON_JSONC ) */
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+#if defined( IOT_STACK_ONLY )
+	/* a fixed buffer can not be grown */
+	result = app_json_encode_reserve( e, 1024u );
+	assert_int_equal( result, IOT_STATUS_NO_MEMORY );
+#endif /* if defined( IOT_STACK_ONLY ) */
+	result = app_json_encode_reserve( e, 128u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+#if !defined( IOT_STACK_ONLY )
+	count = test_json_realloc_count;
+#endif /* if !defined( IOT_STACK_ONLY ) */
+
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	for ( i = 0u; i < 10u; ++i )
+	{
+		result = app_json_encode_integer( e, NULL, i );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+	}
+	result = app_json_encode_array_end( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+#if !defined( IOT_STACK_ONLY ) && \
+    !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
+	/* no allocations required after space was reserved */
+	assert_int_equal( test_json_realloc_count, count );
+#endif
+
+	json_str = app_json_encode_dump( e );
+	assert_non_null( json_str );
+	assert_string_equal( json_str, "[0,1,2,3,4,5,6,7,8,9]" );
+
+	app_json_encode_terminate( e );
+#if !defined( IOT_STACK_ONLY )
+	app_json_allocation_set( NULL, NULL );
+#endif /* if !defined( IOT_STACK_ONLY ) */
+}
+
+static void test_app_json_encode_sink_failure( void **state )
+{
+	app_json_encoder_t *e;
+	iot_status_t result;
+	iot_status_t sink_result = IOT_STATUS_IO_ERROR;
+	char buffer[ 256u ];
+	unsigned int i;
+
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+	assert_non_null( e );
+	result = app_json_encode_sink_set( e, test_sink, &sink_result );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	result = app_json_encode_array_start( e, "values" );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+#if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC )
+	/* the error is returned once the buffer must be drained */
+	for ( i = 0u; i < 100u && result == IOT_STATUS_SUCCESS; ++i )
+		result = app_json_encode_integer( e, NULL, 123456789 );
+	assert_int_equal( result, IOT_STATUS_IO_ERROR );
+#else /* if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC ) */
+	for ( i = 0u; i < 100u && result == IOT_STATUS_SUCCESS; ++i )
+		result = app_json_encode_integer( e, NULL, 123456789 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+#endif /* else if !defined( IOT_JSON_JANSSON ) && !defined( IOT_JSON_JSONC ) */
+	result = app_json_encode_flush( e );
+#if defined( IOT_JSON_JANSSON )
+	assert_int_equal( result, IOT_STATUS_FAILURE );
+#else /* if defined( IOT_JSON_JANSSON ) */
+	assert_int_equal( result, IOT_STATUS_IO_ERROR );
+#endif /* else if defined( IOT_JSON_JANSSON ) */
+	app_json_encode_terminate( e );
+}
+
+static void test_app_json_encode_sink_fixed_buffer( void **state )
+{
+	app_json_encoder_t *e;
+	const char *json_str;
+	iot_status_t result;
+	char buffer[ 192u ];
+	char expected[ 1024u ];
+	size_t len;
+	unsigned int i;
+
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+	assert_non_null( e );
+	test_sink_output_len = 0u;
+	result = app_json_encode_sink_set( e, test_sink, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	/* output is much larger than the fixed buffer */
+	result = app_json_encode_string( e, "name", "sensor" );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_array_start( e, "values" );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	strcpy( expected, "{\"name\":\"sensor\",\"values\":[" );
+	for ( i = 0u; i < 100u; ++i )
+	{
+		result = app_json_encode_integer( e, NULL, 1000 + i );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		len = strlen( expected );
+		snprintf( &expected[len], sizeof( expected ) - len,
+			"%s%u", ( i > 0u ? "," : "" ), 1000u + i );
+	}
+	strcat( expected, "]}" );
+
+	/* contents are only available through the sink */
+	json_str = app_json_encode_dump( e );
+	assert_null( json_str );
+
+	/* flush closes open arrays & objects */
+	result = app_json_encode_flush( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( test_sink_output_len, strlen( expected ) );
+	assert_string_equal( test_sink_output, expected );
+
+	/* encoder can be reused for the next document */
+	test_sink_output_len = 0u;
+	result = app_json_encode_integer( e, "a", 1 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_flush( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( test_sink_output, "{\"a\":1}" );
+	app_json_encode_terminate( e );
+}
+
+static void test_app_json_encode_sink_null_item( void **state )
+{
+	iot_status_t result;
+	result = app_json_encode_sink_set( NULL, test_sink, NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_app_json_encode_sink_set_mid_document( void **state )
+{
+	app_json_encoder_t *e;
+	iot_status_t result;
+	char buffer[ 256u ];
+
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+	assert_non_null( e );
+	result = app_json_encode_integer( e, "a", 1 );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_sink_set( e, test_sink, NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_REQUEST );
+	app_json_encode_terminate( e );
+}
+
 static void test_app_json_encode_string_as_root_item( void **state )
 {
 	app_json_encoder_t *e;
@@ -2070,6 +2612,71 @@ static void test_app_json_encode_string_escape_chars( void **state )
 }
 
 
+static void test_app_json_encode_string_escape_long( void **state )
+{
+	app_json_encoder_t *e;
+	const char *json_str;
+	iot_status_t result;
+	char value[ 101u ];
+	char expected[ 128u ];
+	size_t i;
+	size_t j = 0u;
+	/* escapes on either side of 8, 16 & 32 character blocks */
+	const size_t escape_at[] = { 0u, 7u, 8u, 15u, 16u, 31u, 32u, 63u,
+		64u, 99u };
+	const char escape_in[] = "\"\\\n\t\r\b\f\"\\\n";
+	const char escape_out[] = "\"\\ntrbf\"\\n";
+#if defined( IOT_STACK_ONLY )
+	char buffer[ 256u ];
+#endif /* if defined( IOT_STACK_ONLY ) */
+
+	for ( i = 0u; i < sizeof( value ) - 1u; ++i )
+		value[i] = (char)( 'a' + ( i % 26u ) );
+	value[sizeof( value ) - 1u] = '\0';
+	for ( i = 0u; i < sizeof( escape_at ) / sizeof( size_t ); ++i )
+		value[escape_at[i]] = escape_in[i];
+
+	expected[j++] = '[';
+	expected[j++] = '"';
+	for ( i = 0u; i < sizeof( value ) - 1u; ++i )
+	{
+		const char *const c = strchr( escape_in, value[i] );
+		if ( c )
+		{
+			expected[j++] = '\\';
+			expected[j++] = escape_out[c - escape_in];
+		}
+		else
+			expected[j++] = value[i];
+	}
+	expected[j++] = '"';
+	expected[j++] = ']';
+	expected[j] = '\0';
+
+#if defined( IOT_STACK_ONLY )
+	e = app_json_encode_initialize( buffer, sizeof( buffer ), 0u );
+#else /* if defined( IOT_STACK_ONLY ) */
+#if defined( IOT_JSON_JSONC )
+	will_return( __wrap_os_malloc, 1 );
+#endif /* if defined( IOT_JSON_JSONC ) */
+	will_return_always( __wrap_os_realloc, 1 );
+	e = app_json_encode_initialize( NULL, 0u, APP_JSON_FLAG_DYNAMIC );
+#endif /* else if defined( IOT_STACK_ONLY ) */
+	assert_non_null( e );
+
+	result = app_json_encode_array_start( e, NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_string( e, NULL, value );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_encode_array_end( e );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	json_str = app_json_encode_dump( e );
+	assert_non_null( json_str );
+	assert_string_equal( json_str, expected );
+	app_json_encode_terminate( e );
+}
+
 static void test_app_json_encode_string_inside_array_null_key( void **state )
 {
 	app_json_encoder_t *e;
@@ -2284,6 +2891,8 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_app_json_encode_bool_inside_object_blank_key ),
 		cmocka_unit_test( test_app_json_encode_bool_null_item ),
 		cmocka_unit_test( test_app_json_encode_bool_outside_object ),
+		cmocka_unit_test( test_app_json_encode_flush_no_sink ),
+		cmocka_unit_test( test_app_json_encode_flush_null_item ),
 		cmocka_unit_test( test_app_json_encode_initialize_null ),
 		cmocka_unit_test( test_app_json_encode_initialize_too_small ),
 		cmocka_unit_test( test_app_json_encode_initialize_valid ),
@@ -2299,11 +2908,15 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_app_json_encode_dump_indent_5 ),
 #endif /* if !defined( IOT_JSON_JSONC ) */
 		cmocka_unit_test( test_app_json_encode_dump_indent_expand ),
+		cmocka_unit_test( test_app_json_encode_estimate_compact ),
+		cmocka_unit_test( test_app_json_encode_estimate_expand ),
+		cmocka_unit_test( test_app_json_encode_growth_allocations ),
 		cmocka_unit_test( test_app_json_encode_integer_as_root_item ),
 		cmocka_unit_test( test_app_json_encode_integer_inside_array_null_key ),
 		cmocka_unit_test( test_app_json_encode_integer_inside_array_valid_key ),
 		cmocka_unit_test( test_app_json_encode_integer_inside_object ),
 		cmocka_unit_test( test_app_json_encode_integer_inside_object_blank_key ),
+		cmocka_unit_test( test_app_json_encode_integer_limits ),
 		cmocka_unit_test( test_app_json_encode_integer_null_item ),
 		cmocka_unit_test( test_app_json_encode_integer_outside_object ),
 		cmocka_unit_test( test_app_json_encode_object_cancel_at_root ),
@@ -2334,10 +2947,20 @@ int main( int argc, char *argv[] )
 		cmocka_unit_test( test_app_json_encode_real_inside_array_valid_key ),
 		cmocka_unit_test( test_app_json_encode_real_inside_object ),
 		cmocka_unit_test( test_app_json_encode_real_inside_object_blank_key ),
+		cmocka_unit_test( test_app_json_encode_real_non_finite ),
 		cmocka_unit_test( test_app_json_encode_real_null_item ),
 		cmocka_unit_test( test_app_json_encode_real_outside_object ),
+		cmocka_unit_test( test_app_json_encode_real_round_trip ),
+		cmocka_unit_test( test_app_json_encode_real_shortest ),
+		cmocka_unit_test( test_app_json_encode_reserve_null_item ),
+		cmocka_unit_test( test_app_json_encode_reserve_valid ),
+		cmocka_unit_test( test_app_json_encode_sink_failure ),
+		cmocka_unit_test( test_app_json_encode_sink_fixed_buffer ),
+		cmocka_unit_test( test_app_json_encode_sink_null_item ),
+		cmocka_unit_test( test_app_json_encode_sink_set_mid_document ),
 		cmocka_unit_test( test_app_json_encode_string_as_root_item ),
 		cmocka_unit_test( test_app_json_encode_string_escape_chars ),
+		cmocka_unit_test( test_app_json_encode_string_escape_long ),
 		cmocka_unit_test( test_app_json_encode_string_inside_array_null_key ),
 		cmocka_unit_test( test_app_json_encode_string_inside_array_valid_key ),
 		cmocka_unit_test( test_app_json_encode_string_inside_object ),
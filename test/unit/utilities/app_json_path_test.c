@@ -0,0 +1,403 @@
+/**
+ * @file
+ * @brief unit testing for IoT library (json path support)
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "test_support.h"
+
+#include "utilities/app_json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Reply to a mailbox check used by the tests */
+static const char *const PATH_TEST_JSON =
+	"{"
+	"\"success\":true,"
+	"\"params\":{"
+		"\"messages\":["
+			"{\"id\":\"a1\",\"params\":{\"method\":\"reboot\","
+				"\"params\":{\"delay\":5}}},"
+			"{\"id\":\"b2\",\"params\":{\"method\":\"update\","
+				"\"params\":{\"url\":\"x\"}}},"
+			"{\"id\":\"c3\",\"params\":{\"method\":\"ping\"}}"
+		"]"
+	"}"
+	"}";
+
+/** @brief Strings matched, separated by ',' */
+static char path_matches[256u];
+
+/**
+ * @brief Records the string value of each item matched ("?" for items that
+ *        are not strings)
+ *
+ * @param[in]      user_data           value to return (if not NULL)
+ * @param[in]      decoder             JSON decoder object
+ * @param[in]      item                item matched
+ *
+ * @return the value pointed to by @p user_data, or IOT_STATUS_SUCCESS
+ */
+static iot_status_t path_test_callback(
+	void *user_data,
+	const app_json_decoder_t *decoder,
+	const app_json_item_t *item )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	const char *value = "?";
+	size_t value_len = 1u;
+	size_t len = strlen( path_matches );
+
+	if ( app_json_decode_type( decoder, item ) == APP_JSON_TYPE_STRING )
+		app_json_decode_string( decoder, item, &value, &value_len );
+	snprintf( &path_matches[len], sizeof( path_matches ) - len, "%s%.*s",
+		( len > 0u ? "," : "" ), (int)value_len, value );
+	if ( user_data )
+		result = *(iot_status_t *)user_data;
+	return result;
+}
+
+#if !defined( IOT_STACK_ONLY )
+static void test_app_json_path_compile_dynamic( void **state )
+{
+	app_json_path_t *path;
+	will_return( __wrap_os_realloc, 1 );
+	path = app_json_path_compile( NULL, 0u, APP_JSON_FLAG_DYNAMIC,
+		"params.messages[*].params.method" );
+	assert_non_null( path );
+	app_json_path_terminate( path );
+}
+#endif /* if !defined( IOT_STACK_ONLY ) */
+
+static void test_app_json_path_compile_invalid( void **state )
+{
+	char buf[256u];
+	const char *const invalid[] = {
+		".a", "a.", "a..b", "a[", "a[]", "a[x]", "a[1", "a[1]b",
+		"a[*", NULL };
+	size_t i;
+
+	for ( i = 0u; invalid[i]; ++i )
+		assert_null( app_json_path_compile( buf, sizeof( buf ), 0u,
+			invalid[i] ) );
+	assert_null( app_json_path_compile( buf, sizeof( buf ), 0u, NULL ) );
+}
+
+static void test_app_json_path_compile_small_buffer( void **state )
+{
+	char buf[16u];
+	assert_null( app_json_path_compile( buf, sizeof( buf ), 0u,
+		"params.messages[*].params.method" ) );
+}
+
+static void test_app_json_path_compile_valid( void **state )
+{
+	char buf[256u];
+	const char *const valid[] = {
+		"", "a", "a.b", "[0]", "[*]", "*", "a[2].b", "a[*][1].*",
+		"a\\.b", "a\\[0]", NULL };
+	size_t i;
+
+	for ( i = 0u; valid[i]; ++i )
+	{
+		app_json_path_t *const path = app_json_path_compile( buf,
+			sizeof( buf ), 0u, valid[i] );
+		assert_non_null( path );
+		app_json_path_terminate( path );
+	}
+}
+
+static void test_app_json_path_extract_null_parameters( void **state )
+{
+	char buf[256u];
+	char dec_buf[1024u];
+	const app_json_item_t *out[1u];
+	const app_json_path_t *paths[1u];
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+	paths[0] = app_json_path_compile( buf, sizeof( buf ), 0u, "a" );
+	assert_non_null( paths[0] );
+
+	result = app_json_path_extract( NULL, NULL, paths, 1u, out );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_extract( decoder, NULL, NULL, 1u, out );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_extract( decoder, NULL, paths, 1u, NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_extract( decoder, NULL, paths, 0u, out );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_extract( decoder, NULL, paths,
+		APP_JSON_PATH_MAX + 1u, out );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	app_json_decode_terminate( decoder );
+}
+
+static void test_app_json_path_extract_single( void **state )
+{
+	char buf[256u];
+	char dec_buf[2048u];
+	const app_json_item_t *out[1u];
+	const app_json_path_t *paths[1u];
+	const app_json_item_t *root = NULL;
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+	const char *value = NULL;
+	size_t value_len = 0u;
+
+	/* a single path uses a direct look up of each key, which is given
+	 * by length (the key in the path is not nul-terminated) */
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, PATH_TEST_JSON,
+		strlen( PATH_TEST_JSON ), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	paths[0] = app_json_path_compile( buf, sizeof( buf ), 0u,
+		"params.messages[2].params.method" );
+	assert_non_null( paths[0] );
+	result = app_json_path_extract( decoder, root, paths, 1u, out );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_non_null( out[0] );
+	app_json_decode_string( decoder, out[0], &value, &value_len );
+	assert_int_equal( value_len, 4u );
+	assert_memory_equal( value, "ping", 4u );
+
+	/* a prefix of a key does not match it */
+	paths[0] = app_json_path_compile( buf, sizeof( buf ), 0u, "param" );
+	assert_non_null( paths[0] );
+	result = app_json_path_extract( decoder, root, paths, 1u, out );
+	assert_int_equal( result, IOT_STATUS_NOT_FOUND );
+	assert_null( out[0] );
+	app_json_decode_terminate( decoder );
+}
+
+static void test_app_json_path_extract_valid( void **state )
+{
+	char buf[4u][256u];
+	char dec_buf[2048u];
+	const char *const expr[4u] = {
+		"params.messages[1].id",
+		"params.messages[0].params.method",
+		"success",
+		"params.messages[2].params.params" };
+	const app_json_item_t *out[4u];
+	const app_json_path_t *paths[4u];
+	const app_json_item_t *root = NULL;
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+	iot_bool_t success = IOT_FALSE;
+	const char *value = NULL;
+	size_t value_len = 0u;
+	size_t i;
+
+	for ( i = 0u; i < 4u; ++i )
+	{
+		paths[i] = app_json_path_compile( buf[i], sizeof( buf[i] ), 0u,
+			expr[i] );
+		assert_non_null( paths[i] );
+	}
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, PATH_TEST_JSON,
+		strlen( PATH_TEST_JSON ), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	/* last message has no parameters */
+	result = app_json_path_extract( decoder, root, paths, 4u, out );
+	assert_int_equal( result, IOT_STATUS_NOT_FOUND );
+	assert_non_null( out[0] );
+	app_json_decode_string( decoder, out[0], &value, &value_len );
+	assert_int_equal( value_len, 2u );
+	assert_memory_equal( value, "b2", 2u );
+	assert_non_null( out[1] );
+	app_json_decode_string( decoder, out[1], &value, &value_len );
+	assert_int_equal( value_len, 6u );
+	assert_memory_equal( value, "reboot", 6u );
+	assert_non_null( out[2] );
+	app_json_decode_bool( decoder, out[2], &success );
+	assert_int_equal( success, IOT_TRUE );
+	assert_null( out[3] );
+
+	/* paths that are NULL are skipped */
+	paths[3] = NULL;
+	result = app_json_path_extract( decoder, root, paths, 4u, out );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_non_null( out[0] );
+	assert_null( out[3] );
+	app_json_decode_terminate( decoder );
+}
+
+static void test_app_json_path_match_callback_failure( void **state )
+{
+	char buf[256u];
+	char dec_buf[2048u];
+	const app_json_path_t *path;
+	const app_json_item_t *root = NULL;
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+	iot_status_t cb_result = IOT_STATUS_FAILURE;
+
+	path = app_json_path_compile( buf, sizeof( buf ), 0u,
+		"params.messages[*].id" );
+	assert_non_null( path );
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, PATH_TEST_JSON,
+		strlen( PATH_TEST_JSON ), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	/* matching stops at the first failure */
+	path_matches[0] = '\0';
+	result = app_json_path_match( decoder, root, path, path_test_callback,
+		&cb_result );
+	assert_int_equal( result, IOT_STATUS_FAILURE );
+	assert_string_equal( path_matches, "a1" );
+	app_json_decode_terminate( decoder );
+}
+
+static void test_app_json_path_match_escaped_key( void **state )
+{
+	char buf[256u];
+	char dec_buf[512u];
+	const char *const json = "{\"a.b\":{\"c[0]\":\"x\",\"c\":[\"y\"]}}";
+	const app_json_path_t *path;
+	const app_json_item_t *root = NULL;
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+
+	path = app_json_path_compile( buf, sizeof( buf ), 0u, "a\\.b.c\\[0]" );
+	assert_non_null( path );
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, json, strlen( json ), &root,
+		NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	path_matches[0] = '\0';
+	result = app_json_path_match( decoder, root, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( path_matches, "x" );
+	app_json_decode_terminate( decoder );
+}
+
+static void test_app_json_path_match_null_parameters( void **state )
+{
+	char buf[256u];
+	char dec_buf[512u];
+	const app_json_path_t *path;
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+
+	path = app_json_path_compile( buf, sizeof( buf ), 0u, "a" );
+	assert_non_null( path );
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+
+	result = app_json_path_match( NULL, NULL, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_match( decoder, NULL, NULL, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_match( decoder, NULL, path, NULL, NULL );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+	result = app_json_path_match( decoder, NULL, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_NOT_FOUND );
+	app_json_decode_terminate( decoder );
+}
+
+static void test_app_json_path_match_wildcards( void **state )
+{
+	char buf[256u];
+	char dec_buf[2048u];
+	const app_json_path_t *path;
+	const app_json_item_t *root = NULL;
+	app_json_decoder_t *decoder;
+	iot_status_t result;
+
+	decoder = app_json_decode_initialize( dec_buf, sizeof( dec_buf ), 0u );
+	assert_non_null( decoder );
+	result = app_json_decode_parse( decoder, PATH_TEST_JSON,
+		strlen( PATH_TEST_JSON ), &root, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+
+	/* every array element */
+	path = app_json_path_compile( buf, sizeof( buf ), 0u,
+		"params.messages[*].params.method" );
+	assert_non_null( path );
+	path_matches[0] = '\0';
+	result = app_json_path_match( decoder, root, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( path_matches, "reboot,update,ping" );
+
+	/* every object member */
+	path = app_json_path_compile( buf, sizeof( buf ), 0u,
+		"params.messages[*].*" );
+	assert_non_null( path );
+	path_matches[0] = '\0';
+	result = app_json_path_match( decoder, root, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( path_matches, "a1,?,b2,?,c3,?" );
+
+	/* an array index does not select object members */
+	path = app_json_path_compile( buf, sizeof( buf ), 0u, "params[*]" );
+	assert_non_null( path );
+	path_matches[0] = '\0';
+	result = app_json_path_match( decoder, root, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_NOT_FOUND );
+	assert_string_equal( path_matches, "" );
+
+	/* an empty path selects the item itself */
+	path = app_json_path_compile( buf, sizeof( buf ), 0u, "" );
+	assert_non_null( path );
+	path_matches[0] = '\0';
+	result = app_json_path_match( decoder, root, path, path_test_callback,
+		NULL );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( path_matches, "?" );
+	app_json_decode_terminate( decoder );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+#if !defined( IOT_STACK_ONLY )
+		cmocka_unit_test( test_app_json_path_compile_dynamic ),
+#endif /* if !defined( IOT_STACK_ONLY ) */
+		cmocka_unit_test( test_app_json_path_compile_invalid ),
+		cmocka_unit_test( test_app_json_path_compile_small_buffer ),
+		cmocka_unit_test( test_app_json_path_compile_valid ),
+		cmocka_unit_test( test_app_json_path_extract_null_parameters ),
+		cmocka_unit_test( test_app_json_path_extract_single ),
+		cmocka_unit_test( test_app_json_path_extract_valid ),
+		cmocka_unit_test( test_app_json_path_match_callback_failure ),
+		cmocka_unit_test( test_app_json_path_match_escaped_key ),
+		cmocka_unit_test( test_app_json_path_match_null_parameters ),
+		cmocka_unit_test( test_app_json_path_match_wildcards ),
+	};
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file
+ * @brief unit testing for IoT library (json schema support)
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "test_support.h"
+
+#include "utilities/app_json_schema.h"
+
+#include <string.h>
+
+/** @brief Schema used by the tests */
+static const char *const SCHEMA_TEST_JSON =
+	"{"
+	"\"type\":\"object\","
+	"\"required\":[\"host\"],"
+	"\"properties\":{"
+		"\"host\":{\"type\":\"string\",\"minLength\":3,\"maxLength\":8},"
+		"\"port\":{\"type\":\"integer\",\"minimum\":1,\"maximum\":1024,"
+			"\"exclusiveMaximum\":true,\"multipleOf\":2},"
+		"\"ratio\":{\"type\":\"number\",\"minimum\":0.5,\"maximum\":2.5,"
+			"\"exclusiveMinimum\":true},"
+		"\"mode\":{\"type\":\"string\",\"enum\":[\"fast\",\"slow\"]},"
+		"\"level\":{\"type\":\"integer\",\"multipleOf\":\"two\"},"
+		"\"enabled\":{\"type\":\"boolean\"}"
+	"}"
+	"}";
+
+#if !defined( IOT_STACK_ONLY )
+/**
+ * @brief Parses the test schema and returns the item for a property
+ *
+ * @param[out]     schema              parsed schema
+ * @param[in]      key                 name of the property to return
+ *
+ * @return the item in the schema for the property
+ */
+static app_json_schema_item_t *schema_test_property(
+	app_json_schema_t **schema,
+	const char *key )
+{
+	app_json_schema_item_t *root = NULL;
+	app_json_schema_item_t *result = NULL;
+	app_json_schema_object_iterator_t *iter;
+	iot_status_t status;
+
+	*schema = app_json_schema_initialize( NULL, 0u,
+		APP_JSON_FLAG_DYNAMIC );
+	assert_non_null( *schema );
+	status = app_json_schema_parse( *schema, SCHEMA_TEST_JSON,
+		strlen( SCHEMA_TEST_JSON ), &root, NULL, 0u );
+	assert_int_equal( status, IOT_STATUS_SUCCESS );
+	assert_non_null( root );
+
+	iter = app_json_schema_object_iterator( *schema, root );
+	while ( !result && iter )
+	{
+		const char *k = NULL;
+		size_t k_len = 0u;
+		app_json_schema_object_iterator_key( *schema, root, iter,
+			&k, &k_len );
+		if ( k_len == strlen( key ) && strncmp( k, key, k_len ) == 0 )
+			app_json_schema_object_iterator_value( *schema, root,
+				iter, &result );
+		iter = app_json_schema_object_iterator_next( *schema, root,
+			iter );
+	}
+	assert_non_null( result );
+	return result;
+}
+
+static void test_app_json_schema_integer_bounds( void **state )
+{
+	app_json_schema_t *schema = NULL;
+	app_json_schema_item_t *item;
+	const char *error_msg = NULL;
+
+	will_return_always( __wrap_os_realloc, 1 );
+	item = schema_test_property( &schema, "port" );
+	assert_int_equal( app_json_schema_type( schema, item ),
+		APP_JSON_TYPE_INTEGER );
+	assert_int_equal( app_json_schema_required( schema, item ), IOT_FALSE );
+
+	assert_int_equal( app_json_schema_integer( schema, item, "22", 2u,
+		&error_msg ), IOT_TRUE );
+	assert_int_equal( app_json_schema_integer( schema, item, "1022", 4u,
+		&error_msg ), IOT_TRUE );
+	assert_int_equal( app_json_schema_integer( schema, item, "1024", 4u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "value is greater than maximum" );
+	assert_int_equal( app_json_schema_integer( schema, item, "-2", 2u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "value is less than minimum" );
+	assert_int_equal( app_json_schema_integer( schema, item, "21", 2u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "value is not a valid multiple" );
+	assert_int_equal( app_json_schema_integer( schema, item, "2a", 2u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "invalid number" );
+	/* not required */
+	assert_int_equal( app_json_schema_integer( schema, item, "", 0u,
+		&error_msg ), IOT_TRUE );
+	app_json_schema_terminate( schema );
+}
+
+static void test_app_json_schema_invalid_keyword( void **state )
+{
+	app_json_schema_t *schema = NULL;
+	app_json_schema_item_t *item;
+	const char *error_msg = NULL;
+
+	will_return_always( __wrap_os_realloc, 1 );
+	item = schema_test_property( &schema, "level" );
+	assert_int_equal( app_json_schema_integer( schema, item, "3", 1u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "invalid 'multipleOf' value" );
+	app_json_schema_terminate( schema );
+}
+
+static void test_app_json_schema_real_bounds( void **state )
+{
+	app_json_schema_t *schema = NULL;
+	app_json_schema_item_t *item;
+	const char *error_msg = NULL;
+
+	will_return_always( __wrap_os_realloc, 1 );
+	item = schema_test_property( &schema, "ratio" );
+	assert_int_equal( app_json_schema_type( schema, item ),
+		APP_JSON_TYPE_REAL );
+	assert_int_equal( app_json_schema_real( schema, item, "2.5", 3u,
+		&error_msg ), IOT_TRUE );
+	assert_int_equal( app_json_schema_real( schema, item, "2.75", 4u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "value is greater than maximum" );
+	assert_int_equal( app_json_schema_real( schema, item, "0.5", 3u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "value is less than minimum" );
+	app_json_schema_terminate( schema );
+}
+
+static void test_app_json_schema_string_enum( void **state )
+{
+	app_json_schema_t *schema = NULL;
+	app_json_schema_item_t *item;
+	const char *error_msg = NULL;
+
+	will_return_always( __wrap_os_realloc, 1 );
+	item = schema_test_property( &schema, "mode" );
+	assert_int_equal( app_json_schema_string( schema, item, "slow", 4u,
+		&error_msg ), IOT_TRUE );
+	assert_int_equal( app_json_schema_string( schema, item, "none", 4u,
+		&error_msg ), IOT_FALSE );
+	assert_non_null( error_msg );
+	assert_memory_equal( error_msg, "value not in accepted list",
+		strlen( "value not in accepted list" ) );
+	app_json_schema_terminate( schema );
+}
+
+static void test_app_json_schema_string_length( void **state )
+{
+	app_json_schema_t *schema = NULL;
+	app_json_schema_item_t *item;
+	const char *error_msg = NULL;
+
+	will_return_always( __wrap_os_realloc, 1 );
+	item = schema_test_property( &schema, "host" );
+	assert_int_equal( app_json_schema_required( schema, item ), IOT_TRUE );
+	assert_int_equal( app_json_schema_string( schema, item, "abc", 3u,
+		&error_msg ), IOT_TRUE );
+	assert_int_equal( app_json_schema_string( schema, item, "ab", 2u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "string is too short" );
+	assert_int_equal( app_json_schema_string( schema, item, "abcdefghi", 9u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "string is too long" );
+	assert_int_equal( app_json_schema_string( schema, item, "", 0u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "value is required" );
+	/* wrong type of item */
+	assert_int_equal( app_json_schema_integer( schema, item, "5", 1u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "invalid object" );
+	app_json_schema_terminate( schema );
+}
+#endif /* if !defined( IOT_STACK_ONLY ) */
+
+static void test_app_json_schema_null_parameters( void **state )
+{
+	const char *error_msg = NULL;
+
+	assert_int_equal( app_json_schema_type( NULL, NULL ),
+		APP_JSON_TYPE_NULL );
+	assert_int_equal( app_json_schema_integer( NULL, NULL, "1", 1u,
+		&error_msg ), IOT_FALSE );
+	assert_string_equal( error_msg, "invalid object" );
+	assert_null( app_json_schema_object_iterator( NULL, NULL ) );
+}
+
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+#if !defined( IOT_STACK_ONLY )
+		cmocka_unit_test( test_app_json_schema_integer_bounds ),
+		cmocka_unit_test( test_app_json_schema_invalid_keyword ),
+		cmocka_unit_test( test_app_json_schema_real_bounds ),
+		cmocka_unit_test( test_app_json_schema_string_enum ),
+		cmocka_unit_test( test_app_json_schema_string_length ),
+#endif /* if !defined( IOT_STACK_ONLY ) */
+		cmocka_unit_test( test_app_json_schema_null_parameters ),
+	};
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}
@@ -0,0 +1,397 @@
+/**
+ * @file
+ * @brief unit testing for IoT library (json streaming support)
+ *
+ * @copyright Copyright (C) 2018 Wind River Systems, Inc. All Rights Reserved.
+ *
+ * @license Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed
+ * under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES
+ * OR CONDITIONS OF ANY KIND, either express or implied."
+ */
+
+#include "test_support.h"
+
+#include "utilities/app_json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/** @brief Events reported by the stream, one per line */
+static char stream_events[1024u];
+/** @brief Amount of text in @c stream_events */
+static size_t stream_events_len;
+
+/**
+ * @brief Records the events reported while streaming
+ *
+ * Each event is written as "<event>/<type>/<depth>/<key>=<value>"
+ *
+ * @param[in]      user_data           value to return (if not NULL)
+ * @param[in]      event               event being reported
+ * @param[in]      type                type of the item
+ * @param[in]      depth               depth of the item
+ * @param[in]      key                 key of the item (optional)
+ * @param[in]      key_len             length of the key
+ * @param[in]      value               text of the value (optional)
+ * @param[in]      value_len           length of the value text
+ *
+ * @return IOT_STATUS_SUCCESS, or the status pointed to by @c user_data
+ */
+static iot_status_t test_app_json_stream_event(
+	void *user_data,
+	app_json_stream_event_t event,
+	app_json_type_t type,
+	unsigned int depth,
+	const char *key,
+	size_t key_len,
+	const char *value,
+	size_t value_len );
+
+iot_status_t test_app_json_stream_event(
+	void *user_data,
+	app_json_stream_event_t event,
+	app_json_type_t type,
+	unsigned int depth,
+	const char *key,
+	size_t key_len,
+	const char *value,
+	size_t value_len )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	if ( user_data )
+		result = *(const iot_status_t *)user_data;
+	if ( !key )
+		key_len = 0u;
+	if ( !value )
+		value_len = 0u;
+	stream_events_len += (size_t)snprintf(
+		&stream_events[stream_events_len],
+		sizeof( stream_events ) - stream_events_len,
+		"%d/%d/%u/%.*s=%.*s\n", (int)event, (int)type, depth,
+		(int)key_len, key ? key : "",
+		(int)value_len, value ? value : "" );
+	return result;
+}
+
+/**
+ * @brief Streams a document to a decoder in chunks of a given size
+ *
+ * @param[in,out]  stream              streaming decoder
+ * @param[in]      js                  document to stream
+ * @param[in]      chunk               size of each chunk
+ *
+ * @return the result of the first call that fails, or of finishing
+ */
+static iot_status_t test_app_json_stream_chunks(
+	app_json_stream_t *stream,
+	const char *js,
+	size_t chunk );
+
+iot_status_t test_app_json_stream_chunks(
+	app_json_stream_t *stream,
+	const char *js,
+	size_t chunk )
+{
+	iot_status_t result = IOT_STATUS_SUCCESS;
+	const size_t len = strlen( js );
+	size_t i;
+
+	stream_events_len = 0u;
+	*stream_events = '\0';
+	for ( i = 0u; i < len && result == IOT_STATUS_SUCCESS; i += chunk )
+	{
+		size_t cur = len - i;
+		if ( cur > chunk )
+			cur = chunk;
+		result = app_json_stream_parse( stream, &js[i], cur, NULL, 0u );
+	}
+	if ( result == IOT_STATUS_SUCCESS )
+		result = app_json_stream_finish( stream, NULL, 0u );
+	else
+		app_json_stream_finish( stream, NULL, 0u );
+	return result;
+}
+
+static void test_app_json_stream_finish_incomplete( void **state )
+{
+	char buf[512u];
+	char err[64u];
+	app_json_stream_t *stream;
+	iot_status_t result;
+
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	result = app_json_stream_parse( stream, "{\"a\":[1,", 8u, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	result = app_json_stream_finish( stream, err, 64u );
+	assert_int_equal( result, IOT_STATUS_PARSE_ERROR );
+	assert_non_null( strstr( err, "incomplete" ) );
+
+	/* stream can be reused once finished */
+	result = test_app_json_stream_chunks( stream, "[true]", 1u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( stream_events,
+		"1/1/0/=\n0/4/1/=true\n2/1/0/=\n" );
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_finish_null_stream( void **state )
+{
+	iot_status_t result;
+	result = app_json_stream_finish( NULL, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+static void test_app_json_stream_finish_root_number( void **state )
+{
+	char buf[512u];
+	app_json_stream_t *stream;
+	iot_status_t result;
+
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	/* a number at the root is only complete once finished */
+	result = test_app_json_stream_chunks( stream, "-12.5e3", 2u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_string_equal( stream_events, "0/16/0/=-12.5e3\n" );
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_initialize_dynamic( void **state )
+{
+	app_json_stream_t *stream;
+#ifndef IOT_STACK_ONLY
+	char js[512u];
+	iot_status_t result;
+	size_t i;
+	will_return_always( __wrap_os_realloc, 1 );
+#endif
+
+#ifdef IOT_STACK_ONLY
+	stream = app_json_stream_initialize( NULL, 0u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_null( stream );
+#else
+	/* value longer than the initial space, split across chunks */
+	js[0] = '"';
+	for ( i = 1u; i < 301u; ++i )
+		js[i] = (char)( 'a' + ( i % 26u ) );
+	js[301] = '"';
+	js[302] = '\0';
+
+	stream = app_json_stream_initialize( NULL, 0u,
+		APP_JSON_FLAG_DYNAMIC, test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	result = test_app_json_stream_chunks( stream, js, 7u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	assert_int_equal( stream_events_len, 300u + 9u );
+	assert_memory_equal( &stream_events[8], &js[1], 300u );
+	app_json_stream_terminate( stream );
+#endif
+}
+
+static void test_app_json_stream_initialize_null_callback( void **state )
+{
+	char buf[512u];
+	app_json_stream_t *stream;
+	stream = app_json_stream_initialize( buf, 512u, 0u, NULL, NULL );
+	assert_null( stream );
+}
+
+static void test_app_json_stream_initialize_small_buffer( void **state )
+{
+	char buf[8u];
+	app_json_stream_t *stream;
+	stream = app_json_stream_initialize( buf, 8u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_null( stream );
+}
+
+static void test_app_json_stream_parse_callback_failure( void **state )
+{
+	char buf[512u];
+	app_json_stream_t *stream;
+	iot_status_t result;
+	iot_status_t stop = IOT_STATUS_FULL;
+
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, &stop );
+	assert_non_null( stream );
+	result = test_app_json_stream_chunks( stream, "[1,2,3]", 16u );
+	assert_int_equal( result, IOT_STATUS_FULL );
+	assert_string_equal( stream_events, "1/1/0/=\n" );
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_parse_chunks( void **state )
+{
+	const char *const js =
+		" {\"cloud\": {\"host\": \"api.example.com\", \"port\": 8883},"
+		" \"list\": [null, false, -0.25, [], {}],"
+		" \"empty\": {} } ";
+	const char *const expected =
+		"1/2/0/=\n"
+		"1/2/1/cloud=\n"
+		"0/32/2/host=api.example.com\n"
+		"0/8/2/port=8883\n"
+		"2/2/1/=\n"
+		"1/1/1/list=\n"
+		"0/0/2/=null\n"
+		"0/4/2/=false\n"
+		"0/16/2/=-0.25\n"
+		"1/1/2/=\n"
+		"2/1/2/=\n"
+		"1/2/2/=\n"
+		"2/2/2/=\n"
+		"2/1/1/=\n"
+		"1/2/1/empty=\n"
+		"2/2/1/=\n"
+		"2/2/0/=\n";
+	char buf[512u];
+	app_json_stream_t *stream;
+	size_t chunk;
+
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	/* events do not depend on how the document is split */
+	for ( chunk = 1u; chunk <= 17u; ++chunk )
+	{
+		iot_status_t result;
+		result = test_app_json_stream_chunks( stream, js, chunk );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		assert_string_equal( stream_events, expected );
+	}
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_parse_depth( void **state )
+{
+	char buf[512u];
+	char js[128u];
+	char err[64u];
+	app_json_stream_t *stream;
+	iot_status_t result;
+
+	memset( js, '[', 127u );
+	js[127] = '\0';
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	stream_events_len = 0u;
+	result = app_json_stream_parse( stream, js, 127u, err, 64u );
+	assert_int_equal( result, IOT_STATUS_PARSE_ERROR );
+	assert_non_null( strstr( err, "depth" ) );
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_parse_escapes( void **state )
+{
+	char buf[512u];
+	app_json_stream_t *stream;
+	iot_status_t result;
+	size_t chunk;
+
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	for ( chunk = 1u; chunk <= 8u; ++chunk )
+	{
+		result = test_app_json_stream_chunks( stream,
+			"{\"k\\u0065y\":\"a\\\"b\\\\c\\/d\\te\\u00e9"
+			"\\ud83d\\ude00\"}", chunk );
+		assert_int_equal( result, IOT_STATUS_SUCCESS );
+		assert_string_equal( stream_events,
+			"1/2/0/=\n"
+			"0/32/1/key=a\"b\\c/d\te\xc3\xa9\xf0\x9f\x98\x80\n"
+			"2/2/0/=\n" );
+	}
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_parse_invalid( void **state )
+{
+	const char *const invalid[] = {
+		"{\"a\" 1}", "[1,]", "{\"a\":1,}", "[01]", "[1.]", "[-]",
+		"[1e]", "[tru]", "[nulls]", "[\"\\x\"]", "[\"\\ud800\"]",
+		"{]", "[1]x", "\"\x01\""
+	};
+	char buf[512u];
+	app_json_stream_t *stream;
+	size_t i;
+
+	stream = app_json_stream_initialize( buf, 512u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	for ( i = 0u; i < sizeof( invalid ) / sizeof( invalid[0] ); ++i )
+	{
+		iot_status_t result;
+		result = test_app_json_stream_chunks( stream, invalid[i], 2u );
+		assert_int_equal( result, IOT_STATUS_PARSE_ERROR );
+	}
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_parse_no_memory( void **state )
+{
+	char buf[256u];
+	char js[512u];
+	app_json_stream_t *stream;
+	iot_status_t result;
+
+	/* split value larger than the space left in the buffer */
+	memset( js, 'x', 511u );
+	js[0] = '"';
+	js[510] = '"';
+	js[511] = '\0';
+	stream = app_json_stream_initialize( buf, 256u, 0u,
+		test_app_json_stream_event, NULL );
+	assert_non_null( stream );
+	result = test_app_json_stream_chunks( stream, js, 64u );
+	assert_int_equal( result, IOT_STATUS_NO_MEMORY );
+
+	/* the same value is passed directly when not split */
+	result = test_app_json_stream_chunks( stream, js, 512u );
+	assert_int_equal( result, IOT_STATUS_SUCCESS );
+	app_json_stream_terminate( stream );
+}
+
+static void test_app_json_stream_parse_null_stream( void **state )
+{
+	iot_status_t result;
+	result = app_json_stream_parse( NULL, "[]", 2u, NULL, 0u );
+	assert_int_equal( result, IOT_STATUS_BAD_PARAMETER );
+}
+
+/* main */
+int main( int argc, char *argv[] )
+{
+	int result;
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test( test_app_json_stream_finish_incomplete ),
+		cmocka_unit_test( test_app_json_stream_finish_null_stream ),
+		cmocka_unit_test( test_app_json_stream_finish_root_number ),
+		cmocka_unit_test( test_app_json_stream_initialize_dynamic ),
+		cmocka_unit_test( test_app_json_stream_initialize_null_callback ),
+		cmocka_unit_test( test_app_json_stream_initialize_small_buffer ),
+		cmocka_unit_test( test_app_json_stream_parse_callback_failure ),
+		cmocka_unit_test( test_app_json_stream_parse_chunks ),
+		cmocka_unit_test( test_app_json_stream_parse_depth ),
+		cmocka_unit_test( test_app_json_stream_parse_escapes ),
+		cmocka_unit_test( test_app_json_stream_parse_invalid ),
+		cmocka_unit_test( test_app_json_stream_parse_no_memory ),
+		cmocka_unit_test( test_app_json_stream_parse_null_stream ),
+	};
+	test_initialize( argc, argv );
+	result = cmocka_run_group_tests( tests, NULL, NULL );
+	test_finalize( argc, argv );
+	return result;
+}